@@ -42,6 +42,15 @@ solution "0MySolution"
     description = "Disable C-API and its demos"
   } 
 
+  newoption {
+    trigger     = "pe-32bit-object-id",
+    description = "Use 32 bit rigid body ids and 64 bit pair keys in Physics Effects"
+  }
+
+	if _OPTIONS["pe-32bit-object-id"] then
+		defines { "SCE_PFX_USE_32BIT_OBJECT_ID" }
+	end
+
 	dofile ("findOpenCL.lua")
 	dofile ("findDirectX11.lua")
 	
@@ -78,6 +87,12 @@ end
 		include "../sample/api_physics_effects/4_motion_type"
 		include "../sample/api_physics_effects/5_raycast"
 		include "../sample/api_physics_effects/6_joint"
+		include "../sample/api_physics_effects/7_broadphase_benchmark"
+		include "../sample/api_physics_effects/8_pair_bandwidth_benchmark"
+		include "../sample/api_physics_effects/9_benchmark"
+		include "../sample/api_physics_effects/10_narrowphase_benchmark"
+		include "../sample/api_physics_effects/11_large_mesh_benchmark"
+		include "../sample/api_physics_effects/12_bake_large_mesh"
   end
 
 	if not _OPTIONS["no-bulletdemos"] and not _OPTIONS["no-bulletlibs"] then
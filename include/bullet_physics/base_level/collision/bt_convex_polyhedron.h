@@ -30,6 +30,16 @@ struct btFace
 	float	m_plane[4];
 };
 
+///an edge of the hull with the two faces that meet at it, m_faces[0] is the face
+///that walks the edge from m_vertices[0] to m_vertices[1]
+struct btPolyhedronEdge
+{
+	unsigned short	m_vertices[2];
+	unsigned short	m_faces[2];
+};
+
+class btConvexHullComputer;
+
 #define TEST_INTERNAL_OBJECTS 1
 
 
@@ -46,6 +56,7 @@ class SCE_PFX_ALIGNED(16) btConvexPolyhedron
 	btAlignedObjectArray<btVector3>	m_vertices;
 	btAlignedObjectArray<btFace>	m_faces;
 	btAlignedObjectArray<btVector3> m_uniqueEdges;
+	btAlignedObjectArray<btPolyhedronEdge> m_edges;
 
 #ifdef TEST_INTERNAL_OBJECTS
 	btVector3		m_extents;
@@ -58,7 +69,68 @@ class SCE_PFX_ALIGNED(16) btConvexPolyhedron
 
 	void	initialize();
 
+	///builds the faces and planes from a computed hull and initializes the polyhedron,
+	///returns false for an empty hull. btPackedConvexPolyhedron::build is the packed counterpart
+	bool	build(const btConvexHullComputer& hull);
+
+	///returns false for a face with more than MAXINDICESPERFACE vertices,
+	///which the inplace clipper and btPackedConvexPolyhedron can't hold
+	bool fitsInplaceClipper() const;
+
 	void project(const btTransform& trans, const btVector3& dir, float& min, float& max) const;
+
+	///accessors shared with btPackedConvexPolyhedron, the clipper reads the hulls through them
+	inline int getNumVertices() const
+	{
+		return m_vertices.size();
+	}
+	inline const btVector3& getVertex(int i) const
+	{
+		return m_vertices[i];
+	}
+
+	inline int getNumFaces() const
+	{
+		return m_faces.size();
+	}
+	inline btVector3 getFaceNormal(int face) const
+	{
+		return btVector3(m_faces[face].m_plane[0],m_faces[face].m_plane[1],m_faces[face].m_plane[2]);
+	}
+	inline btScalar getFacePlaneEq(int face) const
+	{
+		return m_faces[face].m_plane[3];
+	}
+	inline int getNumFaceVertices(int face) const
+	{
+		return m_faces[face].m_indices.size();
+	}
+	inline int getFaceVertexIndex(int face, int i) const
+	{
+		return m_faces[face].m_indices[i];
+	}
+	inline int getConnectedFace(int face, int i) const
+	{
+		return m_faces[face].m_connectedFaces[i];
+	}
+
+	inline int getNumUniqueEdges() const
+	{
+		return m_uniqueEdges.size();
+	}
+	inline const btVector3& getUniqueEdge(int i) const
+	{
+		return m_uniqueEdges[i];
+	}
+
+	inline int getNumEdges() const
+	{
+		return m_edges.size();
+	}
+	inline const btPolyhedronEdge& getEdge(int i) const
+	{
+		return m_edges[i];
+	}
 };
 
 
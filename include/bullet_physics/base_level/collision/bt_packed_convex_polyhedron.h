@@ -0,0 +1,143 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2011 Advanced Micro Devices, Inc.  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef BT_PACKED_CONVEX_POLYHEDRON_H
+#define BT_PACKED_CONVEX_POLYHEDRON_H
+
+#include "bullet_physics/bt_math_conversions.h"
+#include "bullet_physics/base_level/collision/bt_convex_polyhedron.h"
+
+class btConvexHullComputer;
+
+///Immutable, flattened version of btConvexPolyhedron.
+///All arrays share a single allocation: the vertices and unique edges, the vertices again
+///as separate x, y, z arrays for project, the face planes as separate x, y, z and d arrays,
+///the edges with their faces, and one pool of vertex indices and connected faces
+///addressed by per face offsets. The clipper walks the faces without touching any
+///per face heap block, so findSeparatingAxis and clipHullAgainstHull stay in a few cache lines.
+///Build it once from the btConvexHullComputer output, it can't be changed afterwards.
+class SCE_PFX_ALIGNED(16) btPackedConvexPolyhedron
+{
+public:
+	BT_DECLARE_ALIGNED_ALLOCATOR()
+
+	btPackedConvexPolyhedron();
+	~btPackedConvexPolyhedron();
+
+	///builds the polyhedron from a computed hull, returns false for an empty or too large hull,
+	///or for a face with more than MAXINDICESPERFACE vertices
+	bool build(const btConvexHullComputer& hull);
+
+	///packs an initialized btConvexPolyhedron, with the same limits
+	bool build(const btConvexPolyhedron& polyhedron);
+
+	btVector3		m_localCenter;
+
+#ifdef TEST_INTERNAL_OBJECTS
+	btVector3		m_extents;
+	btScalar		m_radius;
+#endif //TEST_INTERNAL_OBJECTS
+
+	inline int getNumVertices() const
+	{
+		return m_numVertices;
+	}
+	inline const btVector3& getVertex(int i) const
+	{
+		return m_vertices[i];
+	}
+
+	inline int getNumFaces() const
+	{
+		return m_numFaces;
+	}
+	inline btVector3 getFaceNormal(int face) const
+	{
+		return btVector3(m_planeX[face],m_planeY[face],m_planeZ[face]);
+	}
+	inline btScalar getFacePlaneEq(int face) const
+	{
+		return m_planeD[face];
+	}
+	inline int getNumFaceVertices(int face) const
+	{
+		return m_faceOffsets[face+1]-m_faceOffsets[face];
+	}
+	inline int getFaceVertexIndex(int face, int i) const
+	{
+		return m_faceIndices[m_faceOffsets[face]+i];
+	}
+	inline int getConnectedFace(int face, int i) const
+	{
+		return m_connectedFaces[m_faceOffsets[face]+i];
+	}
+
+	inline int getNumUniqueEdges() const
+	{
+		return m_numUniqueEdges;
+	}
+	inline const btVector3& getUniqueEdge(int i) const
+	{
+		return m_uniqueEdges[i];
+	}
+
+	inline int getNumEdges() const
+	{
+		return m_numEdges;
+	}
+	inline const btPolyhedronEdge& getEdge(int i) const
+	{
+		return m_edges[i];
+	}
+
+	///projects the vertices four at a time, with the direction taken to the local space
+	void project(const btTransform& trans, const btVector3& dir, float& min, float& max) const;
+
+private:
+	btPackedConvexPolyhedron(const btPackedConvexPolyhedron&);
+	btPackedConvexPolyhedron& operator=(const btPackedConvexPolyhedron&);
+
+	void	allocate(int numVertices, int numFaces, int numIndices, int numUniqueEdges, int numEdges);
+	void	release();
+	void	fillVertexArrays();
+	void	computeInternalObjects();
+#ifdef TEST_INTERNAL_OBJECTS
+	bool	testContainment() const;
+#endif //TEST_INTERNAL_OBJECTS
+
+	int				m_numVertices;
+	int				m_numFaces;
+	int				m_numIndices;
+	int				m_numUniqueEdges;
+	int				m_numEdges;
+
+	void*			m_buffer;
+
+	btVector3*		m_vertices;
+	btVector3*		m_uniqueEdges;
+	float*			m_vertexX;
+	float*			m_vertexY;
+	float*			m_vertexZ;
+	float*			m_planeX;
+	float*			m_planeY;
+	float*			m_planeZ;
+	float*			m_planeD;
+	int*			m_faceOffsets;
+	unsigned short*	m_faceIndices;
+	unsigned short*	m_connectedFaces;
+	btPolyhedronEdge*	m_edges;
+};
+
+#endif //BT_PACKED_CONVEX_POLYHEDRON_H
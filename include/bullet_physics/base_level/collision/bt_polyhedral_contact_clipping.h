@@ -24,17 +24,42 @@ subject to the following restrictions:
 
 #include "bullet_physics/bt_math_conversions.h"
 class btConvexPolyhedron;
+class btPackedConvexPolyhedron;
 
 
 
+///findSeparatingAxis prunes the edge pairs on the Gauss map only when the hulls don't have
+///many more edges than unique edge directions, see gUseGaussMapEdgePruning
+#define BT_GAUSS_MAP_MAX_EDGE_PAIR_RATIO 4
+
+///Separating axis of a pair from the previous frame, in the local space of hullA.
+///findSeparatingAxis tests it first and returns at once when the hulls are still separated along it,
+///and stores the new axis. Keep one per pair, m_valid is false for a new pair.
+///gSeparatingAxisCacheHits counts the pairs that returned on the cached axis.
+struct btSeparatingAxisCache
+{
+	btVector3	m_localAxis;
+	bool		m_valid;
+
+	btSeparatingAxisCache()
+		:m_valid(false)
+	{
+	}
+};
+
 /// Clips a face to the back of a plane
+/// The hulls are either btConvexPolyhedron or btPackedConvexPolyhedron, both are read through the same accessors
 template <typename BT_CONTACT_CACHE, typename BT_VERTEX_ARRAY>
 struct btPolyhedralContactClipping
 {
-	static void clipHullAgainstHull(const btVector3& separatingNormal, const btConvexPolyhedron& hullA, const btConvexPolyhedron& hullB, const btTransform& transA,const btTransform& transB, const btScalar minDist, btScalar maxDist, BT_CONTACT_CACHE& resultOut);
-	static void	clipFaceAgainstHull(const btVector3& separatingNormal, const btConvexPolyhedron& hullA,  const btTransform& transA, BT_VERTEX_ARRAY& worldVertsB1, const btTransform& transB, const btScalar minDist, btScalar maxDist, BT_CONTACT_CACHE& resultOut);
+	template <typename BT_POLYHEDRON>
+	static void clipHullAgainstHull(const btVector3& separatingNormal, const BT_POLYHEDRON& hullA, const BT_POLYHEDRON& hullB, const btTransform& transA,const btTransform& transB, const btScalar minDist, btScalar maxDist, BT_CONTACT_CACHE& resultOut);
+	template <typename BT_POLYHEDRON>
+	static void	clipFaceAgainstHull(const btVector3& separatingNormal, const BT_POLYHEDRON& hullA,  const btTransform& transA, BT_VERTEX_ARRAY& worldVertsB1, const btTransform& transB, const btScalar minDist, btScalar maxDist, BT_CONTACT_CACHE& resultOut);
 
-	static bool findSeparatingAxis(	const btConvexPolyhedron& hullA, const btConvexPolyhedron& hullB, const btTransform& transA,const btTransform& transB, btVector3& sep);
+	///returns false when the hulls are separated, sep is then the separating axis
+	template <typename BT_POLYHEDRON>
+	static bool findSeparatingAxis(	const BT_POLYHEDRON& hullA, const BT_POLYHEDRON& hullB, const btTransform& transA,const btTransform& transB, btVector3& sep, btSeparatingAxisCache* axisCache=0);
 
 	///the clipFace method is used internally
 	static void clipFace(const BT_VERTEX_ARRAY& pVtxIn, BT_VERTEX_ARRAY& ppVtxOut, const btVector3& planeNormalWS,btScalar planeEqWS);
@@ -44,6 +69,40 @@ struct btPolyhedralContactClipping
 #include "bt_polyhedral_contact_clipping.inl"
 
 
+#include "bullet_physics/util/bt_inplace_array.h"
+
+///Upper limit of the vertices of a clipped face. Clipping a convex polygon against a plane
+///adds at most one vertex, so a face of hullB clipped against the side planes of a face of
+///hullA stays below twice MAXINDICESPERFACE.
+#define BT_MAX_CLIP_VERTICES (2*MAXINDICESPERFACE)
+
+///Fixed capacity vertex array for the clipper that never touches the heap.
+///btPackedConvexPolyhedron::build rejects faces with more than MAXINDICESPERFACE vertices
+///and btConvexPolyhedron::fitsInplaceClipper reports them, so the array can't fill up. If it does anyway, push_back
+///asserts, and release builds drop the vertex instead of overrunning the array.
+template <int SIZE>
+class btBoundedVertexArray : public PfxInplaceArray<btVector3,SIZE>
+{
+public:
+	inline void push_back(const btVector3& v)
+	{
+		VMASSERT(this->size() < this->capacity());
+		if (this->size() < this->capacity())
+			PfxInplaceArray<btVector3,SIZE>::push_back(v);
+	}
+};
+
+typedef btBoundedVertexArray<BT_MAX_CLIP_VERTICES> btClipVertexArray;
+
+///Allocation-free contact clipping, all vertex arrays live on the stack.
+///Use it instead of instantiating btPolyhedralContactClipping with btAlignedObjectArray,
+///which allocates on every convex pair and contends on the heap lock when several threads run the narrowphase.
+template <typename BT_CONTACT_CACHE>
+struct btInplacePolyhedralContactClipping : public btPolyhedralContactClipping<BT_CONTACT_CACHE,btClipVertexArray>
+{
+};
+
+
 
 #endif // BT_POLYHEDRAL_CONTACT_CLIPPING_H
 
@@ -20,19 +20,25 @@ subject to the following restrictions:
 
 
 #include "bullet_physics/base_level/collision/bt_convex_polyhedron.h"
+#include "bullet_physics/base_level/collision/bt_packed_convex_polyhedron.h"
 
 #include <float.h> //for FLT_MAX
 #include <assert.h>
 
-int gActualNbTests=0;
-int gExpectedNbTests=0;
-int gActualSATPairTests=0;
-bool gUseInternalObject=true;
+///statistics and switches, defined in bt_polyhedral_contact_clipping.cpp
+extern int gActualNbTests;
+extern int gExpectedNbTests;
+extern int gActualSATPairTests;
+extern int gFaceAxisTests;
+extern int gEdgeEdgeTests;
+extern int gSeparatingAxisCacheHits;
+extern bool gUseInternalObject;
+extern bool gUseGaussMapEdgePruning;
 
 
 // Clips a face to the back of a plane
 template<typename BT_CONTACT_CACHE, typename BT_VERTEX_ARRAY>
-void btPolyhedralContactClipping<typename BT_CONTACT_CACHE, typename BT_VERTEX_ARRAY>::clipFace(const BT_VERTEX_ARRAY& pVtxIn, BT_VERTEX_ARRAY& ppVtxOut, const btVector3& planeNormalWS,btScalar planeEqWS)
+void btPolyhedralContactClipping<BT_CONTACT_CACHE, BT_VERTEX_ARRAY>::clipFace(const BT_VERTEX_ARRAY& pVtxIn, BT_VERTEX_ARRAY& ppVtxOut, const btVector3& planeNormalWS,btScalar planeEqWS)
 {
 	
 	int ve;
@@ -81,7 +87,8 @@ void btPolyhedralContactClipping<typename BT_CONTACT_CACHE, typename BT_VERTEX_A
 
 
 
-static bool TestSepAxis(const btConvexPolyhedron& hullA, const btConvexPolyhedron& hullB, const btTransform& transA,const btTransform& transB, const btVector3& sep_axis, float& depth)
+template <typename BT_POLYHEDRON>
+inline bool TestSepAxis(const BT_POLYHEDRON& hullA, const BT_POLYHEDRON& hullB, const btTransform& transA,const btTransform& transB, const btVector3& sep_axis, float& depth)
 {
 	float Min0,Max0;
 	float Min1,Max1;
@@ -117,7 +124,7 @@ inline void BoxSupport(const btVector3& extents, const btVector3& sv, btVector3&
 	p[2] = sv[2] < 0.0f ? -extents[2] : extents[2];
 }
 
-void InverseTransformPoint3x3(btVector3& out, const btVector3& in, const btTransform& tr)
+inline void InverseTransformPoint3x3(btVector3& out, const btVector3& in, const btTransform& tr)
 {
 	const btMatrix3x3& rot = VMGETBASIS(tr);
 	btVector3 r0 = rot.getRow(0);
@@ -131,7 +138,8 @@ void InverseTransformPoint3x3(btVector3& out, const btVector3& in, const btTrans
 	VMSET(out,x,y,z);
 }
 
-bool TestInternalObjects( const btTransform& trans0, const btTransform& trans1, const btVector3& delta_c, const btVector3& axis, const btConvexPolyhedron& convex0, const btConvexPolyhedron& convex1, btScalar dmin)
+template <typename BT_POLYHEDRON>
+inline bool TestInternalObjects( const btTransform& trans0, const btTransform& trans1, const btVector3& delta_c, const btVector3& axis, const BT_POLYHEDRON& convex0, const BT_POLYHEDRON& convex1, btScalar dmin)
 {
 	const btScalar dp = VMDOT(delta_c,axis);
 
@@ -163,8 +171,31 @@ bool TestInternalObjects( const btTransform& trans0, const btTransform& trans1,
 #endif //TEST_INTERNAL_OBJECTS
 
 
+///The arcs a-b and c-d of the Gauss maps of two edges cross, so the edges build a face
+///of the Minkowski difference. Edges that don't can't give the minimum separating axis.
+///b_x_a and d_x_c are the planes of the arcs. See Gregorius, The Separating Axis Test between Convex Polyhedra, GDC 2013
+inline bool IsMinkowskiFace(const btVector3& a, const btVector3& b, const btVector3& b_x_a, const btVector3& c, const btVector3& d, const btVector3& d_x_c)
+{
+	const btScalar CBA = VMDOT(c,b_x_a);
+	const btScalar DBA = VMDOT(d,b_x_a);
+	const btScalar ADC = VMDOT(a,d_x_c);
+	const btScalar BDC = VMDOT(b,d_x_c);
+
+	return CBA * DBA < 0.0f && ADC * BDC < 0.0f && CBA * BDC > 0.0f;
+}
+
+inline void StoreSeparatingAxis(btSeparatingAxisCache* axisCache, const btTransform& transA, const btVector3& sep)
+{
+	if (axisCache)
+	{
+		axisCache->m_localAxis = VMTRANSPOSE(VMGETBASIS(transA)) * sep;
+		axisCache->m_valid = true;
+	}
+}
+
 template<typename BT_CONTACT_CACHE, typename BT_VERTEX_ARRAY>
-bool btPolyhedralContactClipping<typename BT_CONTACT_CACHE, typename BT_VERTEX_ARRAY>::findSeparatingAxis(	const btConvexPolyhedron& hullA, const btConvexPolyhedron& hullB, const btTransform& transA,const btTransform& transB, btVector3& sep)
+template<typename BT_POLYHEDRON>
+bool btPolyhedralContactClipping<BT_CONTACT_CACHE, BT_VERTEX_ARRAY>::findSeparatingAxis(	const BT_POLYHEDRON& hullA, const BT_POLYHEDRON& hullB, const btTransform& transA,const btTransform& transB, btVector3& sep, btSeparatingAxisCache* axisCache)
 {
 	gActualSATPairTests++;
 
@@ -175,16 +206,31 @@ bool btPolyhedralContactClipping<typename BT_CONTACT_CACHE, typename BT_VERTEX_A
 #endif
 
 	float dmin = FLT_MAX;
-	int curPlaneTests=0;
 
-	int numFacesA = hullA.m_faces.size();
+	// Test the axis of the previous frame, the hulls are usually still separated along it
+	if (axisCache && axisCache->m_valid)
+	{
+		const btVector3 cachedAxisWS = VMGETBASIS(transA) * axisCache->m_localAxis;
+
+		float d;
+		if(!TestSepAxis( hullA, hullB, transA,transB, cachedAxisWS, d))
+		{
+			gSeparatingAxisCacheHits++;
+			sep = cachedAxisWS;
+			return false;
+		}
+
+		dmin = d;
+		sep = cachedAxisWS;
+	}
+
+	int numFacesA = hullA.getNumFaces();
 	// Test normals from hullA
 	for(int i=0;i<numFacesA;i++)
 	{
-		const btVector3 Normal(hullA.m_faces[i].m_plane[0], hullA.m_faces[i].m_plane[1], hullA.m_faces[i].m_plane[2]);
-		const btVector3 faceANormalWS = VMGETBASIS(transA) * Normal;
+		const btVector3 faceANormalWS = VMGETBASIS(transA) * hullA.getFaceNormal(i);
 
-		curPlaneTests++;
+		gFaceAxisTests++;
 #ifdef TEST_INTERNAL_OBJECTS
 		gExpectedNbTests++;
 		if(gUseInternalObject && !TestInternalObjects(transA,transB,DeltaC2, faceANormalWS, hullA, hullB, dmin))
@@ -194,7 +240,11 @@ bool btPolyhedralContactClipping<typename BT_CONTACT_CACHE, typename BT_VERTEX_A
 
 		float d;
 		if(!TestSepAxis( hullA, hullB, transA,transB, faceANormalWS, d))
+		{
+			sep = faceANormalWS;
+			StoreSeparatingAxis(axisCache,transA,sep);
 			return false;
+		}
 
 		if(d<dmin)
 		{
@@ -203,14 +253,13 @@ bool btPolyhedralContactClipping<typename BT_CONTACT_CACHE, typename BT_VERTEX_A
 		}
 	}
 
-	int numFacesB = hullB.m_faces.size();
+	int numFacesB = hullB.getNumFaces();
 	// Test normals from hullB
 	for(int i=0;i<numFacesB;i++)
 	{
-		const btVector3 Normal(hullB.m_faces[i].m_plane[0], hullB.m_faces[i].m_plane[1], hullB.m_faces[i].m_plane[2]);
-		const btVector3 WorldNormal = VMGETBASIS(transB) * Normal;
+		const btVector3 WorldNormal = VMGETBASIS(transB) * hullB.getFaceNormal(i);
 
-		curPlaneTests++;
+		gFaceAxisTests++;
 #ifdef TEST_INTERNAL_OBJECTS
 		gExpectedNbTests++;
 		if(gUseInternalObject && !TestInternalObjects(transA,transB,DeltaC2, WorldNormal, hullA, hullB, dmin))
@@ -220,7 +269,11 @@ bool btPolyhedralContactClipping<typename BT_CONTACT_CACHE, typename BT_VERTEX_A
 
 		float d;
 		if(!TestSepAxis(hullA, hullB,transA,transB, WorldNormal,d))
+		{
+			sep = WorldNormal;
+			StoreSeparatingAxis(axisCache,transA,sep);
 			return false;
+		}
 
 		if(d<dmin)
 		{
@@ -229,24 +282,43 @@ bool btPolyhedralContactClipping<typename BT_CONTACT_CACHE, typename BT_VERTEX_A
 		}
 	}
 
-	btVector3 edgeAstart,edgeAend,edgeBstart,edgeBend;
-
-	int curEdgeEdge = 0;
-	// Test edges
-	for(int e0=0;e0<hullA.m_uniqueEdges.size();e0++)
+	// gEdgeEdgeTests counts the edge axes that reach the internal object and separating axis tests
+	// Many parallel edges, like the sides of a prism, collapse into few unique edges.
+	// Testing the pairs of unique edges is then cheaper than walking all edge pairs on the Gauss map
+	const int numEdgePairs = hullA.getNumEdges() * hullB.getNumEdges();
+	const int numUniqueEdgePairs = hullA.getNumUniqueEdges() * hullB.getNumUniqueEdges();
+	if (gUseGaussMapEdgePruning && numEdgePairs > 0 && numEdgePairs <= BT_GAUSS_MAP_MAX_EDGE_PAIR_RATIO * numUniqueEdgePairs)
 	{
-		const btVector3 edge0 = hullA.m_uniqueEdges[e0];
-		const btVector3 WorldEdge0 = VMGETBASIS(transA) * edge0;
-		for(int e1=0;e1<hullB.m_uniqueEdges.size();e1++)
+		// Test the edge pairs that build a face of the Minkowski difference, in the local space of hullA
+		const btMatrix3x3 basisBtoA = VMTRANSPOSE(VMGETBASIS(transA)) * VMGETBASIS(transB);
+
+		for(int e1=0;e1<hullB.getNumEdges();e1++)
 		{
-			const btVector3 edge1 = hullB.m_uniqueEdges[e1];
-			const btVector3 WorldEdge1 = VMGETBASIS(transB) * edge1;
+			const btPolyhedronEdge& edgeB = hullB.getEdge(e1);
 
-			btVector3 Cross = VMCROSS(WorldEdge0,WorldEdge1);
-			curEdgeEdge++;
-			if(!IsAlmostZero(Cross))
+			// the Gauss map of the Minkowski difference holds the negated normals of hullB
+			const btVector3 c = -(basisBtoA * hullB.getFaceNormal(edgeB.m_faces[0]));
+			const btVector3 d = -(basisBtoA * hullB.getFaceNormal(edgeB.m_faces[1]));
+			const btVector3 d_x_c = VMCROSS(d,c);
+			const btVector3 edge1 = VMNORMALIZED(basisBtoA * (hullB.getVertex(edgeB.m_vertices[1]) - hullB.getVertex(edgeB.m_vertices[0])));
+
+			for(int e0=0;e0<hullA.getNumEdges();e0++)
 			{
-				Cross = VMNORMALIZED(Cross);
+				const btPolyhedronEdge& edgeA = hullA.getEdge(e0);
+				const btVector3 a = hullA.getFaceNormal(edgeA.m_faces[0]);
+				const btVector3 b = hullA.getFaceNormal(edgeA.m_faces[1]);
+
+				if(!IsMinkowskiFace(a,b,VMCROSS(b,a),c,d,d_x_c))
+					continue;
+
+				const btVector3 edge0 = VMNORMALIZED(hullA.getVertex(edgeA.m_vertices[1]) - hullA.getVertex(edgeA.m_vertices[0]));
+				btVector3 Cross = VMCROSS(edge0,edge1);
+				if(IsAlmostZero(Cross))
+					continue;
+
+				gEdgeEdgeTests++;
+
+				Cross = VMNORMALIZED(VMGETBASIS(transA) * Cross);
 
 #ifdef TEST_INTERNAL_OBJECTS
 				gExpectedNbTests++;
@@ -257,7 +329,11 @@ bool btPolyhedralContactClipping<typename BT_CONTACT_CACHE, typename BT_VERTEX_A
 
 				float dist;
 				if(!TestSepAxis( hullA, hullB, transA,transB, Cross, dist))
+				{
+					sep = Cross;
+					StoreSeparatingAxis(axisCache,transA,sep);
 					return false;
+				}
 
 				if(dist<dmin)
 				{
@@ -266,18 +342,59 @@ bool btPolyhedralContactClipping<typename BT_CONTACT_CACHE, typename BT_VERTEX_A
 				}
 			}
 		}
+	}
+	else
+	{
+		// Test all pairs of unique edges
+		for(int e0=0;e0<hullA.getNumUniqueEdges();e0++)
+		{
+			const btVector3 WorldEdge0 = VMGETBASIS(transA) * hullA.getUniqueEdge(e0);
+			for(int e1=0;e1<hullB.getNumUniqueEdges();e1++)
+			{
+				const btVector3 WorldEdge1 = VMGETBASIS(transB) * hullB.getUniqueEdge(e1);
+
+				btVector3 Cross = VMCROSS(WorldEdge0,WorldEdge1);
+				if(!IsAlmostZero(Cross))
+				{
+					gEdgeEdgeTests++;
+					Cross = VMNORMALIZED(Cross);
+
+#ifdef TEST_INTERNAL_OBJECTS
+					gExpectedNbTests++;
+					if(gUseInternalObject && !TestInternalObjects(transA,transB,DeltaC2, Cross, hullA, hullB, dmin))
+						continue;
+					gActualNbTests++;
+#endif
 
+					float dist;
+					if(!TestSepAxis( hullA, hullB, transA,transB, Cross, dist))
+					{
+						sep = Cross;
+						StoreSeparatingAxis(axisCache,transA,sep);
+						return false;
+					}
+
+					if(dist<dmin)
+					{
+						dmin = dist;
+						sep = Cross;
+					}
+				}
+			}
+		}
 	}
 
 	const btVector3 deltaC = VMGETTRANSLATION(transB) - VMGETTRANSLATION(transA);
 	if((VMDOT(deltaC,sep))>0.0f)
 		sep = -sep;
 
+	StoreSeparatingAxis(axisCache,transA,sep);
 	return true;
 }
 
 template<typename BT_CONTACT_CACHE, typename BT_VERTEX_ARRAY>
-void	btPolyhedralContactClipping<typename BT_CONTACT_CACHE, typename BT_VERTEX_ARRAY>::clipFaceAgainstHull(const btVector3& separatingNormal, const btConvexPolyhedron& hullA,  const btTransform& transA, BT_VERTEX_ARRAY& worldVertsB1, const btTransform& transB,const btScalar minDist, btScalar maxDist,BT_CONTACT_CACHE& resultOut)
+template<typename BT_POLYHEDRON>
+void	btPolyhedralContactClipping<BT_CONTACT_CACHE, BT_VERTEX_ARRAY>::clipFaceAgainstHull(const btVector3& separatingNormal, const BT_POLYHEDRON& hullA,  const btTransform& transA, BT_VERTEX_ARRAY& worldVertsB1, const btTransform& transB,const btScalar minDist, btScalar maxDist,BT_CONTACT_CACHE& resultOut)
 {
 	BT_VERTEX_ARRAY worldVertsB2;
 	BT_VERTEX_ARRAY* pVtxIn = &worldVertsB1;
@@ -286,10 +403,9 @@ void	btPolyhedralContactClipping<typename BT_CONTACT_CACHE, typename BT_VERTEX_A
 	int closestFaceA=-1;
 	{
 		btScalar dmin = FLT_MAX;
-		for(int face=0;face<hullA.m_faces.size();face++)
+		for(int face=0;face<hullA.getNumFaces();face++)
 		{
-			const btVector3 Normal(hullA.m_faces[face].m_plane[0], hullA.m_faces[face].m_plane[1], hullA.m_faces[face].m_plane[2]);
-			const btVector3 faceANormalWS = VMGETBASIS(transA) * Normal;
+			const btVector3 faceANormalWS = VMGETBASIS(transA) * hullA.getFaceNormal(face);
 		
 			btScalar d = VMDOT(faceANormalWS,separatingNormal);
 			if (d < dmin)
@@ -302,11 +418,8 @@ void	btPolyhedralContactClipping<typename BT_CONTACT_CACHE, typename BT_VERTEX_A
 	if (closestFaceA<0)
 		return;
 
-	const btFace& polyA = hullA.m_faces[closestFaceA];
-
 		// clip polygon to back of planes of all faces of hull A that are adjacent to witness face
-	int numContacts = pVtxIn->size();
-	int numVerticesA = polyA.m_indices.size();
+	int numVerticesA = hullA.getNumFaceVertices(closestFaceA);
 	for(int e0=0;e0<numVerticesA;e0++)
 	{
 		/*const btVector3& a = hullA.m_vertices[polyA.m_indices[e0]];
@@ -315,9 +428,9 @@ void	btPolyhedralContactClipping<typename BT_CONTACT_CACHE, typename BT_VERTEX_A
 		const btVector3 WorldEdge0 = transA.getBasis() * edge0;
 		*/
 
-		int otherFace = polyA.m_connectedFaces[e0];
-		btVector3 localPlaneNormal (hullA.m_faces[otherFace].m_plane[0],hullA.m_faces[otherFace].m_plane[1],hullA.m_faces[otherFace].m_plane[2]);
-		btScalar localPlaneEq = hullA.m_faces[otherFace].m_plane[3];
+		int otherFace = hullA.getConnectedFace(closestFaceA,e0);
+		btVector3 localPlaneNormal = hullA.getFaceNormal(otherFace);
+		btScalar localPlaneEq = hullA.getFacePlaneEq(otherFace);
 
 		btVector3 planeNormalWS = VMGETBASIS(transA)*localPlaneNormal;
 		btScalar planeEqWS=localPlaneEq-VMDOT(planeNormalWS,VMGETTRANSLATION(transA));
@@ -330,16 +443,20 @@ void	btPolyhedralContactClipping<typename BT_CONTACT_CACHE, typename BT_VERTEX_A
 		pVtxOut->resize(0);
 	}
 
-	btVector3 localPlaneNormal (polyA.m_plane[0],polyA.m_plane[1],polyA.m_plane[2]);
-	btScalar localPlaneEq = polyA.m_plane[3];
+	btVector3 localPlaneNormal = hullA.getFaceNormal(closestFaceA);
+	btScalar localPlaneEq = hullA.getFacePlaneEq(closestFaceA);
 	btVector3 planeNormalWS = VMGETBASIS(transA)*localPlaneNormal;
 	btScalar planeEqWS=localPlaneEq-VMDOT(planeNormalWS,VMGETTRANSLATION(transA));
 
+	if (!pVtxIn->size())
+		return;
+
 	resultOut.addContacts(planeNormalWS, planeEqWS, pVtxIn->size(), &pVtxIn->at(0));
 
 }
 template<typename BT_CONTACT_CACHE, typename BT_VERTEX_ARRAY>
-void	btPolyhedralContactClipping<typename BT_CONTACT_CACHE, typename BT_VERTEX_ARRAY>::clipHullAgainstHull(const btVector3& separatingNormal, const btConvexPolyhedron& hullA, const btConvexPolyhedron& hullB, const btTransform& transA,const btTransform& transB, const btScalar minDist, btScalar maxDist,BT_CONTACT_CACHE& resultOut)
+template<typename BT_POLYHEDRON>
+void	btPolyhedralContactClipping<BT_CONTACT_CACHE, BT_VERTEX_ARRAY>::clipHullAgainstHull(const btVector3& separatingNormal, const BT_POLYHEDRON& hullA, const BT_POLYHEDRON& hullB, const btTransform& transA,const btTransform& transB, const btScalar minDist, btScalar maxDist,BT_CONTACT_CACHE& resultOut)
 {
 
 	btScalar curMaxDist=maxDist;
@@ -347,10 +464,9 @@ void	btPolyhedralContactClipping<typename BT_CONTACT_CACHE, typename BT_VERTEX_A
 
 	{
 		btScalar dmax = -FLT_MAX;
-		for(int face=0;face<hullB.m_faces.size();face++)
+		for(int face=0;face<hullB.getNumFaces();face++)
 		{
-			const btVector3 Normal(hullB.m_faces[face].m_plane[0], hullB.m_faces[face].m_plane[1], hullB.m_faces[face].m_plane[2]);
-			const btVector3 WorldNormal = VMGETBASIS(transB) * Normal;
+			const btVector3 WorldNormal = VMGETBASIS(transB) * hullB.getFaceNormal(face);
 
 			btScalar d = VMDOT(WorldNormal,separatingNormal);
 			if (d > dmax)
@@ -373,11 +489,10 @@ void	btPolyhedralContactClipping<typename BT_CONTACT_CACHE, typename BT_VERTEX_A
 	// setup initial clip face (minimizing face from hull B)
 	BT_VERTEX_ARRAY worldVertsB1;
 	{
-		const btFace& polyB = hullB.m_faces[closestFaceB];
-		const int numVertices = polyB.m_indices.size();
+		const int numVertices = hullB.getNumFaceVertices(closestFaceB);
 		for(int e0=0;e0<numVertices;e0++)
 		{
-			const btVector3& b = hullB.m_vertices[polyB.m_indices[e0]];
+			const btVector3& b = hullB.getVertex(hullB.getFaceVertexIndex(closestFaceB,e0));
 			worldVertsB1.push_back(VMTRANS(transB,b));
 		}
 	}
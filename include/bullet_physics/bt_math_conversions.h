@@ -46,6 +46,7 @@ inline const T& VMMAX(const T& a, const T& b)
 
 //for transform
 #define VMGETBASIS(t) t.getUpper3x3()
+#define VMTRANSPOSE(m) transpose(m)
 #define VMGETTRANSLATION(t) t.getTranslation()
 #define VMTRANS(t,v) t*v+t.getTranslation()
 
@@ -19,6 +19,11 @@ subject to the following restrictions:
 
 #include "bullet_physics/util/bt_inplace_array.h"
 
+#ifndef btAssert
+#include <assert.h>
+#define btAssert(a) assert(a)
+#endif
+
 ///very basic hashable string implementation, compatible with btHashMap
 struct btHashString
 {
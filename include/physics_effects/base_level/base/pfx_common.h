@@ -62,6 +62,22 @@ namespace PhysicsEffects {
 
 typedef bool                        PfxBool;
 typedef float                       PfxFloat;
+
+//J SCE_PFX_USE_32BIT_OBJECT_IDを定義すると、剛体IDを32ビット、ペアのキーを64ビットにして
+//J 65536個を超える剛体を扱えるようにする。ペアのサイズは16バイトから32バイトになる
+//E Defining SCE_PFX_USE_32BIT_OBJECT_ID widens rigid body ids to 32 bits and
+//E pair keys to 64 bits, lifting the limit of 65536 rigid bodies. Broadphase
+//E and constraint pairs grow from 16 to 32 bytes.
+#ifdef SCE_PFX_USE_32BIT_OBJECT_ID
+typedef PfxUInt32                   PfxObjectId;
+typedef PfxUInt64                   PfxPairKey;
+#define SCE_PFX_MAX_OBJECT_IDS      0x40000000
+#else
+typedef PfxUInt16                   PfxObjectId;
+typedef PfxUInt32                   PfxPairKey;
+#define SCE_PFX_MAX_OBJECT_IDS      0x10000
+#endif
+
 } //namespace PhysicsEffects
 } //namespace sce
 
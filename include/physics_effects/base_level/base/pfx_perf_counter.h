@@ -20,20 +20,55 @@ Physics Effects under the filename: physics_effects_license.txt
 #include "pfx_common.h"
 
 //J パフォーマンス測定する場合はPFX_USE_PERFCOUNTERを定義
-//J ブックマークを使用する場合はPFX_USE_BOOKMARKを定義
+//J 定義されている場合、SCE_PFX_PUSH_MARKER/SCE_PFX_POP_MARKERはトレースに記録される
 
 //E Define SCE_PFX_USE_PERFCOUNTER to check performance
-//E Define SCE_PFX_USE_BOOKMARK to use bookmark
+//E When it is defined, SCE_PFX_PUSH_MARKER/SCE_PFX_POP_MARKER are recorded to the trace
 
 
 #define SCE_PFX_MAX_PERF_STR	32
 #define SCE_PFX_MAX_PERF_COUNT	20
 
 #define SCE_PFX_USE_PERFCOUNTER
-//#define SCE_PFX_USE_BOOKMARK
+
+#if !defined(_WIN32)
+	#include <time.h>
+	#if defined(SCE_PFX_USE_TSC)
+		#include <x86intrin.h>
+	#endif
+#endif
 
 namespace sce {
 namespace PhysicsEffects {
+
+///////////////////////////////////////////////////////////////////////////////
+// Timer
+
+//J 高分解能タイマーの現在値。WindowsではQueryPerformanceCounter、それ以外ではclock_gettime(CLOCK_MONOTONIC)
+//J SCE_PFX_USE_TSCを定義するとx86のタイムスタンプカウンタを直接読む
+//E Current value of the high resolution timer. QueryPerformanceCounter on
+//E Windows, clock_gettime(CLOCK_MONOTONIC) elsewhere. Define SCE_PFX_USE_TSC to
+//E read the x86 time stamp counter directly, which avoids the system call
+//E but assumes an invariant TSC.
+SCE_PFX_FORCE_INLINE PfxUInt64 pfxGetPerfTicks()
+{
+#if defined(_WIN32)
+	LARGE_INTEGER count;
+	QueryPerformanceCounter(&count);
+	return (PfxUInt64)count.QuadPart;
+#elif defined(SCE_PFX_USE_TSC)
+	return (PfxUInt64)__rdtsc();
+#else
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC,&t);
+	return (PfxUInt64)t.tv_sec * 1000000000ull + (PfxUInt64)t.tv_nsec;
+#endif
+}
+
+//J 1秒あたりのティック数。TSCの場合は初回呼び出し時に較正する
+//E Ticks per second. The TSC is calibrated on the first call.
+PfxFloat pfxGetPerfTicksPerSecond();
+
 #ifdef SCE_PFX_USE_PERFCOUNTER
 
 class PfxPerfCounter
@@ -44,25 +79,18 @@ private:
 	float m_freq;
 
 	SCE_PFX_PADDING(1,4)
-#ifdef _WIN32
-	LONGLONG  m_cnt[SCE_PFX_MAX_PERF_COUNT*2];
-#endif
+	PfxUInt64 m_cnt[SCE_PFX_MAX_PERF_COUNT*2];
 
 	void count(int i)
 	{
-#ifdef _WIN32
-		QueryPerformanceCounter( (LARGE_INTEGER *)&m_cnt[i] );
-#endif
+		SCE_PFX_ASSERT(i < SCE_PFX_MAX_PERF_COUNT*2);
+		m_cnt[i] = pfxGetPerfTicks();
 	}
 
 public:
 	PfxPerfCounter()
 	{
-#ifdef _WIN32
-		LARGE_INTEGER sPerfCountFreq;
-		QueryPerformanceFrequency(&sPerfCountFreq);
-		m_freq = (float)sPerfCountFreq.QuadPart;
-#endif
+		m_freq = pfxGetPerfTicksPerSecond();
 		resetCount();
 	}
 
@@ -93,12 +121,8 @@ public:
 
 	float getCountTime(int i)
 	{
-#if _WIN32
-	return (float)(m_cnt[i+1]-m_cnt[i]) / m_freq * 1000.0f;
-#else
-	return 0.f;
-#endif	
-}
+		return (float)(m_cnt[i+1]-m_cnt[i]) / m_freq * 1000.0f;
+	}
 
 	void printCount()
 	{
@@ -115,6 +139,112 @@ public:
 	}
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// Profiler
+
+//J 階層化されたスレッド毎のプロファイラ。
+//J pfxProfileBegin/pfxProfileEndで囲んだ区間を呼び出し階層ごとに集計し、
+//J pfxProfileEndFrameでフレーム毎の時間を記録して、最小・平均・99パーセンタイル・最大を求める。
+//J 各スレッドは初回呼び出し時に専用のバッファを取得するので、計測中にロックは発生しない。
+//J バッファはプロセス終了まで解放されないので、タスクマネージャのワーカーのような常駐スレッドで使用すること。
+//E Hierarchical per-thread profiler. Scopes opened with pfxProfileBegin and
+//E closed with pfxProfileEnd are accumulated per call path. pfxProfileEndFrame
+//E records the time of each path for the frame and keeps min, average, 99th
+//E percentile and max over the last SCE_PFX_PROFILE_HISTORY frames.
+//E Each thread takes its own buffer on first use, so measuring never locks.
+//E A thread keeps its buffer for the life of the process and at most
+//E SCE_PFX_MAX_PROFILE_THREADS threads are measured, so profile long lived
+//E worker threads such as those of the task manager.
+
+#define SCE_PFX_MAX_PROFILE_THREADS	16
+#define SCE_PFX_MAX_PROFILE_NODES	64
+#define SCE_PFX_MAX_PROFILE_DEPTH	16
+#define SCE_PFX_PROFILE_HISTORY		256
+
+struct PfxProfileStats {
+	const char *name;
+	PfxUInt32 depth;
+	PfxUInt32 numFrames;	// Frames in which the scope ran, up to SCE_PFX_PROFILE_HISTORY
+	PfxFloat callsPerFrame;
+	PfxFloat minTime;		// ms per frame
+	PfxFloat avgTime;
+	PfxFloat p99Time;
+	PfxFloat maxTime;
+};
+
+//J nameはプロファイラを使用している間有効な文字列（文字列リテラルなど）を渡すこと
+//E name must stay valid while the profiler is used, e.g. a string literal
+void pfxProfileBegin(const char *name);
+void pfxProfileEnd();
+
+//J フレームの終わりに、どのスレッドも区間の中にいない状態で呼び出す
+//E Call at the end of a frame while no thread is inside a scope
+void pfxProfileEndFrame();
+
+void pfxProfileReset();
+
+PfxUInt32 pfxGetNumProfileThreads();
+PfxUInt32 pfxGetNumProfileNodes(PfxUInt32 threadId);
+
+//J ノードは深さ優先順に並ぶ
+//E Nodes are listed in depth first order
+void pfxGetProfileStats(PfxUInt32 threadId,PfxUInt32 nodeId,PfxProfileStats &stats);
+
+void pfxPrintProfile();
+
+class PfxProfileScope
+{
+public:
+	PfxProfileScope(const char *name) {pfxProfileBegin(name);}
+	~PfxProfileScope() {pfxProfileEnd();}
+};
+
+#define SCE_PFX_PROFILE_CONCAT_(a,b) a##b
+#define SCE_PFX_PROFILE_CONCAT(a,b) SCE_PFX_PROFILE_CONCAT_(a,b)
+#define SCE_PFX_PROFILE_SCOPE(name) sce::PhysicsEffects::PfxProfileScope SCE_PFX_PROFILE_CONCAT(pfxProfileScope,__LINE__)(name)
+
+///////////////////////////////////////////////////////////////////////////////
+// Trace
+
+//J SCE_PFX_PUSH_MARKER/SCE_PFX_POP_MARKERの区間をスレッド毎のリングバッファに記録し、
+//J chrome://tracingやPerfettoで読めるJSON形式で書き出す。
+//J 各スレッドは初回の記録時にバッファの一部を取得し、以後は自分のリングにのみ書き込むのでロックは発生しない。
+//J リングが一杯になると古いイベントから上書きされる。
+//J トレースを停止している間、マーカーのコストはフラグの確認のみ。
+//E Records the scopes of SCE_PFX_PUSH_MARKER/SCE_PFX_POP_MARKER into a ring
+//E buffer per thread and writes them as trace event JSON, which can be loaded
+//E into chrome://tracing or Perfetto. Each thread takes a slice of the trace
+//E buffer when it first records an event and writes only to its own ring, so
+//E recording never locks. A full ring overwrites its oldest events.
+//E While the trace is stopped a marker costs a single flag check.
+
+struct PfxStartTraceParam {
+	void *traceBuff;
+	PfxUInt32 traceBytes;
+	PfxUInt32 maxThreads;
+};
+
+//J maxEventsは各スレッドのイベント数。2のべき乗に切り下げられる
+//E maxEvents is the number of events per thread, rounded down to a power of two
+PfxUInt32 pfxGetTraceBytesOfStartTrace(PfxUInt32 maxThreads,PfxUInt32 maxEvents);
+
+//J 以前の記録は破棄される。トレース中はtraceBuffを破棄しないでください
+//E Discards the previous recording. Keep traceBuff while tracing
+PfxInt32 pfxStartTrace(PfxStartTraceParam &param);
+
+//J pfxStartTrace、pfxStopTrace、pfxWriteTraceは、どのスレッドもマーカーを記録していない間に呼び出すこと
+//E Call pfxStartTrace, pfxStopTrace and pfxWriteTrace while no thread records markers
+void pfxStopTrace();
+
+//J 最後に記録したトレースをファイルに書き出す。閉じていない区間は停止時刻で閉じる
+//E Write the last recording to a file. Scopes still open are closed at the stop time
+PfxInt32 pfxWriteTrace(const char *filename);
+
+//J nameはトレースを書き出すまで有効な文字列（文字列リテラルなど）を渡すこと
+//E name must stay valid until the trace is written, e.g. a string literal
+void pfxPushTraceMarker(const char *name);
+void pfxPopTraceMarker();
+
 #else /* SCE_PFX_USE_PERFCOUNTER */
 
 class PfxPerfCounter
@@ -129,13 +259,48 @@ public:
 	void printCount() {}
 };
 
+struct PfxProfileStats {
+	const char *name;
+	PfxUInt32 depth;
+	PfxUInt32 numFrames;
+	PfxFloat callsPerFrame;
+	PfxFloat minTime;
+	PfxFloat avgTime;
+	PfxFloat p99Time;
+	PfxFloat maxTime;
+};
+
+inline void pfxProfileBegin(const char *name) {(void)name;}
+inline void pfxProfileEnd() {}
+inline void pfxProfileEndFrame() {}
+inline void pfxProfileReset() {}
+inline PfxUInt32 pfxGetNumProfileThreads() {return 0;}
+inline PfxUInt32 pfxGetNumProfileNodes(PfxUInt32 threadId) {(void)threadId;return 0;}
+inline void pfxGetProfileStats(PfxUInt32 threadId,PfxUInt32 nodeId,PfxProfileStats &stats) {(void)threadId;(void)nodeId;memset(&stats,0,sizeof(stats));}
+inline void pfxPrintProfile() {}
+
+#define SCE_PFX_PROFILE_SCOPE(name)
+
+struct PfxStartTraceParam {
+	void *traceBuff;
+	PfxUInt32 traceBytes;
+	PfxUInt32 maxThreads;
+};
+
+inline PfxUInt32 pfxGetTraceBytesOfStartTrace(PfxUInt32 maxThreads,PfxUInt32 maxEvents) {(void)maxThreads;(void)maxEvents;return 0;}
+inline PfxInt32 pfxStartTrace(PfxStartTraceParam &param) {(void)param;return SCE_PFX_OK;}
+inline void pfxStopTrace() {}
+inline PfxInt32 pfxWriteTrace(const char *filename) {(void)filename;return SCE_PFX_OK;}
+inline void pfxPushTraceMarker(const char *name) {(void)name;}
+inline void pfxPopTraceMarker() {}
+
 #endif /* SCE_PFX_USE_PERFCOUNTER */
 
 #define pfxInsertBookmark(bookmark)
 
-#ifdef SCE_PFX_USE_BOOKMARK
-	#define SCE_PFX_PUSH_MARKER(name)
-	#define SCE_PFX_POP_MARKER()
+#ifdef SCE_PFX_USE_PERFCOUNTER
+	#define SCE_PFX_PUSH_MARKER(name) sce::PhysicsEffects::pfxPushTraceMarker(name)
+	#define SCE_PFX_POP_MARKER() sce::PhysicsEffects::pfxPopTraceMarker()
 #else
 	#define SCE_PFX_PUSH_MARKER(name)
 	#define SCE_PFX_POP_MARKER()
@@ -24,6 +24,22 @@ namespace PhysicsEffects {
 
 #define SCE_PFX_NUMPRIMS 64
 
+///////////////////////////////////////////////////////////////////////////////
+// Shape BVH
+
+//J 形状のBVHのノード数。バッファはこの数のPfxAabb16を用意する
+//E Number of nodes of the shape BVH. Supply a buffer of this many PfxAabb16
+#define SCE_PFX_COLLIDABLE_BVH_NODES(numShapes) (2*(numShapes)-1)
+
+//J ノードはコリダブルのAABBの範囲で量子化したAABBで、空いている2要素に
+//J 葉の形状番号（内部ノードは0xffff）と部分木の次のノード番号を持つ
+//E A node is an AABB quantized over the AABB of the collidable. The two spare
+//E elements hold the shape of a leaf (0xffff for an internal node) and the
+//E index of the node that follows its subtree, as in the island BVH of PfxLargeTriMesh.
+#define SCE_PFX_COLLIDABLE_BVH_INTERNAL 0xffff
+
+SCE_PFX_FORCE_INLINE PfxUInt16 pfxGetBvhShapeId(const PfxAabb16 &node) {return node.get16(6);}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Collidable Object
 
@@ -40,7 +56,9 @@ private:
 	PfxFloat m_center[3];	// AABB center (Local)
 	PfxFloat m_half[3];		// AABB half (Local)
 	PfxShape m_defShape;
-	SCE_PFX_PADDING(2,32)
+	PfxAabb16 *m_bvhNodes;	// Shape BVH (Local)
+	PfxUInt8 m_numBvhNodes;
+	SCE_PFX_PADDING(2,23)
 
 	inline PfxShape &getNewShape();
 
@@ -48,6 +66,13 @@ public:
 	inline void reset();
 	inline void reset(PfxShape *base,PfxUInt16 *ids,int n=1);
 
+	//J bvhNodesを渡すと、finish()で形状のBVHを作成して衝突判定とレイキャストで形状を絞り込む
+	//J bvhNodesはSCE_PFX_COLLIDABLE_BVH_NODES(n)個の要素を持ち、コリダブルを使い終わるまで保持すること
+	//E With bvhNodes, finish() builds a BVH over the shapes that culls shape pairs
+	//E in collision detection and shapes in ray casts. bvhNodes holds
+	//E SCE_PFX_COLLIDABLE_BVH_NODES(n) nodes and must outlive the collidable.
+	inline void reset(PfxShape *base,PfxUInt16 *ids,PfxAabb16 *bvhNodes,int n);
+
 	void finish();
 
 	void addShape(const PfxShape &shape);
@@ -63,6 +88,20 @@ public:
 
 	inline PfxVector3 getHalf() const;
 	inline PfxVector3 getCenter() const;
+
+	// Shape BVH
+	inline PfxUInt32 getNumBvhNodes() const;
+	inline const PfxAabb16 &getBvhNode(int i) const;
+	inline void getBvhNodeAabb(int i,PfxVector3 &aabbMin,PfxVector3 &aabbMax) const;
+
+	//J 全ての形状をビットで返す
+	//E Returns a bit per shape
+	inline PfxUInt64 getAllShapes() const;
+
+	//J ローカル座標のAABBと重なる形状をビットで返す。BVHが無い場合は全ての形状を返す
+	//E Returns a bit per shape overlapping the AABB given in local coordinates.
+	//E Every shape is returned when there is no BVH.
+	PfxUInt64 getOverlappingShapes(const PfxVector3 &aabbMin,const PfxVector3 &aabbMax) const;
 };
 
 #include "pfx_collidable_implementation.h"
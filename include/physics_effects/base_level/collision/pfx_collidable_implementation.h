@@ -23,6 +23,8 @@ void PfxCollidable::reset()
 	m_shapeBase = NULL;
 	m_numShapes = 0;
 	m_maxShapes = 1;
+	m_bvhNodes = NULL;
+	m_numBvhNodes = 0;
 	m_center[0] = 0.0f;
 	m_center[1] = 0.0f;
 	m_center[2] = 0.0f;
@@ -46,6 +48,15 @@ void PfxCollidable::reset(PfxShape *base,PfxUInt16 *ids,int n)
 	m_half[0] = 0.0f;
 	m_half[1] = 0.0f;
 	m_half[2] = 0.0f;
+	m_bvhNodes = NULL;
+	m_numBvhNodes = 0;
+}
+
+inline
+void PfxCollidable::reset(PfxShape *base,PfxUInt16 *ids,PfxAabb16 *bvhNodes,int n)
+{
+	reset(base,ids,n);
+	m_bvhNodes = bvhNodes;
 }
 
 inline
@@ -111,4 +122,34 @@ PfxVector3 PfxCollidable::getCenter() const
 	return pfxReadVector3(m_center);
 }
 
+inline
+PfxUInt32 PfxCollidable::getNumBvhNodes() const
+{
+	return m_numBvhNodes;
+}
+
+inline
+PfxUInt64 PfxCollidable::getAllShapes() const
+{
+	return m_numShapes < 64 ? (((PfxUInt64)1 << m_numShapes) - 1) : ~(PfxUInt64)0;
+}
+
+inline
+const PfxAabb16 &PfxCollidable::getBvhNode(int i) const
+{
+	SCE_PFX_ASSERT(i<m_numBvhNodes);
+	return m_bvhNodes[i];
+}
+
+inline
+void PfxCollidable::getBvhNodeAabb(int i,PfxVector3 &aabbMin,PfxVector3 &aabbMax) const
+{
+	const PfxAabb16 &node = getBvhNode(i);
+	PfxVector3 half = getHalf();
+	PfxVector3 scale = half * (2.0f / 65535.0f);
+	PfxVector3 origin = getCenter() - half;
+	aabbMin = origin + mulPerElem(scale,PfxVector3((PfxFloat)pfxGetXMin(node),(PfxFloat)pfxGetYMin(node),(PfxFloat)pfxGetZMin(node)));
+	aabbMax = origin + mulPerElem(scale,PfxVector3((PfxFloat)pfxGetXMax(node),(PfxFloat)pfxGetYMax(node),(PfxFloat)pfxGetZMax(node)));
+}
+
 #endif // _SCE_PFX_COLLIDABLE_IMPLEMENTATION_H
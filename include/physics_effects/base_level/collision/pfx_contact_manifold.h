@@ -64,7 +64,7 @@ struct PfxContactPoint
 class SCE_PFX_ALIGNED(128) PfxContactManifold
 {
 private:
-	PfxUInt16 m_rigidBodyIdA,m_rigidBodyIdB;
+	PfxObjectId m_rigidBodyIdA,m_rigidBodyIdB;
 	PfxUInt16 m_duration;
 	PfxUInt16 m_numContacts;
 	PfxFloat  m_compositeFriction;
@@ -72,7 +72,15 @@ private:
 	PfxContactPoint m_contactPoints[SCE_PFX_NUMCONTACTS_PER_BODIES];
 	void		*m_userData;
 	PfxUInt32	m_userParam[4];
-	SCE_PFX_PADDING(1,28)
+	PfxFloat	m_cachedAxis[3];
+	PfxUInt8	m_cachedAxisShapeIdA;
+	PfxUInt8	m_cachedAxisShapeIdB;
+	PfxUInt8	m_cachedAxisFlag;
+#ifdef SCE_PFX_USE_32BIT_OBJECT_ID
+	SCE_PFX_PADDING(1,9)
+#else
+	SCE_PFX_PADDING(1,13)
+#endif
 
 	int findNearestContactPoint(const PfxPoint3 &newPoint,const PfxVector3 &newNormal);
 	int sort4ContactPoints(const PfxPoint3 &newPoint,PfxFloat newDistance);
@@ -85,11 +93,31 @@ public:
 	PfxUInt32 getInternalFlag() const {return m_internalFlag;}
 	void setInternalFlag(PfxUInt32 f) {m_internalFlag = f;}
 
+	//J 前回のGJKの分離軸（形状Aのローカル座標）。次のフレームのGJKの初期値に使う
+	//E Separating axis of the last GJK run in the local space of shape A, used to warm start the next frame
+	PfxBool getCachedAxis(PfxUInt8 &shapeIdA,PfxUInt8 &shapeIdB,PfxVector3 &axis) const
+	{
+		if(!m_cachedAxisFlag) return false;
+		shapeIdA = m_cachedAxisShapeIdA;
+		shapeIdB = m_cachedAxisShapeIdB;
+		axis = pfxReadVector3(m_cachedAxis);
+		return true;
+	}
+	void setCachedAxis(PfxUInt8 shapeIdA,PfxUInt8 shapeIdB,const PfxVector3 &axis)
+	{
+		m_cachedAxisShapeIdA = shapeIdA;
+		m_cachedAxisShapeIdB = shapeIdB;
+		pfxStoreVector3(axis,m_cachedAxis);
+		m_cachedAxisFlag = 1;
+	}
+	void clearCachedAxis() {m_cachedAxisFlag = 0;}
+
 public:
-	void reset(PfxUInt16 rigidBodyIdA,PfxUInt16 rigidBodyIdB)
+	void reset(PfxObjectId rigidBodyIdA,PfxObjectId rigidBodyIdB)
 	{
 		m_userData = 0;
 		m_userParam[0] = m_userParam[1] = m_userParam[2] = m_userParam[3] = 0;
+		m_cachedAxisFlag = 0;
 		m_numContacts = 0;
 		m_duration = 0;
 		m_rigidBodyIdA = rigidBodyIdA;
@@ -124,9 +152,9 @@ public:
 	
 	PfxUInt16 getDuration() const {return m_duration;}
 	
-	PfxUInt16 getRigidBodyIdA() const {return m_rigidBodyIdA;}
+	PfxObjectId getRigidBodyIdA() const {return m_rigidBodyIdA;}
 	
-	PfxUInt16 getRigidBodyIdB() const {return m_rigidBodyIdB;}
+	PfxObjectId getRigidBodyIdB() const {return m_rigidBodyIdB;}
 };
 
 } //namespace PhysicsEffects
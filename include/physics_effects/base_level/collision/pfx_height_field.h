@@ -0,0 +1,174 @@
+/*
+Physics Effects Copyright(C) 2011 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#ifndef _SCE_PFX_HEIGHT_FIELD_H
+#define _SCE_PFX_HEIGHT_FIELD_H
+
+#include "../base/pfx_common.h"
+#include "../base/pfx_vec_utils.h"
+#include "pfx_sub_data.h"
+
+namespace sce {
+namespace PhysicsEffects {
+
+//J 三角形の数の上限。PfxSubDataのアイランド番号と面番号の24ビットで三角形を表すため
+//E Upper limit of triangles, set by the 24 bits of the island and facet ids of PfxSubData
+#define SCE_PFX_MAX_HEIGHTFIELD_FACETS (1<<24)
+
+///////////////////////////////////////////////////////////////////////////////
+// Height Field
+
+//J 格子状に並べた高さからなる地形形状
+//J 高さ配列は m_numX * m_numZ 個で、(x,z)の高さは m_heights[z*m_numX+x]
+//J 格子はXZ平面上でローカル座標の原点を中心とし、セル(x,z)は2つの三角形
+//J (x,z)-(x,z+1)-(x+1,z+1) と (x,z)-(x+1,z+1)-(x+1,z) に分割される
+//J 高さ配列はコピーされないので、使い終わるまで保持すること
+//E Terrain shape made of heights sampled on a regular grid.
+//E There are m_numX * m_numZ heights, the height at (x,z) is m_heights[z*m_numX+x].
+//E The grid is centered on the local origin in the XZ plane and the cell (x,z)
+//E is split into the triangles (x,z)-(x,z+1)-(x+1,z+1) and (x,z)-(x+1,z+1)-(x+1,z).
+//E The heights are not copied and must outlive the height field.
+struct SCE_PFX_ALIGNED(16) PfxHeightField
+{
+	//J ハイトフィールドのサイズ
+	//E Size of a height field
+	PfxVector3 m_half;
+
+	//J X,Z方向のサンプル数（2以上）
+	//E Number of samples along X and Z (2 or more)
+	PfxUInt32 m_numX;
+	PfxUInt32 m_numZ;
+
+	//J セルの大きさ
+	//E Size of a cell
+	PfxFloat m_cellSizeX;
+	PfxFloat m_cellSizeZ;
+
+	//J 面の厚み
+	//E Thickness of the facets
+	PfxFloat m_thickness;
+
+	//J 高さの範囲（updateAABBで計算する）
+	//E Range of the heights (calculated by updateAABB)
+	PfxFloat m_minHeight;
+	PfxFloat m_maxHeight;
+	SCE_PFX_PADDING(1,4)
+
+	//J 高さ配列
+	//E Array of heights
+	const PfxFloat *m_heights;
+
+	PfxHeightField()
+	{
+		m_numX = m_numZ = 0;
+		m_cellSizeX = m_cellSizeZ = 1.0f;
+		m_thickness = 0.1f;
+		m_minHeight = m_maxHeight = 0.0f;
+		m_heights = NULL;
+	}
+
+	//J 高さの範囲とサイズを計算する。高さを変更したら呼び出すこと
+	//J 三角形の数がSCE_PFX_MAX_HEIGHTFIELD_FACETSを超える格子は停止する
+	//E Calculates the range of heights and the size. Call it whenever the heights change
+	//E Halts on a grid with more than SCE_PFX_MAX_HEIGHTFIELD_FACETS triangles
+	inline void updateAABB();
+
+	PfxUInt32 getNumCellsX() const {return m_numX-1;}
+	PfxUInt32 getNumCellsZ() const {return m_numZ-1;}
+
+	PfxFloat getHeight(PfxUInt32 x,PfxUInt32 z) const {return m_heights[z*m_numX+x];}
+
+	//J サンプル(x,z)のローカル座標
+	//E Local position of the sample (x,z)
+	inline PfxVector3 getVertex(PfxUInt32 x,PfxUInt32 z) const;
+
+	//J セルの三角形(0か1)の頂点
+	//E Vertices of a triangle (0 or 1) of a cell
+	inline void getTriangle(PfxUInt32 cellX,PfxUInt32 cellZ,PfxUInt32 triangle,PfxVector3 *verts) const;
+
+	//J 衝突点やレイの交点のPfxSubDataと三角形を対応付ける
+	//E Maps the PfxSubData of a contact or a ray hit to a triangle and back
+	inline void setFacet(PfxSubData &subData,PfxUInt32 cellX,PfxUInt32 cellZ,PfxUInt32 triangle) const;
+	inline void getFacet(PfxSubData subData,PfxUInt32 &cellX,PfxUInt32 &cellZ,PfxUInt32 &triangle) const;
+};
+
+inline
+void PfxHeightField::updateAABB()
+{
+	SCE_PFX_ALWAYS_ASSERT_MSG(m_numX >= 2 && m_numZ >= 2,"height field needs 2 or more samples along X and Z");
+	SCE_PFX_ALWAYS_ASSERT_MSG((PfxUInt64)getNumCellsX() * getNumCellsZ() * 2 <= SCE_PFX_MAX_HEIGHTFIELD_FACETS,"too many height field cells");
+
+	PfxFloat minHeight = m_heights[0];
+	PfxFloat maxHeight = m_heights[0];
+	for(PfxUInt32 i=1;i<m_numX*m_numZ;i++) {
+		minHeight = SCE_PFX_MIN(minHeight,m_heights[i]);
+		maxHeight = SCE_PFX_MAX(maxHeight,m_heights[i]);
+	}
+	m_minHeight = minHeight;
+	m_maxHeight = maxHeight;
+
+	m_half = PfxVector3(
+		0.5f * m_cellSizeX * getNumCellsX(),
+		SCE_PFX_MAX(fabsf(minHeight-m_thickness),fabsf(maxHeight)),
+		0.5f * m_cellSizeZ * getNumCellsZ());
+}
+
+inline
+PfxVector3 PfxHeightField::getVertex(PfxUInt32 x,PfxUInt32 z) const
+{
+	return PfxVector3(
+		x * m_cellSizeX - m_half[0],
+		getHeight(x,z),
+		z * m_cellSizeZ - m_half[2]);
+}
+
+inline
+void PfxHeightField::getTriangle(PfxUInt32 cellX,PfxUInt32 cellZ,PfxUInt32 triangle,PfxVector3 *verts) const
+{
+	verts[0] = getVertex(cellX,cellZ);
+	if(triangle == 0) {
+		verts[1] = getVertex(cellX,cellZ+1);
+		verts[2] = getVertex(cellX+1,cellZ+1);
+	}
+	else {
+		verts[1] = getVertex(cellX+1,cellZ+1);
+		verts[2] = getVertex(cellX+1,cellZ);
+	}
+}
+
+inline
+void PfxHeightField::setFacet(PfxSubData &subData,PfxUInt32 cellX,PfxUInt32 cellZ,PfxUInt32 triangle) const
+{
+	PfxUInt32 facetId = (cellZ * getNumCellsX() + cellX) * 2 + triangle;
+	SCE_PFX_ASSERT(facetId < SCE_PFX_MAX_HEIGHTFIELD_FACETS);
+	subData.setIslandId((PfxUInt16)(facetId >> 8));
+	subData.setFacetId((PfxUInt8)(facetId & 0xff));
+}
+
+inline
+void PfxHeightField::getFacet(PfxSubData subData,PfxUInt32 &cellX,PfxUInt32 &cellZ,PfxUInt32 &triangle) const
+{
+	PfxUInt32 facetId = ((PfxUInt32)subData.getIslandId() << 8) | subData.getFacetId();
+	PfxUInt32 cellId = facetId >> 1;
+	cellX = cellId % getNumCellsX();
+	cellZ = cellId / getNumCellsX();
+	triangle = facetId & 1;
+}
+
+} // namespace PhysicsEffects
+} // namespace sce
+
+#endif // _SCE_PFX_HEIGHT_FIELD_H
@@ -22,7 +22,35 @@ Physics Effects under the filename: physics_effects_license.txt
 namespace sce {
 namespace PhysicsEffects {
 
-#define SCE_PFX_MAX_LARGETRIMESH_ISLANDS 256
+//J アイランド数の上限。BVHのノード番号とPfxSubDataのアイランド番号が16ビットのため
+//E Upper limit of islands, set by the 16 bit BVH node indices and PfxSubData island ids
+#define SCE_PFX_MAX_LARGETRIMESH_ISLANDS 32768
+
+///////////////////////////////////////////////////////////////////////////////
+// Island BVH
+
+//J BVHのノードはアイランドと同じ量子化AABBで、空いている2要素に
+//J 葉のアイランド番号（内部ノードは0xffff）と部分木の次のノード番号を持つ
+//E A BVH node is a quantized AABB like the island AABBs. The two spare
+//E elements hold the island of a leaf (0xffff for an internal node) and the
+//E index of the node that follows its subtree in depth first order, so the
+//E tree is walked without a stack.
+#define SCE_PFX_LARGETRIMESH_BVH_INTERNAL 0xffff
+
+SCE_PFX_FORCE_INLINE void pfxSetBvhIslandId(PfxAabb16 &node,PfxUInt16 i) {node.set16(6,i);}
+SCE_PFX_FORCE_INLINE void pfxSetBvhEscapeId(PfxAabb16 &node,PfxUInt16 i) {node.set16(7,i);}
+
+SCE_PFX_FORCE_INLINE PfxUInt16 pfxGetBvhIslandId(const PfxAabb16 &node) {return node.get16(6);}
+SCE_PFX_FORCE_INLINE PfxUInt16 pfxGetBvhEscapeId(const PfxAabb16 &node) {return node.get16(7);}
+
+SCE_PFX_FORCE_INLINE
+bool pfxTestAabb(const PfxAabb16 &aabb,const PfxVecInt3 &aabbMinL,const PfxVecInt3 &aabbMaxL)
+{
+	if(aabbMaxL.getX() < pfxGetXMin(aabb) || aabbMinL.getX() > pfxGetXMax(aabb)) return false;
+	if(aabbMaxL.getY() < pfxGetYMin(aabb) || aabbMinL.getY() > pfxGetYMax(aabb)) return false;
+	if(aabbMaxL.getZ() < pfxGetZMin(aabb) || aabbMinL.getZ() > pfxGetZMax(aabb)) return false;
+	return true;
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 // Large Mesh
@@ -49,11 +77,21 @@ public:
 	//E Array of island
 	PfxTriMesh *m_islands;
 
+	//J アイランドのBVH（深さ優先順）。NULLの場合はm_aabbListを線形に探索する
+	//E BVH over the islands in depth first order. When NULL, m_aabbList is scanned linearly
+	PfxUInt16 m_numBvhNodes;
+	SCE_PFX_PADDING(3,2)
+	PfxAabb16 *m_bvhNodes;
+
 	PfxLargeTriMesh()
 	{
+		m_half = PfxVector3(0.0f);
 		m_numIslands = 0;
+		m_axis = 0;
 		m_islands = NULL;
 		m_aabbList = NULL;
+		m_numBvhNodes = 0;
+		m_bvhNodes = NULL;
 	}
 	
 	inline bool testAABB(int islandId,const PfxVector3 &center,const PfxVector3 &half) const;
@@ -76,11 +114,7 @@ bool PfxLargeTriMesh::testAABB(int islandId,const PfxVector3 &center,const PfxVe
 	PfxVecInt3 aabbMinL = getLocalPosition(center-half);
 	PfxVecInt3 aabbMaxL = getLocalPosition(center+half);
 	
-	if(aabbMaxL.getX() < pfxGetXMin(m_aabbList[islandId]) || aabbMinL.getX() > pfxGetXMax(m_aabbList[islandId])) return false;
-	if(aabbMaxL.getY() < pfxGetYMin(m_aabbList[islandId]) || aabbMinL.getY() > pfxGetYMax(m_aabbList[islandId])) return false;
-	if(aabbMaxL.getZ() < pfxGetZMin(m_aabbList[islandId]) || aabbMinL.getZ() > pfxGetZMax(m_aabbList[islandId])) return false;
-	
-	return true;
+	return pfxTestAabb(m_aabbList[islandId],aabbMinL,aabbMaxL);
 }
 
 inline
@@ -48,7 +48,7 @@ struct SCE_PFX_ALIGNED(16) PfxRayOutput
 	PfxVector3 m_contactPoint;
 	PfxVector3 m_contactNormal;
 	PfxFloat   m_variable;
-	PfxUInt16  m_objectId;
+	PfxObjectId m_objectId;
 	PfxUInt8   m_shapeId;
 	PfxBool    m_contactFlag : 1;
 	PfxSubData m_subData;
@@ -25,6 +25,7 @@ Physics Effects under the filename: physics_effects_license.txt
 #include "pfx_cylinder.h"
 #include "pfx_tri_mesh.h"
 #include "pfx_large_tri_mesh.h"
+#include "pfx_height_field.h"
 
 namespace sce {
 namespace PhysicsEffects {
@@ -37,7 +38,7 @@ enum ePfxShapeType
 	kPfxShapeCylinder,	
 	kPfxShapeConvexMesh,
 	kPfxShapeLargeTriMesh,
-	kPfxShapeReserved0,
+	kPfxShapeHeightField,
 	kPfxShapeReserved1,
 	kPfxShapeReserved2,
 	kPfxShapeUser0,
@@ -78,6 +79,7 @@ public:
 	inline void setSphere(PfxSphere sphere);
 	inline void setConvexMesh(const PfxConvexMesh *convexMesh);
 	inline void setLargeTriMesh(const PfxLargeTriMesh *largeMesh);
+	inline void setHeightField(const PfxHeightField *heightField);
 
 	inline PfxUInt8			getType() const;
 	inline PfxBox			getBox()const ;
@@ -86,6 +88,7 @@ public:
 	inline PfxSphere		getSphere() const;
 	inline const PfxConvexMesh*   getConvexMesh() const;
 	inline const PfxLargeTriMesh* getLargeTriMesh() const;
+	inline const PfxHeightField*  getHeightField() const;
 
 	// Offset
 	inline void setOffsetTransform(const PfxTransform3 & xfrm);
@@ -80,6 +80,14 @@ void PfxShape::setLargeTriMesh(const PfxLargeTriMesh *largeMesh)
 	m_type = kPfxShapeLargeTriMesh;
 }
 
+inline
+void PfxShape::setHeightField(const PfxHeightField *heightField)
+{
+	m_vecDataPtr[0] = (void*)heightField;
+	m_vecDataPtr[1] = NULL;
+	m_type = kPfxShapeHeightField;
+}
+
 inline
 void PfxShape::setOffsetTransform(const PfxTransform3 & xfrm)
 {
@@ -137,6 +145,14 @@ const PfxLargeTriMesh *PfxShape::getLargeTriMesh() const
 	return (PfxLargeTriMesh*)m_vecDataPtr[0];
 }
 
+inline
+const PfxHeightField *PfxShape::getHeightField() const
+{
+	SCE_PFX_ALWAYS_ASSERT(m_type==kPfxShapeHeightField);
+	SCE_PFX_ALWAYS_ASSERT(m_vecDataPtr[0]!=NULL);
+	return (PfxHeightField*)m_vecDataPtr[0];
+}
+
 inline
 PfxTransform3 PfxShape::getOffsetTransform() const
 {
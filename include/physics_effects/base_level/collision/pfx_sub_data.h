@@ -29,15 +29,10 @@ struct PfxSubData {
 	union {
 		struct {
 			PfxUInt8  m_type;
-			SCE_PFX_PADDING(1,1)
-
-			struct {
-				PfxUInt8  islandId;
-				PfxUInt8  facetId;
-				PfxUInt16 s;
-				PfxUInt16 t;
-
-			} m_facetLocal;
+			PfxUInt8  m_facetId;
+			PfxUInt16 m_islandId;
+			PfxUInt16 m_facetLocalS;
+			PfxUInt16 m_facetLocalT;
 		};
 		PfxUInt32 param[2];
 	};
@@ -47,15 +42,15 @@ struct PfxSubData {
 		param[0] = param[1] = 0;
 	}
 
-	void  setIslandId(PfxUInt8 i) {m_facetLocal.islandId = i;}
-	void  setFacetId(PfxUInt8 i) {m_facetLocal.facetId = i;}
-	void  setFacetLocalS(PfxFloat s) {m_facetLocal.s = (PfxUInt16)(s * 65535.0f);}
-	void  setFacetLocalT(PfxFloat t) {m_facetLocal.t = (PfxUInt16)(t * 65535.0f);}
+	void  setIslandId(PfxUInt16 i) {m_islandId = i;}
+	void  setFacetId(PfxUInt8 i) {m_facetId = i;}
+	void  setFacetLocalS(PfxFloat s) {m_facetLocalS = (PfxUInt16)(s * 65535.0f);}
+	void  setFacetLocalT(PfxFloat t) {m_facetLocalT = (PfxUInt16)(t * 65535.0f);}
 
-	PfxUInt8 getIslandId() {return m_facetLocal.islandId;}
-	PfxUInt8 getFacetId() {return m_facetLocal.facetId;}
-	PfxFloat getFacetLocalS() {return m_facetLocal.s / 65535.0f;}
-	PfxFloat getFacetLocalT() {return m_facetLocal.t / 65535.0f;}
+	PfxUInt16 getIslandId() {return m_islandId;}
+	PfxUInt8 getFacetId() {return m_facetId;}
+	PfxFloat getFacetLocalS() {return m_facetLocalS / 65535.0f;}
+	PfxFloat getFacetLocalT() {return m_facetLocalT / 65535.0f;}
 };
 
 } //namespace PhysicsEffects
@@ -120,6 +120,14 @@ void PfxTriMesh::updateAABB()
 ///////////////////////////////////////////////////////////////////////////////
 // Convex Mesh
 
+//J 頂点の隣接リストの要素数の上限。三角形の辺の両方向を格納する
+//E Upper limit of the vertex adjacency list, which holds both directions of the triangle edges
+#define SCE_PFX_NUMMESHADJACENCY	(SCE_PFX_NUMMESHFACETS*6)
+
+//J 頂点数がこの数以下の凸メッシュは隣接リストを辿らずに全頂点を調べる
+//E Convex meshes with this many vertices or fewer check every vertex instead of walking the adjacency
+#define SCE_PFX_CONVEX_BRUTE_FORCE_VERTICES	16
+
 struct SCE_PFX_ALIGNED(16) PfxConvexMesh
 {
 	PfxUInt8 m_numVerts;
@@ -128,14 +136,33 @@ struct SCE_PFX_ALIGNED(16) PfxConvexMesh
 	SCE_PFX_PADDING(1,14)
 	PfxVector3 m_verts[SCE_PFX_NUMMESHVERTICES];
 	PfxVector3 m_half;
-	SCE_PFX_PADDING(2,16)
+
+	//J 頂点iに隣接する頂点は m_adjVerts[m_adjOffsets[i]] から m_adjVerts[m_adjOffsets[i+1]-1] まで
+	//J 同じ位置の頂点は最初の頂点にまとめられ、それ以外の頂点の隣接リストは空になる
+	//E The vertices adjacent to vertex i are m_adjVerts[m_adjOffsets[i]] to m_adjVerts[m_adjOffsets[i+1]-1].
+	//E Vertices sharing a position are welded to the first one, the others have empty lists.
+	PfxUInt16 m_adjOffsets[SCE_PFX_NUMMESHVERTICES+1];
+	PfxUInt8 m_adjVerts[SCE_PFX_NUMMESHADJACENCY];
+	SCE_PFX_PADDING(2,14)
 
 	PfxConvexMesh()
 	{
 		m_numVerts = m_numIndices = 0;
+		for(int i=0;i<=SCE_PFX_NUMMESHVERTICES;i++) {
+			m_adjOffsets[i] = 0;
+		}
 	}
 	
 	inline void updateAABB();
+
+	//J 頂点の隣接リストを作成する。頂点か面を変更したら呼び出すこと
+	//J 辺を持たない溶接先の頂点がある場合は隣接リストを作らず、サポート関数は全頂点を調べる
+	//E Builds the vertex adjacency. Call it whenever the vertices or the triangles change.
+	//E If a welded vertex has no edge, e.g. it is not used by any triangle, no adjacency
+	//E is built and the support function checks every vertex instead.
+	inline void updateAdjacency();
+
+	PfxBool hasAdjacency() const {return m_adjOffsets[m_numVerts] > 0;}
 };
 
 inline
@@ -148,6 +175,59 @@ void PfxConvexMesh::updateAABB()
 	m_half = halfMax;
 }
 
+inline
+void PfxConvexMesh::updateAdjacency()
+{
+	// 同じ位置の頂点を最初の頂点にまとめる
+	PfxUInt8 weld[SCE_PFX_NUMMESHVERTICES];
+	for(int i=0;i<m_numVerts;i++) {
+		weld[i] = (PfxUInt8)i;
+		for(int j=0;j<i;j++) {
+			if(weld[j] == j &&
+			   m_verts[i][0] == m_verts[j][0] && m_verts[i][1] == m_verts[j][1] && m_verts[i][2] == m_verts[j][2]) {
+				weld[i] = (PfxUInt8)j;
+				break;
+			}
+		}
+	}
+
+	// 辺を隣接行列に登録
+	PfxUInt32 adjBits[SCE_PFX_NUMMESHVERTICES][SCE_PFX_NUMMESHVERTICES/32];
+	for(int i=0;i<m_numVerts;i++) {
+		for(int j=0;j<SCE_PFX_NUMMESHVERTICES/32;j++) {
+			adjBits[i][j] = 0;
+		}
+	}
+
+	for(int i=0;i<m_numIndices;i++) {
+		PfxUInt32 v0 = weld[m_indices[i]];
+		PfxUInt32 v1 = weld[m_indices[i%3==2?i-2:i+1]];
+		if(v0 == v1) continue;
+		adjBits[v0][v1>>5] |= 1u<<(v1&31);
+		adjBits[v1][v0>>5] |= 1u<<(v0&31);
+	}
+
+	PfxUInt32 numAdjVerts = 0;
+	for(int i=0;i<m_numVerts;i++) {
+		m_adjOffsets[i] = (PfxUInt16)numAdjVerts;
+		for(int j=0;j<m_numVerts;j++) {
+			if(adjBits[i][j>>5] & (1u<<(j&31))) {
+				SCE_PFX_ASSERT(numAdjVerts < SCE_PFX_NUMMESHADJACENCY);
+				m_adjVerts[numAdjVerts++] = (PfxUInt8)j;
+			}
+		}
+
+		// 辺を持たない溶接先の頂点（三角形から参照されない頂点など）からは辿れないので、隣接リストを使わない
+		if(weld[i] == i && m_adjOffsets[i] == numAdjVerts) {
+			for(int j=0;j<=m_numVerts;j++) {
+				m_adjOffsets[j] = 0;
+			}
+			return;
+		}
+	}
+	m_adjOffsets[m_numVerts] = (PfxUInt16)numAdjVerts;
+}
+
 } // namespace PhysicsEffects
 } // namespace sce
 
@@ -58,9 +58,11 @@ private:
 	};
 	PfxUInt8	m_motionType;
 	PfxUInt16	m_sleepCount;
-	PfxUInt16	m_rigidBodyId;
+	PfxObjectId	m_rigidBodyId;
 
+#ifndef SCE_PFX_USE_32BIT_OBJECT_ID
 	SCE_PFX_PADDING(1,2)
+#endif
 
 	PfxUInt32	m_contactFilterSelf;
 	PfxUInt32	m_contactFilterTarget;
@@ -84,8 +86,8 @@ private:
 public:
 	inline void reset();
 
-	PfxUInt16	getRigidBodyId() const {return m_rigidBodyId;}
-	void		setRigidBodyId(PfxUInt16 i) {m_rigidBodyId = i;}
+	PfxObjectId	getRigidBodyId() const {return m_rigidBodyId;}
+	void		setRigidBodyId(PfxObjectId i) {m_rigidBodyId = i;}
 
 	PfxUInt32	getContactFilterSelf() const {return m_contactFilterSelf;}
 	void		setContactFilterSelf(PfxUInt32 filter) {m_contactFilterSelf = filter;}
@@ -50,9 +50,13 @@ struct SCE_PFX_ALIGNED(128) PfxJoint {
 	PfxUInt8 m_numConstraints;
 	PfxUInt8 m_type;
 	SCE_PFX_PADDING(1,1)
-	PfxUInt16 m_rigidBodyIdA;
-	PfxUInt16 m_rigidBodyIdB;
+	PfxObjectId m_rigidBodyIdA;
+	PfxObjectId m_rigidBodyIdB;
+#ifdef SCE_PFX_USE_32BIT_OBJECT_ID
+	SCE_PFX_PADDING(2,4)
+#else
 	SCE_PFX_PADDING(2,8)
+#endif
 	PfxJointConstraint m_constraints[6];
 	void *m_userData;
 	SCE_PFX_PADDING(3,12)
@@ -26,6 +26,7 @@ namespace PhysicsEffects {
 
 void pfxSort(PfxSortData16 *data,PfxSortData16 *buff,unsigned int n);
 void pfxSort(PfxSortData32 *data,PfxSortData32 *buff,unsigned int n);
+void pfxSort(PfxSortData32Key64 *data,PfxSortData32Key64 *buff,unsigned int n);
 
 } //namespace PhysicsEffects
 } //namespace sce
@@ -56,6 +56,26 @@ PfxUInt16 get16(int slot) const {return i16data[slot];}
 PfxUInt32 get32(int slot) const {return i32data[slot];}
 };
 
+//J 64ビットキーを持つソートデータ
+//E Sort data with a 64 bit key
+struct SCE_PFX_ALIGNED(16) PfxSortData32Key64 {
+	union {
+		PfxUInt8   i8data[32];
+		PfxUInt16  i16data[16];
+		PfxUInt32  i32data[8];
+		PfxUInt64  i64data[4];
+	};
+
+void set8(int slot,PfxUInt8 data)   {i8data[slot] = data;}
+void set16(int slot,PfxUInt16 data) {i16data[slot] = data;}
+void set32(int slot,PfxUInt32 data) {i32data[slot] = data;}
+void set64(int slot,PfxUInt64 data) {i64data[slot] = data;}
+PfxUInt8 get8(int slot)   const {return i8data[slot];}
+PfxUInt16 get16(int slot) const {return i16data[slot];}
+PfxUInt32 get32(int slot) const {return i32data[slot];}
+PfxUInt64 get64(int slot) const {return i64data[slot];}
+};
+
 SCE_PFX_FORCE_INLINE
 void pfxSetKey(PfxSortData16 &sortData,PfxUInt32 key) {sortData.set32(3,key);}
 
@@ -69,11 +89,21 @@ SCE_PFX_FORCE_INLINE
 PfxUInt32 pfxGetKey(const PfxSortData32 &sortData) {return sortData.get32(7);}
 
 SCE_PFX_FORCE_INLINE
-PfxUInt32 pfxCreateUniqueKey(PfxUInt32 i,PfxUInt32 j)
+void pfxSetKey(PfxSortData32Key64 &sortData,PfxUInt64 key) {sortData.set64(3,key);}
+
+SCE_PFX_FORCE_INLINE
+PfxUInt64 pfxGetKey(const PfxSortData32Key64 &sortData) {return sortData.get64(3);}
+
+SCE_PFX_FORCE_INLINE
+PfxPairKey pfxCreateUniqueKey(PfxUInt32 i,PfxUInt32 j)
 {
 	PfxUInt32 minIdx = SCE_PFX_MIN(i,j);
 	PfxUInt32 maxIdx = SCE_PFX_MAX(i,j);
+#ifdef SCE_PFX_USE_32BIT_OBJECT_ID
+	return ((PfxUInt64)maxIdx<<32)|minIdx;
+#else
 	return (maxIdx<<16)|(minIdx&0xffff);
+#endif
 }
 
 } // namespace PhysicsEffects
@@ -0,0 +1,116 @@
+/*
+Physics Effects Copyright(C) 2010 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#ifndef _SCE_PFX_DYNAMIC_TREE_H_
+#define _SCE_PFX_DYNAMIC_TREE_H_
+
+#include "pfx_broadphase.h"
+
+namespace sce {
+namespace PhysicsEffects {
+
+///////////////////////////////////////////////////////////////////////////////
+// Dynamic AABB Tree
+
+//J 剛体ごとに一つのリーフを持つ動的AABBツリー。リーフは余裕を持たせた太いAABBを持ち、
+//J 剛体がそれをはみ出した時だけリーフを更新して祖先をリフィットする。リフィット中に
+//J 子と孫を入れ替える回転を行い、ツリーの質を保つ。
+//J pfxFindPairsと異なり、特定の軸に剛体が密集しても性能が劣化しない。
+//E A dynamic bounding volume tree holding one leaf per rigid body. Each leaf
+//E stores a fattened AABB and is only updated when the body leaves it. The
+//E ancestors are then refit, and rotations swap a child with a grandchild
+//E whenever that reduces the surface area, which keeps the tree balanced.
+//E Unlike pfxFindPairs it doesn't degrade when bodies cluster along one axis.
+
+struct PfxDynamicTree;
+
+struct PfxCreateDynamicTreeParam {
+	void *treeBuff;
+	PfxUInt32 treeBytes;
+	PfxUInt32 maxRigidBodies;
+};
+
+struct PfxCreateDynamicTreeResult {
+	PfxDynamicTree *tree;
+};
+
+//J	ツリーを使い終わるまでtreeBuffを破棄しないでください
+//E Keep treeBuff while the tree is used
+PfxUInt32 pfxGetTreeBytesOfCreateDynamicTree(PfxUInt32 maxRigidBodies);
+
+PfxInt32 pfxCreateDynamicTree(PfxCreateDynamicTreeParam &param,PfxCreateDynamicTreeResult &result);
+
+//E Remove all leaves so the next update rebuilds the tree
+//J 全てのリーフを削除し、次の更新でツリーを作り直す
+void pfxResetDynamicTree(PfxDynamicTree *tree);
+
+struct PfxUpdateDynamicTreeParam {
+	PfxDynamicTree *tree;
+	PfxRigidState *offsetRigidStates;
+	PfxCollidable *offsetCollidables;
+	PfxUInt32 numRigidBodies;
+	PfxUInt32 outOfWorldBehavior;
+	PfxFloat fatMargin; // Margin added to the leaf AABBs in world units
+	PfxVector3 worldCenter;
+	PfxVector3 worldExtent;
+
+	PfxUpdateDynamicTreeParam()
+	{
+		outOfWorldBehavior = 0;
+		fatMargin = 0.1f;
+	}
+};
+
+struct PfxUpdateDynamicTreeResult {
+	PfxUInt32 numRefitLeaves;
+	PfxUInt32 numRotations;
+	PfxInt32 numOutOfWorldProxies;
+};
+
+//J 剛体数が増減した場合はリーフを追加・削除する。ワールドの範囲が変わった場合はツリーを作り直す
+//E Leaves are added or removed when the number of rigid bodies changes.
+//E The tree is rebuilt when the world center or extent changes.
+PfxInt32 pfxUpdateDynamicTree(PfxUpdateDynamicTreeParam &param,PfxUpdateDynamicTreeResult &result);
+
+///////////////////////////////////////////////////////////////////////////////
+// Find Pairs
+
+struct PfxFindPairsDynamicTreeParam {
+	void *workBuff;
+	PfxUInt32 workBytes;
+	void *pairBuff;
+	PfxUInt32 pairBytes;
+	PfxDynamicTree *tree;
+	PfxUInt32 maxPairs;
+};
+
+struct PfxFindPairsDynamicTreeResult {
+	PfxBroadphasePair *pairs;
+	PfxUInt32 numPairs;
+};
+
+PfxUInt32 pfxGetWorkBytesOfFindPairsDynamicTree(PfxUInt32 maxRigidBodies,PfxUInt32 maxPairs);
+PfxUInt32 pfxGetPairBytesOfFindPairsDynamicTree(PfxUInt32 maxPairs);
+
+//J 出力はpfxFindPairsと同じくキー順にソートされているので、そのままpfxDecomposePairsに渡せる
+//E Like pfxFindPairs the pairs are sorted by key, so they can be passed to
+//E pfxDecomposePairs as the current pairs.
+PfxInt32 pfxFindPairs(PfxFindPairsDynamicTreeParam &param,PfxFindPairsDynamicTreeResult &result);
+
+} //namespace PhysicsEffects
+} //namespace sce
+
+#endif /* _SCE_PFX_DYNAMIC_TREE_H_ */
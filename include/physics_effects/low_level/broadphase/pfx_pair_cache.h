@@ -0,0 +1,119 @@
+/*
+Physics Effects Copyright(C) 2011 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#ifndef _SCE_PFX_PAIR_CACHE_H_
+#define _SCE_PFX_PAIR_CACHE_H_
+
+#include "../../base_level/broadphase/pfx_broadphase_pair.h"
+#include "../../base_level/collision/pfx_contact_manifold.h"
+
+namespace sce {
+namespace PhysicsEffects {
+
+///////////////////////////////////////////////////////////////////////////////
+// Pair Cache
+
+//J フレーム間で持続するペアとコンタクトマニフォールドを管理する。
+//J pfxFindPairsの結果を前フレームのペアと1回の走査で合成し、キー順にソートされた現在のペアを作る。
+//J 新規ペアには空きリストからマニフォールドを割り当て、廃棄ペアのマニフォールドは次の更新で空きリストに戻す。
+//J 容量が足りない場合はペアを変更せずにエラーを返すので、pfxGrowPairCacheで拡張して再実行できる。
+//E Keeps the pairs and contact manifolds that persist across frames. The pairs
+//E found by pfxFindPairs are merged with the previous pairs in one pass, which
+//E produces the current pairs already sorted by key. New pairs get a manifold
+//E from a free list. Removed pairs return theirs on the next update, so the
+//E manifolds of outRemovePairs can still be read, e.g. for contact end callbacks.
+//E When the capacity is exceeded the update fails without changing the pairs,
+//E so the cache can be grown with pfxGrowPairCache and updated again.
+
+struct PfxPairCache;
+
+struct PfxCreatePairCacheParam {
+	void *cacheBuff;
+	PfxUInt32 cacheBytes;
+	PfxUInt32 maxPairs;
+	PfxUInt32 maxContacts;
+};
+
+struct PfxCreatePairCacheResult {
+	PfxPairCache *cache;
+};
+
+//J	キャッシュを使い終わるまでcacheBuffを破棄しないでください
+//E Keep cacheBuff while the cache is used
+PfxUInt32 pfxGetCacheBytesOfCreatePairCache(PfxUInt32 maxPairs,PfxUInt32 maxContacts);
+
+PfxInt32 pfxCreatePairCache(PfxCreatePairCacheParam &param,PfxCreatePairCacheResult &result);
+
+//J 全てのペアを破棄し、全てのマニフォールドを解放する
+//E Discard all pairs and release all manifolds
+void pfxResetPairCache(PfxPairCache *cache);
+
+struct PfxGrowPairCacheParam {
+	void *cacheBuff;
+	PfxUInt32 cacheBytes;
+	PfxPairCache *cache;
+	PfxUInt32 maxPairs;
+	PfxUInt32 maxContacts;
+};
+
+struct PfxGrowPairCacheResult {
+	PfxPairCache *cache;
+};
+
+//J ペア、マニフォールド、空きリストを新しいバッファに移す。コンタクトIDは変わらない
+//J 成功した後は元のバッファを破棄してよい
+//E Move the pairs, the manifolds and the free list into a new, larger buffer.
+//E Contact ids are preserved. The old buffer may be released on success.
+PfxInt32 pfxGrowPairCache(PfxGrowPairCacheParam &param,PfxGrowPairCacheResult &result);
+
+struct PfxUpdatePairCacheParam {
+	PfxPairCache *cache;
+	PfxBroadphasePair *currentPairs; // Pairs of this frame sorted by key, e.g. from pfxFindPairs()
+	PfxUInt32 numCurrentPairs;
+};
+
+struct PfxUpdatePairCacheResult {
+	PfxUInt32 numNewPairs;
+	PfxUInt32 numKeepPairs;
+	PfxBroadphasePair *outRemovePairs; // The pairs and their manifolds are valid until the next update
+	PfxUInt32 numOutRemovePairs;
+	PfxUInt32 requiredPairs;    // Capacity needed by this update
+	PfxUInt32 requiredContacts;
+};
+
+//J maxPairsを超えるとSCE_PFX_ERR_OUT_OF_MAX_PAIRS、マニフォールドが足りないとSCE_PFX_ERR_OUT_OF_BUFFERを返す
+//J いずれの場合もペアは変更されず、requiredPairsとrequiredContactsに必要な容量が返る
+//J 前回の廃棄ペアのマニフォールドは失敗した場合も解放される
+//E Returns SCE_PFX_ERR_OUT_OF_MAX_PAIRS when the pairs exceed maxPairs and
+//E SCE_PFX_ERR_OUT_OF_BUFFER when no manifold is left. In both cases the pairs
+//E are unchanged and requiredPairs and requiredContacts report the capacity needed.
+//E The manifolds of the pairs removed by the previous update are released even on failure.
+PfxInt32 pfxUpdatePairCache(PfxUpdatePairCacheParam &param,PfxUpdatePairCacheResult &result);
+
+//J 現在のペア。キー順にソートされ、コンタクトIDはpfxGetContactsOfPairCacheの配列を指す
+//E Current pairs, sorted by key. Contact ids index the array returned by pfxGetContactsOfPairCache.
+PfxBroadphasePair *pfxGetPairsOfPairCache(PfxPairCache *cache);
+PfxUInt32 pfxGetNumPairsOfPairCache(const PfxPairCache *cache);
+
+PfxContactManifold *pfxGetContactsOfPairCache(PfxPairCache *cache);
+PfxUInt32 pfxGetNumContactsOfPairCache(const PfxPairCache *cache); // Manifolds in use, including those of the last outRemovePairs
+PfxUInt32 pfxGetMaxContactsOfPairCache(const PfxPairCache *cache);
+PfxUInt32 pfxGetMaxPairsOfPairCache(const PfxPairCache *cache);
+
+} //namespace PhysicsEffects
+} //namespace sce
+
+#endif /* _SCE_PFX_PAIR_CACHE_H_ */
@@ -0,0 +1,101 @@
+/*
+Physics Effects Copyright(C) 2010 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#ifndef _SCE_PFX_SWEEP_AND_PRUNE_H_
+#define _SCE_PFX_SWEEP_AND_PRUNE_H_
+
+#include "../../base_level/broadphase/pfx_broadphase_pair.h"
+#include "../../base_level/broadphase/pfx_broadphase_proxy.h"
+#include "../../base_level/rigidbody/pfx_rigid_state.h"
+#include "../../base_level/collision/pfx_collidable.h"
+
+namespace sce {
+namespace PhysicsEffects {
+
+///////////////////////////////////////////////////////////////////////////////
+// Incremental Sweep And Prune
+
+//J 剛体のAABB端点を3軸それぞれでソートしたまま保持し、フレーム間で移動した剛体の端点だけを
+//J 挿入ソートで更新する。端点が入れ替わったペアだけを再判定し、新規・維持・廃棄ペアを直接出力する。
+//J pfxUpdateBroadphaseProxy、ソート、pfxFindPairs、pfxDecomposePairsの組み合わせを置き換える。
+//E Keeps the AABB endpoints of all rigid bodies sorted on the three axes across
+//E frames and updates only the endpoints of bodies that moved, by insertion sort.
+//E Only pairs whose endpoints swapped are re-tested, and new, keep and remove
+//E pairs are written directly. Replaces pfxUpdateBroadphaseProxy, the proxy
+//E sort, pfxFindPairs and pfxDecomposePairs.
+
+struct PfxSweepAndPrune;
+
+struct PfxCreateSweepAndPruneParam {
+	void *sapBuff;
+	PfxUInt32 sapBytes;
+	PfxUInt32 maxRigidBodies;
+};
+
+struct PfxCreateSweepAndPruneResult {
+	PfxSweepAndPrune *sap;
+};
+
+//J	SAPを使い終わるまでsapBuffを破棄しないでください
+//E Keep sapBuff while the sweep and prune is used
+PfxUInt32 pfxGetSapBytesOfCreateSweepAndPrune(PfxUInt32 maxRigidBodies);
+
+PfxInt32 pfxCreateSweepAndPrune(PfxCreateSweepAndPruneParam &param,PfxCreateSweepAndPruneResult &result);
+
+//E Discard the sorted endpoints so the next update rebuilds them
+//J 次の更新で端点を作り直す
+void pfxResetSweepAndPrune(PfxSweepAndPrune *sap);
+
+struct PfxUpdateSweepAndPruneParam {
+	void *workBuff;
+	PfxUInt32 workBytes;
+	void *pairBuff;
+	PfxUInt32 pairBytes;
+	PfxSweepAndPrune *sap;
+	PfxRigidState *offsetRigidStates;
+	PfxCollidable *offsetCollidables;
+	PfxUInt32 numRigidBodies;
+	PfxBroadphasePair *previousPairs; // Pairs of the previous frame sorted by key
+	PfxUInt32 numPreviousPairs;
+	PfxUInt32 maxPairs;
+	PfxVector3 worldCenter;
+	PfxVector3 worldExtent;
+};
+
+struct PfxUpdateSweepAndPruneResult {
+	PfxBroadphasePair *outNewPairs;
+	PfxUInt32 numOutNewPairs;
+	PfxBroadphasePair *outKeepPairs;
+	PfxUInt32 numOutKeepPairs;
+	PfxBroadphasePair *outRemovePairs;
+	PfxUInt32 numOutRemovePairs;
+	PfxUInt32 numMovedBodies;
+	PfxBool rebuilt;
+};
+
+PfxUInt32 pfxGetWorkBytesOfUpdateSweepAndPrune(PfxUInt32 maxRigidBodies,PfxUInt32 maxPairs);
+PfxUInt32 pfxGetPairBytesOfUpdateSweepAndPrune(PfxUInt32 numPreviousPairs,PfxUInt32 maxPairs);
+
+//J 出力はpfxDecomposePairsと同じく、維持ペアには前フレームのコンタクトIDが引き継がれる
+//J 新規ペアと維持ペアはそれぞれキー順にソートされている
+//E Like pfxDecomposePairs, keep pairs inherit the contact id of the previous
+//E pair. New pairs and keep pairs are each sorted by key.
+PfxInt32 pfxUpdateSweepAndPrune(PfxUpdateSweepAndPruneParam &param,PfxUpdateSweepAndPruneResult &result);
+
+} //namespace PhysicsEffects
+} //namespace sce
+
+#endif /* _SCE_PFX_SWEEP_AND_PRUNE_H_ */
@@ -36,6 +36,16 @@ struct PfxDetectCollisionParam {
 	PfxRigidState *offsetRigidStates;
 	PfxCollidable *offsetCollidables;
 	PfxUInt32 numRigidBodies;
+
+	//J マルチスレッド版で各タスクの処理時間(ms)を受け取る配列（タスク数分、NULLなら出力しない）
+	//E Optional array of numTasks entries that receives the time in ms spent
+	//E by each task of the multithreaded version
+	PfxFloat *taskTimes;
+
+	PfxDetectCollisionParam()
+	{
+		taskTimes = NULL;
+	}
 };
 
 PfxInt32 pfxDetectCollision(PfxDetectCollisionParam &param);
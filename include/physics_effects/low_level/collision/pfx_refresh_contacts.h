@@ -34,6 +34,16 @@ struct PfxRefreshContactsParam {
 	PfxContactManifold *offsetContactManifolds;
 	PfxRigidState *offsetRigidStates;
 	PfxUInt32 numRigidBodies;
+
+	//J マルチスレッド版で各タスクの処理時間(ms)を受け取る配列（タスク数分、NULLなら出力しない）
+	//E Optional array of numTasks entries that receives the time in ms spent
+	//E by each task of the multithreaded version
+	PfxFloat *taskTimes;
+
+	PfxRefreshContactsParam()
+	{
+		taskTimes = NULL;
+	}
 };
 
 PfxInt32 pfxRefreshContacts(PfxRefreshContactsParam &param);
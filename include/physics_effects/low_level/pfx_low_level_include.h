@@ -25,6 +25,9 @@ Physics Effects under the filename: physics_effects_license.txt
 
 // Include low level headers
 #include "broadphase/pfx_broadphase.h"
+#include "broadphase/pfx_sweep_and_prune.h"
+#include "broadphase/pfx_dynamic_tree.h"
+#include "broadphase/pfx_pair_cache.h"
 
 #include "collision/pfx_collision_detection.h"
 #include "collision/pfx_refresh_contacts.h"
@@ -29,6 +29,8 @@ PfxInt32 pfxParallelSort(PfxSortData16 *data,PfxUInt32 numData,void *workBuff,Pf
 
 PfxInt32 pfxParallelSort(PfxSortData32 *data,PfxUInt32 numData,void *workBuff,PfxUInt32 workBytes);
 
+PfxInt32 pfxParallelSort(PfxSortData32Key64 *data,PfxUInt32 numData,void *workBuff,PfxUInt32 workBytes);
+
 PfxInt32 pfxParallelSort(PfxSortData16 *data,PfxUInt32 numData,void *workBuff,PfxUInt32 workBytes,
 	PfxTaskManager *taskManager);
 
@@ -48,6 +48,14 @@ PfxUInt32 m_commonBuff[32];
 	virtual void unlock() = 0;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// POSIX Threads Implementation
+
+//J pthreadを使用した同期コンポネントを作成する（deleteで破棄）
+//E Create synchronization components based on POSIX threads (release with delete)
+PfxBarrier *pfxCreateBarrierPthreads(int n);
+PfxCriticalSection *pfxCreateCriticalSectionPthreads();
+
 } //namespace PhysicsEffects
 } //namespace sce
 #endif // _SCE_PFX_SYNC_COMPONENTS_H
@@ -91,6 +91,18 @@ public:
 	virtual void finalize() = 0;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// POSIX Threads Implementation
+
+//J maxTasks個のワーカースレッドを常駐させるタスクマネージャを作成する
+//J 使用前にinitialize()、破棄前にfinalize()を呼び出し、deleteで破棄する
+//E Create a task manager which keeps maxTasks worker threads alive
+//E Call initialize() before use and finalize() before releasing it with delete
+
+PfxUInt32 pfxGetWorkBytesOfTaskManagerPthreads(PfxUInt32 numTasks,PfxUInt32 maxTasks);
+
+PfxTaskManager *pfxCreateTaskManagerPthreads(PfxUInt32 numTasks,PfxUInt32 maxTasks,void *workBuff,PfxUInt32 workBytes);
+
 } //namespace PhysicsEffects
 } //namespace sce
 #endif // _SCE_PFX_TASK_MANAGER_H
\ No newline at end of file
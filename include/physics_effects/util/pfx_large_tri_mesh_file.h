@@ -0,0 +1,108 @@
+/*
+Physics Effects Copyright(C) 2011 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#ifndef _SCE_PFX_LARGE_TRI_MESH_FILE_H
+#define _SCE_PFX_LARGE_TRI_MESH_FILE_H
+
+#include "../base_level/collision/pfx_large_tri_mesh.h"
+
+namespace sce {
+namespace PhysicsEffects {
+
+///////////////////////////////////////////////////////////////////////////////
+// Baked Large Mesh
+
+//J ベイクしたラージメッシュのイメージはポインタを含まず、ヘッダからのオフセットで配列を参照する
+//J 配列はPfxLargeTriMeshと同じメモリ配置なので、イメージをそのまま参照して使用できる
+//J 同じコンパイラ設定でビルドしたプログラムの間でのみ互換性がある
+//E A baked large mesh image holds no pointers, its arrays are referenced by
+//E offsets from the header. The arrays have the memory layout PfxLargeTriMesh
+//E uses, so a loaded image is used in place without copying or rebuilding.
+//E Images are only compatible between builds with the same PfxTriMesh layout.
+//E
+//E   PfxLargeTriMeshFileHeader
+//E   PfxAabb16  aabbList[numIslands]     at aabbListOffset
+//E   PfxTriMesh islands[numIslands]      at islandsOffset
+//E   PfxAabb16  bvhNodes[numBvhNodes]    at bvhNodesOffset (0 when there is no BVH)
+
+#define SCE_PFX_LARGETRIMESH_FILE_MAGIC		0x4d584650 // "PFXM"
+#define SCE_PFX_LARGETRIMESH_FILE_VERSION	1
+#define SCE_PFX_LARGETRIMESH_FILE_ALIGN		128
+
+struct PfxLargeTriMeshFileHeader {
+	PfxUInt32 magic;
+	PfxUInt32 version;
+	PfxUInt32 fileBytes;
+	PfxUInt32 triMeshBytes; // sizeof(PfxTriMesh)
+	PfxUInt32 numIslands;
+	PfxUInt32 numBvhNodes;
+	PfxUInt32 aabbListOffset;
+	PfxUInt32 islandsOffset;
+	PfxUInt32 bvhNodesOffset;
+	PfxFloat half[3];
+	PfxUInt32 reserved[4];
+};
+
+//J イメージの作成に必要なバイト数を返す
+//E Returns the bytes needed by the image of lmesh
+PfxUInt32 pfxGetLargeTriMeshImageBytes(const PfxLargeTriMesh &lmesh);
+
+//J lmeshのイメージをbuffに書き出す。未使用の領域は0で埋めるので、同じメッシュからは同じイメージが作られる
+//E Writes the image of lmesh to buff. Unused space is cleared, so the same mesh always gives the same image
+PfxInt32 pfxWriteLargeTriMeshImage(const PfxLargeTriMesh &lmesh,void *buff,PfxUInt32 bytes);
+
+//J イメージを検証し、lmeshがイメージ内の配列を直接参照するように設定する
+//J ヘッダーに加えて、各アイランドの数とインデックス、BVHノードのアイランドとエスケープのインデックスも検証する
+//J イメージは16バイト境界に置き、lmeshを使い終わるまで保持すること。pfxReleaseLargeTriMeshは呼ばないこと
+//E Validates the image and points lmesh at the arrays inside it
+//E Besides the header, the counts and indices of every island and the island and escape index of every BVH node are checked
+//E The image must be 16 byte aligned and outlive lmesh. Don't call pfxReleaseLargeTriMesh on lmesh
+PfxInt32 pfxBindLargeTriMeshImage(PfxLargeTriMesh &lmesh,const void *image,PfxUInt32 bytes);
+
+//J lmeshのイメージをファイルに保存する
+//E Saves the image of lmesh to a file
+PfxInt32 pfxSaveLargeTriMeshFile(const PfxLargeTriMesh &lmesh,const char *path);
+
+//J メモリにマップしたファイルと、それを参照するラージメッシュ
+//E A file mapped into memory and the large mesh referencing it
+struct PfxMappedLargeTriMesh {
+	PfxLargeTriMesh lmesh;
+	void *data;
+	PfxUInt32 bytes;
+	SCE_PFX_PADDING(1,4)
+	void *handle;
+	SCE_PFX_PADDING(2,8)
+
+	PfxMappedLargeTriMesh()
+	{
+		data = NULL;
+		bytes = 0;
+		handle = NULL;
+	}
+};
+
+//J ファイルを読み込み専用でメモリにマップし、ページをコピーせずにラージメッシュとして参照する
+//J 同じファイルをマップしたプロセスは物理ページを共有する
+//E Maps a file read only and uses its pages as the large mesh without copying
+//E Processes mapping the same file share its physical pages
+PfxInt32 pfxMapLargeTriMeshFile(PfxMappedLargeTriMesh &mapped,const char *path);
+
+void pfxUnmapLargeTriMeshFile(PfxMappedLargeTriMesh &mapped);
+
+} //namespace PhysicsEffects
+} //namespace sce
+
+#endif // _SCE_PFX_LARGE_TRI_MESH_FILE_H
@@ -18,6 +18,7 @@ Physics Effects under the filename: physics_effects_license.txt
 #define _SCE_PFX_MESH_CREATOR_H
 
 #include "../base_level/collision/pfx_large_tri_mesh.h"
+#include "../low_level/task/pfx_task_manager.h"
 
 namespace sce {
 namespace PhysicsEffects {
@@ -88,6 +89,10 @@ struct PfxCreateLargeTriMeshParam {
 
 PfxInt32 pfxCreateLargeTriMesh(PfxLargeTriMesh &lmesh,const PfxCreateLargeTriMeshParam &param);
 
+//J アイランドの構築をタスクマネージャのタスクに分割して並列に行う。結果はシングルスレッド版と同じ
+//E Builds the islands in parallel over the tasks of the task manager. The result is the same as the single threaded version
+PfxInt32 pfxCreateLargeTriMesh(PfxLargeTriMesh &lmesh,const PfxCreateLargeTriMeshParam &param,PfxTaskManager *taskManager);
+
 void pfxReleaseLargeTriMesh(PfxLargeTriMesh &lmesh);
 
 } //namespace PhysicsEffects
@@ -22,5 +22,6 @@ Physics Effects under the filename: physics_effects_license.txt
 
 #include "pfx_mass.h"
 #include "pfx_mesh_creator.h"
+#include "pfx_large_tri_mesh_file.h"
 
 #endif // _SCE_PFX_UTIL_INCLUDE_H
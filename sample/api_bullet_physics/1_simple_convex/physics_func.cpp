@@ -17,7 +17,7 @@ Physics Effects under the filename: physics_effects_license.txt
 #include "physics_func.h"
 #include "../common/perf_func.h"
 #include "bullet_physics/util/bt_convex_hull_computer.h"
-#include "bullet_physics/base_level/collision/bt_convex_polyhedron.h"
+#include "bullet_physics/base_level/collision/bt_packed_convex_polyhedron.h"
 #include "bullet_physics/base_level/collision/bt_polyhedral_contact_clipping.h"
 #include "../../../src/physics_effects/low_level/collision/pfx_detect_collision_func.h"
 #include "../../../src/physics_effects/base_level/collision/pfx_gjk_solver.h"
@@ -71,7 +71,7 @@ struct MyContactBridge
 
 
 
-typedef btPolyhedralContactClipping<MyContactBridge,btAlignedObjectArray<btVector3> > btDefaultPolyClipper;
+typedef btInplacePolyhedralContactClipping<MyContactBridge> btDefaultPolyClipper;
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -480,98 +480,19 @@ void getBoxVertices(PfxVector3& halfExtents, PfxInplaceArray<btVector3,MAXSIZE>&
 }
 
 
-btConvexPolyhedron* initializePolyhedralFeatures(PfxInplaceArray<btVector3,MAXSIZE>& tmpVertices)
+btPackedConvexPolyhedron* initializePolyhedralFeatures(PfxInplaceArray<btVector3,MAXSIZE>& tmpVertices)
 {
-	
-	btConvexPolyhedron* polyhedron = new btConvexPolyhedron();
-
-	
 	btConvexHullComputer conv;
 	float* ptr = (float*) &tmpVertices[0];
 
 	conv.compute(ptr, sizeof(btVector3),tmpVertices.size(),0.f,0.f);
 
-	
-
-	PfxInplaceArray<btVector3,MAXSIZE> faceNormals;
-	int numFaces = conv.faces.size();
-	faceNormals.resize(numFaces);
-	btConvexHullComputer* convexUtil = &conv;
-
-	
-	
-	polyhedron->m_faces.resize(numFaces);
-	int numVertices = convexUtil->vertices.size();
-	polyhedron->m_vertices.resize(numVertices);
-	for (int p=0;p<numVertices;p++)
+	btPackedConvexPolyhedron* polyhedron = new btPackedConvexPolyhedron();
+	if (!polyhedron->build(conv))
 	{
-		polyhedron->m_vertices[p] = convexUtil->vertices[p];
-	}
-
-	for (int i=0;i<numFaces;i++)
-	{
-		int face = convexUtil->faces[i];
-		//printf("face=%d\n",face);
-		const btConvexHullComputer::Edge*  firstEdge = &convexUtil->edges[face];
-		const btConvexHullComputer::Edge*  edge = firstEdge;
-
-		btVector3 edges[3];
-		int numEdges = 0;
-		//compute face normals
-
-		btScalar maxCross2 = 0.f;
-		int chosenEdge = -1;
-
-		do
-		{
-			
-			int src = edge->getSourceVertex();
-			polyhedron->m_faces[i].m_indices.push_back(src);
-			int targ = edge->getTargetVertex();
-			btVector3 wa = convexUtil->vertices[src];
-
-			btVector3 wb = convexUtil->vertices[targ];
-			btVector3 newEdge = wb-wa;
-			VMNORMALIZE(newEdge);
-			if (numEdges<2)
-				edges[numEdges++] = newEdge;
-
-			edge = edge->getNextEdgeOfFace();
-		} while (edge!=firstEdge);
-
-		btScalar planeEq = 1e30f;
-
-		
-		if (numEdges==2)
-		{
-			faceNormals[i] = VMCROSS(edges[0],edges[1]);
-			VMNORMALIZE(faceNormals[i]);
-			polyhedron->m_faces[i].m_plane[0] = faceNormals[i].getX();
-			polyhedron->m_faces[i].m_plane[1] = faceNormals[i].getY();
-			polyhedron->m_faces[i].m_plane[2] = faceNormals[i].getZ();
-			polyhedron->m_faces[i].m_plane[3] = planeEq;
-
-		}
-		else
-		{
-			VMASSERT(0);//degenerate?
-			VMSET(faceNormals[i],0.f,0.f,0.f);
-		}
-
-		for (int v=0;v<polyhedron->m_faces[i].m_indices.size();v++)
-		{
-			btScalar eq = VMDOT(polyhedron->m_vertices[polyhedron->m_faces[i].m_indices[v]],faceNormals[i]);
-			if (planeEq>eq)
-			{
-				planeEq=eq;
-			}
-		}
-		polyhedron->m_faces[i].m_plane[3] = -planeEq;
+		VMASSERT(0);//degenerate?
 	}
 
-
-	polyhedron->initialize();
-
 	return polyhedron;
 }
 
@@ -1008,13 +929,18 @@ void myCustomCollisionDummy(
 	if (shapeA.m_convexPolyhedron && shapeB.m_convexPolyhedron)
 	{
 		
-		btConvexPolyhedron* polA = (btConvexPolyhedron*)shapeA.m_convexPolyhedron;
-		btConvexPolyhedron* polB = (btConvexPolyhedron*)shapeB.m_convexPolyhedron;
+		btPackedConvexPolyhedron* polA = (btPackedConvexPolyhedron*)shapeA.m_convexPolyhedron;
+		btPackedConvexPolyhedron* polB = (btPackedConvexPolyhedron*)shapeB.m_convexPolyhedron;
 
 		if (!foundSep)
 		{
 			BT_PROFILE("findSeparatingAxis");
-			foundSep = btDefaultPolyClipper::findSeparatingAxis(*polA, *polB, worldTransformA,worldTransformB, sep);
+
+			//the axis of the previous frame is kept in the contact manifold of the pair
+			btSeparatingAxisCache axisCache;
+			axisCache.m_valid = contacts.getCachedAxis((PfxUInt8)shapeIdA,(PfxUInt8)shapeIdB,axisCache.m_localAxis);
+			foundSep = btDefaultPolyClipper::findSeparatingAxis(*polA, *polB, worldTransformA,worldTransformB, sep, &axisCache);
+			contacts.setCachedAxis((PfxUInt8)shapeIdA,(PfxUInt8)shapeIdB,axisCache.m_localAxis);
 		}
 		if (foundSep)
 		{
@@ -0,0 +1,189 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2011 Advanced Micro Devices, Inc.  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose, 
+including commercial applications, and to alter it and redistribute it freely, 
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+///Compares the heap based btPolyhedralContactClipping instantiation with the
+///allocation-free btInplacePolyhedralContactClipping on overlapping convex pairs,
+///with the pairs split over several threads like a parallel narrowphase.
+///
+///usage: 3_bt_inplace_clipping [maxThreads] [rounds]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bullet_physics/base_level/collision/bt_polyhedral_contact_clipping.h"
+#include "bullet_physics/base_level/collision/bt_convex_polyhedron.h"
+#include "bullet_physics/util/bt_aligned_object_array.h"
+#include "bullet_physics/util/bt_stopwatch.h"
+#include "hull_test_util.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#define NUM_PAIRS 4096
+#define MAX_THREADS 16
+
+typedef btPolyhedralContactClipping<CountingContactCache,btAlignedObjectArray<btVector3> > HeapPolyClipper;
+typedef btInplacePolyhedralContactClipping<CountingContactCache> InplacePolyClipper;
+
+struct ClipPair
+{
+	const btConvexPolyhedron* m_hullA;
+	const btConvexPolyhedron* m_hullB;
+	btTransform m_transA;
+	btTransform m_transB;
+};
+
+ClipPair gPairs[NUM_PAIRS];
+
+struct ClipTask
+{
+	int m_start;
+	int m_end;
+	int m_rounds;
+	bool m_inplace;
+	int m_numContacts;
+};
+
+template <typename CLIPPER>
+static int clipPairs(int start, int end, int rounds)
+{
+	int numContacts = 0;
+	for (int r=0;r<rounds;r++)
+	{
+		for (int i=start;i<end;i++)
+		{
+			const ClipPair& pair = gPairs[i];
+			btVector3 sep;
+			if (!CLIPPER::findSeparatingAxis(*pair.m_hullA,*pair.m_hullB,pair.m_transA,pair.m_transB,sep))
+				continue;
+
+			CountingContactCache contacts(-1e30f,0.01f);
+			CLIPPER::clipHullAgainstHull(sep,*pair.m_hullA,*pair.m_hullB,pair.m_transA,pair.m_transB,contacts.m_minDist,contacts.m_maxDist,contacts);
+			numContacts += contacts.m_numContacts;
+		}
+	}
+	return numContacts;
+}
+
+static void* clipTaskEntry(void* arg)
+{
+	ClipTask* task = (ClipTask*)arg;
+	if (task->m_inplace)
+		task->m_numContacts = clipPairs<InplacePolyClipper>(task->m_start,task->m_end,task->m_rounds);
+	else
+		task->m_numContacts = clipPairs<HeapPolyClipper>(task->m_start,task->m_end,task->m_rounds);
+	return 0;
+}
+
+///returns the milliseconds to clip all pairs, numContacts is the sum over all threads
+static float runClipping(int numThreads, int rounds, bool inplace, int& numContacts)
+{
+	ClipTask tasks[MAX_THREADS];
+	for (int t=0;t<numThreads;t++)
+	{
+		tasks[t].m_start = NUM_PAIRS * t / numThreads;
+		tasks[t].m_end = NUM_PAIRS * (t+1) / numThreads;
+		tasks[t].m_rounds = rounds;
+		tasks[t].m_inplace = inplace;
+		tasks[t].m_numContacts = 0;
+	}
+
+	btStopwatch timer;
+	timer.reset();
+
+#ifdef _WIN32
+	clipTaskEntry(&tasks[0]);
+#else
+	pthread_t threads[MAX_THREADS];
+	for (int t=1;t<numThreads;t++)
+	{
+		pthread_create(&threads[t],NULL,clipTaskEntry,&tasks[t]);
+	}
+	clipTaskEntry(&tasks[0]);
+	for (int t=1;t<numThreads;t++)
+	{
+		pthread_join(threads[t],NULL);
+	}
+#endif
+
+	float ms = timer.getTimeMilliseconds();
+
+	numContacts = 0;
+	for (int t=0;t<numThreads;t++)
+	{
+		numContacts += tasks[t].m_numContacts;
+	}
+	return ms;
+}
+
+int main(int argc, char* argv[])
+{
+	int maxThreads = argc > 1 ? atoi(argv[1]) : 4;
+	int rounds = argc > 2 ? atoi(argv[2]) : 10;
+	maxThreads = maxThreads < 1 ? 1 : (maxThreads > MAX_THREADS ? MAX_THREADS : maxThreads);
+#ifdef _WIN32
+	if (maxThreads > 1)
+	{
+		printf("multiple threads are not supported on this platform\n");
+		maxThreads = 1;
+	}
+#endif
+
+	btConvexPolyhedron* hulls[3];
+	hulls[0] = createPrism<btConvexPolyhedron>(4,0.7f,0.5f);
+	hulls[1] = createPrism<btConvexPolyhedron>(12,0.5f,0.5f);
+	hulls[2] = createPrism<btConvexPolyhedron>(24,0.5f,0.3f);
+
+	for (int i=0;i<3;i++)
+	{
+		if (!hulls[i]->fitsInplaceClipper())
+		{
+			printf("hull %d has a face with more than %d vertices\n",i,MAXINDICESPERFACE);
+			return 1;
+		}
+	}
+
+	for (int i=0;i<NUM_PAIRS;i++)
+	{
+		gPairs[i].m_hullA = hulls[i%3];
+		gPairs[i].m_hullB = hulls[(i/3)%3];
+		gPairs[i].m_transA = randomTransform(btVector3(0.f,0.f,0.f),0.2f);
+		gPairs[i].m_transB = randomTransform(btVector3(0.f,0.8f,0.f),0.4f);
+	}
+
+	printf("%7s %12s %12s %9s %9s\n","threads","heap(ms)","inplace(ms)","speedup","contacts");
+
+	for (int numThreads=1;numThreads<=maxThreads;numThreads*=2)
+	{
+		int heapContacts,inplaceContacts;
+		float heapTime = runClipping(numThreads,rounds,false,heapContacts);
+		float inplaceTime = runClipping(numThreads,rounds,true,inplaceContacts);
+
+		printf("%7d %12.3f %12.3f %9.2f %9d\n",numThreads,heapTime,inplaceTime,heapTime/inplaceTime,inplaceContacts);
+
+		if (heapContacts != inplaceContacts)
+		{
+			printf("contacts differ: heap %d, inplace %d\n",heapContacts,inplaceContacts);
+			return 1;
+		}
+	}
+
+	for (int i=0;i<3;i++)
+	{
+		delete hulls[i];
+	}
+
+	return 0;
+}
@@ -0,0 +1,24 @@
+	project "3_bt_inplace_clipping"
+		
+	kind "ConsoleApp"
+	targetdir "../../../bin"
+	includedirs {
+		"../../../include"	
+		}
+
+	flags { "Symbols"}
+	
+	includedirs {	"../common"		}
+		
+	links {
+		"bullet_physics_util",
+		"bullet_physics_base_level"
+	}
+
+	configuration "not windows"
+		links { "pthread" }
+	configuration {}
+	
+	files {
+		"main.cpp",
+	}
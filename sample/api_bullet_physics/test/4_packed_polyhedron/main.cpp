@@ -0,0 +1,132 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2011 Advanced Micro Devices, Inc.  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+///Clips the same overlapping convex pairs with hulls stored as btConvexPolyhedron
+///and as btPackedConvexPolyhedron, and checks that both layouts give the same contacts.
+///There are many copies of every hull, so that like in a real scene the hulls
+///don't all stay in the cache between two pairs.
+///
+///usage: 4_bt_packed_polyhedron [rounds]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bullet_physics/base_level/collision/bt_polyhedral_contact_clipping.h"
+#include "bullet_physics/base_level/collision/bt_convex_polyhedron.h"
+#include "bullet_physics/base_level/collision/bt_packed_convex_polyhedron.h"
+#include "bullet_physics/util/bt_aligned_object_array.h"
+#include "bullet_physics/util/bt_convex_hull_computer.h"
+#include "bullet_physics/util/bt_stopwatch.h"
+#include "hull_test_util.h"
+
+#define NUM_HULL_TYPES 3
+#define NUM_HULLS 768
+#define NUM_PAIRS 4096
+
+typedef btInplacePolyhedralContactClipping<CountingContactCache> PolyClipper;
+
+struct ClipPair
+{
+	int m_hullA;
+	int m_hullB;
+	btTransform m_transA;
+	btTransform m_transB;
+};
+
+ClipPair gPairs[NUM_PAIRS];
+
+///returns the milliseconds to clip all pairs
+template <typename BT_POLYHEDRON>
+static float clipPairs(BT_POLYHEDRON* const* hulls, int rounds, int& numContacts)
+{
+	btStopwatch timer;
+	timer.reset();
+
+	numContacts = 0;
+	for (int r=0;r<rounds;r++)
+	{
+		for (int i=0;i<NUM_PAIRS;i++)
+		{
+			const ClipPair& pair = gPairs[i];
+			const BT_POLYHEDRON& hullA = *hulls[pair.m_hullA];
+			const BT_POLYHEDRON& hullB = *hulls[pair.m_hullB];
+			btVector3 sep;
+			if (!PolyClipper::findSeparatingAxis(hullA,hullB,pair.m_transA,pair.m_transB,sep))
+				continue;
+
+			CountingContactCache contacts(-1e30f,0.01f);
+			PolyClipper::clipHullAgainstHull(sep,hullA,hullB,pair.m_transA,pair.m_transB,contacts.m_minDist,contacts.m_maxDist,contacts);
+			numContacts += contacts.m_numContacts;
+		}
+	}
+
+	return timer.getTimeMilliseconds();
+}
+
+int main(int argc, char* argv[])
+{
+	int rounds = argc > 1 ? atoi(argv[1]) : 10;
+
+	btConvexHullComputer conv[NUM_HULL_TYPES];
+	computePrism(conv[0],4,0.7f,0.5f);
+	computePrism(conv[1],12,0.5f,0.5f);
+	computePrism(conv[2],24,0.5f,0.3f);
+
+	btConvexPolyhedron* hulls[NUM_HULLS];
+	btPackedConvexPolyhedron* packedHulls[NUM_HULLS];
+	for (int i=0;i<NUM_HULLS;i++)
+	{
+		hulls[i] = new btConvexPolyhedron();
+		if (!hulls[i]->build(conv[i%NUM_HULL_TYPES]) || !hulls[i]->fitsInplaceClipper())
+		{
+			printf("can't build hull %d for the inplace clipper\n",i);
+			return 1;
+		}
+		packedHulls[i] = new btPackedConvexPolyhedron();
+		if (!packedHulls[i]->build(conv[i%NUM_HULL_TYPES]))
+		{
+			printf("can't pack hull %d\n",i);
+			return 1;
+		}
+	}
+
+	for (int i=0;i<NUM_PAIRS;i++)
+	{
+		gPairs[i].m_hullA = (i*7)%NUM_HULLS;
+		gPairs[i].m_hullB = (i*13+(i/NUM_HULL_TYPES))%NUM_HULLS;
+		gPairs[i].m_transA = randomTransform(btVector3(0.f,0.f,0.f),0.2f);
+		gPairs[i].m_transB = randomTransform(btVector3(0.f,0.8f,0.f),0.4f);
+	}
+
+	int contacts,packedContacts;
+	float time = clipPairs(hulls,rounds,contacts);
+	float packedTime = clipPairs(packedHulls,rounds,packedContacts);
+
+	printf("%12s %12s %9s %9s\n","faces(ms)","packed(ms)","speedup","contacts");
+	printf("%12.3f %12.3f %9.2f %9d\n",time,packedTime,time/packedTime,packedContacts);
+
+	for (int i=0;i<NUM_HULLS;i++)
+	{
+		delete hulls[i];
+		delete packedHulls[i];
+	}
+
+	if (contacts != packedContacts)
+	{
+		printf("contacts differ: faces %d, packed %d\n",contacts,packedContacts);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,20 @@
+	project "4_bt_packed_polyhedron"
+		
+	kind "ConsoleApp"
+	targetdir "../../../bin"
+	includedirs {
+		"../../../include"	
+		}
+
+	flags { "Symbols"}
+	
+	includedirs {	"../common"		}
+		
+	links {
+		"bullet_physics_util",
+		"bullet_physics_base_level"
+	}
+
+	files {
+		"main.cpp",
+	}
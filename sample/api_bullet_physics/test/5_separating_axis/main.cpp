@@ -0,0 +1,203 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2011 Advanced Micro Devices, Inc.  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+///Runs findSeparatingAxis and clipHullAgainstHull on slowly moving pairs of packed hulls,
+///with all unique edge pairs, with Gauss map edge pruning, and with the separating axis
+///of the previous frame cached per pair. All runs must find the same separated pairs.
+///The pairs are set up twice, mostly touching and mostly separated. The cached axis only
+///pays off for separated pairs, the cache hits and the face and edge axes they skip are reported.
+///
+///usage: 5_bt_separating_axis [frames]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bullet_physics/base_level/collision/bt_polyhedral_contact_clipping.h"
+#include "bullet_physics/base_level/collision/bt_packed_convex_polyhedron.h"
+#include "bullet_physics/util/bt_aligned_object_array.h"
+#include "bullet_physics/util/bt_stopwatch.h"
+#include "hull_test_util.h"
+
+#define NUM_HULLS 4
+#define NUM_PAIRS 4096
+
+typedef btInplacePolyhedralContactClipping<CountingContactCache> PolyClipper;
+
+///a rock like hull of random points on a sphere, almost no edges are parallel
+static btPackedConvexPolyhedron* createRock(int numPoints, btScalar radius)
+{
+	btAlignedObjectArray<btVector3> points;
+	for (int i=0;i<numPoints;i++)
+	{
+		btVector3 dir = randomVector();
+		points.push_back(radius * VMNORMALIZED(dir));
+	}
+	return createPolyhedron<btPackedConvexPolyhedron>(points);
+}
+
+struct MovingPair
+{
+	int m_hullA;
+	int m_hullB;
+	sce::PhysicsEffects::PfxQuat m_rotA;
+	sce::PhysicsEffects::PfxQuat m_rotB;
+	btVector3 m_posA;
+	btVector3 m_posB;
+	btVector3 m_angularVelocityB;
+	btVector3 m_linearVelocityB;
+};
+
+MovingPair gPairs[NUM_PAIRS];
+btSeparatingAxisCache gAxisCaches[NUM_PAIRS];
+
+struct RunResult
+{
+	float m_ms;
+	int m_faceAxes;
+	int m_edgeAxes;
+	int m_cacheHits;
+	int m_separated;
+	int m_contacts;
+};
+
+static RunResult runFrames(btPackedConvexPolyhedron* const* hulls, int frames, bool gaussMap, bool cacheAxis)
+{
+	gUseGaussMapEdgePruning = gaussMap;
+	gFaceAxisTests = 0;
+	gEdgeEdgeTests = 0;
+	gSeparatingAxisCacheHits = 0;
+	for (int i=0;i<NUM_PAIRS;i++)
+	{
+		gAxisCaches[i] = btSeparatingAxisCache();
+	}
+
+	RunResult result;
+	result.m_separated = 0;
+	result.m_contacts = 0;
+
+	btStopwatch timer;
+	timer.reset();
+
+	for (int f=0;f<frames;f++)
+	{
+		const btScalar time = f * (1.f/60.f);
+		for (int i=0;i<NUM_PAIRS;i++)
+		{
+			const MovingPair& pair = gPairs[i];
+			const btVector3 angle = time * pair.m_angularVelocityB;
+			const sce::PhysicsEffects::PfxQuat rotB = normalize(pair.m_rotB + sce::PhysicsEffects::PfxQuat(angle,0.f) * pair.m_rotB * 0.5f);
+			const btTransform transA(pair.m_rotA,pair.m_posA);
+			const btTransform transB(rotB,pair.m_posB + time * pair.m_linearVelocityB);
+			const btPackedConvexPolyhedron& hullA = *hulls[pair.m_hullA];
+			const btPackedConvexPolyhedron& hullB = *hulls[pair.m_hullB];
+
+			btVector3 sep;
+			if (!PolyClipper::findSeparatingAxis(hullA,hullB,transA,transB,sep,cacheAxis ? &gAxisCaches[i] : 0))
+			{
+				result.m_separated++;
+				continue;
+			}
+
+			CountingContactCache contacts(-1e30f,0.01f);
+			PolyClipper::clipHullAgainstHull(sep,hullA,hullB,transA,transB,contacts.m_minDist,contacts.m_maxDist,contacts);
+			result.m_contacts += contacts.m_numContacts;
+		}
+	}
+
+	result.m_ms = timer.getTimeMilliseconds();
+	result.m_faceAxes = gFaceAxisTests;
+	result.m_edgeAxes = gEdgeEdgeTests;
+	result.m_cacheHits = gSeparatingAxisCacheHits;
+	return result;
+}
+
+static void printResult(const char* name, const RunResult& result)
+{
+	printf("%-12s %10.3f %11d %11d %10d %10d %10d\n",name,result.m_ms,result.m_faceAxes,result.m_edgeAxes,result.m_cacheHits,result.m_separated,result.m_contacts);
+}
+
+static void setupPairs(btScalar distance)
+{
+	for (int i=0;i<NUM_PAIRS;i++)
+	{
+		MovingPair& pair = gPairs[i];
+		pair.m_hullA = i%NUM_HULLS;
+		pair.m_hullB = (i/NUM_HULLS)%NUM_HULLS;
+		pair.m_rotA = normalize(sce::PhysicsEffects::PfxQuat(randomVector(),nextRandom()-0.5f));
+		pair.m_rotB = normalize(sce::PhysicsEffects::PfxQuat(randomVector(),nextRandom()-0.5f));
+		pair.m_posA = 0.2f * randomVector();
+		pair.m_posB = btVector3(0.f,distance,0.f) + 0.4f * randomVector();
+		pair.m_angularVelocityB = 2.f * randomVector();
+		pair.m_linearVelocityB = 0.5f * randomVector();
+	}
+}
+
+///returns false when the runs don't agree or the cached axis didn't skip any axes
+static bool runScene(const char* name, btPackedConvexPolyhedron* const* hulls, int frames, btScalar distance)
+{
+	setupPairs(distance);
+
+	RunResult uniqueEdges = runFrames(hulls,frames,false,false);
+	RunResult gaussMap = runFrames(hulls,frames,true,false);
+	RunResult cachedAxis = runFrames(hulls,frames,true,true);
+
+	printf("\n%s pairs\n",name);
+	printf("%-12s %10s %11s %11s %10s %10s %10s\n","","time(ms)","face axes","edge axes","cache hits","separated","contacts");
+	printResult("unique edges",uniqueEdges);
+	printResult("gauss map",gaussMap);
+	printResult("cached axis",cachedAxis);
+	printf("the cached axis skipped %d face axes and %d edge axes, %.2fx faster than the gauss map\n",
+		gaussMap.m_faceAxes-cachedAxis.m_faceAxes,gaussMap.m_edgeAxes-cachedAxis.m_edgeAxes,gaussMap.m_ms/cachedAxis.m_ms);
+
+	if (gaussMap.m_separated != uniqueEdges.m_separated || cachedAxis.m_separated != uniqueEdges.m_separated)
+	{
+		printf("separated pairs differ\n");
+		return false;
+	}
+
+	if (cachedAxis.m_cacheHits > 0 && cachedAxis.m_faceAxes >= gaussMap.m_faceAxes)
+	{
+		printf("cache hits didn't skip any axes\n");
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	int frames = argc > 1 ? atoi(argv[1]) : 10;
+
+	btPackedConvexPolyhedron* hulls[NUM_HULLS];
+	hulls[0] = createPrism<btPackedConvexPolyhedron>(12,0.5f,0.5f);
+	hulls[1] = createPrism<btPackedConvexPolyhedron>(24,0.5f,0.3f);
+	hulls[2] = createRock(32,0.5f);
+	hulls[3] = createRock(64,0.5f);
+
+	for (int i=0;i<NUM_HULLS;i++)
+	{
+		printf("hull %d: %d vertices, %d faces, %d edges, %d unique edges\n",i,
+			hulls[i]->getNumVertices(),hulls[i]->getNumFaces(),hulls[i]->getNumEdges(),hulls[i]->getNumUniqueEdges());
+	}
+
+	bool ok = runScene("touching",hulls,frames,0.9f);
+	ok = runScene("separated",hulls,frames,1.3f) && ok;
+
+	for (int i=0;i<NUM_HULLS;i++)
+	{
+		delete hulls[i];
+	}
+
+	return ok ? 0 : 1;
+}
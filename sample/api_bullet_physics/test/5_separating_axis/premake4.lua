@@ -0,0 +1,20 @@
+	project "5_bt_separating_axis"
+		
+	kind "ConsoleApp"
+	targetdir "../../../bin"
+	includedirs {
+		"../../../include"	
+		}
+
+	flags { "Symbols"}
+	
+	includedirs {	"../common"		}
+		
+	links {
+		"bullet_physics_util",
+		"bullet_physics_base_level"
+	}
+
+	files {
+		"main.cpp",
+	}
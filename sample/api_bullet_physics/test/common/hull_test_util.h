@@ -0,0 +1,111 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2011 Advanced Micro Devices, Inc.  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+///Helpers shared by the contact clipping tests: a contact cache that only counts
+///the clipped points, hull and prism construction, and a repeatable random generator.
+
+#ifndef _HULL_TEST_UTIL_H
+#define _HULL_TEST_UTIL_H
+
+#include <math.h>
+#include "bullet_physics/bt_math_conversions.h"
+#include "bullet_physics/util/bt_aligned_object_array.h"
+#include "bullet_physics/util/bt_convex_hull_computer.h"
+
+///counts the clipped points within the contact range
+struct CountingContactCache
+{
+	btScalar	m_minDist;
+	btScalar	m_maxDist;
+	int			m_numContacts;
+
+	CountingContactCache(btScalar minDist, btScalar maxDist)
+		:m_minDist(minDist),m_maxDist(maxDist),m_numContacts(0)
+	{
+	}
+
+	inline void addContacts(const btVector3& planeNormalWS, btScalar planeEqWS, int numVertices, const btVector3* vertices)
+	{
+		for (int i=0;i<numVertices;i++)
+		{
+			btScalar depth = VMDOT(planeNormalWS,vertices[i])+planeEqWS;
+			if (depth <= m_maxDist && depth >= m_minDist)
+				m_numContacts++;
+		}
+	}
+};
+
+///builds a btConvexPolyhedron or a btPackedConvexPolyhedron from the convex hull of the points
+template <typename BT_POLYHEDRON>
+inline BT_POLYHEDRON* createPolyhedron(const btAlignedObjectArray<btVector3>& points)
+{
+	btConvexHullComputer conv;
+	conv.compute((const float*)&points[0], sizeof(btVector3), points.size(), 0.f, 0.f);
+
+	BT_POLYHEDRON* polyhedron = new BT_POLYHEDRON();
+	polyhedron->build(conv);
+	return polyhedron;
+}
+
+///the corners of a barrel like prism with numSides sides, most of its edges are parallel
+inline void getPrismPoints(btAlignedObjectArray<btVector3>& points, int numSides, btScalar radius, btScalar halfHeight)
+{
+	for (int i=0;i<numSides;i++)
+	{
+		btScalar angle = 2.f * 3.14159265f * i / numSides;
+		points.push_back(btVector3(radius*cosf(angle),-halfHeight,radius*sinf(angle)));
+		points.push_back(btVector3(radius*cosf(angle), halfHeight,radius*sinf(angle)));
+	}
+}
+
+///computes the hull of a barrel like prism with numSides sides
+inline void computePrism(btConvexHullComputer& conv, int numSides, btScalar radius, btScalar halfHeight)
+{
+	btAlignedObjectArray<btVector3> points;
+	getPrismPoints(points,numSides,radius,halfHeight);
+	conv.compute((const float*)&points[0], sizeof(btVector3), points.size(), 0.f, 0.f);
+}
+
+///a barrel like prism with numSides sides
+template <typename BT_POLYHEDRON>
+inline BT_POLYHEDRON* createPrism(int numSides, btScalar radius, btScalar halfHeight)
+{
+	btAlignedObjectArray<btVector3> points;
+	getPrismPoints(points,numSides,radius,halfHeight);
+	return createPolyhedron<BT_POLYHEDRON>(points);
+}
+
+static unsigned int randomSeed = 1234;
+
+///a linear congruential generator, so that every run sets up the same pairs
+inline float nextRandom()
+{
+	randomSeed = randomSeed * 1664525 + 1013904223;
+	return (float)(randomSeed >> 8) / (float)(1 << 24);
+}
+
+inline btVector3 randomVector()
+{
+	return btVector3(nextRandom()-0.5f,nextRandom()-0.5f,nextRandom()-0.5f);
+}
+
+inline btTransform randomTransform(const btVector3& center, btScalar spread)
+{
+	sce::PhysicsEffects::PfxQuat rot = normalize(sce::PhysicsEffects::PfxQuat(nextRandom()-0.5f,nextRandom()-0.5f,nextRandom()-0.5f,nextRandom()-0.5f));
+	btVector3 pos = center + spread * randomVector();
+	return btTransform(rot,pos);
+}
+
+#endif //_HULL_TEST_UTIL_H
@@ -77,6 +77,9 @@ static float BarrelVtx[] = {
 0.282362f,0.5f,0.205148f,       0.774478f,0.289072f,0.562691f,
 };
 
+//J テクスチャ座標は描画にだけ使う。形状だけが必要なサンプルはSAMPLE_GEOMETRY_ONLYを定義する
+//E Texture coordinates are only used for rendering. Samples that only need the shape define SAMPLE_GEOMETRY_ONLY
+#ifndef SAMPLE_GEOMETRY_ONLY
 static float BarrelTex[] = {
 0.0f,0.5f,
 0.0f,0.85f,
@@ -136,6 +139,7 @@ static float BarrelTex[] = {
 1.0f,0.55f,
 1.0f,0.65f,
 };
+#endif
 
 static unsigned short BarrelIdx[] = {
 0,1,2,
@@ -101,6 +101,9 @@ static float LargeMeshVtx[] = {
 25.0f,1.05366f,-24.75f,                 0.161f,0.986887f,-0.0115473f,
 };
 
+//J テクスチャ座標は描画にだけ使う。形状だけが必要なサンプルはSAMPLE_GEOMETRY_ONLYを定義する
+//E Texture coordinates are only used for rendering. Samples that only need the shape define SAMPLE_GEOMETRY_ONLY
+#ifndef SAMPLE_GEOMETRY_ONLY
 static float LargeMeshTex[] = {
 0.125f,0.0f,
 0.0f,0.0f,
@@ -184,6 +187,7 @@ static float LargeMeshTex[] = {
 1.0f,0.875f,
 1.0f,1.0f,
 };
+#endif
 
 static unsigned short LargeMeshIdx[] = {
 0,1,2,
@@ -21,6 +21,14 @@ Physics Effects under the filename: physics_effects_license.txt
 static int frameCount = 0;
 static int sceneId = 2;
 
+//J マーカーのトレースを記録し、chrome://tracingやPerfettoで読めるファイルに書き出す
+//E Record the markers and write them to a file for chrome://tracing or Perfetto
+#define TRACE_THREADS 4
+#define TRACE_EVENTS  32768
+#define TRACE_BYTES   (128+TRACE_THREADS*TRACE_EVENTS*16+TRACE_THREADS*128)
+
+static unsigned char SCE_PFX_ALIGNED(128) traceBuff[TRACE_BYTES];
+
 int main()
 {
 
@@ -33,9 +41,24 @@ int main()
 
 	//createScene();
 
+	PfxStartTraceParam traceParam;
+	traceParam.traceBuff = traceBuff;
+	traceParam.traceBytes = TRACE_BYTES;
+	traceParam.maxThreads = TRACE_THREADS;
+	pfxStartTrace(traceParam);
+
 	while(frameCount<600) {
 		physics_simulate();
+		pfxProfileEndFrame();
 		perf_sync();
+		frameCount++;
+	}
+
+	pfxPrintProfile();
+
+	pfxStopTrace();
+	if(pfxWriteTrace("physics_trace.json") == SCE_PFX_OK) {
+		SCE_PFX_PRINTF("trace written to physics_trace.json\n");
 	}
 
 	SCE_PFX_PRINTF("program complete\n");
@@ -61,19 +61,11 @@ PfxConstraintPair jointPairs[NUM_JOINTS];
 PfxJoint joints[NUM_JOINTS];
 int numJoints = 0;
 
-//J ペア
-//E Pairs
-unsigned int pairSwap;
-unsigned int numPairs[2];
-PfxBroadphasePair pairsBuff[2][NUM_CONTACTS];
-
-//J コンタクト
-//E Contacts
-PfxContactManifold contacts[NUM_CONTACTS];
-int numContacts;
-
-PfxUInt32 contactIdPool[NUM_CONTACTS];
-int numContactIdPool;
+//J ペアとコンタクト
+//E Pairs and contacts
+#define PAIR_CACHE_BYTES (4*1024*1024)
+unsigned char SCE_PFX_ALIGNED(128) pairCacheBuff[PAIR_CACHE_BYTES];
+PfxPairCache *pairCache = NULL;
 
 //J 一時バッファ
 //E Temporary buffers
@@ -91,13 +83,6 @@ int frame = 0;
 
 void broadphase()
 {
-	pairSwap = 1-pairSwap;
-
-	unsigned int &numPreviousPairs = numPairs[1-pairSwap];
-	unsigned int &numCurrentPairs = numPairs[pairSwap];
-	PfxBroadphasePair *previousPairs = pairsBuff[1-pairSwap];
-	PfxBroadphasePair *currentPairs = pairsBuff[pairSwap];
-
 	//J 剛体が最も分散している軸を見つける
 	//E Find the axis along which all rigid bodies are most widely positioned
 	int axis = 0;
@@ -148,85 +133,27 @@ void broadphase()
 		
 		pool.deallocate(findPairsParam.workBuff);
 
-		//J 交差ペア合成
-		//E Decompose overlapped pairs into 3 arrays
-		PfxDecomposePairsParam decomposePairsParam;
-		decomposePairsParam.pairBytes = pfxGetPairBytesOfDecomposePairs(numPreviousPairs,findPairsResult.numPairs);
-		decomposePairsParam.pairBuff = pool.allocate(decomposePairsParam.pairBytes);
-		decomposePairsParam.workBytes = pfxGetWorkBytesOfDecomposePairs(numPreviousPairs,findPairsResult.numPairs);
-		decomposePairsParam.workBuff = pool.allocate(decomposePairsParam.workBytes);
-		decomposePairsParam.previousPairs = previousPairs;
-		decomposePairsParam.numPreviousPairs = numPreviousPairs;
-		decomposePairsParam.currentPairs = findPairsResult.pairs; // Set pairs from pfxFindPairs()
-		decomposePairsParam.numCurrentPairs = findPairsResult.numPairs; // Set the number of pairs from pfxFindPairs()
-
-		PfxDecomposePairsResult decomposePairsResult;
-
-		ret = pfxDecomposePairs(decomposePairsParam,decomposePairsResult);
-		if(ret != SCE_PFX_OK) SCE_PFX_PRINTF("pfxDecomposePairs failed %d\n",ret);
-
-		pool.deallocate(decomposePairsParam.workBuff);
-
-		PfxBroadphasePair *outNewPairs = decomposePairsResult.outNewPairs;
-		PfxBroadphasePair *outKeepPairs = decomposePairsResult.outKeepPairs;
-		PfxBroadphasePair *outRemovePairs = decomposePairsResult.outRemovePairs;
-		PfxUInt32 numOutNewPairs = decomposePairsResult.numOutNewPairs;
-		PfxUInt32 numOutKeepPairs = decomposePairsResult.numOutKeepPairs;
-		PfxUInt32 numOutRemovePairs = decomposePairsResult.numOutRemovePairs;
-
-		//J 廃棄ペアのコンタクトをプールに戻す
-		//E Put removed contacts into the contact pool
-		for(PfxUInt32 i=0;i<numOutRemovePairs;i++) {
-			contactIdPool[numContactIdPool++] = pfxGetContactId(outRemovePairs[i]);
-		}
+		//J 前フレームのペアと合成し、マニフォールドを割り当てる
+		//E Merge with the previous pairs and assign manifolds
+		PfxUpdatePairCacheParam updatePairCacheParam;
+		updatePairCacheParam.cache = pairCache;
+		updatePairCacheParam.currentPairs = findPairsResult.pairs; // Set pairs from pfxFindPairs()
+		updatePairCacheParam.numCurrentPairs = findPairsResult.numPairs; // Set the number of pairs from pfxFindPairs()
 
-		//J 新規ペアのコンタクトのリンクと初期化
-		//E Add new contacts and initialize
-		for(PfxUInt32 i=0;i<numOutNewPairs;i++) {
-			int cId = 0;
-			if(numContactIdPool > 0) {
-				cId = contactIdPool[--numContactIdPool];
-			}
-			else {
-				cId = numContacts++;
-			}
-			if(cId >= NUM_CONTACTS) {
-				cId = 0;
-			}
-			SCE_PFX_ASSERT(cId < NUM_CONTACTS);
-			pfxSetContactId(outNewPairs[i],cId);
-			PfxContactManifold &contact = contacts[cId];
-			contact.reset(pfxGetObjectIdA(outNewPairs[i]),pfxGetObjectIdB(outNewPairs[i]));
-		}
+		PfxUpdatePairCacheResult updatePairCacheResult;
+
+		ret = pfxUpdatePairCache(updatePairCacheParam,updatePairCacheResult);
+		if(ret != SCE_PFX_OK) SCE_PFX_PRINTF("pfxUpdatePairCache failed %d\n",ret);
 
-		//J 新規ペアと維持ペアを合成
-		//E Merge 'new' and 'keep' pairs
-		numCurrentPairs = 0;
-		for(PfxUInt32 i=0;i<numOutKeepPairs;i++) {
-			currentPairs[numCurrentPairs++] = outKeepPairs[i];
-		}
-		for(PfxUInt32 i=0;i<numOutNewPairs;i++) {
-			currentPairs[numCurrentPairs++] = outNewPairs[i];
-		}
-		
-		pool.deallocate(decomposePairsParam.pairBuff);
 		pool.deallocate(findPairsParam.pairBuff);
 	}
-	
-	{
-		int workBytes = sizeof(PfxBroadphasePair) * numCurrentPairs;
-		void *workBuff = pool.allocate(workBytes);
-		
-		pfxParallelSort(currentPairs,numCurrentPairs,workBuff,workBytes);
-		
-		pool.deallocate(workBuff);
-	}
 }
 
 void collision()
 {
-	unsigned int numCurrentPairs = numPairs[pairSwap];
-	PfxBroadphasePair *currentPairs = pairsBuff[pairSwap];
+	unsigned int numCurrentPairs = pfxGetNumPairsOfPairCache(pairCache);
+	PfxBroadphasePair *currentPairs = pfxGetPairsOfPairCache(pairCache);
+	PfxContactManifold *contacts = pfxGetContactsOfPairCache(pairCache);
 	
 	//J 衝突検出
 	//E Detect collisions
@@ -262,8 +189,9 @@ void constraintSolver()
 {
 	PfxPerfCounter pc;
 
-	unsigned int numCurrentPairs = numPairs[pairSwap];
-	PfxBroadphasePair *currentPairs = pairsBuff[pairSwap];
+	unsigned int numCurrentPairs = pfxGetNumPairsOfPairCache(pairCache);
+	PfxBroadphasePair *currentPairs = pfxGetPairsOfPairCache(pairCache);
+	PfxContactManifold *contacts = pfxGetContactsOfPairCache(pairCache);
 
 	pc.countBegin("setup solver bodies");
 	{
@@ -358,31 +286,45 @@ void physics_simulate()
 {
 	PfxPerfCounter pc;
 
+	SCE_PFX_PROFILE_SCOPE("simulate");
+
 	for(int i=1;i<numRigidBodies;i++) {
 		pfxApplyExternalForce(states[i],bodies[i],bodies[i].getMass()*PfxVector3(0.0f,-9.8f,0.0f),PfxVector3(0.0f),timeStep);
 	}
 	
 	perf_push_marker("broadphase");
 	pc.countBegin("broadphase");
-	broadphase();
+	{
+		SCE_PFX_PROFILE_SCOPE("broadphase");
+		broadphase();
+	}
 	pc.countEnd();
 	perf_pop_marker();
 	
 	perf_push_marker("collision");
 	pc.countBegin("collision");
-	collision();
+	{
+		SCE_PFX_PROFILE_SCOPE("collision");
+		collision();
+	}
 	pc.countEnd();
 	perf_pop_marker();
 	
 	perf_push_marker("solver");
 	pc.countBegin("solver");
-	constraintSolver();
+	{
+		SCE_PFX_PROFILE_SCOPE("solver");
+		constraintSolver();
+	}
 	pc.countEnd();
 	perf_pop_marker();
 	
 	perf_push_marker("integrate");
 	pc.countBegin("integrate");
-	integrate();
+	{
+		SCE_PFX_PROFILE_SCOPE("integrate");
+		integrate();
+	}
 	pc.countEnd();
 	perf_pop_marker();
 	
@@ -751,11 +693,7 @@ void physics_create_scene(int sceneId)
 	int sid = sceneId % numScenes;
 	
 	numRigidBodies= 0;
-	pairSwap = 0;
-	numPairs[0] = 0;
-	numPairs[1] = 0;
-	numContacts = 0;
-	numContactIdPool = 0;
+	pfxResetPairCache(pairCache);
 	numJoints = 0;
 	frame = 0;
 	
@@ -804,6 +742,22 @@ void physics_create_scene(int sceneId)
 
 bool physics_init()
 {
+	PfxCreatePairCacheParam param;
+	param.cacheBuff = pairCacheBuff;
+	param.cacheBytes = PAIR_CACHE_BYTES;
+	param.maxPairs = NUM_CONTACTS;
+	param.maxContacts = NUM_CONTACTS;
+
+	PfxCreatePairCacheResult result;
+
+	int ret = pfxCreatePairCache(param,result);
+	if(ret != SCE_PFX_OK) {
+		SCE_PFX_PRINTF("pfxCreatePairCache failed %d\n",ret);
+		return false;
+	}
+
+	pairCache = result.cache;
+
 	return true;
 }
 
@@ -852,10 +806,10 @@ const PfxCollidable& physics_get_collidable(int id)
 
 int physics_get_num_contacts()
 {
-	return numPairs[pairSwap];
+	return pfxGetNumPairsOfPairCache(pairCache);
 }
 
 const PfxContactManifold &physics_get_contact(int id)
 {
-	return contacts[pfxGetConstraintId(pairsBuff[pairSwap][id])];
+	return pfxGetContactsOfPairCache(pairCache)[pfxGetConstraintId(pfxGetPairsOfPairCache(pairCache)[id])];
 }
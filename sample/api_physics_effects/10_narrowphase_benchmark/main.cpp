@@ -0,0 +1,267 @@
+/*
+Physics Effects Copyright(C) 2011 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#include "physics_effects.h"
+#include "../../../src/physics_effects/low_level/collision/pfx_detect_collision_func.h"
+#define SAMPLE_GEOMETRY_ONLY
+#include "../0_console/landscape.h"
+#include "../0_console/barrel.h"
+
+#include <stdlib.h>
+
+using namespace sce::PhysicsEffects;
+
+//J 衝突判定関数テーブルの形状の組み合わせごとに、衝突判定関数だけの処理時間を計測する
+//E Measures the contact routines of the pfxGetDetectCollisionFunc table in
+//E isolation. For every pair of shape types a reproducible set of random
+//E relative transforms is generated, then the routine registered for the pair
+//E is called over the whole set several times. Reports the time per pair,
+//E the number of contacts per pair and the ratio of pairs that touch.
+//E
+//E usage: App_10_NarrowphaseBenchmark [numSamples] [numRepeats] [seed]
+
+///////////////////////////////////////////////////////////////////////////////
+// Benchmark Data
+
+#define MAX_SAMPLES 65536
+
+//J パイプラインと同じ閾値 (SCE_PFX_CONTACT_THRESHOLD)
+//E Same threshold as the pipeline (SCE_PFX_CONTACT_THRESHOLD)
+#define CONTACT_THRESHOLD 0.0f
+
+enum {
+	SHAPE_SPHERE = 0,
+	SHAPE_BOX,
+	SHAPE_CAPSULE,
+	SHAPE_CYLINDER,
+	SHAPE_CONVEX_MESH,
+	SHAPE_LARGE_TRI_MESH,
+	SHAPE_COUNT,
+};
+
+const char *shapeNames[SHAPE_COUNT] = {
+	"sphere",
+	"box",
+	"capsule",
+	"cylinder",
+	"convex",
+	"largemesh",
+};
+
+PfxShape shapes[SHAPE_COUNT];
+PfxConvexMesh convexMesh;
+PfxLargeTriMesh largeMesh;
+
+PfxTransform3 transformsA[MAX_SAMPLES];
+PfxTransform3 transformsB[MAX_SAMPLES];
+
+unsigned int randomSeed;
+
+static float nextRandom()
+{
+	randomSeed = randomSeed * 1664525 + 1013904223;
+	return (float)(randomSeed >> 8) / (float)(1 << 24);
+}
+
+static PfxVector3 randomDirection()
+{
+	PfxFloat z = 2.0f * nextRandom() - 1.0f;
+	PfxFloat a = 2.0f * SCE_PFX_PI * nextRandom();
+	PfxFloat r = sqrtf(SCE_PFX_MAX(0.0f,1.0f - z * z));
+	return PfxVector3(r * cosf(a),r * sinf(a),z);
+}
+
+static PfxQuat randomOrientation()
+{
+	return PfxQuat::rotation(2.0f * SCE_PFX_PI * nextRandom(),randomDirection());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Shapes
+
+static bool createShapes()
+{
+	shapes[SHAPE_SPHERE].reset();
+	shapes[SHAPE_SPHERE].setSphere(PfxSphere(0.5f));
+
+	shapes[SHAPE_BOX].reset();
+	shapes[SHAPE_BOX].setBox(PfxBox(0.5f,0.3f,0.4f));
+
+	shapes[SHAPE_CAPSULE].reset();
+	shapes[SHAPE_CAPSULE].setCapsule(PfxCapsule(0.5f,0.25f));
+
+	shapes[SHAPE_CYLINDER].reset();
+	shapes[SHAPE_CYLINDER].setCylinder(PfxCylinder(0.4f,0.3f));
+
+	{
+		PfxCreateConvexMeshParam param;
+		param.verts = BarrelVtx;
+		param.numVerts = BarrelVtxCount;
+		param.vertexStrideBytes = sizeof(float)*6;
+		param.triangles = BarrelIdx;
+		param.numTriangles = BarrelIdxCount/3;
+		param.triangleStrideBytes = sizeof(unsigned short)*3;
+
+		if(pfxCreateConvexMesh(convexMesh,param) != SCE_PFX_OK) {
+			SCE_PFX_PRINTF("Can't create convex mesh.\n");
+			return false;
+		}
+
+		shapes[SHAPE_CONVEX_MESH].reset();
+		shapes[SHAPE_CONVEX_MESH].setConvexMesh(&convexMesh);
+	}
+
+	{
+		PfxCreateLargeTriMeshParam param;
+		param.verts = LargeMeshVtx;
+		param.numVerts = LargeMeshVtxCount;
+		param.vertexStrideBytes = sizeof(float)*6;
+		param.triangles = LargeMeshIdx;
+		param.numTriangles = LargeMeshIdxCount/3;
+		param.triangleStrideBytes = sizeof(unsigned short)*3;
+
+		if(pfxCreateLargeTriMesh(largeMesh,param) != SCE_PFX_OK) {
+			SCE_PFX_PRINTF("Can't create large mesh.\n");
+			return false;
+		}
+
+		shapes[SHAPE_LARGE_TRI_MESH].reset();
+		shapes[SHAPE_LARGE_TRI_MESH].setLargeTriMesh(&largeMesh);
+	}
+
+	return true;
+}
+
+//J AABBの対角線の半分を形状の大きさとする
+//E The half diagonal of the local AABB is used as the size of a shape
+static PfxFloat getShapeRadius(const PfxShape &shape)
+{
+	PfxVector3 aabbMin,aabbMax;
+	shape.getAabb(aabbMin,aabbMax);
+	return 0.5f * length(aabbMax - aabbMin);
+}
+
+//J 相対的な配置をランダムに生成する。凸形状同士は中心間の距離を半径の和の0〜1.2倍とし、
+//J 大きなメッシュに対してはメッシュの範囲内に凸形状を置く
+//E Generate random relative transforms. Two convex shapes are placed 0 to 1.2
+//E times the sum of their radii apart. A convex shape against the large mesh
+//E is placed anywhere over the mesh, within its radius of the height range.
+static void createSamples(int shapeA,int shapeB,int numSamples,unsigned int seed)
+{
+	randomSeed = seed + shapeA * SHAPE_COUNT + shapeB;
+
+	PfxFloat radiusA = getShapeRadius(shapes[shapeA]);
+	PfxFloat radiusB = getShapeRadius(shapes[shapeB]);
+
+	for(int i=0;i<numSamples;i++) {
+		if(shapeA == SHAPE_LARGE_TRI_MESH || shapeB == SHAPE_LARGE_TRI_MESH) {
+			int meshId = shapeA == SHAPE_LARGE_TRI_MESH ? shapeA : shapeB;
+			PfxFloat radius = shapeA == SHAPE_LARGE_TRI_MESH ? radiusB : radiusA;
+
+			PfxVector3 aabbMin,aabbMax;
+			shapes[meshId].getAabb(aabbMin,aabbMax);
+			aabbMin -= PfxVector3(0.0f,radius,0.0f);
+			aabbMax += PfxVector3(0.0f,radius,0.0f);
+
+			PfxVector3 pos = aabbMin + mulPerElem(aabbMax - aabbMin,PfxVector3(nextRandom(),nextRandom(),nextRandom()));
+			PfxTransform3 mesh = PfxTransform3::identity();
+			PfxTransform3 other(randomOrientation(),pos);
+
+			transformsA[i] = shapeA == SHAPE_LARGE_TRI_MESH ? mesh : other;
+			transformsB[i] = shapeA == SHAPE_LARGE_TRI_MESH ? other : mesh;
+		}
+		else {
+			PfxFloat distance = 1.2f * (radiusA + radiusB) * nextRandom();
+			transformsA[i] = PfxTransform3(randomOrientation(),PfxVector3(0.0f));
+			transformsB[i] = PfxTransform3(randomOrientation(),distance * randomDirection());
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+
+int main(int argc,char **argv)
+{
+	int numSamples = argc > 1 ? atoi(argv[1]) : 4096;
+	int numRepeats = argc > 2 ? atoi(argv[2]) : 20;
+	unsigned int seed = argc > 3 ? (unsigned int)atoi(argv[3]) : 1234;
+
+	numSamples = SCE_PFX_CLAMP(numSamples,1,MAX_SAMPLES);
+	numRepeats = SCE_PFX_MAX(numRepeats,1);
+
+	if(!createShapes()) {
+		return 1;
+	}
+
+	SCE_PFX_PRINTF("%d samples, %d repeats, seed %u\n",numSamples,numRepeats,seed);
+	SCE_PFX_PRINTF("%-10s %-10s %10s %14s %10s\n","shapeA","shapeB","ns/pair","contacts/pair","hit ratio");
+
+	PfxTransform3 offsetTransform = PfxTransform3::identity();
+	double nsPerTick = 1.0e9 / pfxGetPerfTicksPerSecond();
+
+	for(int shapeA=0;shapeA<SHAPE_COUNT;shapeA++) {
+		for(int shapeB=0;shapeB<SHAPE_COUNT;shapeB++) {
+			const PfxShape &sA = shapes[shapeA];
+			const PfxShape &sB = shapes[shapeB];
+
+			pfx_detect_collision_func func = pfxGetDetectCollisionFunc(sA.getType(),sB.getType());
+
+			createSamples(shapeA,shapeB,numSamples,seed);
+
+			//J 接触点数とヒット率は1回目の結果から求める
+			//E Contacts and hits are counted on the first pass only
+			int numContacts = 0;
+			int numHits = 0;
+			for(int i=0;i<numSamples;i++) {
+				PfxContactCache contacts;
+				func(contacts,
+					sA,offsetTransform,transformsA[i],0,
+					sB,offsetTransform,transformsB[i],0,
+					CONTACT_THRESHOLD);
+				numContacts += contacts.getNumContacts();
+				numHits += contacts.getNumContacts() > 0 ? 1 : 0;
+			}
+
+			int checkSum = 0;
+			PfxUInt64 ticks = pfxGetPerfTicks();
+			for(int r=0;r<numRepeats;r++) {
+				for(int i=0;i<numSamples;i++) {
+					PfxContactCache contacts;
+					func(contacts,
+						sA,offsetTransform,transformsA[i],0,
+						sB,offsetTransform,transformsB[i],0,
+						CONTACT_THRESHOLD);
+					checkSum += contacts.getNumContacts();
+				}
+			}
+			ticks = pfxGetPerfTicks() - ticks;
+
+			if(checkSum != numContacts * numRepeats) {
+				SCE_PFX_PRINTF("%-10s %-10s results differ between passes\n",shapeNames[shapeA],shapeNames[shapeB]);
+			}
+
+			SCE_PFX_PRINTF("%-10s %-10s %10.1f %14.3f %10.3f\n",shapeNames[shapeA],shapeNames[shapeB],
+				(double)ticks * nsPerTick / ((double)numSamples * numRepeats),
+				(double)numContacts / numSamples,
+				(double)numHits / numSamples);
+		}
+	}
+
+	pfxReleaseLargeTriMesh(largeMesh);
+
+	return 0;
+}
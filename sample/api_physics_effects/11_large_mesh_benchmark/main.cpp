@@ -0,0 +1,437 @@
+/*
+Physics Effects Copyright(C) 2011 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#include "physics_effects.h"
+#include "../../../src/physics_effects/low_level/collision/pfx_detect_collision_func.h"
+#include "../../../src/physics_effects/low_level/collision/pfx_intersect_ray_func.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+using namespace sce::PhysicsEffects;
+
+//J 大きな地形に対する衝突判定とレイキャストの処理時間を、アイランドのBVHを使う場合と
+//J アイランドのAABBを線形に探索する場合で比較する
+//E Compares contact and ray queries against a large procedural landscape
+//E using the island BVH built by pfxCreateLargeTriMesh with the linear scan
+//E of the island AABBs (the path taken when m_bvhNodes is NULL). Both paths
+//E must agree on which shapes touch the mesh and on every ray hit.
+//E The landscape is built once on a single thread and, when numThreads > 1,
+//E once more over numThreads tasks. The parallel build must produce the same
+//E islands. The build throughput is reported in triangles per second.
+//E The same landscape is also queried as a PfxHeightField, which must agree
+//E with the large mesh on contacts and ray hits at a fraction of its memory.
+//E
+//E usage: App_11_LargeMeshBenchmark [gridSize] [numQueries] [numRepeats] [numThreads]
+
+///////////////////////////////////////////////////////////////////////////////
+// Landscape
+
+#define MAX_GRID    512
+#define MAX_QUERIES 16384
+#define MAX_THREADS 16
+
+#define TASK_MANAGER_BYTES (64*1024)
+unsigned char SCE_PFX_ALIGNED(128) taskManagerBuff[TASK_MANAGER_BYTES];
+
+#define NUM_QUERY_SHAPES 5
+
+PfxFloat landscapeVerts[(MAX_GRID+1)*(MAX_GRID+1)*3];
+PfxUInt32 landscapeIndices[MAX_GRID*MAX_GRID*6];
+PfxFloat landscapeHeights[(MAX_GRID+1)*(MAX_GRID+1)];
+
+PfxLargeTriMesh largeMesh;
+PfxLargeTriMesh referenceMesh;
+PfxHeightField heightField;
+PfxConvexMesh convexMesh;
+PfxShape meshShape;
+PfxShape fieldShape;
+PfxShape queryShapes[NUM_QUERY_SHAPES];
+const char *queryShapeNames[NUM_QUERY_SHAPES] = {"sphere","box","capsule","cylinder","convex"};
+
+PfxTransform3 queryTransforms[MAX_QUERIES];
+PfxRayInput rayInputs[MAX_QUERIES];
+PfxRayOutput rayOutputs[2][MAX_QUERIES];
+int contactCounts[2][MAX_QUERIES];
+
+unsigned int randomSeed = 1234;
+
+static float nextRandom()
+{
+	randomSeed = randomSeed * 1664525 + 1013904223;
+	return (float)(randomSeed >> 8) / (float)(1 << 24);
+}
+
+static PfxFloat getHeight(PfxFloat x,PfxFloat z)
+{
+	return 3.0f * sinf(x * 0.11f) * cosf(z * 0.07f) + 1.5f * sinf((x + z) * 0.23f);
+}
+
+static bool isSameIsland(const PfxTriMesh &islandA,const PfxTriMesh &islandB)
+{
+	if(islandA.m_numVerts != islandB.m_numVerts ||
+	   islandA.m_numEdges != islandB.m_numEdges ||
+	   islandA.m_numFacets != islandB.m_numFacets) return false;
+
+	for(int i=0;i<islandA.m_numVerts;i++) {
+		for(int j=0;j<3;j++) {
+			if(islandA.m_verts[i][j] != islandB.m_verts[i][j]) return false;
+		}
+	}
+
+	for(int i=0;i<islandA.m_numEdges;i++) {
+		if(memcmp(&islandA.m_edges[i],&islandB.m_edges[i],sizeof(PfxEdge)) != 0) return false;
+	}
+
+	for(int i=0;i<islandA.m_numFacets;i++) {
+		const PfxFacet &facetA = islandA.m_facets[i];
+		const PfxFacet &facetB = islandB.m_facets[i];
+		if(facetA.m_thickness != facetB.m_thickness) return false;
+		for(int j=0;j<3;j++) {
+			if(facetA.m_vertIds[j] != facetB.m_vertIds[j] || facetA.m_edgeIds[j] != facetB.m_edgeIds[j]) return false;
+		}
+	}
+
+	return true;
+}
+
+//J 1マス1mのグリッドの高さ場を作成する
+//J 三角形の分割はPfxHeightFieldと同じにする
+//E Create a height field with one metre grid cells
+//E The cells are split into triangles the same way PfxHeightField splits them
+static bool createLandscape(int gridSize,PfxTaskManager *taskManager)
+{
+	PfxFloat half = gridSize * 0.5f;
+	int numVerts = 0;
+	for(int z=0;z<=gridSize;z++) {
+		for(int x=0;x<=gridSize;x++) {
+			PfxFloat px = x - half;
+			PfxFloat pz = z - half;
+			landscapeVerts[numVerts*3+0] = px;
+			landscapeVerts[numVerts*3+1] = getHeight(px,pz);
+			landscapeVerts[numVerts*3+2] = pz;
+			landscapeHeights[numVerts] = landscapeVerts[numVerts*3+1];
+			numVerts++;
+		}
+	}
+
+	int numIndices = 0;
+	for(int z=0;z<gridSize;z++) {
+		for(int x=0;x<gridSize;x++) {
+			PfxUInt32 v0 = z * (gridSize+1) + x;
+			PfxUInt32 v1 = v0 + 1;
+			PfxUInt32 v2 = v0 + gridSize + 1;
+			PfxUInt32 v3 = v2 + 1;
+			landscapeIndices[numIndices++] = v0;
+			landscapeIndices[numIndices++] = v2;
+			landscapeIndices[numIndices++] = v3;
+			landscapeIndices[numIndices++] = v0;
+			landscapeIndices[numIndices++] = v3;
+			landscapeIndices[numIndices++] = v1;
+		}
+	}
+
+	PfxCreateLargeTriMeshParam param;
+	param.flag = SCE_PFX_MESH_FLAG_32BIT_INDEX|SCE_PFX_MESH_FLAG_AUTO_ELIMINATION|SCE_PFX_MESH_FLAG_AUTO_THICKNESS;
+	param.verts = landscapeVerts;
+	param.numVerts = numVerts;
+	param.triangles = landscapeIndices;
+	param.numTriangles = numIndices / 3;
+	param.triangleStrideBytes = sizeof(PfxUInt32)*3;
+	param.numFacetsLimit = 64;
+
+	SCE_PFX_PRINTF("%-10s %14s %14s\n","build","time(ms)","triangles/s");
+
+	PfxUInt64 ticks = pfxGetPerfTicks();
+	if(pfxCreateLargeTriMesh(taskManager ? referenceMesh : largeMesh,param) != SCE_PFX_OK) {
+		SCE_PFX_PRINTF("Can't create large mesh.\n");
+		return false;
+	}
+	double seconds = (double)(pfxGetPerfTicks() - ticks) / pfxGetPerfTicksPerSecond();
+	SCE_PFX_PRINTF("%-10s %14.1f %14.0f\n","1 thread",seconds * 1000.0,param.numTriangles / seconds);
+
+	//J シングルスレッドで作成したメッシュを基準にして、並列に作成したメッシュと比較する
+	//E The mesh built on a single thread is the reference for the one built in parallel
+	if(taskManager) {
+		ticks = pfxGetPerfTicks();
+		int ret = pfxCreateLargeTriMesh(largeMesh,param,taskManager);
+		seconds = (double)(pfxGetPerfTicks() - ticks) / pfxGetPerfTicksPerSecond();
+
+		bool same = ret == SCE_PFX_OK && largeMesh.m_numIslands == referenceMesh.m_numIslands;
+		for(PfxUInt32 i=0;same && i<largeMesh.m_numIslands;i++) {
+			same = isSameIsland(largeMesh.m_islands[i],referenceMesh.m_islands[i]);
+		}
+		pfxReleaseLargeTriMesh(referenceMesh);
+
+		if(ret != SCE_PFX_OK) {
+			SCE_PFX_PRINTF("Can't create large mesh.\n");
+			return false;
+		}
+
+		SCE_PFX_PRINTF("%2d threads %14.1f %14.0f\n",taskManager->getNumTasks(),seconds * 1000.0,param.numTriangles / seconds);
+
+		if(!same) {
+			SCE_PFX_PRINTF("the islands built in parallel differ from the single threaded build\n");
+			pfxReleaseLargeTriMesh(largeMesh);
+			return false;
+		}
+	}
+
+	meshShape.reset();
+	meshShape.setLargeTriMesh(&largeMesh);
+
+	heightField.m_numX = gridSize + 1;
+	heightField.m_numZ = gridSize + 1;
+	heightField.m_cellSizeX = 1.0f;
+	heightField.m_cellSizeZ = 1.0f;
+	heightField.m_thickness = param.defaultThickness;
+	heightField.m_heights = landscapeHeights;
+	heightField.updateAABB();
+
+	fieldShape.reset();
+	fieldShape.setHeightField(&heightField);
+
+	//J 凸メッシュは八面体
+	//E The convex mesh is an octahedron
+	PfxFloat convexVerts[] = {
+		0.5f,0.0f,0.0f, -0.5f,0.0f,0.0f, 0.0f,0.4f,0.0f, 0.0f,-0.4f,0.0f, 0.0f,0.0f,0.3f, 0.0f,0.0f,-0.3f,
+	};
+	PfxUInt16 convexIndices[] = {
+		0,2,4, 2,1,4, 1,3,4, 3,0,4, 2,0,5, 1,2,5, 3,1,5, 0,3,5,
+	};
+
+	PfxCreateConvexMeshParam convexParam;
+	convexParam.verts = convexVerts;
+	convexParam.numVerts = 6;
+	convexParam.triangles = convexIndices;
+	convexParam.numTriangles = 8;
+	if(pfxCreateConvexMesh(convexMesh,convexParam) != SCE_PFX_OK) {
+		SCE_PFX_PRINTF("Can't create convex mesh.\n");
+		pfxReleaseLargeTriMesh(largeMesh);
+		return false;
+	}
+
+	queryShapes[0].reset();
+	queryShapes[0].setSphere(PfxSphere(0.5f));
+	queryShapes[1].reset();
+	queryShapes[1].setBox(PfxBox(0.5f,0.3f,0.4f));
+	queryShapes[2].reset();
+	queryShapes[2].setCapsule(PfxCapsule(0.5f,0.25f));
+	queryShapes[3].reset();
+	queryShapes[3].setCylinder(PfxCylinder(0.4f,0.3f));
+	queryShapes[4].reset();
+	queryShapes[4].setConvexMesh(&convexMesh);
+
+	return true;
+}
+
+//J 地形の表面付近に形状を置き、レイは短い鉛直なものと地形を横切る長いものを半分ずつ作る
+//E Shapes are placed around the surface. Half of the rays are short and
+//E vertical, the other half cross the landscape at a shallow angle.
+static void createQueries(int gridSize,int numQueries)
+{
+	PfxFloat half = gridSize * 0.5f;
+
+	for(int i=0;i<numQueries;i++) {
+		PfxFloat x = (nextRandom() - 0.5f) * gridSize;
+		PfxFloat z = (nextRandom() - 0.5f) * gridSize;
+		PfxFloat y = getHeight(x,z) + (nextRandom() - 0.5f) * 1.5f;
+		PfxQuat rot = PfxQuat::rotationY(nextRandom() * SCE_PFX_PI) * PfxQuat::rotationX(nextRandom() * SCE_PFX_PI);
+		queryTransforms[i] = PfxTransform3(rot,PfxVector3(x,y,z));
+
+		rayInputs[i].reset();
+		if(i & 1) {
+			PfxFloat a = nextRandom() * 2.0f * SCE_PFX_PI;
+			PfxVector3 dir(cosf(a),0.0f,sinf(a));
+			rayInputs[i].m_startPosition = PfxVector3(x,6.0f,z) - dir * half;
+			rayInputs[i].m_direction = dir * (2.0f * half) + PfxVector3(0.0f,-8.0f,0.0f);
+		}
+		else {
+			rayInputs[i].m_startPosition = PfxVector3(x,10.0f,z);
+			rayInputs[i].m_direction = PfxVector3(0.0f,-20.0f,0.0f);
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Queries
+
+static double runContacts(const PfxShape &terrainShape,int shapeId,int numQueries,int numRepeats,int *counts)
+{
+	pfx_detect_collision_func func = pfxGetDetectCollisionFunc(terrainShape.getType(),queryShapes[shapeId].getType());
+	PfxTransform3 identity = PfxTransform3::identity();
+
+	PfxUInt64 ticks = pfxGetPerfTicks();
+	for(int r=0;r<numRepeats;r++) {
+		for(int i=0;i<numQueries;i++) {
+			PfxContactCache contacts;
+			func(contacts,
+				terrainShape,identity,identity,0,
+				queryShapes[shapeId],identity,queryTransforms[i],0,
+				0.0f);
+			counts[i] = contacts.getNumContacts();
+		}
+	}
+	ticks = pfxGetPerfTicks() - ticks;
+
+	return (double)ticks * 1.0e9 / pfxGetPerfTicksPerSecond() / ((double)numQueries * numRepeats);
+}
+
+static double runRays(const PfxShape &terrainShape,int numQueries,int numRepeats,PfxRayOutput *outputs)
+{
+	PfxIntersectRayFunc func = pfxGetIntersectRayFunc(terrainShape.getType());
+	PfxTransform3 identity = PfxTransform3::identity();
+
+	PfxUInt64 ticks = pfxGetPerfTicks();
+	for(int r=0;r<numRepeats;r++) {
+		for(int i=0;i<numQueries;i++) {
+			outputs[i].m_variable = 1.0f;
+			outputs[i].m_contactFlag = false;
+			func(rayInputs[i],outputs[i],terrainShape,identity);
+		}
+	}
+	ticks = pfxGetPerfTicks() - ticks;
+
+	return (double)ticks * 1.0e9 / pfxGetPerfTicksPerSecond() / ((double)numQueries * numRepeats);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+
+int main(int argc,char **argv)
+{
+	int gridSize = argc > 1 ? atoi(argv[1]) : 256;
+	int numQueries = argc > 2 ? atoi(argv[2]) : 4096;
+	int numRepeats = argc > 3 ? atoi(argv[3]) : 10;
+	int numThreads = argc > 4 ? atoi(argv[4]) : 4;
+
+	gridSize = SCE_PFX_CLAMP(gridSize,2,MAX_GRID);
+	numQueries = SCE_PFX_CLAMP(numQueries,1,MAX_QUERIES);
+	numRepeats = SCE_PFX_MAX(numRepeats,1);
+	numThreads = SCE_PFX_CLAMP(numThreads,1,MAX_THREADS);
+
+	PfxTaskManager *taskManager = NULL;
+	if(numThreads > 1) {
+#ifdef _WIN32
+		SCE_PFX_PRINTF("multiple threads are not supported on this platform\n");
+#else
+		if(pfxGetWorkBytesOfTaskManagerPthreads(numThreads,numThreads) > TASK_MANAGER_BYTES) {
+			SCE_PFX_PRINTF("task manager buffer is too small\n");
+			return 1;
+		}
+		taskManager = pfxCreateTaskManagerPthreads(numThreads,numThreads,taskManagerBuff,TASK_MANAGER_BYTES);
+		if(!taskManager) {
+			SCE_PFX_PRINTF("pfxCreateTaskManagerPthreads failed\n");
+			return 1;
+		}
+		taskManager->initialize();
+#endif
+	}
+
+	bool created = createLandscape(gridSize,taskManager);
+
+	if(taskManager) {
+		taskManager->finalize();
+		delete taskManager;
+	}
+
+	if(!created) {
+		return 1;
+	}
+	createQueries(gridSize,numQueries);
+
+	SCE_PFX_PRINTF("landscape %dx%d, %d triangles, %d islands, %d bvh nodes\n",
+		gridSize,gridSize,gridSize*gridSize*2,largeMesh.m_numIslands,largeMesh.m_numBvhNodes);
+	SCE_PFX_PRINTF("%d queries, %d repeats\n",numQueries,numRepeats);
+	SCE_PFX_PRINTF("%-10s %14s %14s %9s\n","query","linear(ns)","bvh(ns)","speedup");
+
+	PfxAabb16 *bvhNodes = largeMesh.m_bvhNodes;
+	int numMismatches = 0;
+
+	for(int s=0;s<NUM_QUERY_SHAPES;s++) {
+		largeMesh.m_bvhNodes = NULL;
+		double linearTime = runContacts(meshShape,s,numQueries,numRepeats,contactCounts[0]);
+		largeMesh.m_bvhNodes = bvhNodes;
+		double bvhTime = runContacts(meshShape,s,numQueries,numRepeats,contactCounts[1]);
+
+		//J 衝突点の削減はアイランドを訪れる順番に依存するので、接触の有無だけを比較する
+		//E The reduction of contact points depends on the order the islands are
+		//E visited in, so only whether the shape touches the mesh is compared
+		for(int i=0;i<numQueries;i++) {
+			if((contactCounts[0][i] > 0) != (contactCounts[1][i] > 0)) numMismatches++;
+		}
+
+		SCE_PFX_PRINTF("%-10s %14.1f %14.1f %8.2fx\n",queryShapeNames[s],linearTime,bvhTime,linearTime / bvhTime);
+	}
+
+	{
+		largeMesh.m_bvhNodes = NULL;
+		double linearTime = runRays(meshShape,numQueries,numRepeats,rayOutputs[0]);
+		largeMesh.m_bvhNodes = bvhNodes;
+		double bvhTime = runRays(meshShape,numQueries,numRepeats,rayOutputs[1]);
+
+		for(int i=0;i<numQueries;i++) {
+			if(rayOutputs[0][i].m_contactFlag != rayOutputs[1][i].m_contactFlag ||
+			   rayOutputs[0][i].m_variable != rayOutputs[1][i].m_variable) numMismatches++;
+		}
+
+		SCE_PFX_PRINTF("%-10s %14.1f %14.1f %8.2fx\n","ray",linearTime,bvhTime,linearTime / bvhTime);
+	}
+
+	if(numMismatches > 0) {
+		SCE_PFX_PRINTF("%d queries differ between the linear scan and the bvh\n",numMismatches);
+	}
+
+	//J 同じ地形をハイトフィールドとして判定し、ラージメッシュ(BVH)と比較する
+	//E Query the same landscape as a height field and compare it with the large mesh (bvh)
+	PfxUInt32 meshBytes = largeMesh.m_numIslands * (sizeof(PfxTriMesh) + sizeof(PfxAabb16)) + largeMesh.m_numBvhNodes * sizeof(PfxAabb16);
+	PfxUInt32 fieldBytes = heightField.m_numX * heightField.m_numZ * sizeof(PfxFloat) + sizeof(PfxHeightField);
+	SCE_PFX_PRINTF("memory: large mesh %u bytes, height field %u bytes (%.1fx)\n",meshBytes,fieldBytes,(double)meshBytes / fieldBytes);
+	SCE_PFX_PRINTF("%-10s %14s %14s %9s\n","query","mesh(ns)","field(ns)","speedup");
+
+	int numFieldMismatches = 0;
+
+	for(int s=0;s<NUM_QUERY_SHAPES;s++) {
+		double meshTime = runContacts(meshShape,s,numQueries,numRepeats,contactCounts[0]);
+		double fieldTime = runContacts(fieldShape,s,numQueries,numRepeats,contactCounts[1]);
+
+		for(int i=0;i<numQueries;i++) {
+			if((contactCounts[0][i] > 0) != (contactCounts[1][i] > 0)) numFieldMismatches++;
+		}
+
+		SCE_PFX_PRINTF("%-10s %14.1f %14.1f %8.2fx\n",queryShapeNames[s],meshTime,fieldTime,meshTime / fieldTime);
+	}
+
+	{
+		double meshTime = runRays(meshShape,numQueries,numRepeats,rayOutputs[0]);
+		double fieldTime = runRays(fieldShape,numQueries,numRepeats,rayOutputs[1]);
+
+		for(int i=0;i<numQueries;i++) {
+			if(rayOutputs[0][i].m_contactFlag != rayOutputs[1][i].m_contactFlag ||
+			   fabsf(rayOutputs[0][i].m_variable - rayOutputs[1][i].m_variable) > 1.0e-5f) numFieldMismatches++;
+		}
+
+		SCE_PFX_PRINTF("%-10s %14.1f %14.1f %8.2fx\n","ray",meshTime,fieldTime,meshTime / fieldTime);
+	}
+
+	if(numFieldMismatches > 0) {
+		SCE_PFX_PRINTF("%d queries differ between the large mesh and the height field\n",numFieldMismatches);
+	}
+
+	pfxReleaseLargeTriMesh(largeMesh);
+
+	return numMismatches + numFieldMismatches > 0 ? 1 : 0;
+}
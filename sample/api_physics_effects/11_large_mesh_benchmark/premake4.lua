@@ -0,0 +1,15 @@
+	project "pe_sample_11_large_mesh_benchmark"
+		
+	kind "ConsoleApp"
+	targetdir "../../../bin"
+	includedirs {"../../../include","../../../src/physics_effects/low_level"}
+		
+	links {
+		"physics_effects_low_level",
+		"physics_effects_base_level",
+		"physics_effects_util"
+	}
+	
+	files {
+		"main.cpp"
+	}
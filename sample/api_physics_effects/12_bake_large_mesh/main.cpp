@@ -0,0 +1,263 @@
+/*
+Physics Effects Copyright(C) 2011 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#include "physics_effects.h"
+#define SAMPLE_GEOMETRY_ONLY
+#include "../0_console/landscape.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+using namespace sce::PhysicsEffects;
+
+//J 三角形メッシュからラージメッシュを作成してファイルにベイクする
+//J ベイクしたファイルをメモリにマップして読み込み、作成したメッシュと同じであることを確認する
+//E Builds a large mesh from a triangle mesh and bakes it to a file. The baked
+//E file is then mapped back and checked against the mesh it was built from.
+//E Without an input file the landscape of App_0_Console is baked.
+//E
+//E usage: App_12_BakeLargeMesh [input.obj|-] [output] [numThreads]
+
+#define MAX_THREADS 16
+
+#define TASK_MANAGER_BYTES (64*1024)
+unsigned char SCE_PFX_ALIGNED(128) taskManagerBuff[TASK_MANAGER_BYTES];
+
+std::vector<PfxFloat> meshVerts;
+std::vector<PfxUInt32> meshIndices;
+
+///////////////////////////////////////////////////////////////////////////////
+// Input
+
+//J Wavefront OBJの頂点と面だけを読み込む。多角形は扇形に三角形分割する
+//E Reads the vertices and faces of a Wavefront OBJ file. Polygons are split into triangle fans
+static bool loadObj(const char *path)
+{
+	FILE *fp = fopen(path,"r");
+	if(!fp) {
+		SCE_PFX_PRINTF("can't open %s\n",path);
+		return false;
+	}
+
+	char line[1024];
+	while(fgets(line,sizeof(line),fp)) {
+		if(line[0] == 'v' && line[1] == ' ') {
+			float x,y,z;
+			if(sscanf(line+2,"%f %f %f",&x,&y,&z) == 3) {
+				meshVerts.push_back(x);
+				meshVerts.push_back(y);
+				meshVerts.push_back(z);
+			}
+		}
+		else if(line[0] == 'f' && line[1] == ' ') {
+			PfxUInt32 polygon[3];
+			int numPolygonVerts = 0;
+			char *str = line + 2;
+			for(;;) {
+				char *end;
+				long idx = strtol(str,&end,10);
+				if(end == str) break;
+				str = end;
+				while(*str && *str != ' ' && *str != '\t') str++; // skip /vt/vn
+
+				//J 負のインデックスは直前の頂点からの相対位置
+				//E Negative indices are relative to the last vertex
+				long numVerts = (long)meshVerts.size() / 3;
+				idx = idx < 0 ? numVerts + idx : idx - 1;
+				if(idx < 0 || idx >= numVerts) {
+					SCE_PFX_PRINTF("invalid face in %s: %s",path,line);
+					fclose(fp);
+					return false;
+				}
+
+				if(numPolygonVerts < 3) {
+					polygon[numPolygonVerts++] = (PfxUInt32)idx;
+				}
+				else {
+					polygon[1] = polygon[2];
+					polygon[2] = (PfxUInt32)idx;
+				}
+				if(numPolygonVerts == 3) {
+					meshIndices.push_back(polygon[0]);
+					meshIndices.push_back(polygon[1]);
+					meshIndices.push_back(polygon[2]);
+				}
+			}
+		}
+	}
+
+	fclose(fp);
+	return !meshIndices.empty();
+}
+
+static void loadLandscape()
+{
+	for(int i=0;i<LargeMeshVtxCount;i++) {
+		meshVerts.push_back(LargeMeshVtx[i*6+0]);
+		meshVerts.push_back(LargeMeshVtx[i*6+1]);
+		meshVerts.push_back(LargeMeshVtx[i*6+2]);
+	}
+	for(int i=0;i<LargeMeshIdxCount;i++) {
+		meshIndices.push_back(LargeMeshIdx[i]);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Verification
+
+static bool isSameAabb(const PfxAabb16 &aabbA,const PfxAabb16 &aabbB,int numElements)
+{
+	for(int i=0;i<numElements;i++) {
+		if(aabbA.get16(i) != aabbB.get16(i)) return false;
+	}
+	return true;
+}
+
+static bool isSameIsland(const PfxTriMesh &islandA,const PfxTriMesh &islandB)
+{
+	if(islandA.m_numVerts != islandB.m_numVerts ||
+	   islandA.m_numEdges != islandB.m_numEdges ||
+	   islandA.m_numFacets != islandB.m_numFacets) return false;
+
+	for(int i=0;i<islandA.m_numVerts;i++) {
+		for(int j=0;j<3;j++) {
+			if(islandA.m_verts[i][j] != islandB.m_verts[i][j]) return false;
+		}
+	}
+
+	if(memcmp(islandA.m_edges,islandB.m_edges,sizeof(PfxEdge)*islandA.m_numEdges) != 0) return false;
+	if(memcmp(islandA.m_facets,islandB.m_facets,sizeof(PfxFacet)*islandA.m_numFacets) != 0) return false;
+
+	for(int j=0;j<3;j++) {
+		if(islandA.m_half[j] != islandB.m_half[j]) return false;
+	}
+
+	return true;
+}
+
+static bool isSameLargeMesh(const PfxLargeTriMesh &meshA,const PfxLargeTriMesh &meshB)
+{
+	if(meshA.m_numIslands != meshB.m_numIslands || meshA.m_numBvhNodes != meshB.m_numBvhNodes) return false;
+
+	for(int j=0;j<3;j++) {
+		if(meshA.m_half[j] != meshB.m_half[j]) return false;
+	}
+
+	for(PfxUInt32 i=0;i<meshA.m_numIslands;i++) {
+		if(!isSameAabb(meshA.m_aabbList[i],meshB.m_aabbList[i],6)) return false;
+		if(!isSameIsland(meshA.m_islands[i],meshB.m_islands[i])) return false;
+	}
+
+	for(PfxUInt32 i=0;i<meshA.m_numBvhNodes;i++) {
+		if(!isSameAabb(meshA.m_bvhNodes[i],meshB.m_bvhNodes[i],8)) return false;
+	}
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+
+int main(int argc,char **argv)
+{
+	const char *input = argc > 1 ? argv[1] : "-";
+	const char *output = argc > 2 ? argv[2] : "landscape.pfxmesh";
+	int numThreads = argc > 3 ? atoi(argv[3]) : 1;
+	numThreads = SCE_PFX_CLAMP(numThreads,1,MAX_THREADS);
+
+	if(strcmp(input,"-") == 0) {
+		loadLandscape();
+	}
+	else if(!loadObj(input)) {
+		return 1;
+	}
+
+	PfxTaskManager *taskManager = NULL;
+	if(numThreads > 1) {
+#ifdef _WIN32
+		SCE_PFX_PRINTF("multiple threads are not supported on this platform\n");
+#else
+		if(pfxGetWorkBytesOfTaskManagerPthreads(numThreads,numThreads) > TASK_MANAGER_BYTES) {
+			SCE_PFX_PRINTF("task manager buffer is too small\n");
+			return 1;
+		}
+		taskManager = pfxCreateTaskManagerPthreads(numThreads,numThreads,taskManagerBuff,TASK_MANAGER_BYTES);
+		if(!taskManager) {
+			SCE_PFX_PRINTF("pfxCreateTaskManagerPthreads failed\n");
+			return 1;
+		}
+		taskManager->initialize();
+#endif
+	}
+
+	PfxCreateLargeTriMeshParam param;
+	param.flag = SCE_PFX_MESH_FLAG_32BIT_INDEX|SCE_PFX_MESH_FLAG_AUTO_ELIMINATION|SCE_PFX_MESH_FLAG_AUTO_THICKNESS;
+	param.verts = &meshVerts[0];
+	param.numVerts = (PfxUInt32)meshVerts.size() / 3;
+	param.triangles = &meshIndices[0];
+	param.numTriangles = (PfxUInt32)meshIndices.size() / 3;
+	param.triangleStrideBytes = sizeof(PfxUInt32)*3;
+
+	PfxLargeTriMesh largeMesh;
+	PfxUInt64 ticks = pfxGetPerfTicks();
+	PfxInt32 ret = taskManager ? pfxCreateLargeTriMesh(largeMesh,param,taskManager) : pfxCreateLargeTriMesh(largeMesh,param);
+	double buildTime = (double)(pfxGetPerfTicks() - ticks) / pfxGetPerfTicksPerSecond();
+
+	if(taskManager) {
+		taskManager->finalize();
+		delete taskManager;
+	}
+
+	if(ret != SCE_PFX_OK) {
+		SCE_PFX_PRINTF("pfxCreateLargeTriMesh failed %d\n",ret);
+		return 1;
+	}
+
+	ret = pfxSaveLargeTriMeshFile(largeMesh,output);
+	if(ret != SCE_PFX_OK) {
+		SCE_PFX_PRINTF("can't write %s\n",output);
+		pfxReleaseLargeTriMesh(largeMesh);
+		return 1;
+	}
+
+	PfxMappedLargeTriMesh mapped;
+	ticks = pfxGetPerfTicks();
+	ret = pfxMapLargeTriMeshFile(mapped,output);
+	double mapTime = (double)(pfxGetPerfTicks() - ticks) / pfxGetPerfTicksPerSecond();
+
+	if(ret != SCE_PFX_OK) {
+		SCE_PFX_PRINTF("can't map %s %d\n",output,ret);
+		pfxReleaseLargeTriMesh(largeMesh);
+		return 1;
+	}
+
+	bool same = isSameLargeMesh(largeMesh,mapped.lmesh);
+
+	SCE_PFX_PRINTF("%s: %d triangles, %d islands, %d bvh nodes, %u bytes\n",
+		output,param.numTriangles,mapped.lmesh.m_numIslands,mapped.lmesh.m_numBvhNodes,mapped.bytes);
+	SCE_PFX_PRINTF("build %.3f ms, map %.3f ms\n",buildTime * 1000.0,mapTime * 1000.0);
+
+	if(!same) {
+		SCE_PFX_PRINTF("the mapped mesh differs from the built mesh\n");
+	}
+
+	pfxUnmapLargeTriMeshFile(mapped);
+	pfxReleaseLargeTriMesh(largeMesh);
+
+	return same ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+	project "pe_sample_12_bake_large_mesh"
+		
+	kind "ConsoleApp"
+	targetdir "../../../bin"
+	includedirs {"../../../include"}
+		
+	links {
+		"physics_effects_low_level",
+		"physics_effects_base_level",
+		"physics_effects_util"
+	}
+	
+	files {
+		"main.cpp"
+	}
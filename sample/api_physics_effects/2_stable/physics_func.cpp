@@ -252,8 +252,8 @@ void collision()
 	for(PfxUInt32 i=0;i<numCurrentPairs;i++) {
 		PfxConstraintPair &pair = currentPairs[i];
 	
-		PfxUInt16 iA = pfxGetObjectIdA(pair);
-		PfxUInt16 iB = pfxGetObjectIdB(pair);
+		PfxObjectId iA = pfxGetObjectIdA(pair);
+		PfxObjectId iB = pfxGetObjectIdB(pair);
 		PfxUInt32 iConstraint = pfxGetConstraintId(pair);
 
 		PfxContactManifold &contact = contacts[iConstraint];
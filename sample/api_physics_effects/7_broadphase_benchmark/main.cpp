@@ -0,0 +1,443 @@
+/*
+Physics Effects Copyright(C) 2011 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#include "physics_effects.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include <stdlib.h>
+
+using namespace sce::PhysicsEffects;
+
+//J シングル軸SAP、インクリメンタルSAP、動的AABBツリーのブロードフェーズ処理時間を比較する
+//E Compares the broadphase time of the single axis SAP (pfxFindPairs), the
+//E incremental sweep and prune and the dynamic AABB tree on a uniform scene
+//E and on a clustered scene. Each method produces the same pairs, which are
+//E decomposed into new, keep and remove pairs as in the samples.
+//E
+//E usage: App_7_BroadphaseBenchmark [numRigidBodies] [numFrames]
+
+///////////////////////////////////////////////////////////////////////////////
+// Benchmark Data
+
+#define NUM_RIGIDBODIES 16384
+#define NUM_PAIRS       (NUM_RIGIDBODIES*8)
+
+PfxVector3 worldCenter(0.0f);
+PfxVector3 worldExtent(500.0f);
+
+PfxRigidState states[NUM_RIGIDBODIES];
+PfxCollidable collidables[NUM_RIGIDBODIES];
+PfxVector3 basePositions[NUM_RIGIDBODIES];
+int numRigidBodies = 0;
+
+PfxBroadphaseProxy proxies[NUM_RIGIDBODIES];
+
+unsigned int pairSwap;
+unsigned int numPairs[2];
+PfxBroadphasePair pairsBuff[2][NUM_PAIRS];
+
+#define POOL_BYTES (64*1024*1024)
+unsigned char SCE_PFX_ALIGNED(128) poolBuff[POOL_BYTES];
+
+PfxHeapManager pool(poolBuff,POOL_BYTES);
+
+#define SAP_BYTES (4*1024*1024)
+unsigned char SCE_PFX_ALIGNED(128) sapBuff[SAP_BYTES];
+PfxSweepAndPrune *sap = NULL;
+
+#define TREE_BYTES (4*1024*1024)
+unsigned char SCE_PFX_ALIGNED(128) treeBuff[TREE_BYTES];
+PfxDynamicTree *tree = NULL;
+
+static double getTimeMs()
+{
+#ifdef _WIN32
+	LARGE_INTEGER count,freq;
+	QueryPerformanceCounter(&count);
+	QueryPerformanceFrequency(&freq);
+	return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC,&t);
+	return (double)t.tv_sec * 1000.0 + (double)t.tv_nsec * 0.000001;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Scenes
+
+enum {
+	SCENE_UNIFORM = 0,
+	SCENE_CLUSTERED,
+	SCENE_COUNT,
+};
+
+const char *sceneNames[SCENE_COUNT] = {
+	"uniform",
+	"clustered",
+};
+
+//J 一様分布：立方体の領域にランダムに配置
+//J 密集：直交する3本の通路が原点で交わる。どの軸を選んでも2本の通路の剛体がその軸上で重なる
+//E Uniform : bodies are scattered randomly in a cube.
+//E Clustered : three perpendicular corridors cross at the origin. Whichever
+//E axis is chosen for the sweep, the bodies of two corridors overlap on it.
+void createScene(int sceneId,int n)
+{
+	srand(1234);
+
+	PfxShape shape;
+	shape.reset();
+	shape.setBox(PfxBox(0.5f,0.5f,0.5f));
+
+	const int corridorWidth = 3;
+	int corridorLength = (n / 3 + corridorWidth * corridorWidth - 1) / (corridorWidth * corridorWidth);
+
+	for(int i=0;i<n;i++) {
+		PfxVector3 pos(0.0f);
+		if(sceneId == SCENE_UNIFORM) {
+			PfxFloat side = 2.0f * powf((PfxFloat)n,1.0f/3.0f);
+			pos = PfxVector3(
+				side * ((PfxFloat)rand()/RAND_MAX - 0.5f),
+				side * ((PfxFloat)rand()/RAND_MAX - 0.5f),
+				side * ((PfxFloat)rand()/RAND_MAX - 0.5f));
+		}
+		else {
+			int corridor = i % 3;
+			int j = i / 3;
+			int along = j / (corridorWidth * corridorWidth);
+			int across = j % (corridorWidth * corridorWidth);
+			pos[corridor] = (along - corridorLength / 2) * 1.05f;
+			pos[(corridor+1)%3] = (across % corridorWidth - corridorWidth / 2) * 1.05f;
+			pos[(corridor+2)%3] = (across / corridorWidth - corridorWidth / 2) * 1.05f;
+		}
+
+		states[i].reset();
+		states[i].setRigidBodyId(i);
+		states[i].setMotionType(i % 16 == 0 ? kPfxMotionTypeFixed : kPfxMotionTypeActive);
+		states[i].setPosition(pos);
+		basePositions[i] = pos;
+
+		collidables[i].reset();
+		collidables[i].addShape(shape);
+		collidables[i].finish();
+	}
+
+	numRigidBodies = n;
+}
+
+//J 動的な剛体を元の位置の周りで揺らす
+//E Sway the dynamic bodies around their initial positions
+void moveBodies(int frame)
+{
+	for(int i=0;i<numRigidBodies;i++) {
+		if(states[i].getMotionType() == kPfxMotionTypeFixed) continue;
+		PfxFloat t = frame * 0.05f + i;
+		states[i].setPosition(basePositions[i] + PfxVector3(0.3f * sinf(t),0.02f * sinf(t * 1.3f),0.3f * cosf(t * 0.7f)));
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Broadphase
+
+//J 新規ペアと維持ペアを合成して次のフレームの前回ペアとする
+//E Merge new and keep pairs as the previous pairs of the next frame
+static void storePairs(
+	PfxBroadphasePair *outNewPairs,PfxUInt32 numOutNewPairs,
+	PfxBroadphasePair *outKeepPairs,PfxUInt32 numOutKeepPairs)
+{
+	unsigned int &numCurrentPairs = numPairs[pairSwap];
+	PfxBroadphasePair *currentPairs = pairsBuff[pairSwap];
+
+	numCurrentPairs = 0;
+	for(PfxUInt32 i=0;i<numOutKeepPairs;i++) {
+		currentPairs[numCurrentPairs++] = outKeepPairs[i];
+	}
+	for(PfxUInt32 i=0;i<numOutNewPairs;i++) {
+		currentPairs[numCurrentPairs++] = outNewPairs[i];
+	}
+
+	int workBytes = sizeof(PfxBroadphasePair) * numCurrentPairs;
+	void *workBuff = pool.allocate(workBytes);
+	pfxParallelSort(currentPairs,numCurrentPairs,workBuff,workBytes);
+	pool.deallocate(workBuff);
+}
+
+static PfxInt32 decomposePairs(PfxBroadphasePair *pairs,PfxUInt32 numCurrentPairs)
+{
+	unsigned int numPreviousPairs = numPairs[1-pairSwap];
+	PfxBroadphasePair *previousPairs = pairsBuff[1-pairSwap];
+
+	PfxDecomposePairsParam decomposePairsParam;
+	decomposePairsParam.pairBytes = pfxGetPairBytesOfDecomposePairs(numPreviousPairs,numCurrentPairs);
+	decomposePairsParam.pairBuff = pool.allocate(decomposePairsParam.pairBytes);
+	decomposePairsParam.workBytes = pfxGetWorkBytesOfDecomposePairs(numPreviousPairs,numCurrentPairs);
+	decomposePairsParam.workBuff = pool.allocate(decomposePairsParam.workBytes);
+	decomposePairsParam.previousPairs = previousPairs;
+	decomposePairsParam.numPreviousPairs = numPreviousPairs;
+	decomposePairsParam.currentPairs = pairs;
+	decomposePairsParam.numCurrentPairs = numCurrentPairs;
+
+	PfxDecomposePairsResult decomposePairsResult;
+
+	PfxInt32 ret = pfxDecomposePairs(decomposePairsParam,decomposePairsResult);
+
+	pool.deallocate(decomposePairsParam.workBuff);
+
+	if(ret == SCE_PFX_OK) {
+		storePairs(
+			decomposePairsResult.outNewPairs,decomposePairsResult.numOutNewPairs,
+			decomposePairsResult.outKeepPairs,decomposePairsResult.numOutKeepPairs);
+	}
+
+	pool.deallocate(decomposePairsParam.pairBuff);
+
+	return ret;
+}
+
+PfxInt32 broadphaseSingleAxisSap()
+{
+	//J 剛体が最も分散している軸を見つける
+	//E Find the axis along which all rigid bodies are most widely positioned
+	int axis = 0;
+	{
+		PfxVector3 s(0.0f),s2(0.0f);
+		for(int i=0;i<numRigidBodies;i++) {
+			PfxVector3 c = states[i].getPosition();
+			s += c;
+			s2 += mulPerElem(c,c);
+		}
+		PfxVector3 v = s2 - mulPerElem(s,s) / (float)numRigidBodies;
+		if(v[1] > v[0]) axis = 1;
+		if(v[2] > v[axis]) axis = 2;
+	}
+
+	for(int i=0;i<numRigidBodies;i++) {
+		pfxUpdateBroadphaseProxy(proxies[i],states[i],collidables[i],worldCenter,worldExtent,axis);
+	}
+
+	{
+		int workBytes = sizeof(PfxBroadphaseProxy) * numRigidBodies;
+		void *workBuff = pool.allocate(workBytes);
+		pfxParallelSort(proxies,numRigidBodies,workBuff,workBytes);
+		pool.deallocate(workBuff);
+	}
+
+	PfxFindPairsParam findPairsParam;
+	findPairsParam.pairBytes = pfxGetPairBytesOfFindPairs(NUM_PAIRS);
+	findPairsParam.pairBuff = pool.allocate(findPairsParam.pairBytes);
+	findPairsParam.workBytes = pfxGetWorkBytesOfFindPairs(NUM_PAIRS);
+	findPairsParam.workBuff = pool.allocate(findPairsParam.workBytes);
+	findPairsParam.proxies = proxies;
+	findPairsParam.numProxies = numRigidBodies;
+	findPairsParam.maxPairs = NUM_PAIRS;
+	findPairsParam.axis = axis;
+
+	PfxFindPairsResult findPairsResult;
+
+	PfxInt32 ret = pfxFindPairs(findPairsParam,findPairsResult);
+
+	pool.deallocate(findPairsParam.workBuff);
+
+	if(ret == SCE_PFX_OK) {
+		ret = decomposePairs(findPairsResult.pairs,findPairsResult.numPairs);
+	}
+
+	pool.deallocate(findPairsParam.pairBuff);
+
+	return ret;
+}
+
+PfxInt32 broadphaseIncrementalSap()
+{
+	unsigned int numPreviousPairs = numPairs[1-pairSwap];
+	PfxBroadphasePair *previousPairs = pairsBuff[1-pairSwap];
+
+	PfxUpdateSweepAndPruneParam sapParam;
+	sapParam.pairBytes = pfxGetPairBytesOfUpdateSweepAndPrune(numPreviousPairs,NUM_PAIRS);
+	sapParam.pairBuff = pool.allocate(sapParam.pairBytes);
+	sapParam.workBytes = pfxGetWorkBytesOfUpdateSweepAndPrune(NUM_RIGIDBODIES,NUM_PAIRS);
+	sapParam.workBuff = pool.allocate(sapParam.workBytes);
+	sapParam.sap = sap;
+	sapParam.offsetRigidStates = states;
+	sapParam.offsetCollidables = collidables;
+	sapParam.numRigidBodies = numRigidBodies;
+	sapParam.previousPairs = previousPairs;
+	sapParam.numPreviousPairs = numPreviousPairs;
+	sapParam.maxPairs = NUM_PAIRS;
+	sapParam.worldCenter = worldCenter;
+	sapParam.worldExtent = worldExtent;
+
+	PfxUpdateSweepAndPruneResult sapResult;
+
+	PfxInt32 ret = pfxUpdateSweepAndPrune(sapParam,sapResult);
+
+	pool.deallocate(sapParam.workBuff);
+
+	if(ret == SCE_PFX_OK) {
+		storePairs(
+			sapResult.outNewPairs,sapResult.numOutNewPairs,
+			sapResult.outKeepPairs,sapResult.numOutKeepPairs);
+	}
+
+	pool.deallocate(sapParam.pairBuff);
+
+	return ret;
+}
+
+PfxInt32 broadphaseDynamicTree()
+{
+	PfxUpdateDynamicTreeParam updateParam;
+	updateParam.tree = tree;
+	updateParam.offsetRigidStates = states;
+	updateParam.offsetCollidables = collidables;
+	updateParam.numRigidBodies = numRigidBodies;
+	updateParam.worldCenter = worldCenter;
+	updateParam.worldExtent = worldExtent;
+
+	PfxUpdateDynamicTreeResult updateResult;
+
+	PfxInt32 ret = pfxUpdateDynamicTree(updateParam,updateResult);
+	if(ret != SCE_PFX_OK) return ret;
+
+	PfxFindPairsDynamicTreeParam findPairsParam;
+	findPairsParam.pairBytes = pfxGetPairBytesOfFindPairsDynamicTree(NUM_PAIRS);
+	findPairsParam.pairBuff = pool.allocate(findPairsParam.pairBytes);
+	findPairsParam.workBytes = pfxGetWorkBytesOfFindPairsDynamicTree(NUM_RIGIDBODIES,NUM_PAIRS);
+	findPairsParam.workBuff = pool.allocate(findPairsParam.workBytes);
+	findPairsParam.tree = tree;
+	findPairsParam.maxPairs = NUM_PAIRS;
+
+	PfxFindPairsDynamicTreeResult findPairsResult;
+
+	ret = pfxFindPairs(findPairsParam,findPairsResult);
+
+	pool.deallocate(findPairsParam.workBuff);
+
+	if(ret == SCE_PFX_OK) {
+		ret = decomposePairs(findPairsResult.pairs,findPairsResult.numPairs);
+	}
+
+	pool.deallocate(findPairsParam.pairBuff);
+
+	return ret;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+
+enum {
+	METHOD_SINGLE_AXIS_SAP = 0,
+	METHOD_INCREMENTAL_SAP,
+	METHOD_DYNAMIC_TREE,
+	METHOD_COUNT,
+};
+
+const char *methodNames[METHOD_COUNT] = {
+	"single axis sap",
+	"incremental sap",
+	"dynamic tree",
+};
+
+PfxInt32 (*broadphaseFuncs[METHOD_COUNT])() = {
+	broadphaseSingleAxisSap,
+	broadphaseIncrementalSap,
+	broadphaseDynamicTree,
+};
+
+int main(int argc,char **argv)
+{
+	int n = argc > 1 ? atoi(argv[1]) : 8192;
+	int numFrames = argc > 2 ? atoi(argv[2]) : 200;
+
+	n = SCE_PFX_CLAMP(n,1,NUM_RIGIDBODIES);
+
+	{
+		PfxCreateSweepAndPruneParam param;
+		param.sapBuff = sapBuff;
+		param.sapBytes = SAP_BYTES;
+		param.maxRigidBodies = NUM_RIGIDBODIES;
+
+		PfxCreateSweepAndPruneResult result;
+		if(pfxCreateSweepAndPrune(param,result) != SCE_PFX_OK) {
+			SCE_PFX_PRINTF("pfxCreateSweepAndPrune failed\n");
+			return 1;
+		}
+		sap = result.sap;
+	}
+
+	{
+		PfxCreateDynamicTreeParam param;
+		param.treeBuff = treeBuff;
+		param.treeBytes = TREE_BYTES;
+		param.maxRigidBodies = NUM_RIGIDBODIES;
+
+		PfxCreateDynamicTreeResult result;
+		if(pfxCreateDynamicTree(param,result) != SCE_PFX_OK) {
+			SCE_PFX_PRINTF("pfxCreateDynamicTree failed\n");
+			return 1;
+		}
+		tree = result.tree;
+	}
+
+	SCE_PFX_PRINTF("%d rigid bodies, %d frames\n",n,numFrames);
+	SCE_PFX_PRINTF("%-10s %-16s %10s %10s %10s\n","scene","method","avg(ms)","max(ms)","pairs");
+
+	for(int sceneId=0;sceneId<SCENE_COUNT;sceneId++) {
+		for(int method=0;method<METHOD_COUNT;method++) {
+			createScene(sceneId,n);
+
+			pfxResetSweepAndPrune(sap);
+			pfxResetDynamicTree(tree);
+
+			pairSwap = 0;
+			numPairs[0] = numPairs[1] = 0;
+
+			double total = 0.0,worst = 0.0;
+
+			for(int frame=0;frame<numFrames;frame++) {
+				moveBodies(frame);
+
+				pairSwap = 1-pairSwap;
+
+				double t0 = getTimeMs();
+				PfxInt32 ret = broadphaseFuncs[method]();
+				double t1 = getTimeMs();
+
+				if(ret != SCE_PFX_OK) {
+					SCE_PFX_PRINTF("%s failed %d\n",methodNames[method],ret);
+					return 1;
+				}
+
+				//J 最初のフレームは構築を含むので除外する
+				//E The first frame builds the structures and is excluded
+				if(frame > 0) {
+					total += t1 - t0;
+					worst = SCE_PFX_MAX(worst,t1 - t0);
+				}
+			}
+
+			SCE_PFX_PRINTF("%-10s %-16s %10.3f %10.3f %10u\n",sceneNames[sceneId],methodNames[method],
+				total / SCE_PFX_MAX(numFrames-1,1),worst,numPairs[pairSwap]);
+		}
+	}
+
+	return 0;
+}
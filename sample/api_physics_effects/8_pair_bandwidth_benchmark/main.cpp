@@ -0,0 +1,231 @@
+/*
+Physics Effects Copyright(C) 2011 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#include "physics_effects.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include <stdlib.h>
+
+using namespace sce::PhysicsEffects;
+
+//J ペアのサイズがメモリ帯域に与える影響を測定する
+//J SCE_PFX_USE_32BIT_OBJECT_IDの有無でビルドして結果を比較する
+//E Measures how the size of the pair structures affects memory bandwidth.
+//E Build once with and once without SCE_PFX_USE_32BIT_OBJECT_ID
+//E (cmake -DUSE_PFX_32BIT_OBJECT_ID=ON) and compare the results.
+//E
+//E usage: App_8_PairBandwidthBenchmark [numRigidBodies] [numIterations]
+
+///////////////////////////////////////////////////////////////////////////////
+// Benchmark Data
+
+#define MAX_RIGIDBODIES   (1<<17)
+#define PAIRS_PER_BODY    4
+#define MAX_PAIRS         (MAX_RIGIDBODIES*PAIRS_PER_BODY)
+
+PfxBroadphasePair previousPairs[MAX_PAIRS];
+PfxBroadphasePair currentPairs[MAX_PAIRS];
+PfxBroadphasePair sortBuff[MAX_PAIRS];
+
+#define POOL_BYTES (128*1024*1024)
+unsigned char SCE_PFX_ALIGNED(128) poolBuff[POOL_BYTES];
+
+PfxHeapManager pool(poolBuff,POOL_BYTES);
+
+static double getTimeMs()
+{
+#ifdef _WIN32
+	LARGE_INTEGER count,freq;
+	QueryPerformanceCounter(&count);
+	QueryPerformanceFrequency(&freq);
+	return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC,&t);
+	return (double)t.tv_sec * 1000.0 + (double)t.tv_nsec * 0.000001;
+#endif
+}
+
+static unsigned int randomSeed = 1234;
+
+static unsigned int nextRandom()
+{
+	randomSeed = randomSeed * 1664525 + 1013904223;
+	return randomSeed >> 8;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Pairs
+
+//J 各剛体を近傍の剛体とペアにする。changeRateの割合のペアは相手を入れ替える
+//E Pair every body with a few neighbours. A fraction changeRate of the pairs
+//E picks a different partner, which produces new and removed pairs.
+static PfxUInt32 createPairs(PfxBroadphasePair *pairs,PfxUInt32 numRigidBodies,PfxFloat changeRate)
+{
+	PfxUInt32 numPairs = 0;
+	for(PfxUInt32 i=0;i<numRigidBodies;i++) {
+		for(PfxUInt32 j=1;j<=PAIRS_PER_BODY;j++) {
+			PfxUInt32 k = (i + j) % numRigidBodies;
+			if((nextRandom() & 0xffff) < (PfxUInt32)(changeRate * 0x10000)) {
+				k = (i + PAIRS_PER_BODY + 1 + nextRandom() % 64) % numRigidBodies;
+			}
+			if(k == i) continue;
+
+			PfxBroadphasePair &pair = pairs[numPairs++];
+			pfxSetObjectIdA(pair,(PfxObjectId)SCE_PFX_MIN(i,k));
+			pfxSetObjectIdB(pair,(PfxObjectId)SCE_PFX_MAX(i,k));
+			pfxSetMotionMaskA(pair,kPfxMotionTypeActive);
+			pfxSetMotionMaskB(pair,kPfxMotionTypeActive);
+			pfxSetBroadphaseFlag(pair,0);
+			pfxSetActive(pair,true);
+			pfxSetContactId(pair,numPairs);
+			pfxSetKey(pair,pfxCreateUniqueKey(i,k));
+		}
+	}
+
+	//J 重複ペアを取り除く
+	//E Remove duplicated pairs
+	pfxSort(pairs,sortBuff,numPairs);
+
+	PfxUInt32 numUniquePairs = 0;
+	for(PfxUInt32 i=0;i<numPairs;i++) {
+		if(numUniquePairs == 0 || pfxGetKey(pairs[numUniquePairs-1]) != pfxGetKey(pairs[i])) {
+			pairs[numUniquePairs++] = pairs[i];
+		}
+	}
+
+	return numUniquePairs;
+}
+
+//J ペアを先頭から順に読む。ソルバーがペアを辿るときのアクセスパターン
+//E Stream through the pairs in order, as the solver does when it walks them
+static PfxUInt32 streamPairs(const PfxBroadphasePair *pairs,PfxUInt32 numPairs)
+{
+	PfxUInt32 sum = 0;
+	for(PfxUInt32 i=0;i<numPairs;i++) {
+		const PfxBroadphasePair &pair = pairs[i];
+		if(pfxGetActive(pair)) {
+			sum += pfxGetObjectIdA(pair) ^ pfxGetObjectIdB(pair) ^ pfxGetContactId(pair);
+		}
+	}
+	return sum;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+
+static void printResult(const char *name,double ms,double bytes)
+{
+	SCE_PFX_PRINTF("  %-16s %8.3f ms  %9.1f MB/s\n",name,ms,bytes / (ms * 1000.0));
+}
+
+int main(int argc,char **argv)
+{
+	int n = argc > 1 ? atoi(argv[1]) : 65536;
+	int numIterations = argc > 2 ? atoi(argv[2]) : 20;
+
+	n = SCE_PFX_CLAMP(n,2,SCE_PFX_MIN(MAX_RIGIDBODIES,SCE_PFX_MAX_OBJECT_IDS));
+	numIterations = SCE_PFX_MAX(numIterations,1);
+
+#ifdef SCE_PFX_USE_32BIT_OBJECT_ID
+	SCE_PFX_PRINTF("32 bit object ids, 64 bit pair keys\n");
+#else
+	SCE_PFX_PRINTF("16 bit object ids, 32 bit pair keys\n");
+#endif
+	SCE_PFX_PRINTF("sizeof(PfxBroadphasePair)  %4u\n",(PfxUInt32)sizeof(PfxBroadphasePair));
+	SCE_PFX_PRINTF("sizeof(PfxConstraintPair)  %4u\n",(PfxUInt32)sizeof(PfxConstraintPair));
+	SCE_PFX_PRINTF("sizeof(PfxBroadphaseProxy) %4u\n",(PfxUInt32)sizeof(PfxBroadphaseProxy));
+	SCE_PFX_PRINTF("sizeof(PfxRigidState)      %4u\n",(PfxUInt32)sizeof(PfxRigidState));
+	SCE_PFX_PRINTF("sizeof(PfxContactManifold) %4u\n",(PfxUInt32)sizeof(PfxContactManifold));
+	SCE_PFX_PRINTF("sizeof(PfxJoint)           %4u\n",(PfxUInt32)sizeof(PfxJoint));
+
+	PfxUInt32 numPreviousPairs = createPairs(previousPairs,n,0.0f);
+	PfxUInt32 numCurrentPairs = createPairs(currentPairs,n,0.05f);
+
+	SCE_PFX_PRINTF("%d rigid bodies, %u pairs, %u KB of pairs, %d iterations\n",
+		n,numCurrentPairs,(PfxUInt32)(sizeof(PfxBroadphasePair)*numCurrentPairs/1024),numIterations);
+
+	double sortTime = 0.0;
+	double decomposeTime = 0.0;
+	double streamTime = 0.0;
+	PfxUInt32 checkSum = 0;
+
+	for(int it=0;it<numIterations;it++) {
+		//J ソート済みのペアを逆順にしてからソートする
+		//E Reverse the sorted pairs so that every iteration sorts the same input
+		for(PfxUInt32 i=0;i<numCurrentPairs/2;i++) {
+			PfxBroadphasePair tmp = currentPairs[i];
+			currentPairs[i] = currentPairs[numCurrentPairs-1-i];
+			currentPairs[numCurrentPairs-1-i] = tmp;
+		}
+
+		double t0 = getTimeMs();
+		pfxSort(currentPairs,sortBuff,numCurrentPairs);
+		double t1 = getTimeMs();
+
+		PfxDecomposePairsParam param;
+		param.pairBytes = pfxGetPairBytesOfDecomposePairs(numPreviousPairs,numCurrentPairs);
+		param.pairBuff = pool.allocate(param.pairBytes);
+		param.workBytes = pfxGetWorkBytesOfDecomposePairs(numPreviousPairs,numCurrentPairs);
+		param.workBuff = pool.allocate(param.workBytes);
+		param.previousPairs = previousPairs;
+		param.numPreviousPairs = numPreviousPairs;
+		param.currentPairs = currentPairs;
+		param.numCurrentPairs = numCurrentPairs;
+
+		PfxDecomposePairsResult result;
+
+		double t2 = getTimeMs();
+		PfxInt32 ret = pfxDecomposePairs(param,result);
+		double t3 = getTimeMs();
+
+		pool.deallocate(param.workBuff);
+		pool.deallocate(param.pairBuff);
+
+		if(ret != SCE_PFX_OK) {
+			SCE_PFX_PRINTF("pfxDecomposePairs failed %x\n",ret);
+			return 1;
+		}
+
+		double t4 = getTimeMs();
+		checkSum += streamPairs(currentPairs,numCurrentPairs);
+		double t5 = getTimeMs();
+
+		sortTime += t1 - t0;
+		decomposeTime += t3 - t2;
+		streamTime += t5 - t4;
+	}
+
+	PfxUInt32 pairBytes = (PfxUInt32)sizeof(PfxBroadphasePair) * numCurrentPairs;
+
+	//J 各処理で読み書きするペアのバイト数から帯域を求める
+	//E Bandwidth is computed from the pair bytes each pass touches.
+	//E The merge sort reads and writes every pair once per level.
+	PfxUInt32 numLevels = 0;
+	while((1u<<numLevels) < numCurrentPairs) numLevels++;
+
+	SCE_PFX_PRINTF("average per iteration (checksum %x)\n",checkSum);
+	printResult("pfxSort",sortTime / numIterations,(double)pairBytes * 2 * numLevels);
+	printResult("pfxDecomposePairs",decomposeTime / numIterations,
+		(PfxUInt32)sizeof(PfxBroadphasePair) * (numPreviousPairs + numCurrentPairs * 2));
+	printResult("stream",streamTime / numIterations,pairBytes);
+
+	return 0;
+}
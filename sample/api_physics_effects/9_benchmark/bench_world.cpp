@@ -0,0 +1,1016 @@
+/*
+Physics Effects Copyright(C) 2011 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#include "bench_world.h"
+
+const char *stageNames[STAGE_COUNT] = {
+	"broadphase",
+	"pair_cache",
+	"collision",
+	"island",
+	"solver",
+	"sleep",
+	"integrate",
+	"raycast",
+	"total",
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Simulation Data
+
+const float timeStep = 0.016f;
+const float separateBias = 0.1f;
+int iteration = 5;
+
+//J ワールドサイズ
+//E World size
+PfxVector3 worldCenter(0.0f);
+PfxVector3 worldExtent(500.0f);
+
+//J 剛体
+//E Rigid body
+PfxRigidState states[MAX_RIGIDBODIES];
+PfxRigidBody  bodies[MAX_RIGIDBODIES];
+PfxCollidable collidables[MAX_RIGIDBODIES];
+PfxSolverBody solverBodies[MAX_RIGIDBODIES];
+int numRigidBodies = 0;
+
+//J プロキシ。レイキャストと共用するため全ての軸について作成する
+//E Proxies, created for all axes to share them with ray casting
+PfxBroadphaseProxy proxies[6][MAX_RIGIDBODIES];
+
+//J ジョイント
+//E Joint
+PfxConstraintPair jointPairs[MAX_JOINTS];
+PfxJoint joints[MAX_JOINTS];
+int numJoints = 0;
+
+//J ペアとコンタクト
+//E Pairs and contacts
+unsigned char *pairCacheBuff = NULL;
+PfxPairCache *pairCache = NULL;
+
+//J シミュレーションアイランド
+//E Island generation
+PfxIsland *island = NULL;
+PfxUInt8 SCE_PFX_ALIGNED(16) islandBuff[32*MAX_RIGIDBODIES]; // Island buffer should be 32 * the number of rigid bodies.
+
+//J スリープ制御
+//E Sleep control
+const PfxUInt32 sleepCount = 60;
+const PfxFloat sleepVelocity = 0.1f;
+
+//J レイ
+//E Ray
+PfxRayInput SCE_PFX_ALIGNED(128) rayInputs[MAX_RAYS];
+PfxRayOutput SCE_PFX_ALIGNED(128) rayOutputs[MAX_RAYS];
+int numRays = 0;
+
+//J 一時バッファ
+//E Temporary buffers
+#define POOL_BYTES (64*1024*1024)
+unsigned char SCE_PFX_ALIGNED(128) poolBuff[POOL_BYTES];
+
+//J 一時バッファ用スタックアロケータ
+//E Stack allocator for temporary buffers
+PfxHeapManager pool(poolBuff,POOL_BYTES);
+
+//J タスクマネージャ。numThreadsが1の場合は使用しない
+//E Task manager, not used when numThreads is 1
+#define TASK_MANAGER_BYTES (64*1024)
+unsigned char SCE_PFX_ALIGNED(128) taskManagerBuff[TASK_MANAGER_BYTES];
+PfxTaskManager *taskManager = NULL;
+int numThreads = 1;
+
+//J シーンが使用する形状
+//E Shapes used by the scenes
+#define SAMPLE_GEOMETRY_ONLY
+#include "../0_console/landscape.h"
+#include "../0_console/barrel.h"
+PfxLargeTriMesh gLargeMesh;
+PfxConvexMesh gConvex;
+bool gConvexCreated = false;
+float gLandscapeVtx[LargeMeshVtxCount*6];
+
+//J 複合形状の剛体が使用する形状とBVH
+//E Shapes and BVHs of the compound rigid bodies
+#define MAX_COMPOUNDS 2048
+#define COMPOUND_SHAPES 13
+PfxShape compoundShapes[MAX_COMPOUNDS*(COMPOUND_SHAPES-1)];
+PfxUInt16 compoundShapeIds[MAX_COMPOUNDS*(COMPOUND_SHAPES-1)];
+PfxAabb16 compoundBvhNodes[MAX_COMPOUNDS*SCE_PFX_COLLIDABLE_BVH_NODES(COMPOUND_SHAPES)];
+int numCompounds = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+// Simulation Function
+
+static PfxTaskManager *currentTaskManager()
+{
+	return numThreads > 1 ? taskManager : NULL;
+}
+
+static PfxUInt32 currentMaxTasks()
+{
+	return numThreads > 1 ? (PfxUInt32)numThreads : 1;
+}
+
+static bool broadphase(int &axis)
+{
+	//J 剛体が最も分散している軸を見つける
+	//E Find the axis along which all rigid bodies are most widely positioned
+	axis = 0;
+	{
+		PfxVector3 s(0.0f),s2(0.0f);
+		for(int i=0;i<numRigidBodies;i++) {
+			PfxVector3 c = states[i].getPosition();
+			s += c;
+			s2 += mulPerElem(c,c);
+		}
+		PfxVector3 v = s2 - mulPerElem(s,s) / (float)numRigidBodies;
+		if(v[1] > v[0]) axis = 1;
+		if(v[2] > v[axis]) axis = 2;
+	}
+
+	//J ブロードフェーズプロキシの更新
+	//E Create broadpahse proxies
+	{
+		PfxUpdateBroadphaseProxiesParam param;
+		param.workBytes = pfxGetWorkBytesOfUpdateBroadphaseProxies(numRigidBodies,currentMaxTasks());
+		param.workBuff = pool.allocate(param.workBytes,128);
+		param.numRigidBodies = numRigidBodies;
+		param.offsetRigidStates = states;
+		param.offsetCollidables = collidables;
+		param.proxiesX = proxies[0];
+		param.proxiesY = proxies[1];
+		param.proxiesZ = proxies[2];
+		param.proxiesXb = proxies[3];
+		param.proxiesYb = proxies[4];
+		param.proxiesZb = proxies[5];
+		param.worldCenter = worldCenter;
+		param.worldExtent = worldExtent;
+
+		PfxUpdateBroadphaseProxiesResult result;
+
+		int ret = currentTaskManager() ?
+			pfxUpdateBroadphaseProxies(param,result,currentTaskManager()) :
+			pfxUpdateBroadphaseProxies(param,result);
+
+		pool.deallocate(param.workBuff);
+
+		if(ret != SCE_PFX_OK) {
+			SCE_PFX_PRINTF("pfxUpdateBroadphaseProxies failed %d\n",ret);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool findPairsAndUpdateCache(int axis)
+{
+	PfxFindPairsParam findPairsParam;
+	findPairsParam.pairBytes = pfxGetPairBytesOfFindPairs(MAX_CONTACTS);
+	findPairsParam.pairBuff = pool.allocate(findPairsParam.pairBytes);
+	findPairsParam.workBytes = pfxGetWorkBytesOfFindPairs(MAX_CONTACTS,currentMaxTasks());
+	findPairsParam.workBuff = pool.allocate(findPairsParam.workBytes);
+	findPairsParam.proxies = proxies[axis];
+	findPairsParam.numProxies = numRigidBodies;
+	findPairsParam.maxPairs = MAX_CONTACTS;
+	findPairsParam.axis = axis;
+
+	PfxFindPairsResult findPairsResult;
+
+	int ret = currentTaskManager() ?
+		pfxFindPairs(findPairsParam,findPairsResult,currentTaskManager()) :
+		pfxFindPairs(findPairsParam,findPairsResult);
+
+	pool.deallocate(findPairsParam.workBuff);
+
+	if(ret != SCE_PFX_OK) {
+		SCE_PFX_PRINTF("pfxFindPairs failed %d\n",ret);
+		pool.deallocate(findPairsParam.pairBuff);
+		return false;
+	}
+
+	//J 前フレームのペアと合成し、マニフォールドを割り当てる
+	//E Merge with the previous pairs and assign manifolds
+	PfxUpdatePairCacheParam param;
+	param.cache = pairCache;
+	param.currentPairs = findPairsResult.pairs;
+	param.numCurrentPairs = findPairsResult.numPairs;
+
+	PfxUpdatePairCacheResult result;
+
+	ret = pfxUpdatePairCache(param,result);
+
+	pool.deallocate(findPairsParam.pairBuff);
+
+	if(ret != SCE_PFX_OK) {
+		SCE_PFX_PRINTF("pfxUpdatePairCache failed %d\n",ret);
+		return false;
+	}
+
+	//J 廃棄ペアの剛体を起こす。新規ペアはアイランドを通じて起こされる
+	//E Wake up the rigid bodies of removed pairs. New pairs wake up through their island
+	for(PfxUInt32 i=0;i<result.numOutRemovePairs;i++) {
+		PfxRigidState &stateA = states[pfxGetObjectIdA(result.outRemovePairs[i])];
+		PfxRigidState &stateB = states[pfxGetObjectIdB(result.outRemovePairs[i])];
+		if(stateA.isAsleep()) stateA.wakeup();
+		if(stateB.isAsleep()) stateB.wakeup();
+	}
+
+	return true;
+}
+
+static bool collision()
+{
+	unsigned int numCurrentPairs = pfxGetNumPairsOfPairCache(pairCache);
+	PfxBroadphasePair *currentPairs = pfxGetPairsOfPairCache(pairCache);
+	PfxContactManifold *contacts = pfxGetContactsOfPairCache(pairCache);
+
+	//J 衝突検出
+	//E Detect collisions
+	{
+		PfxDetectCollisionParam param;
+		param.contactPairs = currentPairs;
+		param.numContactPairs = numCurrentPairs;
+		param.offsetContactManifolds = contacts;
+		param.offsetRigidStates = states;
+		param.offsetCollidables = collidables;
+		param.numRigidBodies = numRigidBodies;
+
+		int ret = currentTaskManager() ? pfxDetectCollision(param,currentTaskManager()) : pfxDetectCollision(param);
+		if(ret != SCE_PFX_OK) {
+			SCE_PFX_PRINTF("pfxDetectCollision failed %d\n",ret);
+			return false;
+		}
+	}
+
+	//J リフレッシュ
+	//E Refresh contacts
+	{
+		PfxRefreshContactsParam param;
+		param.contactPairs = currentPairs;
+		param.numContactPairs = numCurrentPairs;
+		param.offsetContactManifolds = contacts;
+		param.offsetRigidStates = states;
+		param.numRigidBodies = numRigidBodies;
+
+		int ret = currentTaskManager() ? pfxRefreshContacts(param,currentTaskManager()) : pfxRefreshContacts(param);
+		if(ret != SCE_PFX_OK) {
+			SCE_PFX_PRINTF("pfxRefreshContacts failed %d\n",ret);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool generateIslands()
+{
+	PfxGenerateIslandParam param;
+	param.islandBuff = islandBuff;
+	param.islandBytes = sizeof(islandBuff);
+	param.pairs = pfxGetPairsOfPairCache(pairCache);
+	param.numPairs = pfxGetNumPairsOfPairCache(pairCache);
+	param.numObjects = numRigidBodies;
+
+	PfxGenerateIslandResult result;
+
+	int ret = pfxGenerateIsland(param,result);
+	if(ret != SCE_PFX_OK) {
+		SCE_PFX_PRINTF("pfxGenerateIsland failed %d\n",ret);
+		return false;
+	}
+	island = result.island;
+
+	//J ジョイント分のペアを追加
+	//E Add joint pairs to islands
+	ret = pfxAppendPairs(island,jointPairs,numJoints);
+	if(ret != SCE_PFX_OK) {
+		SCE_PFX_PRINTF("pfxAppendPairs failed %d\n",ret);
+		return false;
+	}
+
+	return true;
+}
+
+static bool constraintSolver()
+{
+	unsigned int numCurrentPairs = pfxGetNumPairsOfPairCache(pairCache);
+	PfxBroadphasePair *currentPairs = pfxGetPairsOfPairCache(pairCache);
+	PfxContactManifold *contacts = pfxGetContactsOfPairCache(pairCache);
+
+	{
+		PfxSetupSolverBodiesParam param;
+		param.states = states;
+		param.bodies = bodies;
+		param.solverBodies = solverBodies;
+		param.numRigidBodies = numRigidBodies;
+
+		int ret = currentTaskManager() ? pfxSetupSolverBodies(param,currentTaskManager()) : pfxSetupSolverBodies(param);
+		if(ret != SCE_PFX_OK) {
+			SCE_PFX_PRINTF("pfxSetupSolverBodies failed %d\n",ret);
+			return false;
+		}
+	}
+
+	{
+		PfxSetupContactConstraintsParam param;
+		param.contactPairs = currentPairs;
+		param.numContactPairs = numCurrentPairs;
+		param.offsetContactManifolds = contacts;
+		param.offsetRigidStates = states;
+		param.offsetRigidBodies = bodies;
+		param.offsetSolverBodies = solverBodies;
+		param.numRigidBodies = numRigidBodies;
+		param.timeStep = timeStep;
+		param.separateBias = separateBias;
+
+		int ret = currentTaskManager() ? pfxSetupContactConstraints(param,currentTaskManager()) : pfxSetupContactConstraints(param);
+		if(ret != SCE_PFX_OK) {
+			SCE_PFX_PRINTF("pfxSetupContactConstraints failed %d\n",ret);
+			return false;
+		}
+	}
+
+	{
+		PfxSetupJointConstraintsParam param;
+		param.jointPairs = jointPairs;
+		param.numJointPairs = numJoints;
+		param.offsetJoints = joints;
+		param.offsetRigidStates = states;
+		param.offsetRigidBodies = bodies;
+		param.offsetSolverBodies = solverBodies;
+		param.numRigidBodies = numRigidBodies;
+		param.timeStep = timeStep;
+
+		for(int i=0;i<numJoints;i++) {
+			pfxUpdateJointPairs(jointPairs[i],i,joints[i],states[joints[i].m_rigidBodyIdA],states[joints[i].m_rigidBodyIdB]);
+		}
+
+		int ret = currentTaskManager() ? pfxSetupJointConstraints(param,currentTaskManager()) : pfxSetupJointConstraints(param);
+		if(ret != SCE_PFX_OK) {
+			SCE_PFX_PRINTF("pfxSetupJointConstraints failed %d\n",ret);
+			return false;
+		}
+	}
+
+	{
+		PfxSolveConstraintsParam param;
+		param.workBytes = pfxGetWorkBytesOfSolveConstraints(numRigidBodies,numCurrentPairs,numJoints,currentMaxTasks());
+		param.workBuff = pool.allocate(param.workBytes);
+		param.contactPairs = currentPairs;
+		param.numContactPairs = numCurrentPairs;
+		param.offsetContactManifolds = contacts;
+		param.jointPairs = jointPairs;
+		param.numJointPairs = numJoints;
+		param.offsetJoints = joints;
+		param.offsetRigidStates = states;
+		param.offsetSolverBodies = solverBodies;
+		param.numRigidBodies = numRigidBodies;
+		param.iteration = iteration;
+
+		int ret = currentTaskManager() ? pfxSolveConstraints(param,currentTaskManager()) : pfxSolveConstraints(param);
+
+		pool.deallocate(param.workBuff);
+
+		if(ret != SCE_PFX_OK) {
+			SCE_PFX_PRINTF("pfxSolveConstraints failed %d\n",ret);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void sleepOrWakeup()
+{
+	PfxFloat sleepVelSqr = sleepVelocity * sleepVelocity;
+
+	for(PfxUInt32 i=0;i<(PfxUInt32)numRigidBodies;i++) {
+		PfxRigidState &state = states[i];
+		if(SCE_PFX_MOTION_MASK_CAN_SLEEP(state.getMotionType()) && state.getUseSleep()) {
+			PfxFloat linVelSqr = lengthSqr(state.getLinearVelocity());
+			PfxFloat angVelSqr = lengthSqr(state.getAngularVelocity());
+
+			if(state.isAwake()) {
+				if( linVelSqr < sleepVelSqr && angVelSqr < sleepVelSqr ) {
+					state.incrementSleepCount();
+				}
+				else {
+					state.resetSleepCount();
+				}
+			}
+		}
+	}
+
+	if(!island) return;
+
+	for(PfxUInt32 i=0;i<pfxGetNumIslands(island);i++) {
+		int numActive = 0;
+		int numSleep = 0;
+		int numCanSleep = 0;
+
+		PfxIslandUnit *islandUnit = pfxGetFirstUnitInIsland(island,(PfxUInt32)i);
+		for(;islandUnit!=NULL;islandUnit=pfxGetNextUnitInIsland(islandUnit)) {
+			PfxRigidState &state = states[pfxGetUnitId(islandUnit)];
+			if(!(SCE_PFX_MOTION_MASK_CAN_SLEEP(state.getMotionType()))) continue;
+			if(state.isAsleep()) {
+				numSleep++;
+			}
+			else {
+				numActive++;
+				if(state.getUseSleep() && state.getSleepCount() > sleepCount) {
+					numCanSleep++;
+				}
+			}
+		}
+
+		// Deactivate Island
+		if(numCanSleep > 0 && numCanSleep == numActive + numSleep) {
+			islandUnit = pfxGetFirstUnitInIsland(island,(PfxUInt32)i);
+			for(;islandUnit!=NULL;islandUnit=pfxGetNextUnitInIsland(islandUnit)) {
+				if(!(SCE_PFX_MOTION_MASK_CAN_SLEEP(states[pfxGetUnitId(islandUnit)].getMotionType()))) continue;
+				states[pfxGetUnitId(islandUnit)].sleep();
+			}
+		}
+
+		// Activate Island
+		else if(numSleep > 0 && numActive > 0) {
+			islandUnit = pfxGetFirstUnitInIsland(island,(PfxUInt32)i);
+			for(;islandUnit!=NULL;islandUnit=pfxGetNextUnitInIsland(islandUnit)) {
+				if(!(SCE_PFX_MOTION_MASK_CAN_SLEEP(states[pfxGetUnitId(islandUnit)].getMotionType()))) continue;
+				states[pfxGetUnitId(islandUnit)].wakeup();
+			}
+		}
+	}
+}
+
+static bool integrate()
+{
+	PfxUpdateRigidStatesParam param;
+	param.states = states;
+	param.bodies = bodies;
+	param.numRigidBodies = numRigidBodies;
+	param.timeStep = timeStep;
+
+	int ret = currentTaskManager() ? pfxUpdateRigidStates(param,currentTaskManager()) : pfxUpdateRigidStates(param);
+	if(ret != SCE_PFX_OK) {
+		SCE_PFX_PRINTF("pfxUpdateRigidStates failed %d\n",ret);
+		return false;
+	}
+	return true;
+}
+
+static void castRays()
+{
+	if(numRays == 0) return;
+
+	PfxRayCastParam param;
+	param.offsetRigidStates = states;
+	param.offsetCollidables = collidables;
+	param.proxiesX  = proxies[0];
+	param.proxiesY  = proxies[1];
+	param.proxiesZ  = proxies[2];
+	param.proxiesXb = proxies[3];
+	param.proxiesYb = proxies[4];
+	param.proxiesZb = proxies[5];
+	param.numProxies = numRigidBodies;
+	param.rangeCenter = worldCenter;
+	param.rangeExtent = worldExtent;
+
+	if(currentTaskManager()) {
+		pfxCastRays(rayInputs,rayOutputs,numRays,param,currentTaskManager());
+	}
+	else {
+		pfxCastRays(rayInputs,rayOutputs,numRays,param);
+	}
+}
+
+bool bench_simulate(double stageTimes[STAGE_COUNT])
+{
+	double msPerTick = 1000.0 / (double)pfxGetPerfTicksPerSecond();
+	PfxUInt64 ticks[STAGE_COUNT+1];
+	bool ok = true;
+	int axis = 0;
+
+	for(int i=1;i<numRigidBodies;i++) {
+		if(states[i].isAsleep()) continue;
+		pfxApplyExternalForce(states[i],bodies[i],bodies[i].getMass()*PfxVector3(0.0f,-9.8f,0.0f),PfxVector3(0.0f),timeStep);
+	}
+
+	ticks[STAGE_BROADPHASE] = pfxGetPerfTicks();
+	ok = ok && broadphase(axis);
+	ticks[STAGE_PAIR_CACHE] = pfxGetPerfTicks();
+	ok = ok && findPairsAndUpdateCache(axis);
+	ticks[STAGE_COLLISION] = pfxGetPerfTicks();
+	ok = ok && collision();
+	ticks[STAGE_ISLAND] = pfxGetPerfTicks();
+	ok = ok && generateIslands();
+	ticks[STAGE_SOLVER] = pfxGetPerfTicks();
+	ok = ok && constraintSolver();
+	ticks[STAGE_SLEEP] = pfxGetPerfTicks();
+	if(ok) sleepOrWakeup();
+	ticks[STAGE_INTEGRATE] = pfxGetPerfTicks();
+	ok = ok && integrate();
+	ticks[STAGE_RAYCAST] = pfxGetPerfTicks();
+	if(ok) castRays();
+	ticks[STAGE_TOTAL] = pfxGetPerfTicks();
+
+	for(int i=0;i<STAGE_TOTAL;i++) {
+		stageTimes[i] = (double)(ticks[i+1] - ticks[i]) * msPerTick;
+	}
+	stageTimes[STAGE_TOTAL] = (double)(ticks[STAGE_TOTAL] - ticks[STAGE_BROADPHASE]) * msPerTick;
+
+	if(taskManager) taskManager->clearPool();
+
+	return ok;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Create Scene
+
+static unsigned int randomSeed = 1234;
+
+static float nextRandom()
+{
+	randomSeed = randomSeed * 1664525 + 1013904223;
+	return (float)(randomSeed >> 8) / (float)(1 << 24);
+}
+
+static int createBody(const PfxShape &shape,const PfxVector3 &pos,const PfxQuat &rot,PfxFloat mass,const PfxMatrix3 &inertia)
+{
+	SCE_PFX_ASSERT(numRigidBodies < MAX_RIGIDBODIES);
+	int id = numRigidBodies++;
+	collidables[id].reset();
+	collidables[id].addShape(shape);
+	collidables[id].finish();
+	bodies[id].reset();
+	states[id].reset();
+	states[id].setPosition(pos);
+	states[id].setOrientation(rot);
+	states[id].setRigidBodyId(id);
+	if(mass > 0.0f) {
+		bodies[id].setMass(mass);
+		bodies[id].setInertia(inertia);
+		states[id].setMotionType(kPfxMotionTypeActive);
+	}
+	else {
+		states[id].setMotionType(kPfxMotionTypeFixed);
+	}
+	return id;
+}
+
+static int createBox(const PfxVector3 &pos,const PfxQuat &rot,const PfxVector3 &boxSize,PfxFloat mass)
+{
+	PfxShape shape;
+	shape.reset();
+	shape.setBox(PfxBox(boxSize));
+	return createBody(shape,pos,rot,mass,pfxCalcInertiaBox(boxSize,mass));
+}
+
+static int createSphere(const PfxVector3 &pos,PfxFloat radius,PfxFloat mass)
+{
+	PfxShape shape;
+	shape.reset();
+	shape.setSphere(PfxSphere(radius));
+	return createBody(shape,pos,PfxQuat::identity(),mass,pfxCalcInertiaSphere(radius,mass));
+}
+
+static void createGround()
+{
+	createBox(PfxVector3(0.0f,-2.5f,0.0f),PfxQuat::identity(),PfxVector3(150.0f,2.5f,150.0f),0.0f);
+}
+
+//J 立方体の数の合計がnumBodies程度になるピラミッド
+//E A pyramid of about numBodies boxes
+static void createBoxPyramid(int numBodies)
+{
+	createGround();
+
+	int stackSize = 1;
+	while((stackSize+1)*(stackSize+2)*(2*stackSize+3)/6 <= numBodies) stackSize++;
+
+	PfxVector3 boxSize(0.5f);
+	PfxFloat space = 0.0001f;
+	PfxFloat diffX = boxSize[0] * 1.02f;
+	PfxFloat diffY = boxSize[1] * 1.02f;
+	PfxFloat diffZ = boxSize[2] * 1.02f;
+	PfxFloat offsetX = -stackSize * (diffX * 2.0f + space) * 0.5f;
+	PfxFloat offsetZ = -stackSize * (diffZ * 2.0f + space) * 0.5f;
+	PfxVector3 pos(0.0f,boxSize[1],0.0f);
+
+	for(;stackSize>0;stackSize--) {
+		for(int j=0;j<stackSize;j++) {
+			pos[2] = offsetZ + (PfxFloat)j * (diffZ * 2.0f + space);
+			for(int i=0;i<stackSize;i++) {
+				pos[0] = offsetX + (PfxFloat)i * (diffX * 2.0f + space);
+				createBox(pos,PfxQuat::identity(),boxSize,1.0f);
+			}
+		}
+		offsetX += diffX;
+		offsetZ += diffZ;
+		pos[1] += (diffY * 2.0f + space);
+	}
+}
+
+//J 格子状に並べた球を少しずらして落とす
+//E Spheres dropped from a jittered grid
+static void createSpherePile(int numBodies)
+{
+	createGround();
+
+	int width = 1;
+	while(width * width * width < numBodies) width++;
+	width = SCE_PFX_MAX(width,4);
+
+	PfxFloat radius = 0.5f;
+	PfxFloat spacing = 1.2f;
+	PfxFloat offset = -width * spacing * 0.5f;
+
+	for(int n=0;n<numBodies;n++) {
+		int x = n % width;
+		int z = (n / width) % width;
+		int y = n / (width * width);
+		PfxVector3 pos(
+			offset + x * spacing + (nextRandom() - 0.5f) * 0.1f,
+			radius + 0.5f + y * spacing,
+			offset + z * spacing + (nextRandom() - 0.5f) * 0.1f);
+		createSphere(pos,radius,1.0f);
+	}
+}
+
+//J 地形の上に凸メッシュの樽を落とす
+//E Convex barrels dropped onto the landscape
+static void createBarrelsOnLandscape(int numBodies)
+{
+	//J 地形を水平方向に拡大してから作成する
+	//E Scale the landscape horizontally before creating it
+	const PfxFloat landscapeScale = 2.0f;
+	for(int i=0;i<LargeMeshVtxCount;i++) {
+		gLandscapeVtx[i*6+0] = LargeMeshVtx[i*6+0] * landscapeScale;
+		gLandscapeVtx[i*6+1] = LargeMeshVtx[i*6+1];
+		gLandscapeVtx[i*6+2] = LargeMeshVtx[i*6+2] * landscapeScale;
+		gLandscapeVtx[i*6+3] = LargeMeshVtx[i*6+3];
+		gLandscapeVtx[i*6+4] = LargeMeshVtx[i*6+4];
+		gLandscapeVtx[i*6+5] = LargeMeshVtx[i*6+5];
+	}
+
+	if(gLargeMesh.m_numIslands > 0) {
+		pfxReleaseLargeTriMesh(gLargeMesh);
+	}
+
+	{
+		PfxCreateLargeTriMeshParam param;
+		param.verts = gLandscapeVtx;
+		param.numVerts = LargeMeshVtxCount;
+		param.vertexStrideBytes = sizeof(float)*6;
+		param.triangles = LargeMeshIdx;
+		param.numTriangles = LargeMeshIdxCount/3;
+		param.triangleStrideBytes = sizeof(unsigned short)*3;
+
+		if(pfxCreateLargeTriMesh(gLargeMesh,param) != SCE_PFX_OK) {
+			SCE_PFX_PRINTF("Can't create large mesh.\n");
+		}
+
+		PfxShape shape;
+		shape.reset();
+		shape.setLargeTriMesh(&gLargeMesh);
+		createBody(shape,PfxVector3(0.0f,-5.0f,0.0f),PfxQuat::identity(),0.0f,PfxMatrix3::identity());
+	}
+
+	if(!gConvexCreated) {
+		PfxCreateConvexMeshParam param;
+		param.verts = BarrelVtx;
+		param.numVerts = BarrelVtxCount;
+		param.vertexStrideBytes = sizeof(float)*6;
+		param.triangles = BarrelIdx;
+		param.numTriangles = BarrelIdxCount/3;
+		param.triangleStrideBytes = sizeof(unsigned short)*3;
+
+		if(pfxCreateConvexMesh(gConvex,param) != SCE_PFX_OK) {
+			SCE_PFX_PRINTF("Can't create gConvex mesh.\n");
+		}
+		gConvexCreated = true;
+	}
+
+	PfxShape shape;
+	shape.reset();
+	shape.setConvexMesh(&gConvex);
+
+	int width = (int)(40.0f * landscapeScale / 1.5f);
+	PfxFloat spacing = 1.5f;
+	PfxFloat offset = -width * spacing * 0.5f;
+
+	for(int n=0;n<numBodies;n++) {
+		int x = n % width;
+		int z = (n / width) % width;
+		int y = n / (width * width);
+		PfxVector3 pos(offset + x * spacing,2.0f + y * spacing,offset + z * spacing);
+		PfxQuat rot = PfxQuat::rotationY(nextRandom() * SCE_PFX_PI) * PfxQuat::rotationX(nextRandom() * SCE_PFX_PI);
+		createBody(shape,pos,rot,1.0f,pfxCalcInertiaSphere(0.5f,1.0f));
+	}
+}
+
+//J 固定された剛体から水平に伸びる、ボールジョイントでつながれた鎖
+//E Chains of boxes linked by ball joints, starting horizontally from a fixed anchor
+static void createJointChains(int numBodies)
+{
+	createGround();
+
+	const int chainLength = 32;
+	int numChains = SCE_PFX_MAX(numBodies / chainLength,1);
+	int width = 1;
+	while(width * width < numChains) width++;
+
+	PfxVector3 linkSize(0.25f,0.1f,0.1f);
+	PfxFloat spacing = 3.0f;
+	PfxFloat offset = -width * spacing * 0.5f;
+	PfxFloat height = chainLength * linkSize[0] * 2.0f + 2.0f;
+
+	for(int c=0;c<numChains;c++) {
+		PfxVector3 anchorPos(offset + (c % width) * spacing,height,offset + (c / width) * spacing);
+		int prevId = createBox(anchorPos,PfxQuat::identity(),linkSize,0.0f);
+
+		for(int i=0;i<chainLength-1 && numRigidBodies<MAX_RIGIDBODIES;i++) {
+			PfxVector3 pos = anchorPos + PfxVector3((i+1) * linkSize[0] * 2.0f,0.0f,0.0f);
+			int id = createBox(pos,PfxQuat::identity(),linkSize,0.2f);
+
+			PfxBallJointInitParam jparam;
+			jparam.anchorPoint = pos - PfxVector3(linkSize[0],0.0f,0.0f);
+
+			SCE_PFX_ASSERT(numJoints < MAX_JOINTS);
+			pfxInitializeBallJoint(joints[numJoints],states[prevId],states[id],jparam);
+			pfxUpdateJointPairs(jointPairs[numJoints],numJoints,joints[numJoints],states[prevId],states[id]);
+			numJoints++;
+
+			prevId = id;
+		}
+	}
+}
+
+//J 眠った状態の剛体の群れと、その間を転がる少数の球
+//E A crowd of sleeping boxes with a few spheres rolling through it
+static void createSleepingCrowd(int numBodies)
+{
+	createGround();
+
+	int numRollers = SCE_PFX_MAX(numBodies / 64,1);
+	int numBoxes = SCE_PFX_MAX(numBodies - numRollers,1);
+
+	int width = 1;
+	while(width * width < numBoxes) width++;
+
+	PfxVector3 boxSize(0.5f);
+	PfxFloat spacing = 2.5f;
+	PfxFloat offset = -width * spacing * 0.5f;
+
+	for(int n=0;n<numBoxes;n++) {
+		PfxVector3 pos(offset + (n % width) * spacing,boxSize[1],offset + (n / width) * spacing);
+		int id = createBox(pos,PfxQuat::identity(),boxSize,1.0f);
+		states[id].setUseSleep(1);
+		states[id].sleep();
+	}
+
+	for(int n=0;n<numRollers;n++) {
+		PfxVector3 pos(offset - 5.0f,0.5f,offset + (nextRandom() * width) * spacing);
+		int id = createSphere(pos,0.5f,1.0f);
+		states[id].setLinearVelocity(PfxVector3(5.0f + nextRandom() * 5.0f,0.0f,0.0f));
+		states[id].setUseSleep(1);
+	}
+}
+
+//J 球の山に上空から多数のレイを撃つ
+//E A sphere pile under a storm of rays cast from above
+static void createRaycastStorm(int numBodies)
+{
+	createSpherePile(numBodies);
+
+	numRays = SCE_PFX_MIN(numBodies * 4,MAX_RAYS);
+	for(int i=0;i<numRays;i++) {
+		PfxVector3 start((nextRandom() - 0.5f) * 60.0f,30.0f,(nextRandom() - 0.5f) * 60.0f);
+		PfxVector3 target((nextRandom() - 0.5f) * 40.0f,0.0f,(nextRandom() - 0.5f) * 40.0f);
+		rayInputs[i].reset();
+		rayInputs[i].m_startPosition = start;
+		rayInputs[i].m_direction = target - start;
+	}
+}
+
+//J 箱を輪に並べた複合形状の歯車を積み上げ、上空からレイを撃つ
+//J 剛体を作成した後でコリダブルを複合形状で作り直す
+//E A pile of gears, each a compound of boxes around a hub, under rays cast from above.
+//E The collidable is rebuilt as a compound after the rigid body is created
+static void createCompoundPile(int numBodies)
+{
+	createGround();
+
+	numBodies = SCE_PFX_MIN(numBodies,MAX_COMPOUNDS);
+
+	const int numTeeth = COMPOUND_SHAPES - 1;
+	const PfxFloat gearRadius = 1.5f;
+	PfxVector3 hubSize(0.5f,0.5f,0.25f);
+	PfxVector3 toothSize(0.35f,0.15f,0.25f);
+
+	int width = 1;
+	while(width * width * width < numBodies) width++;
+	width = SCE_PFX_MAX(width,4);
+
+	PfxFloat spacing = gearRadius * 2.0f + 0.5f;
+	PfxFloat offset = -width * spacing * 0.5f;
+
+	for(int n=0;n<numBodies;n++) {
+		int id = numRigidBodies;
+		int c = numCompounds++;
+		PfxShape *shapeBase = compoundShapes + c * numTeeth;
+		PfxUInt16 *shapeIds = compoundShapeIds + c * numTeeth;
+		for(int i=0;i<numTeeth;i++) {
+			shapeIds[i] = (PfxUInt16)i;
+		}
+
+		PfxVector3 pos(
+			offset + (n % width) * spacing + (nextRandom() - 0.5f) * 0.5f,
+			gearRadius + 0.5f + (n / (width * width)) * spacing,
+			offset + ((n / width) % width) * spacing);
+		PfxQuat rot = PfxQuat::rotationY(nextRandom() * SCE_PFX_PI) * PfxQuat::rotationZ(nextRandom() * SCE_PFX_PI);
+
+		PfxShape hub;
+		hub.reset();
+		hub.setBox(PfxBox(hubSize));
+		createBody(hub,pos,rot,2.0f,pfxCalcInertiaCylinderZ(hubSize[2],gearRadius,2.0f));
+
+		collidables[id].reset(shapeBase,shapeIds,compoundBvhNodes + c * SCE_PFX_COLLIDABLE_BVH_NODES(COMPOUND_SHAPES),COMPOUND_SHAPES);
+		collidables[id].addShape(hub);
+		for(int i=0;i<numTeeth;i++) {
+			PfxFloat angle = 2.0f * SCE_PFX_PI * i / numTeeth;
+			PfxShape tooth;
+			tooth.reset();
+			tooth.setBox(PfxBox(toothSize));
+			tooth.setOffsetPosition(PfxVector3(cosf(angle),sinf(angle),0.0f) * (gearRadius - toothSize[0]));
+			tooth.setOffsetOrientation(PfxQuat::rotationZ(angle));
+			collidables[id].addShape(tooth);
+		}
+		collidables[id].finish();
+	}
+
+	numRays = SCE_PFX_MIN(numBodies * 4,MAX_RAYS);
+	for(int i=0;i<numRays;i++) {
+		PfxVector3 start((nextRandom() - 0.5f) * width * spacing,40.0f,(nextRandom() - 0.5f) * width * spacing);
+		PfxVector3 target((nextRandom() - 0.5f) * width * spacing,0.0f,(nextRandom() - 0.5f) * width * spacing);
+		rayInputs[i].reset();
+		rayInputs[i].m_startPosition = start;
+		rayInputs[i].m_direction = target - start;
+	}
+}
+
+const char *sceneNames[SCENE_COUNT] = {
+	"box_pyramid",
+	"sphere_pile",
+	"barrels_on_landscape",
+	"joint_chains",
+	"sleeping_crowd",
+	"raycast_storm",
+	"compound_pile",
+};
+
+void bench_create_scene(int sceneId,int numBodies)
+{
+	numRigidBodies = 0;
+	numJoints = 0;
+	numRays = 0;
+	numCompounds = 0;
+	island = NULL;
+	randomSeed = 1234;
+	pfxResetPairCache(pairCache);
+
+	//J 地面などの固定された剛体の分を空けておく
+	//E Leave room for the fixed bodies such as the ground
+	numBodies = SCE_PFX_CLAMP(numBodies,1,MAX_RIGIDBODIES - MAX_RIGIDBODIES / 32 - 2);
+
+	switch(sceneId) {
+		case SCENE_BOX_PYRAMID:          createBoxPyramid(numBodies); break;
+		case SCENE_SPHERE_PILE:          createSpherePile(numBodies); break;
+		case SCENE_BARRELS_ON_LANDSCAPE: createBarrelsOnLandscape(numBodies); break;
+		case SCENE_JOINT_CHAINS:         createJointChains(numBodies); break;
+		case SCENE_SLEEPING_CROWD:       createSleepingCrowd(numBodies); break;
+		case SCENE_RAYCAST_STORM:        createRaycastStorm(numBodies); break;
+		case SCENE_COMPOUND_PILE:        createCompoundPile(numBodies); break;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Initialize / Finalize
+
+bool bench_init(int maxThreads)
+{
+	{
+		PfxCreatePairCacheParam param;
+		param.cacheBytes = pfxGetCacheBytesOfCreatePairCache(MAX_CONTACTS,MAX_CONTACTS);
+		param.cacheBuff = pairCacheBuff = new unsigned char[param.cacheBytes+128];
+		param.maxPairs = MAX_CONTACTS;
+		param.maxContacts = MAX_CONTACTS;
+
+		PfxCreatePairCacheResult result;
+
+		int ret = pfxCreatePairCache(param,result);
+		if(ret != SCE_PFX_OK) {
+			SCE_PFX_PRINTF("pfxCreatePairCache failed %d\n",ret);
+			return false;
+		}
+		pairCache = result.cache;
+	}
+
+	if(maxThreads > 1) {
+#ifdef _WIN32
+		SCE_PFX_PRINTF("multiple threads are not supported on this platform\n");
+		return false;
+#else
+		PfxUInt32 maxTasks = SCE_PFX_MIN(maxThreads,MAX_THREADS);
+		if(pfxGetWorkBytesOfTaskManagerPthreads(maxTasks,maxTasks) > TASK_MANAGER_BYTES) {
+			SCE_PFX_PRINTF("task manager buffer is too small\n");
+			return false;
+		}
+		taskManager = pfxCreateTaskManagerPthreads(maxTasks,maxTasks,taskManagerBuff,TASK_MANAGER_BYTES);
+		if(!taskManager) {
+			SCE_PFX_PRINTF("pfxCreateTaskManagerPthreads failed\n");
+			return false;
+		}
+		taskManager->initialize();
+#endif
+	}
+
+	return true;
+}
+
+void bench_release()
+{
+	if(taskManager) {
+		taskManager->finalize();
+		delete taskManager;
+		taskManager = NULL;
+	}
+
+	if(gLargeMesh.m_numIslands > 0) {
+		pfxReleaseLargeTriMesh(gLargeMesh);
+	}
+
+	delete [] pairCacheBuff;
+	pairCacheBuff = NULL;
+	pairCache = NULL;
+}
+
+bool bench_set_threads(int threads)
+{
+	if(threads > 1) {
+		if(!taskManager) return false;
+		taskManager->setNumTasks(threads);
+		if(taskManager->getNumTasks() != (PfxUInt32)threads) return false;
+	}
+	numThreads = threads;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Get Information
+
+int bench_get_num_rigidbodies()
+{
+	return numRigidBodies;
+}
+
+int bench_get_num_joints()
+{
+	return numJoints;
+}
+
+int bench_get_num_rays()
+{
+	return numRays;
+}
+
+int bench_get_num_pairs()
+{
+	return pfxGetNumPairsOfPairCache(pairCache);
+}
+
+int bench_get_num_sleeping()
+{
+	int n = 0;
+	for(int i=0;i<numRigidBodies;i++) {
+		if(states[i].isAsleep()) n++;
+	}
+	return n;
+}
@@ -0,0 +1,95 @@
+/*
+Physics Effects Copyright(C) 2011 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#ifndef _BENCH_WORLD_H
+#define _BENCH_WORLD_H
+
+#include "physics_effects.h"
+
+using namespace sce::PhysicsEffects;
+
+///////////////////////////////////////////////////////////////////////////////
+// Limits
+
+#define MAX_RIGIDBODIES 16384
+#define MAX_JOINTS      MAX_RIGIDBODIES
+#define MAX_CONTACTS    (MAX_RIGIDBODIES*4)
+#define MAX_RAYS        16384
+#define MAX_THREADS     16
+
+///////////////////////////////////////////////////////////////////////////////
+// Stages
+
+//J 1フレームの処理段階。各段階の時間を個別に計測する
+//E Stages of a frame, each one is timed separately
+enum BenchStage {
+	STAGE_BROADPHASE = 0,
+	STAGE_PAIR_CACHE,
+	STAGE_COLLISION,
+	STAGE_ISLAND,
+	STAGE_SOLVER,
+	STAGE_SLEEP,
+	STAGE_INTEGRATE,
+	STAGE_RAYCAST,
+	STAGE_TOTAL,
+	STAGE_COUNT,
+};
+
+extern const char *stageNames[STAGE_COUNT];
+
+///////////////////////////////////////////////////////////////////////////////
+// Scenes
+
+enum BenchScene {
+	SCENE_BOX_PYRAMID = 0,
+	SCENE_SPHERE_PILE,
+	SCENE_BARRELS_ON_LANDSCAPE,
+	SCENE_JOINT_CHAINS,
+	SCENE_SLEEPING_CROWD,
+	SCENE_RAYCAST_STORM,
+	SCENE_COMPOUND_PILE,
+	SCENE_COUNT,
+};
+
+extern const char *sceneNames[SCENE_COUNT];
+
+//J 約numBodies個の動的な剛体を持つシーンを作成する
+//E Create a scene with about numBodies dynamic rigid bodies
+void bench_create_scene(int sceneId,int numBodies);
+
+///////////////////////////////////////////////////////////////////////////////
+// World
+
+//J maxThreads > 1の場合はPOSIXスレッドのタスクマネージャを作成する
+//E Creates a POSIX threads task manager when maxThreads > 1
+bool bench_init(int maxThreads);
+void bench_release();
+
+//J 1ならシングルスレッド版のAPI、2以上ならタスクマネージャ版のAPIを使用する
+//E 1 uses the single threaded API, more uses the task manager versions
+bool bench_set_threads(int numThreads);
+
+//J stageTimesに各段階のミリ秒を返す。失敗した場合はfalse
+//E Returns the milliseconds of each stage in stageTimes, false on failure
+bool bench_simulate(double stageTimes[STAGE_COUNT]);
+
+int bench_get_num_rigidbodies();
+int bench_get_num_joints();
+int bench_get_num_rays();
+int bench_get_num_pairs();
+int bench_get_num_sleeping();
+
+#endif /* _BENCH_WORLD_H */
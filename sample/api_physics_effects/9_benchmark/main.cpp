@@ -0,0 +1,305 @@
+/*
+Physics Effects Copyright(C) 2011 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#include "bench_world.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+//J ウィンドウを使用しないベンチマーク。標準的なシーンを剛体数とスレッド数を変えて実行し、
+//J 段階ごとの処理時間の50/95/99パーセンタイルをJSONで出力する
+//E Headless benchmark. Runs the standard scenes over a sweep of body counts
+//E and thread counts and writes the 50th, 95th and 99th percentile of the
+//E time of every stage as JSON, so that nightly runs can be compared.
+//E
+//E usage: App_9_Benchmark [options]
+//E   --scenes name,...   scenes to run, default all
+//E   --bodies n,...      dynamic rigid bodies per scene, default 512,2048
+//E   --threads n,...     1 runs the single threaded API, default 1,2
+//E   --frames n          measured frames per run, default 300
+//E   --warmup n          frames simulated before measuring, default 30
+//E   --output file       JSON file, default benchmark.json
+
+///////////////////////////////////////////////////////////////////////////////
+// Options
+
+#define MAX_SWEEP  16
+#define MAX_FRAMES 10000
+
+struct BenchOptions {
+	bool scenes[SCENE_COUNT];
+	int bodies[MAX_SWEEP];
+	int numBodies;
+	int threads[MAX_SWEEP];
+	int numThreads;
+	int frames;
+	int warmup;
+	const char *output;
+};
+
+static int parseList(const char *str,int *values,int maxValues)
+{
+	int n = 0;
+	while(*str && n < maxValues) {
+		values[n++] = atoi(str);
+		const char *comma = strchr(str,',');
+		if(!comma) break;
+		str = comma + 1;
+	}
+	return n;
+}
+
+static bool parseScenes(const char *str,bool *scenes)
+{
+	if(strcmp(str,"all") == 0) {
+		for(int i=0;i<SCENE_COUNT;i++) scenes[i] = true;
+		return true;
+	}
+
+	for(int i=0;i<SCENE_COUNT;i++) scenes[i] = false;
+
+	while(*str) {
+		const char *comma = strchr(str,',');
+		size_t len = comma ? (size_t)(comma - str) : strlen(str);
+		bool found = false;
+		for(int i=0;i<SCENE_COUNT;i++) {
+			if(strlen(sceneNames[i]) == len && strncmp(sceneNames[i],str,len) == 0) {
+				scenes[i] = found = true;
+			}
+		}
+		if(!found) {
+			SCE_PFX_PRINTF("unknown scene %.*s\n",(int)len,str);
+			return false;
+		}
+		if(!comma) break;
+		str = comma + 1;
+	}
+	return true;
+}
+
+static void printUsage()
+{
+	SCE_PFX_PRINTF("usage: App_9_Benchmark [--scenes name,...] [--bodies n,...] [--threads n,...]\n");
+	SCE_PFX_PRINTF("                       [--frames n] [--warmup n] [--output file]\n");
+	SCE_PFX_PRINTF("scenes:");
+	for(int i=0;i<SCENE_COUNT;i++) SCE_PFX_PRINTF(" %s",sceneNames[i]);
+	SCE_PFX_PRINTF("\n");
+}
+
+static bool parseOptions(int argc,char **argv,BenchOptions &options)
+{
+	for(int i=0;i<SCENE_COUNT;i++) options.scenes[i] = true;
+	options.bodies[0] = 512;
+	options.bodies[1] = 2048;
+	options.numBodies = 2;
+	options.threads[0] = 1;
+	options.threads[1] = 2;
+	options.numThreads = 2;
+	options.frames = 300;
+	options.warmup = 30;
+	options.output = "benchmark.json";
+
+	for(int i=1;i<argc;i++) {
+		const char *arg = argv[i];
+		const char *value = i+1 < argc ? argv[i+1] : NULL;
+
+		if(strcmp(arg,"--help") == 0 || strcmp(arg,"-h") == 0 || !value) {
+			return false;
+		}
+
+		if(strcmp(arg,"--scenes") == 0) {
+			if(!parseScenes(value,options.scenes)) return false;
+		}
+		else if(strcmp(arg,"--bodies") == 0) {
+			options.numBodies = parseList(value,options.bodies,MAX_SWEEP);
+		}
+		else if(strcmp(arg,"--threads") == 0) {
+			options.numThreads = parseList(value,options.threads,MAX_SWEEP);
+		}
+		else if(strcmp(arg,"--frames") == 0) {
+			options.frames = SCE_PFX_CLAMP(atoi(value),1,MAX_FRAMES);
+		}
+		else if(strcmp(arg,"--warmup") == 0) {
+			options.warmup = SCE_PFX_MAX(atoi(value),0);
+		}
+		else if(strcmp(arg,"--output") == 0) {
+			options.output = value;
+		}
+		else {
+			SCE_PFX_PRINTF("unknown option %s\n",arg);
+			return false;
+		}
+		i++;
+	}
+
+	for(int i=0;i<options.numThreads;i++) {
+		if(options.threads[i] < 1 || options.threads[i] > MAX_THREADS) {
+			SCE_PFX_PRINTF("thread count must be between 1 and %d\n",MAX_THREADS);
+			return false;
+		}
+	}
+
+	return options.numBodies > 0 && options.numThreads > 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Statistics
+
+struct BenchStats {
+	double p50,p95,p99,mean,max;
+};
+
+static double frameTimes[STAGE_COUNT][MAX_FRAMES];
+
+//J 最近傍順位法でパーセンタイルを求める
+//E Percentiles use the nearest rank method
+static double percentile(const double *sorted,int num,int p)
+{
+	int rank = (num * p + 99) / 100;
+	return sorted[SCE_PFX_CLAMP(rank,1,num) - 1];
+}
+
+static void calcStats(double *times,int num,BenchStats &stats)
+{
+	std::sort(times,times+num);
+
+	double sum = 0.0;
+	for(int i=0;i<num;i++) sum += times[i];
+
+	stats.p50 = percentile(times,num,50);
+	stats.p95 = percentile(times,num,95);
+	stats.p99 = percentile(times,num,99);
+	stats.mean = sum / num;
+	stats.max = times[num-1];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+
+int main(int argc,char **argv)
+{
+	BenchOptions options;
+	if(!parseOptions(argc,argv,options)) {
+		printUsage();
+		return 1;
+	}
+
+	int maxThreads = 1;
+	for(int i=0;i<options.numThreads;i++) maxThreads = SCE_PFX_MAX(maxThreads,options.threads[i]);
+
+	if(!bench_init(maxThreads)) {
+		return 1;
+	}
+
+	FILE *fp = fopen(options.output,"w");
+	if(!fp) {
+		SCE_PFX_PRINTF("can't open %s\n",options.output);
+		bench_release();
+		return 1;
+	}
+
+	fprintf(fp,"{\n");
+	fprintf(fp,"  \"benchmark\": \"physics_effects\",\n");
+#ifdef SCE_PFX_USE_32BIT_OBJECT_ID
+	fprintf(fp,"  \"objectIdBits\": 32,\n");
+#else
+	fprintf(fp,"  \"objectIdBits\": 16,\n");
+#endif
+	fprintf(fp,"  \"frames\": %d,\n",options.frames);
+	fprintf(fp,"  \"warmup\": %d,\n",options.warmup);
+	fprintf(fp,"  \"unit\": \"ms\",\n");
+	fprintf(fp,"  \"runs\": [");
+
+	SCE_PFX_PRINTF("%-22s %7s %7s %9s %9s %9s %9s\n","scene","bodies","threads","p50(ms)","p95(ms)","p99(ms)","pairs");
+
+	int numRuns = 0;
+	int numFailures = 0;
+
+	for(int sceneId=0;sceneId<SCENE_COUNT;sceneId++) {
+		if(!options.scenes[sceneId]) continue;
+
+		for(int b=0;b<options.numBodies;b++) {
+			for(int t=0;t<options.numThreads;t++) {
+				if(!bench_set_threads(options.threads[t])) {
+					SCE_PFX_PRINTF("can't use %d threads\n",options.threads[t]);
+					numFailures++;
+					continue;
+				}
+
+				//J 同じ初期状態から始めるため、シーンはスレッド数ごとに作り直す
+				//E The scene is created again for every thread count to start from the same state
+				bench_create_scene(sceneId,options.bodies[b]);
+
+				bool ok = true;
+				double stageTimes[STAGE_COUNT];
+				for(int f=0;f<options.warmup && ok;f++) {
+					ok = bench_simulate(stageTimes);
+				}
+
+				PfxUInt64 pairSum = 0;
+				for(int f=0;f<options.frames && ok;f++) {
+					ok = bench_simulate(stageTimes);
+					for(int s=0;s<STAGE_COUNT;s++) {
+						frameTimes[s][f] = stageTimes[s];
+					}
+					pairSum += bench_get_num_pairs();
+				}
+
+				if(!ok) {
+					SCE_PFX_PRINTF("%-22s %7d %7d failed\n",sceneNames[sceneId],options.bodies[b],options.threads[t]);
+					numFailures++;
+					continue;
+				}
+
+				fprintf(fp,"%s\n    {\n",numRuns > 0 ? "," : "");
+				fprintf(fp,"      \"scene\": \"%s\",\n",sceneNames[sceneId]);
+				fprintf(fp,"      \"requestedBodies\": %d,\n",options.bodies[b]);
+				fprintf(fp,"      \"rigidBodies\": %d,\n",bench_get_num_rigidbodies());
+				fprintf(fp,"      \"joints\": %d,\n",bench_get_num_joints());
+				fprintf(fp,"      \"rays\": %d,\n",bench_get_num_rays());
+				fprintf(fp,"      \"threads\": %d,\n",options.threads[t]);
+				fprintf(fp,"      \"averagePairs\": %.1f,\n",(double)pairSum / options.frames);
+				fprintf(fp,"      \"sleepingBodies\": %d,\n",bench_get_num_sleeping());
+				fprintf(fp,"      \"stages\": {");
+
+				BenchStats total;
+				for(int s=0;s<STAGE_COUNT;s++) {
+					BenchStats stats;
+					calcStats(frameTimes[s],options.frames,stats);
+					if(s == STAGE_TOTAL) total = stats;
+					fprintf(fp,"%s\n        \"%s\": {\"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"mean\": %.4f, \"max\": %.4f}",
+						s > 0 ? "," : "",stageNames[s],stats.p50,stats.p95,stats.p99,stats.mean,stats.max);
+				}
+				fprintf(fp,"\n      }\n    }");
+				numRuns++;
+
+				SCE_PFX_PRINTF("%-22s %7d %7d %9.3f %9.3f %9.3f %9.1f\n",sceneNames[sceneId],bench_get_num_rigidbodies(),
+					options.threads[t],total.p50,total.p95,total.p99,(double)pairSum / options.frames);
+			}
+		}
+	}
+
+	fprintf(fp,"\n  ]\n}\n");
+
+	fclose(fp);
+	SCE_PFX_PRINTF("results written to %s\n",options.output);
+
+	bench_release();
+
+	return numFailures > 0 ? 1 : 0;
+}
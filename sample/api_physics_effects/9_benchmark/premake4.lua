@@ -0,0 +1,17 @@
+	project "pe_sample_9_benchmark"
+		
+	kind "ConsoleApp"
+	targetdir "../../../bin"
+	includedirs {"../../../include"}
+		
+	links {
+		"physics_effects_low_level",
+		"physics_effects_base_level",
+		"physics_effects_util"
+	}
+	
+	files {
+		"main.cpp",
+		"bench_world.cpp",
+		"bench_world.h"
+	}
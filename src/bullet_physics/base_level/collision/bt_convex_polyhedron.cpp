@@ -20,6 +20,7 @@ subject to the following restrictions:
 
 #include "bullet_physics/bt_math_conversions.h"
 #include "bullet_physics/base_level/collision/bt_convex_polyhedron.h"
+#include "bullet_physics/util/bt_convex_hull_computer.h"
 
 static const int MAX_CAP = 1024;
 #include "bullet_physics/util/bt_hash_map.h"
@@ -107,6 +108,78 @@ bool btConvexPolyhedron::testContainment() const
 
 //
 
+bool btConvexPolyhedron::build(const btConvexHullComputer& hull)
+{
+	int numFaces = hull.faces.size();
+	if (numFaces==0)
+		return false;
+
+	int numVertices = hull.vertices.size();
+	m_vertices.resize(numVertices);
+	for (int p=0;p<numVertices;p++)
+	{
+		m_vertices[p] = hull.vertices[p];
+	}
+
+	m_faces.resize(numFaces);
+	for (int i=0;i<numFaces;i++)
+	{
+		btFace& face = m_faces[i];
+		face.m_indices.resize(0);
+		face.m_connectedFaces.resize(0);
+
+		const btConvexHullComputer::Edge* firstEdge = &hull.edges[hull.faces[i]];
+		const btConvexHullComputer::Edge* edge = firstEdge;
+		btVector3 edges[2];
+		int numEdges = 0;
+		do
+		{
+			int src = edge->getSourceVertex();
+			face.m_indices.push_back(src);
+			if (numEdges<2)
+			{
+				btVector3 newEdge = hull.vertices[edge->getTargetVertex()]-hull.vertices[src];
+				VMNORMALIZE(newEdge);
+				edges[numEdges++] = newEdge;
+			}
+			edge = edge->getNextEdgeOfFace();
+		} while (edge!=firstEdge);
+
+		btVector3 normal = VMNORMALIZED(VMCROSS(edges[0],edges[1]));
+		btScalar planeEq = 1e30f;
+		for (int v=0;v<face.m_indices.size();v++)
+		{
+			btScalar eq = VMDOT(m_vertices[face.m_indices[v]],normal);
+			if (planeEq>eq)
+				planeEq=eq;
+		}
+		face.m_plane[0] = VMGETX(normal);
+		face.m_plane[1] = VMGETY(normal);
+		face.m_plane[2] = VMGETZ(normal);
+		face.m_plane[3] = -planeEq;
+	}
+
+	m_uniqueEdges.resize(0);
+	m_edges.resize(0);
+	initialize();
+	return true;
+}
+
+//
+
+bool btConvexPolyhedron::fitsInplaceClipper() const
+{
+	///the inplace clipper keeps the vertices of a clipped face in a fixed size array
+	for(int i=0;i<m_faces.size();i++)
+	{
+		if (m_faces[i].m_indices.size()>MAXINDICESPERFACE)
+			return false;
+	}
+	return true;
+}
+
+//
+
 void	btConvexPolyhedron::initialize()
 {
 
@@ -175,6 +248,16 @@ void	btConvexPolyhedron::initialize()
 
 			int connectedFace = (edptr->m_face0==i)?edptr->m_face1:edptr->m_face0;
 			m_faces[i].m_connectedFaces[j] = connectedFace;
+
+			if (edptr->m_face0==i)
+			{
+				btPolyhedronEdge edge;
+				edge.m_vertices[0] = (unsigned short)m_faces[i].m_indices[j];
+				edge.m_vertices[1] = (unsigned short)m_faces[i].m_indices[k];
+				edge.m_faces[0] = (unsigned short)i;
+				edge.m_faces[1] = (unsigned short)connectedFace;
+				m_edges.push_back(edge);
+			}
 		}
 	}
 
@@ -0,0 +1,428 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2011 Advanced Micro Devices, Inc.  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "bullet_physics/base_level/collision/bt_packed_convex_polyhedron.h"
+#include "bullet_physics/util/bt_convex_hull_computer.h"
+#include "bullet_physics/util/bt_aligned_allocator.h"
+
+///rounds a float array up to 4 elements, so that every array in the buffer starts 16 byte aligned
+static inline int btPackedSize4(int num)
+{
+	return (num+3)&~3;
+}
+
+static inline bool isAlmostZeroEdge(const btVector3& v)
+{
+	if(fabsf(VMGETX(v))>1e-6 || fabsf(VMGETY(v))>1e-6 || fabsf(VMGETZ(v))>1e-6)	return false;
+	return true;
+}
+
+///adds the direction of the edge v0-v1 unless it or its opposite is already known,
+///edges are directed from the higher to the lower vertex index like btConvexPolyhedron::initialize
+static void addUniqueEdge(btAlignedObjectArray<btVector3>& uniqueEdges, const btVector3* vertices, int v0, int v1)
+{
+	if (v1>v0)
+		VMSWAP(v0,v1);
+
+	btVector3 edge = vertices[v1]-vertices[v0];
+	VMNORMALIZE(edge);
+
+	for (int p=0;p<uniqueEdges.size();p++)
+	{
+		if (isAlmostZeroEdge(uniqueEdges[p]-edge) ||
+			isAlmostZeroEdge(uniqueEdges[p]+edge))
+		{
+			return;
+		}
+	}
+	uniqueEdges.push_back(edge);
+}
+
+
+btPackedConvexPolyhedron::btPackedConvexPolyhedron()
+	:m_buffer(0)
+{
+	release();
+}
+
+btPackedConvexPolyhedron::~btPackedConvexPolyhedron()
+{
+	release();
+}
+
+void btPackedConvexPolyhedron::release()
+{
+	if (m_buffer)
+		btAlignedFree(m_buffer);
+
+	m_buffer = 0;
+	m_numVertices = m_numFaces = m_numIndices = m_numUniqueEdges = m_numEdges = 0;
+	m_vertices = m_uniqueEdges = 0;
+	m_vertexX = m_vertexY = m_vertexZ = 0;
+	m_planeX = m_planeY = m_planeZ = m_planeD = 0;
+	m_faceOffsets = 0;
+	m_faceIndices = m_connectedFaces = 0;
+	m_edges = 0;
+}
+
+void btPackedConvexPolyhedron::allocate(int numVertices, int numFaces, int numIndices, int numUniqueEdges, int numEdges)
+{
+	release();
+
+	const int vertexFloats = btPackedSize4(numVertices);
+	const int planeFloats = btPackedSize4(numFaces);
+	const int offsetInts = btPackedSize4(numFaces+1);
+
+	size_t bytes = sizeof(btVector3) * (numVertices+numUniqueEdges);
+	bytes += sizeof(float) * vertexFloats * 3;
+	bytes += sizeof(float) * planeFloats * 4;
+	bytes += sizeof(int) * offsetInts;
+	bytes += sizeof(btPolyhedronEdge) * numEdges;
+	bytes += sizeof(unsigned short) * numIndices * 2;
+
+	m_buffer = btAlignedAlloc(bytes,16);
+
+	unsigned char* ptr = (unsigned char*)m_buffer;
+	m_vertices = (btVector3*)ptr;		ptr += sizeof(btVector3) * numVertices;
+	m_uniqueEdges = (btVector3*)ptr;	ptr += sizeof(btVector3) * numUniqueEdges;
+	m_vertexX = (float*)ptr;			ptr += sizeof(float) * vertexFloats;
+	m_vertexY = (float*)ptr;			ptr += sizeof(float) * vertexFloats;
+	m_vertexZ = (float*)ptr;			ptr += sizeof(float) * vertexFloats;
+	m_planeX = (float*)ptr;				ptr += sizeof(float) * planeFloats;
+	m_planeY = (float*)ptr;				ptr += sizeof(float) * planeFloats;
+	m_planeZ = (float*)ptr;				ptr += sizeof(float) * planeFloats;
+	m_planeD = (float*)ptr;				ptr += sizeof(float) * planeFloats;
+	m_faceOffsets = (int*)ptr;			ptr += sizeof(int) * offsetInts;
+	m_edges = (btPolyhedronEdge*)ptr;	ptr += sizeof(btPolyhedronEdge) * numEdges;
+	m_faceIndices = (unsigned short*)ptr;	ptr += sizeof(unsigned short) * numIndices;
+	m_connectedFaces = (unsigned short*)ptr;
+
+	m_numVertices = numVertices;
+	m_numFaces = numFaces;
+	m_numIndices = numIndices;
+	m_numUniqueEdges = numUniqueEdges;
+	m_numEdges = numEdges;
+}
+
+///copies the vertices to the x, y, z arrays, the lanes after the last vertex repeat the first one
+void btPackedConvexPolyhedron::fillVertexArrays()
+{
+	for (int p=0;p<btPackedSize4(m_numVertices);p++)
+	{
+		const btVector3& v = m_vertices[p<m_numVertices ? p : 0];
+		m_vertexX[p] = VMGETX(v);
+		m_vertexY[p] = VMGETY(v);
+		m_vertexZ[p] = VMGETZ(v);
+	}
+}
+
+bool btPackedConvexPolyhedron::build(const btConvexHullComputer& hull)
+{
+	const int numVertices = hull.vertices.size();
+	const int numFaces = hull.faces.size();
+	if (numFaces==0 || numVertices>0xffff || numFaces>0xffff)
+		return false;
+
+	const btConvexHullComputer::Edge* firstHullEdge = &hull.edges[0];
+
+	///the face on the left of every half edge, the connected face of an edge is the face of its reverse edge
+	btAlignedObjectArray<int> edgeFaces;
+	edgeFaces.resize(hull.edges.size(),-1);
+
+	btAlignedObjectArray<btVector3> uniqueEdges;
+
+	int numIndices = 0;
+	for (int i=0;i<numFaces;i++)
+	{
+		const btConvexHullComputer::Edge* firstEdge = &hull.edges[hull.faces[i]];
+		const btConvexHullComputer::Edge* edge = firstEdge;
+		int numFaceVertices = 0;
+		do
+		{
+			edgeFaces[int(edge-firstHullEdge)] = i;
+			addUniqueEdge(uniqueEdges,&hull.vertices[0],edge->getSourceVertex(),edge->getTargetVertex());
+			numFaceVertices++;
+			edge = edge->getNextEdgeOfFace();
+		} while (edge!=firstEdge);
+
+		///the clipper keeps the vertices of a clipped face in a fixed size array
+		if (numFaceVertices>MAXINDICESPERFACE)
+			return false;
+		numIndices += numFaceVertices;
+	}
+
+	allocate(numVertices,numFaces,numIndices,uniqueEdges.size(),hull.edges.size()/2);
+
+	for (int p=0;p<numVertices;p++)
+	{
+		m_vertices[p] = hull.vertices[p];
+	}
+	fillVertexArrays();
+	for (int p=0;p<m_numUniqueEdges;p++)
+	{
+		m_uniqueEdges[p] = uniqueEdges[p];
+	}
+
+	int index = 0;
+	int edgeIndex = 0;
+	for (int i=0;i<numFaces;i++)
+	{
+		m_faceOffsets[i] = index;
+
+		const btConvexHullComputer::Edge* firstEdge = &hull.edges[hull.faces[i]];
+		const btConvexHullComputer::Edge* edge = firstEdge;
+		btVector3 edges[2];
+		int numEdges = 0;
+		do
+		{
+			int src = edge->getSourceVertex();
+			int connectedFace = edgeFaces[int(edge->getReverseEdge()-firstHullEdge)];
+			m_faceIndices[index] = (unsigned short)src;
+			m_connectedFaces[index] = (unsigned short)connectedFace;
+			index++;
+
+			///every edge is stored once, from the half edge that comes first
+			if (edge<edge->getReverseEdge())
+			{
+				btPolyhedronEdge& polyEdge = m_edges[edgeIndex++];
+				polyEdge.m_vertices[0] = (unsigned short)src;
+				polyEdge.m_vertices[1] = (unsigned short)edge->getTargetVertex();
+				polyEdge.m_faces[0] = (unsigned short)i;
+				polyEdge.m_faces[1] = (unsigned short)connectedFace;
+			}
+
+			if (numEdges<2)
+			{
+				btVector3 newEdge = hull.vertices[edge->getTargetVertex()]-hull.vertices[src];
+				VMNORMALIZE(newEdge);
+				edges[numEdges++] = newEdge;
+			}
+			edge = edge->getNextEdgeOfFace();
+		} while (edge!=firstEdge);
+
+		btVector3 normal = VMNORMALIZED(VMCROSS(edges[0],edges[1]));
+		btScalar planeEq = 1e30f;
+		for (int v=m_faceOffsets[i];v<index;v++)
+		{
+			btScalar eq = VMDOT(m_vertices[m_faceIndices[v]],normal);
+			if (planeEq>eq)
+				planeEq=eq;
+		}
+		m_planeX[i] = VMGETX(normal);
+		m_planeY[i] = VMGETY(normal);
+		m_planeZ[i] = VMGETZ(normal);
+		m_planeD[i] = -planeEq;
+	}
+	m_faceOffsets[numFaces] = index;
+	VMASSERT(edgeIndex==m_numEdges);
+
+	computeInternalObjects();
+	return true;
+}
+
+bool btPackedConvexPolyhedron::build(const btConvexPolyhedron& polyhedron)
+{
+	const int numVertices = polyhedron.getNumVertices();
+	const int numFaces = polyhedron.getNumFaces();
+	if (numFaces==0 || numVertices>0xffff || numFaces>0xffff)
+		return false;
+
+	int numIndices = 0;
+	for (int i=0;i<numFaces;i++)
+	{
+		if (polyhedron.getNumFaceVertices(i)>MAXINDICESPERFACE)
+			return false;
+		numIndices += polyhedron.getNumFaceVertices(i);
+	}
+
+	allocate(numVertices,numFaces,numIndices,polyhedron.getNumUniqueEdges(),polyhedron.getNumEdges());
+
+	for (int p=0;p<numVertices;p++)
+	{
+		m_vertices[p] = polyhedron.getVertex(p);
+	}
+	fillVertexArrays();
+	for (int p=0;p<m_numUniqueEdges;p++)
+	{
+		m_uniqueEdges[p] = polyhedron.getUniqueEdge(p);
+	}
+	for (int p=0;p<m_numEdges;p++)
+	{
+		m_edges[p] = polyhedron.getEdge(p);
+	}
+
+	int index = 0;
+	for (int i=0;i<numFaces;i++)
+	{
+		m_faceOffsets[i] = index;
+		for (int j=0;j<polyhedron.getNumFaceVertices(i);j++)
+		{
+			m_faceIndices[index] = (unsigned short)polyhedron.getFaceVertexIndex(i,j);
+			m_connectedFaces[index] = (unsigned short)polyhedron.getConnectedFace(i,j);
+			index++;
+		}
+
+		const btVector3 normal = polyhedron.getFaceNormal(i);
+		m_planeX[i] = VMGETX(normal);
+		m_planeY[i] = VMGETY(normal);
+		m_planeZ[i] = VMGETZ(normal);
+		m_planeD[i] = polyhedron.getFacePlaneEq(i);
+	}
+	m_faceOffsets[numFaces] = index;
+
+	m_localCenter = polyhedron.m_localCenter;
+#ifdef TEST_INTERNAL_OBJECTS
+	m_extents = polyhedron.m_extents;
+	m_radius = polyhedron.m_radius;
+#endif //TEST_INTERNAL_OBJECTS
+	return true;
+}
+
+#ifdef TEST_INTERNAL_OBJECTS
+bool btPackedConvexPolyhedron::testContainment() const
+{
+	for(int p=0;p<8;p++)
+	{
+		const btVector3 LocalPt = m_localCenter + btVector3(
+			(p&4) ? -m_extents[0] : m_extents[0],
+			(p&2) ? -m_extents[1] : m_extents[1],
+			(p&1) ? -m_extents[2] : m_extents[2]);
+
+		const btScalar x = VMGETX(LocalPt);
+		const btScalar y = VMGETY(LocalPt);
+		const btScalar z = VMGETZ(LocalPt);
+		for(int i=0;i<m_numFaces;i++)
+		{
+			const btScalar d = x*m_planeX[i] + y*m_planeY[i] + z*m_planeZ[i] + m_planeD[i];
+			if(d>0.0f)
+				return false;
+		}
+	}
+	return true;
+}
+#endif //TEST_INTERNAL_OBJECTS
+
+///same center and internal box as btConvexPolyhedron::initialize
+void btPackedConvexPolyhedron::computeInternalObjects()
+{
+	float TotalArea = 0.0f;
+
+	VMSET(m_localCenter,0, 0, 0);
+	for(int i=0;i<m_numFaces;i++)
+	{
+		int numVertices = getNumFaceVertices(i);
+		int NbTris = numVertices-2;
+
+		const btVector3& p0 = m_vertices[getFaceVertexIndex(i,0)];
+		for(int j=1;j<=NbTris;j++)
+		{
+			int k = (j+1)%numVertices;
+			const btVector3& p1 = m_vertices[getFaceVertexIndex(i,j)];
+			const btVector3& p2 = m_vertices[getFaceVertexIndex(i,k)];
+			float Area = (VMLENGTH(VMCROSS((p0 - p1),(p0 - p2)))) * 0.5f;
+			btVector3 Center = (p0+p1+p2)/3.0f;
+			m_localCenter += Area * Center;
+			TotalArea += Area;
+		}
+	}
+	m_localCenter /= TotalArea;
+
+#ifdef TEST_INTERNAL_OBJECTS
+	m_radius = FLT_MAX;
+	for(int i=0;i<m_numFaces;i++)
+	{
+		const btScalar dist = fabsf(VMDOT(m_localCenter,getFaceNormal(i)) + m_planeD[i]);
+		if(dist<m_radius)
+			m_radius = dist;
+	}
+
+	btVector3 MinPt = m_vertices[0];
+	btVector3 MaxPt = m_vertices[0];
+	for(int i=1; i<m_numVertices; i++)
+	{
+		VM_SETMIN(MinPt,m_vertices[i]);
+		VM_SETMAX(MaxPt,m_vertices[i]);
+	}
+	const btVector3 E = MaxPt-MinPt;
+
+	const btScalar r = m_radius / sqrtf(3.0f);
+	const int LargestExtent = VMMAXAXIS(E);
+	const btScalar Step = (E[LargestExtent]*0.5f - r)/1024.0f;
+	m_extents[0] = m_extents[1] = m_extents[2] = r;
+	m_extents[LargestExtent] = E[LargestExtent]*0.5f;
+	bool FoundBox = false;
+	for(int j=0;j<1024;j++)
+	{
+		if(testContainment())
+		{
+			FoundBox = true;
+			break;
+		}
+
+		m_extents[LargestExtent] -= Step;
+	}
+	if(!FoundBox)
+	{
+		m_extents[0] = m_extents[1] = m_extents[2] = r;
+	}
+	else
+	{
+		// Refine the box
+		const btScalar Step = (m_radius - r)/1024.0f;
+		const int e0 = (1<<LargestExtent) & 3;
+		const int e1 = (1<<e0) & 3;
+
+		for(int j=0;j<1024;j++)
+		{
+			const btScalar Saved0 = m_extents[e0];
+			const btScalar Saved1 = m_extents[e1];
+			m_extents[e0] += Step;
+			m_extents[e1] += Step;
+
+			if(!testContainment())
+			{
+				m_extents[e0] = Saved0;
+				m_extents[e1] = Saved1;
+				break;
+			}
+		}
+	}
+#endif //TEST_INTERNAL_OBJECTS
+}
+
+void btPackedConvexPolyhedron::project(const btTransform& trans, const btVector3& dir, float& min, float& max) const
+{
+	///dot(R*v+t,dir) = dot(v,transpose(R)*dir) + dot(t,dir), so the vertices are never transformed
+	const btVector3 localDir = VMTRANSPOSE(VMGETBASIS(trans)) * dir;
+	const float dirX = VMGETX(localDir);
+	const float dirY = VMGETY(localDir);
+	const float dirZ = VMGETZ(localDir);
+
+	float laneMin[4] = {VM_FLT_MAX,VM_FLT_MAX,VM_FLT_MAX,VM_FLT_MAX};
+	float laneMax[4] = {-VM_FLT_MAX,-VM_FLT_MAX,-VM_FLT_MAX,-VM_FLT_MAX};
+	for(int i=0;i<m_numVertices;i+=4)
+	{
+		for(int j=0;j<4;j++)
+		{
+			const float dp = m_vertexX[i+j]*dirX + m_vertexY[i+j]*dirY + m_vertexZ[i+j]*dirZ;
+			laneMin[j] = dp < laneMin[j] ? dp : laneMin[j];
+			laneMax[j] = dp > laneMax[j] ? dp : laneMax[j];
+		}
+	}
+
+	const float offset = VMDOT(VMGETTRANSLATION(trans),dir);
+	min = VMMIN(VMMIN(laneMin[0],laneMin[1]),VMMIN(laneMin[2],laneMin[3])) + offset;
+	max = VMMAX(VMMAX(laneMax[0],laneMax[1]),VMMAX(laneMax[2],laneMax[3])) + offset;
+}
@@ -18,3 +18,13 @@ subject to the following restrictions:
 ///Separating axis rest based on work from Pierre Terdiman, see
 ///And contact clipping based on work from Simon Hobbs
 
+#include "bullet_physics/base_level/collision/bt_polyhedral_contact_clipping.h"
+
+int gActualNbTests=0;
+int gExpectedNbTests=0;
+int gActualSATPairTests=0;
+int gFaceAxisTests=0;
+int gEdgeEdgeTests=0;
+int gSeparatingAxisCacheHits=0;
+bool gUseInternalObject=true;
+bool gUseGaussMapEdgePruning=true;
@@ -14,11 +14,10 @@
 // Ogre (www.ogre3d.org).
 
 #include "btQuickprof.h"
-#include <windows.h>
 #ifndef BT_NO_PROFILE
 
+#include <stdarg.h>
 
-static btClock gProfileClock;
 #define SIMD_EPSILON 1e-6f
 
 #ifdef __CELLOS_LV2__
@@ -47,9 +46,12 @@ static btClock gProfileClock;
 
 #include <time.h>
 
+#define BT_PROFILE_THREAD_LOCAL __declspec(thread)
 
 #else //_WIN32
 #include <sys/time.h>
+
+#define BT_PROFILE_THREAD_LOCAL __thread
 #endif //_WIN32
 
 #define mymin(a,b) (a > b ? a : b)
@@ -239,9 +241,58 @@ unsigned long int btClock::getTimeMicroseconds()
 
 
 
+///The profile clock is read concurrently by all profiled threads. Unlike btClock it never
+///modifies its state while reading, it is only restarted by CProfileManager::Reset.
+#ifdef BT_USE_WINDOWS_TIMERS
+static LARGE_INTEGER gProfileClockFrequency;
+static LARGE_INTEGER gProfileClockStart;
+#else
+#ifdef __CELLOS_LV2__
+static uint64_t gProfileClockStart;
+#else
+static struct timeval gProfileClockStart;
+#endif
+#endif
+
+static void Profile_Reset_Clock()
+{
+#ifdef BT_USE_WINDOWS_TIMERS
+	QueryPerformanceFrequency(&gProfileClockFrequency);
+	QueryPerformanceCounter(&gProfileClockStart);
+#else
+#ifdef __CELLOS_LV2__
+	SYS_TIMEBASE_GET( gProfileClockStart );
+#else
+	gettimeofday(&gProfileClockStart, 0);
+#endif
+#endif
+}
+
+static struct btProfileClockInitializer
+{
+	btProfileClockInitializer() { Profile_Reset_Clock(); }
+} gProfileClockInitializer;
+
 inline void Profile_Get_Ticks(unsigned long int * ticks)
 {
-	*ticks = gProfileClock.getTimeMicroseconds();
+#ifdef BT_USE_WINDOWS_TIMERS
+	LARGE_INTEGER currentTime;
+	QueryPerformanceCounter(&currentTime);
+	*ticks = (unsigned long int)(1000000 * (currentTime.QuadPart - gProfileClockStart.QuadPart) / 
+		gProfileClockFrequency.QuadPart);
+#else
+#ifdef __CELLOS_LV2__
+	uint64_t freq=sys_time_get_timebase_frequency();
+	uint64_t newTime;
+	SYS_TIMEBASE_GET( newTime );
+	*ticks = (unsigned long int)((double(newTime-gProfileClockStart)) / (((double) freq)/ 1000000.0));
+#else
+	struct timeval currentTime;
+	gettimeofday(&currentTime, 0);
+	*ticks = (currentTime.tv_sec - gProfileClockStart.tv_sec) * 1000000 + 
+		(currentTime.tv_usec - gProfileClockStart.tv_usec);
+#endif
+#endif
 }
 
 inline float Profile_Get_Tick_Rate(void)
@@ -361,6 +412,29 @@ bool	CProfileNode::Return( void )
 }
 
 
+/***********************************************************************************************
+ * INPUT:                                                                                      *
+ * source - node of a per thread tree that matches this node                                   *
+ *                                                                                             *
+ * WARNINGS:                                                                                   *
+ * A running node keeps its calls until it returns, otherwise Return would find no calls and   *
+ * drop its time. The owning thread must not be profiling while the merge runs.                *
+ *=============================================================================================*/
+void	CProfileNode::Merge( CProfileNode * source )
+{
+	for ( CProfileNode * child = source->Child; child; child = child->Sibling ) {
+		CProfileNode * node = Get_Sub_Node( child->Name );
+		if ( child->RecursionCounter == 0 ) {
+			node->TotalCalls += child->TotalCalls;
+			node->TotalTime += child->TotalTime;
+			child->TotalCalls = 0;
+			child->TotalTime = 0.0f;
+		}
+		node->Merge( child );
+	}
+}
+
+
 /***************************************************************************************************
 **
 ** CProfileIterator
@@ -422,11 +496,62 @@ void	CProfileIterator::Enter_Parent( void )
 ***************************************************************************************************/
 
 CProfileNode	CProfileManager::Root( "Root", NULL );
-CProfileNode *	CProfileManager::CurrentNode = &CProfileManager::Root;
 int				CProfileManager::FrameCounter = 0;
 unsigned long int			CProfileManager::ResetTime = 0;
 
 
+///The tree that one thread records into. Only the owning thread walks CurrentNode.
+struct btProfileThread
+{
+	CProfileNode	Root;
+	CProfileNode *	CurrentNode;
+
+	btProfileThread() : Root( "Root", NULL ), CurrentNode( &Root ) {}
+};
+
+static btProfileThread *	gProfileThreads[BT_QUICKPROF_MAX_THREADS];
+static volatile long		gNumProfileThreads = 0;
+static BT_PROFILE_THREAD_LOCAL btProfileThread *	gCurrentProfileThread = NULL;
+static BT_PROFILE_THREAD_LOCAL bool				gProfileThreadRejected = false;
+
+
+/***********************************************************************************************
+ * Profile_Get_Thread -- Returns the tree of the calling thread, creating it on first use     *
+ *                                                                                             *
+ * A thread claims its slot with an atomic increment, so no lock is taken. Threads beyond      *
+ * BT_QUICKPROF_MAX_THREADS get NULL and are not profiled.                                     *
+ *=============================================================================================*/
+static btProfileThread *	Profile_Get_Thread( void )
+{
+	btProfileThread * thread = gCurrentProfileThread;
+	if ( thread || gProfileThreadRejected ) {
+		return thread;
+	}
+
+#if defined(WIN32) || defined(_WIN32)
+	long index = InterlockedIncrement( &gNumProfileThreads ) - 1;
+#else
+	long index = __sync_fetch_and_add( &gNumProfileThreads, 1 );
+#endif
+
+	if ( index >= BT_QUICKPROF_MAX_THREADS ) {
+		gProfileThreadRejected = true;
+		return NULL;
+	}
+
+	thread = new btProfileThread;
+	gProfileThreads[index] = thread;
+	gCurrentProfileThread = thread;
+	return thread;
+}
+
+
+static int	Profile_Get_Number_Of_Threads( void )
+{
+	return gNumProfileThreads < BT_QUICKPROF_MAX_THREADS ? (int)gNumProfileThreads : BT_QUICKPROF_MAX_THREADS;
+}
+
+
 /***********************************************************************************************
  * CProfileManager::Start_Profile -- Begin a named profile                                    *
  *                                                                                             *
@@ -442,11 +567,16 @@ unsigned long int			CProfileManager::ResetTime = 0;
  *=============================================================================================*/
 void	CProfileManager::Start_Profile( const char * name )
 {
-	if (name != CurrentNode->Get_Name()) {
-		CurrentNode = CurrentNode->Get_Sub_Node( name );
+	btProfileThread * thread = Profile_Get_Thread();
+	if ( thread == NULL ) {
+		return;
+	}
+
+	if (name != thread->CurrentNode->Get_Name()) {
+		thread->CurrentNode = thread->CurrentNode->Get_Sub_Node( name );
 	} 
 	
-	CurrentNode->Call();
+	thread->CurrentNode->Call();
 }
 
 
@@ -455,10 +585,32 @@ void	CProfileManager::Start_Profile( const char * name )
  *=============================================================================================*/
 void	CProfileManager::Stop_Profile( void )
 {
+	btProfileThread * thread = Profile_Get_Thread();
+	if ( thread == NULL ) {
+		return;
+	}
+
 	// Return will indicate whether we should back up to our parent (we may
 	// be profiling a recursive function)
-	if (CurrentNode->Return()) {
-		CurrentNode = CurrentNode->Get_Parent();
+	if (thread->CurrentNode->Return()) {
+		thread->CurrentNode = thread->CurrentNode->Get_Parent();
+	}
+}
+
+
+/***********************************************************************************************
+ * CProfileManager::CleanupMemory -- Release the nodes of the global and per thread trees     *
+ *=============================================================================================*/
+void	CProfileManager::CleanupMemory( void )
+{
+	Root.CleanupMemory();
+
+	int numThreads = Profile_Get_Number_Of_Threads();
+	for ( int i = 0; i < numThreads; i++ ) {
+		if ( gProfileThreads[i] ) {
+			gProfileThreads[i]->Root.CleanupMemory();
+			gProfileThreads[i]->CurrentNode = &gProfileThreads[i]->Root;
+		}
 	}
 }
 
@@ -470,9 +622,17 @@ void	CProfileManager::Stop_Profile( void )
  *=============================================================================================*/
 void	CProfileManager::Reset( void )
 { 
-	gProfileClock.reset();
+	Profile_Reset_Clock();
 	Root.Reset();
     Root.Call();
+
+	int numThreads = Profile_Get_Number_Of_Threads();
+	for ( int i = 0; i < numThreads; i++ ) {
+		if ( gProfileThreads[i] ) {
+			gProfileThreads[i]->Root.Reset();
+		}
+	}
+
 	FrameCounter = 0;
 	Profile_Get_Ticks(&ResetTime);
 }
@@ -483,10 +643,34 @@ void	CProfileManager::Reset( void )
  *=============================================================================================*/
 void CProfileManager::Increment_Frame_Counter( void )
 {
+	Merge_Threads();
 	FrameCounter++;
 }
 
 
+/***********************************************************************************************
+ * CProfileManager::Get_Number_Of_Threads -- Returns the number of threads being profiled     *
+ *=============================================================================================*/
+int	CProfileManager::Get_Number_Of_Threads( void )
+{
+	return Profile_Get_Number_Of_Threads();
+}
+
+
+/***********************************************************************************************
+ * CProfileManager::Merge_Threads -- Accumulate the per thread trees into the global tree     *
+ *=============================================================================================*/
+void	CProfileManager::Merge_Threads( void )
+{
+	int numThreads = Profile_Get_Number_Of_Threads();
+	for ( int i = 0; i < numThreads; i++ ) {
+		if ( gProfileThreads[i] ) {
+			Root.Merge( &gProfileThreads[i]->Root );
+		}
+	}
+}
+
+
 /***********************************************************************************************
  * CProfileManager::Get_Time_Since_Reset -- returns the elapsed time since last reset         *
  *=============================================================================================*/
@@ -502,11 +686,15 @@ float CProfileManager::Get_Time_Since_Reset( void )
 
 static void pfxOutputDebugString(const char *str, ...)
 {
-    char strDebug[1024]={0};
     va_list argList;
     va_start(argList, str);
+#if defined(WIN32) || defined(_WIN32)
+    char strDebug[1024]={0};
     vsprintf_s(strDebug,str,argList);
 	OutputDebugStringA(strDebug);
+#else
+	vprintf(str,argList);
+#endif
     va_end(argList);
 }
 
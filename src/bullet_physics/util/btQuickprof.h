@@ -77,6 +77,11 @@ public:
 	void				Call( void );
 	bool				Return( void );
 
+	///Adds the calls and times recorded in the subtree of source into the matching nodes
+	///of this subtree, creating nodes as needed, and clears them in source.
+	///Nodes of source that are still running are left for the next merge.
+	void				Merge( CProfileNode * source );
+
 	const char *	Get_Name( void )				{ return Name; }
 	int				Get_Total_Calls( void )		{ return TotalCalls; }
 	float				Get_Total_Time( void )		{ return TotalTime; }
@@ -128,19 +133,26 @@ protected:
 };
 
 
+///The maximum number of threads that are profiled, samples from further threads are ignored.
+///A thread keeps its slot for the life of the process, so profile long lived worker threads.
+#define BT_QUICKPROF_MAX_THREADS 64
+
 ///The Manager for the Profile system
+///Every thread records into its own tree, so Start_Profile and Stop_Profile take no lock.
+///Increment_Frame_Counter merges the trees of all threads into the global tree, which is the
+///one returned by Get_Iterator. Samples with the same path on several threads are summed.
+///Reset, Increment_Frame_Counter, CleanupMemory and dumpAll must be called while no other
+///thread is profiling, e.g. at the end of a frame when the worker threads are idle.
 class	CProfileManager {
 public:
 	static	void						Start_Profile( const char * name );
 	static	void						Stop_Profile( void );
 
-	static	void						CleanupMemory(void)
-	{
-		Root.CleanupMemory();
-	}
+	static	void						CleanupMemory(void);
 
 	static	void						Reset( void );
 	static	void						Increment_Frame_Counter( void );
+	static	int						Get_Number_Of_Threads( void );
 	static	int						Get_Frame_Count_Since_Reset( void )		{ return FrameCounter; }
 	static	float						Get_Time_Since_Reset( void );
 
@@ -156,8 +168,9 @@ public:
 	static void	dumpAll();
 
 private:
+	static	void						Merge_Threads( void );
+
 	static	CProfileNode			Root;
-	static	CProfileNode *			CurrentNode;
 	static	int						FrameCounter;
 	static	unsigned long int					ResetTime;
 };
@@ -0,0 +1,551 @@
+/*
+Physics Effects Copyright(C) 2011 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#include "../../../include/physics_effects/base_level/base/pfx_perf_counter.h"
+
+#if defined(_MSC_VER)
+	#define SCE_PFX_THREAD_LOCAL __declspec(thread)
+#else
+	#define SCE_PFX_THREAD_LOCAL __thread
+#endif
+
+namespace sce {
+namespace PhysicsEffects {
+
+///////////////////////////////////////////////////////////////////////////////
+// Timer
+
+PfxFloat pfxGetPerfTicksPerSecond()
+{
+#if defined(_WIN32)
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency(&freq);
+	return (PfxFloat)freq.QuadPart;
+#elif defined(SCE_PFX_USE_TSC)
+	//J 約10ミリ秒の間のTSCの増分をclock_gettimeと比較する
+	//E Compare the TSC against clock_gettime over about 10 milliseconds
+	static PfxFloat ticksPerSecond = 0.0f;
+	if(ticksPerSecond == 0.0f) {
+		timespec t0,t1;
+		clock_gettime(CLOCK_MONOTONIC,&t0);
+		PfxUInt64 c0 = __rdtsc();
+		PfxUInt64 ns = 0;
+		do {
+			clock_gettime(CLOCK_MONOTONIC,&t1);
+			ns = (PfxUInt64)(t1.tv_sec - t0.tv_sec) * 1000000000ull + t1.tv_nsec - t0.tv_nsec;
+		} while(ns < 10000000ull);
+		PfxUInt64 c1 = __rdtsc();
+		ticksPerSecond = (PfxFloat)((double)(c1 - c0) * 1.0e9 / (double)ns);
+	}
+	return ticksPerSecond;
+#else
+	return 1.0e9f;
+#endif
+}
+
+#ifdef SCE_PFX_USE_PERFCOUNTER
+
+static inline PfxInt32 pfxAtomicFetchAndIncrement(volatile PfxInt32 *value)
+{
+#if defined(_WIN32)
+	return InterlockedIncrement((volatile LONG*)value) - 1;
+#else
+	return __sync_fetch_and_add(value,1);
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Profiler
+
+struct PfxProfileNode {
+	const char *name;
+	PfxInt32 parent;
+	PfxInt32 firstChild;
+	PfxInt32 lastChild;
+	PfxInt32 nextSibling;
+	PfxUInt32 depth;
+
+	// Current frame
+	PfxUInt64 frameTicks;
+	PfxUInt32 frameCalls;
+
+	// History
+	PfxUInt32 numFrames;
+	PfxUInt32 historyHead;
+	PfxUInt32 totalCalls;
+	PfxFloat history[SCE_PFX_PROFILE_HISTORY];
+	PfxUInt32 historyCalls[SCE_PFX_PROFILE_HISTORY];
+};
+
+struct PfxProfileThread {
+	PfxUInt32 numNodes;
+	PfxUInt32 depth;
+	PfxInt32 stackNodes[SCE_PFX_MAX_PROFILE_DEPTH];
+	PfxUInt64 stackTicks[SCE_PFX_MAX_PROFILE_DEPTH];
+	PfxUInt32 numDroppedScopes;
+	PfxProfileNode nodes[SCE_PFX_MAX_PROFILE_NODES];
+};
+
+static PfxProfileThread s_profileThreads[SCE_PFX_MAX_PROFILE_THREADS];
+static volatile PfxInt32 s_numProfileThreads = 0;
+static SCE_PFX_THREAD_LOCAL PfxProfileThread *s_profileThread = NULL;
+static SCE_PFX_THREAD_LOCAL PfxBool s_profileThreadRejected = false;
+
+static void pfxResetProfileThread(PfxProfileThread &thread)
+{
+	thread.numNodes = 1;
+	thread.depth = 0;
+	thread.numDroppedScopes = 0;
+
+	PfxProfileNode &root = thread.nodes[0];
+	root.name = "thread";
+	root.parent = -1;
+	root.firstChild = root.lastChild = root.nextSibling = -1;
+	root.depth = 0;
+	root.frameTicks = 0;
+	root.frameCalls = 0;
+	root.numFrames = 0;
+	root.historyHead = 0;
+	root.totalCalls = 0;
+}
+
+static PfxProfileThread *pfxGetProfileThread()
+{
+	if(SCE_PFX_LIKELY(s_profileThread)) return s_profileThread;
+	if(s_profileThreadRejected) return NULL;
+
+	PfxInt32 threadId = pfxAtomicFetchAndIncrement(&s_numProfileThreads);
+
+	//J スレッド数が上限を超えた場合、そのスレッドは計測しない
+	//E Threads beyond the limit are not measured
+	if(threadId >= SCE_PFX_MAX_PROFILE_THREADS) {
+		s_profileThreadRejected = true;
+		return NULL;
+	}
+
+	s_profileThread = &s_profileThreads[threadId];
+	pfxResetProfileThread(*s_profileThread);
+	return s_profileThread;
+}
+
+static PfxInt32 pfxFindProfileNode(PfxProfileThread &thread,PfxInt32 parentId,const char *name)
+{
+	PfxProfileNode &parent = thread.nodes[parentId];
+
+	for(PfxInt32 i=parent.firstChild;i>=0;i=thread.nodes[i].nextSibling) {
+		if(thread.nodes[i].name == name || strcmp(thread.nodes[i].name,name) == 0) return i;
+	}
+
+	if(thread.numNodes >= SCE_PFX_MAX_PROFILE_NODES) return -1;
+
+	PfxInt32 nodeId = thread.numNodes++;
+	PfxProfileNode &node = thread.nodes[nodeId];
+	node.name = name;
+	node.parent = parentId;
+	node.firstChild = node.lastChild = node.nextSibling = -1;
+	node.depth = parent.depth + 1;
+	node.frameTicks = 0;
+	node.frameCalls = 0;
+	node.numFrames = 0;
+	node.historyHead = 0;
+	node.totalCalls = 0;
+
+	if(parent.lastChild >= 0) {
+		thread.nodes[parent.lastChild].nextSibling = nodeId;
+	}
+	else {
+		parent.firstChild = nodeId;
+	}
+	parent.lastChild = nodeId;
+
+	return nodeId;
+}
+
+void pfxProfileBegin(const char *name)
+{
+	PfxProfileThread *thread = pfxGetProfileThread();
+	if(!thread) return;
+
+	if(thread->depth >= SCE_PFX_MAX_PROFILE_DEPTH) {
+		thread->depth++;
+		thread->numDroppedScopes++;
+		return;
+	}
+
+	PfxInt32 parentId = 0;
+	for(PfxInt32 d=(PfxInt32)thread->depth-1;d>=0;d--) {
+		if(thread->stackNodes[d] >= 0) {
+			parentId = thread->stackNodes[d];
+			break;
+		}
+	}
+
+	PfxInt32 nodeId = pfxFindProfileNode(*thread,parentId,name);
+	if(nodeId < 0) thread->numDroppedScopes++;
+
+	thread->stackNodes[thread->depth] = nodeId;
+	thread->stackTicks[thread->depth] = pfxGetPerfTicks();
+	thread->depth++;
+}
+
+void pfxProfileEnd()
+{
+	PfxUInt64 ticks = pfxGetPerfTicks();
+
+	PfxProfileThread *thread = pfxGetProfileThread();
+	if(!thread) return;
+
+	SCE_PFX_ASSERT(thread->depth > 0);
+	if(thread->depth == 0) return;
+
+	thread->depth--;
+	if(thread->depth >= SCE_PFX_MAX_PROFILE_DEPTH) return;
+
+	PfxInt32 nodeId = thread->stackNodes[thread->depth];
+	if(nodeId < 0) return;
+
+	PfxProfileNode &node = thread->nodes[nodeId];
+	node.frameTicks += ticks - thread->stackTicks[thread->depth];
+	node.frameCalls++;
+}
+
+void pfxProfileEndFrame()
+{
+	PfxFloat msPerTick = 1000.0f / pfxGetPerfTicksPerSecond();
+	PfxUInt32 numThreads = pfxGetNumProfileThreads();
+
+	for(PfxUInt32 t=0;t<numThreads;t++) {
+		PfxProfileThread &thread = s_profileThreads[t];
+		SCE_PFX_ASSERT(thread.depth == 0);
+		for(PfxUInt32 i=1;i<thread.numNodes;i++) {
+			PfxProfileNode &node = thread.nodes[i];
+			if(node.frameCalls == 0) continue;
+
+			node.history[node.historyHead] = (PfxFloat)node.frameTicks * msPerTick;
+			node.historyCalls[node.historyHead] = node.frameCalls;
+			node.historyHead = (node.historyHead + 1) % SCE_PFX_PROFILE_HISTORY;
+			node.numFrames = SCE_PFX_MIN(node.numFrames + 1,(PfxUInt32)SCE_PFX_PROFILE_HISTORY);
+			node.totalCalls += node.frameCalls;
+
+			node.frameTicks = 0;
+			node.frameCalls = 0;
+		}
+	}
+}
+
+void pfxProfileReset()
+{
+	PfxUInt32 numThreads = pfxGetNumProfileThreads();
+	for(PfxUInt32 t=0;t<numThreads;t++) {
+		pfxResetProfileThread(s_profileThreads[t]);
+	}
+}
+
+PfxUInt32 pfxGetNumProfileThreads()
+{
+	return (PfxUInt32)SCE_PFX_MIN((PfxInt32)s_numProfileThreads,SCE_PFX_MAX_PROFILE_THREADS);
+}
+
+//J 深さ優先順のnodeId番目のノードを探す
+//E Find the nodeId-th node in depth first order
+static PfxInt32 pfxGetProfileNodeInDepthFirstOrder(const PfxProfileThread &thread,PfxUInt32 nodeId)
+{
+	PfxInt32 i = thread.nodes[0].firstChild;
+	for(PfxUInt32 n=0;i>=0;n++) {
+		if(n == nodeId) return i;
+		if(thread.nodes[i].firstChild >= 0) {
+			i = thread.nodes[i].firstChild;
+			continue;
+		}
+		while(i > 0 && thread.nodes[i].nextSibling < 0) {
+			i = thread.nodes[i].parent;
+		}
+		if(i <= 0) break;
+		i = thread.nodes[i].nextSibling;
+	}
+	return -1;
+}
+
+PfxUInt32 pfxGetNumProfileNodes(PfxUInt32 threadId)
+{
+	if(threadId >= pfxGetNumProfileThreads()) return 0;
+	return s_profileThreads[threadId].numNodes - 1;
+}
+
+void pfxGetProfileStats(PfxUInt32 threadId,PfxUInt32 nodeId,PfxProfileStats &stats)
+{
+	memset(&stats,0,sizeof(stats));
+
+	if(threadId >= pfxGetNumProfileThreads()) return;
+
+	const PfxProfileThread &thread = s_profileThreads[threadId];
+	PfxInt32 i = pfxGetProfileNodeInDepthFirstOrder(thread,nodeId);
+	if(i < 0) return;
+
+	const PfxProfileNode &node = thread.nodes[i];
+	stats.name = node.name;
+	stats.depth = node.depth - 1;
+	stats.numFrames = node.numFrames;
+	if(node.numFrames == 0) return;
+
+	//J 履歴を昇順に並べてパーセンタイルを求める
+	//E Sort the history to find the percentile
+	PfxFloat sorted[SCE_PFX_PROFILE_HISTORY];
+	PfxUInt32 calls = 0;
+	PfxFloat sum = 0.0f;
+	for(PfxUInt32 f=0;f<node.numFrames;f++) {
+		PfxFloat v = node.history[f];
+		PfxUInt32 j = f;
+		for(;j>0 && sorted[j-1] > v;j--) {
+			sorted[j] = sorted[j-1];
+		}
+		sorted[j] = v;
+		sum += v;
+		calls += node.historyCalls[f];
+	}
+
+	PfxUInt32 p99 = (node.numFrames * 99 + 99) / 100 - 1;
+
+	stats.callsPerFrame = (PfxFloat)calls / node.numFrames;
+	stats.minTime = sorted[0];
+	stats.avgTime = sum / node.numFrames;
+	stats.p99Time = sorted[p99];
+	stats.maxTime = sorted[node.numFrames-1];
+}
+
+void pfxPrintProfile()
+{
+	SCE_PFX_PRINTF("*** PfxProfile results (ms per frame) ***\n");
+	PfxUInt32 numThreads = pfxGetNumProfileThreads();
+	for(PfxUInt32 t=0;t<numThreads;t++) {
+		SCE_PFX_PRINTF(" -- thread %u%s\n",t,s_profileThreads[t].numDroppedScopes > 0 ? " (scopes dropped)" : "");
+		SCE_PFX_PRINTF("    %-40s %8s %8s %8s %8s %8s %6s\n","name","calls","min","avg","p99","max","frames");
+		PfxUInt32 numNodes = pfxGetNumProfileNodes(t);
+		for(PfxUInt32 i=0;i<numNodes;i++) {
+			PfxProfileStats stats;
+			pfxGetProfileStats(t,i,stats);
+			if(stats.numFrames == 0) continue;
+			SCE_PFX_PRINTF("    %*s%-*s %8.1f %8.3f %8.3f %8.3f %8.3f %6u\n",
+				stats.depth*2,"",40-stats.depth*2,stats.name,
+				stats.callsPerFrame,stats.minTime,stats.avgTime,stats.p99Time,stats.maxTime,stats.numFrames);
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Trace
+
+struct PfxTraceEvent {
+	const char *name; // NULL at the end of a scope
+	PfxUInt64 ticks;
+};
+
+//J リングは128バイト境界に置き、他のスレッドのリングとキャッシュラインを共有しない
+//E Rings start on 128 byte boundaries so that no two threads share a cache line
+struct PfxTraceRing {
+	volatile PfxUInt32 head; // Events recorded since the start, the ring keeps the last capacity ones
+	PfxUInt32 capacity;
+	SCE_PFX_PADDING(1,8)
+	PfxTraceEvent events[1];
+};
+
+static PfxUInt8 *s_traceRings = NULL;
+static PfxUInt32 s_traceRingBytes = 0;
+static PfxUInt32 s_traceMaxThreads = 0;
+static volatile PfxInt32 s_traceNumThreads = 0;
+static volatile PfxUInt32 s_traceGeneration = 0;
+static volatile PfxBool s_traceEnabled = false;
+static PfxUInt64 s_traceStartTicks = 0;
+static PfxUInt64 s_traceStopTicks = 0;
+static SCE_PFX_THREAD_LOCAL PfxTraceRing *s_traceRing = NULL;
+static SCE_PFX_THREAD_LOCAL PfxUInt32 s_traceRingGeneration = 0;
+
+static PfxUInt32 pfxGetTraceCapacity(PfxUInt32 maxEvents)
+{
+	PfxUInt32 capacity = 1;
+	while(capacity * 2 <= maxEvents && capacity < 0x40000000) capacity *= 2;
+	return capacity;
+}
+
+static PfxUInt32 pfxGetTraceRingBytes(PfxUInt32 capacity)
+{
+	return SCE_PFX_BYTES_ALIGN128(sizeof(PfxTraceRing) + sizeof(PfxTraceEvent) * (capacity - 1));
+}
+
+PfxUInt32 pfxGetTraceBytesOfStartTrace(PfxUInt32 maxThreads,PfxUInt32 maxEvents)
+{
+	return 128 + maxThreads * pfxGetTraceRingBytes(pfxGetTraceCapacity(SCE_PFX_MAX(maxEvents,1)));
+}
+
+PfxInt32 pfxStartTrace(PfxStartTraceParam &param)
+{
+	if(!param.traceBuff || param.maxThreads == 0) return SCE_PFX_ERR_INVALID_VALUE;
+
+	PfxUInt32 availableBytes = SCE_PFX_AVAILABLE_BYTES_ALIGN128(param.traceBuff,param.traceBytes);
+	if(param.traceBytes < 128 || availableBytes < param.maxThreads * 128) return SCE_PFX_ERR_OUT_OF_BUFFER;
+
+	PfxUInt32 ringBytes = (availableBytes / param.maxThreads) & ~127u;
+	if(ringBytes < sizeof(PfxTraceRing)) return SCE_PFX_ERR_OUT_OF_BUFFER;
+
+	PfxUInt32 capacity = pfxGetTraceCapacity((PfxUInt32)((ringBytes - sizeof(PfxTraceRing)) / sizeof(PfxTraceEvent)) + 1);
+
+	s_traceEnabled = false;
+
+	s_traceRings = (PfxUInt8*)SCE_PFX_PTR_ALIGN128(param.traceBuff);
+	s_traceRingBytes = pfxGetTraceRingBytes(capacity);
+	s_traceMaxThreads = param.maxThreads;
+	for(PfxUInt32 i=0;i<s_traceMaxThreads;i++) {
+		PfxTraceRing *ring = (PfxTraceRing*)(s_traceRings + s_traceRingBytes * i);
+		ring->head = 0;
+		ring->capacity = capacity;
+	}
+
+	//J 世代を進め、各スレッドが次の記録時にリングを取り直すようにする
+	//E Advance the generation so that every thread takes a new ring on its next event
+	s_traceNumThreads = 0;
+	s_traceGeneration++;
+	s_traceStartTicks = s_traceStopTicks = pfxGetPerfTicks();
+	s_traceEnabled = true;
+
+	return SCE_PFX_OK;
+}
+
+void pfxStopTrace()
+{
+	if(!s_traceEnabled) return;
+	s_traceEnabled = false;
+	s_traceStopTicks = pfxGetPerfTicks();
+}
+
+static PfxTraceRing *pfxGetTraceRing()
+{
+	if(SCE_PFX_LIKELY(s_traceRingGeneration == s_traceGeneration)) return s_traceRing;
+
+	s_traceRingGeneration = s_traceGeneration;
+	s_traceRing = NULL;
+
+	//J スレッド数が上限を超えた場合、そのスレッドは記録しない
+	//E Threads beyond the limit are not recorded
+	PfxInt32 threadId = pfxAtomicFetchAndIncrement(&s_traceNumThreads);
+	if(threadId < (PfxInt32)s_traceMaxThreads) {
+		s_traceRing = (PfxTraceRing*)(s_traceRings + s_traceRingBytes * threadId);
+	}
+	return s_traceRing;
+}
+
+static SCE_PFX_FORCE_INLINE void pfxRecordTraceEvent(const char *name)
+{
+	PfxTraceRing *ring = pfxGetTraceRing();
+	if(!ring) return;
+
+	//J イベントを書いてからheadを進める。リングに書き込むのは所有スレッドだけ
+	//E Only the owning thread writes to a ring, the event is stored before head advances
+	PfxUInt32 head = ring->head;
+	PfxTraceEvent &ev = ring->events[head & (ring->capacity - 1)];
+	ev.name = name;
+	ev.ticks = pfxGetPerfTicks();
+	ring->head = head + 1;
+}
+
+void pfxPushTraceMarker(const char *name)
+{
+	if(SCE_PFX_LIKELY(!s_traceEnabled)) return;
+	pfxRecordTraceEvent(name);
+}
+
+void pfxPopTraceMarker()
+{
+	if(SCE_PFX_LIKELY(!s_traceEnabled)) return;
+	pfxRecordTraceEvent(NULL);
+}
+
+static void pfxWriteTraceString(FILE *fp,const char *str)
+{
+	fputc('"',fp);
+	for(const char *c=str;*c;c++) {
+		if(*c == '"' || *c == '\\') {
+			fputc('\\',fp);
+			fputc(*c,fp);
+		}
+		else if((PfxUInt8)*c < 0x20) {
+			fprintf(fp,"\\u%04x",(PfxUInt32)(PfxUInt8)*c);
+		}
+		else {
+			fputc(*c,fp);
+		}
+	}
+	fputc('"',fp);
+}
+
+PfxInt32 pfxWriteTrace(const char *filename)
+{
+	SCE_PFX_ASSERT(!s_traceEnabled);
+
+	FILE *fp = fopen(filename,"w");
+	if(!fp) return SCE_PFX_ERR_INVALID_VALUE;
+
+	//J タイムスタンプはトレース開始からのマイクロ秒
+	//E Time stamps are microseconds since the start of the trace
+	double usPerTick = 1000000.0 / (double)pfxGetPerfTicksPerSecond();
+
+	fprintf(fp,"{\"traceEvents\":[\n");
+	fprintf(fp,"{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"Physics Effects\"}}");
+
+	PfxUInt32 numThreads = SCE_PFX_MIN((PfxUInt32)s_traceNumThreads,s_traceMaxThreads);
+	for(PfxUInt32 t=0;t<numThreads;t++) {
+		const PfxTraceRing *ring = (const PfxTraceRing*)(s_traceRings + s_traceRingBytes * t);
+
+		fprintf(fp,",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",t,t);
+
+		//J 上書きされたイベントに対応する終了イベントは捨てる
+		//E Drop the ends of scopes whose beginning has been overwritten
+		PfxUInt32 head = ring->head;
+		PfxUInt32 first = head > ring->capacity ? head - ring->capacity : 0;
+		PfxUInt32 depth = 0;
+		for(PfxUInt32 i=first;i<head;i++) {
+			const PfxTraceEvent &ev = ring->events[i & (ring->capacity - 1)];
+			double ts = (double)(ev.ticks - s_traceStartTicks) * usPerTick;
+			if(ev.name) {
+				fprintf(fp,",\n{\"name\":");
+				pfxWriteTraceString(fp,ev.name);
+				fprintf(fp,",\"ph\":\"B\",\"pid\":0,\"tid\":%u,\"ts\":%.3f}",t,ts);
+				depth++;
+			}
+			else if(depth > 0) {
+				fprintf(fp,",\n{\"ph\":\"E\",\"pid\":0,\"tid\":%u,\"ts\":%.3f}",t,ts);
+				depth--;
+			}
+		}
+
+		//J 閉じていない区間を停止時刻で閉じる
+		//E Close the scopes still open at the stop time
+		double stopTs = (double)(s_traceStopTicks - s_traceStartTicks) * usPerTick;
+		for(;depth>0;depth--) {
+			fprintf(fp,",\n{\"ph\":\"E\",\"pid\":0,\"tid\":%u,\"ts\":%.3f}",t,stopTs);
+		}
+	}
+
+	fprintf(fp,"\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	PfxInt32 ret = ferror(fp) ? SCE_PFX_ERR_INVALID_VALUE : SCE_PFX_OK;
+	fclose(fp);
+	return ret;
+}
+
+#endif /* SCE_PFX_USE_PERFCOUNTER */
+
+} //namespace PhysicsEffects
+} //namespace sce
@@ -19,6 +19,83 @@ Physics Effects under the filename: physics_effects_license.txt
 namespace sce {
 namespace PhysicsEffects {
 
+// コリダブルのAABBの範囲でローカル座標を量子化する
+static SCE_PFX_FORCE_INLINE
+void pfxQuantizeShapeAabb(
+	const PfxVector3 &center,const PfxVector3 &half,
+	const PfxVector3 &aabbMin,const PfxVector3 &aabbMax,
+	PfxVecInt3 &quantizedMin,PfxVecInt3 &quantizedMax)
+{
+	const PfxVector3 sz(65535.0f);
+	PfxVector3 origin = center - half;
+	PfxVector3 scale = divPerElem(sz,maxPerElem(2.0f * half,PfxVector3(0.00001f)));
+
+	PfxVector3 qmin = mulPerElem(aabbMin - origin,scale);
+	qmin = minPerElem(maxPerElem(qmin,PfxVector3(0.0f)),sz);
+	PfxVector3 qmax = mulPerElem(aabbMax - origin,scale);
+	qmax = minPerElem(maxPerElem(qmax,PfxVector3(0.0f)),sz);
+
+	quantizedMin = PfxVecInt3(floorf(qmin[0]),floorf(qmin[1]),floorf(qmin[2]));
+	quantizedMax = PfxVecInt3(ceilf(qmax[0]),ceilf(qmax[1]),ceilf(qmax[2]));
+}
+
+static SCE_PFX_FORCE_INLINE
+PfxUInt32 pfxGetShapeCenter(const PfxAabb16 &aabb,int axis)
+{
+	return (PfxUInt32)pfxGetXYZMin(aabb,axis) + (PfxUInt32)pfxGetXYZMax(aabb,axis);
+}
+
+// 中心の分布が最も広い軸で半分に分割する。ノードは深さ優先順に並ぶ
+static
+void pfxBuildShapeBvh(PfxAabb16 *nodes,PfxUInt32 &numNodes,const PfxAabb16 *shapeAabbs,PfxUInt8 *ids,PfxInt32 numIds)
+{
+	PfxUInt32 nodeId = numNodes++;
+	PfxAabb16 &node = nodes[nodeId];
+
+	if(numIds == 1) {
+		node = shapeAabbs[ids[0]];
+		node.set16(6,ids[0]);
+		pfxSetBvhEscapeId(node,(PfxUInt16)(nodeId+1));
+		return;
+	}
+
+	PfxUInt32 centerMin[3] = {0xffffffff,0xffffffff,0xffffffff};
+	PfxUInt32 centerMax[3] = {0,0,0};
+
+	node = shapeAabbs[ids[0]];
+	for(PfxInt32 i=0;i<numIds;i++) {
+		const PfxAabb16 &aabb = shapeAabbs[ids[i]];
+		node = pfxMergeAabb(node,aabb);
+		for(int axis=0;axis<3;axis++) {
+			centerMin[axis] = SCE_PFX_MIN(centerMin[axis],pfxGetShapeCenter(aabb,axis));
+			centerMax[axis] = SCE_PFX_MAX(centerMax[axis],pfxGetShapeCenter(aabb,axis));
+		}
+	}
+
+	int splitAxis = 0;
+	for(int axis=1;axis<3;axis++) {
+		if(centerMax[axis] - centerMin[axis] > centerMax[splitAxis] - centerMin[splitAxis]) splitAxis = axis;
+	}
+
+	// 形状は高々SCE_PFX_NUMPRIMS個なので挿入ソートで並べる
+	for(PfxInt32 i=1;i<numIds;i++) {
+		PfxUInt8 id = ids[i];
+		PfxUInt32 center = pfxGetShapeCenter(shapeAabbs[id],splitAxis);
+		PfxInt32 j = i;
+		for(;j>0 && pfxGetShapeCenter(shapeAabbs[ids[j-1]],splitAxis) > center;j--) {
+			ids[j] = ids[j-1];
+		}
+		ids[j] = id;
+	}
+
+	PfxInt32 numLeft = numIds >> 1;
+	pfxBuildShapeBvh(nodes,numNodes,shapeAabbs,ids,numLeft);
+	pfxBuildShapeBvh(nodes,numNodes,shapeAabbs,ids+numLeft,numIds-numLeft);
+
+	nodes[nodeId].set16(6,SCE_PFX_COLLIDABLE_BVH_INTERNAL);
+	pfxSetBvhEscapeId(nodes[nodeId],(PfxUInt16)numNodes);
+}
+
 void PfxCollidable::addShape(const PfxShape &shape)
 {
 	if(m_numShapes<m_maxShapes) {
@@ -50,6 +127,66 @@ void PfxCollidable::finish()
 	m_half[0] = allHalf[0];
 	m_half[1] = allHalf[1];
 	m_half[2] = allHalf[2];
+
+	// 形状のBVHを作成
+	m_numBvhNodes = 0;
+	if(!m_bvhNodes || getNumShapes() < 2) return;
+
+	PfxAabb16 shapeAabbs[SCE_PFX_NUMPRIMS];
+	PfxUInt8 ids[SCE_PFX_NUMPRIMS];
+	for(PfxUInt32 i=0;i<getNumShapes();i++) {
+		PfxVector3 aabbMin,aabbMax;
+		getShape(i).getAabb(aabbMin,aabbMax);
+
+		PfxVecInt3 quantizedMin,quantizedMax;
+		pfxQuantizeShapeAabb(allCenter,allHalf,aabbMin,aabbMax,quantizedMin,quantizedMax);
+		pfxSetXMin(shapeAabbs[i],quantizedMin.getX());
+		pfxSetYMin(shapeAabbs[i],quantizedMin.getY());
+		pfxSetZMin(shapeAabbs[i],quantizedMin.getZ());
+		pfxSetXMax(shapeAabbs[i],quantizedMax.getX());
+		pfxSetYMax(shapeAabbs[i],quantizedMax.getY());
+		pfxSetZMax(shapeAabbs[i],quantizedMax.getZ());
+		ids[i] = (PfxUInt8)i;
+	}
+
+	PfxUInt32 numNodes = 0;
+	pfxBuildShapeBvh(m_bvhNodes,numNodes,shapeAabbs,ids,getNumShapes());
+	m_numBvhNodes = (PfxUInt8)numNodes;
+}
+
+PfxUInt64 PfxCollidable::getOverlappingShapes(const PfxVector3 &aabbMin,const PfxVector3 &aabbMax) const
+{
+	if(m_numBvhNodes == 0) return getAllShapes();
+
+	PfxVector3 center = getCenter();
+	PfxVector3 half = getHalf();
+	PfxVector3 collMin = center - half;
+	PfxVector3 collMax = center + half;
+	if(aabbMax[0] < collMin[0] || aabbMin[0] > collMax[0]) return 0;
+	if(aabbMax[1] < collMin[1] || aabbMin[1] > collMax[1]) return 0;
+	if(aabbMax[2] < collMin[2] || aabbMin[2] > collMax[2]) return 0;
+
+	PfxVecInt3 quantizedMin,quantizedMax;
+	pfxQuantizeShapeAabb(center,half,aabbMin,aabbMax,quantizedMin,quantizedMax);
+
+	// BVHを深さ優先で辿り、交差しないノードは部分木ごと飛ばす
+	PfxUInt64 shapes = 0;
+	PfxUInt32 n = 0;
+	while(n < m_numBvhNodes) {
+		const PfxAabb16 &node = m_bvhNodes[n];
+		if(!pfxTestAabb(node,quantizedMin,quantizedMax)) {
+			n = pfxGetBvhEscapeId(node);
+			continue;
+		}
+
+		PfxUInt32 shapeId = pfxGetBvhShapeId(node);
+		if(shapeId != SCE_PFX_COLLIDABLE_BVH_INTERNAL) {
+			shapes |= (PfxUInt64)1 << shapeId;
+		}
+		n++;
+	}
+
+	return shapes;
 }
 
 } //namespace PhysicsEffects
@@ -59,14 +59,60 @@ class PfxContactCache
 {
 private:
 	PfxUInt32 m_numContacts;
-	SCE_PFX_PADDING(1,12)
+	PfxUInt8 m_cachedAxisShapeIdA;
+	PfxUInt8 m_cachedAxisShapeIdB;
+	PfxUInt8 m_cachedAxisFlag;
+	SCE_PFX_PADDING(1,9)
+	PfxVector3 m_cachedAxis;
 	PfxCachedContactPoint m_cachedContactPoints[SCE_PFX_MAX_CACHED_CONTACT_POINTS];
 	
 	int findNearestContactPoint(const PfxPoint3 &newPoint,const PfxVector3 &newNormal);
 	int sort4ContactPoints(const PfxPoint3 &newPoint,PfxFloat newDistance);
 	
 public:
-	PfxContactCache() : m_numContacts(0) {}
+	PfxContactCache() : m_numContacts(0),m_cachedAxisFlag(0) {}
+
+	/*
+		GJKのウォームスタートに使う分離軸（形状Aのローカル座標）
+		ペアにつき1つだけ保持し、最初に書き込んだ形状の組み合わせが所有する
+		今回のフレームで更新されなかった分離軸はコンタクトへ書き戻さない
+	*/
+	enum {
+		CACHED_AXIS_VALID = 0x01,
+		CACHED_AXIS_UPDATED = 0x02,
+	};
+
+	void loadCachedAxis(PfxUInt8 shapeIdA,PfxUInt8 shapeIdB,const PfxVector3 &axis)
+	{
+		m_cachedAxisShapeIdA = shapeIdA;
+		m_cachedAxisShapeIdB = shapeIdB;
+		m_cachedAxis = axis;
+		m_cachedAxisFlag = CACHED_AXIS_VALID;
+	}
+
+	PfxBool getCachedAxis(PfxUInt8 shapeIdA,PfxUInt8 shapeIdB,PfxVector3 &axis) const
+	{
+		if(!(m_cachedAxisFlag & CACHED_AXIS_VALID) || m_cachedAxisShapeIdA != shapeIdA || m_cachedAxisShapeIdB != shapeIdB) return false;
+		axis = m_cachedAxis;
+		return true;
+	}
+
+	void setCachedAxis(PfxUInt8 shapeIdA,PfxUInt8 shapeIdB,const PfxVector3 &axis)
+	{
+		if((m_cachedAxisFlag & CACHED_AXIS_VALID) && (m_cachedAxisShapeIdA != shapeIdA || m_cachedAxisShapeIdB != shapeIdB)) return;
+		m_cachedAxisShapeIdA = shapeIdA;
+		m_cachedAxisShapeIdB = shapeIdB;
+		m_cachedAxis = axis;
+		m_cachedAxisFlag = CACHED_AXIS_VALID | CACHED_AXIS_UPDATED;
+	}
+
+	PfxBool isCachedAxisUpdated() const {return (m_cachedAxisFlag & CACHED_AXIS_UPDATED) != 0;}
+
+	PfxUInt8 getCachedAxisShapeIdA() const {return m_cachedAxisShapeIdA;}
+
+	PfxUInt8 getCachedAxisShapeIdB() const {return m_cachedAxisShapeIdB;}
+
+	const PfxVector3 &getCachedAxis() const {return m_cachedAxis;}
 	
 	void addContactPoint(
 		PfxFloat newDistance,
@@ -0,0 +1,347 @@
+/*
+Physics Effects Copyright(C) 2011 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#include "../../../include/physics_effects/base_level/base/pfx_vec_utils.h"
+#include "pfx_contact_tri_mesh_sphere.h"
+#include "pfx_contact_tri_mesh_box.h"
+#include "pfx_contact_tri_mesh_capsule.h"
+#include "pfx_contact_tri_mesh_cylinder.h"
+#include "pfx_contact_tri_mesh_convex.h"
+#include "pfx_contact_height_field.h"
+
+
+namespace sce {
+namespace PhysicsEffects {
+
+// 一度に判定するセルの範囲。PfxTriMeshの面数の上限に収まる大きさ
+#define SCE_PFX_HEIGHTFIELD_TILE_X 8
+#define SCE_PFX_HEIGHTFIELD_TILE_Z 4
+
+// 2面のなす角からエッジの凹凸を判定する。pfxCreateLargeTriMeshと同じ判定
+static
+void pfxCalcEdgeAngle(
+				PfxEdge &edge,
+				const PfxVector3 &pntOnEdge,
+				const PfxVector3 &normalA,const PfxVector3 &oppositeA,
+				const PfxVector3 &normalB,const PfxVector3 &oppositeB)
+{
+	const PfxFloat epsilon = 0.00001f;
+
+	PfxVector3 midPnt = (oppositeA + oppositeB) * 0.5f;
+
+	PfxFloat chk1 = dot(normalA,midPnt-pntOnEdge);
+	PfxFloat chk2 = dot(normalB,midPnt-pntOnEdge);
+
+	if(chk1 < -epsilon && chk2 < -epsilon) {
+		edge.m_angleType = SCE_PFX_EDGE_CONVEX;
+		PfxFloat angle = 0.5f*acosf(SCE_PFX_CLAMP(dot(normalA,normalB),-1.0f,1.0f));
+		edge.m_tilt = (PfxUInt8)((angle/(0.5f*SCE_PFX_PI))*255.0f);
+	}
+	else if(chk1 > epsilon && chk2 > epsilon) {
+		edge.m_angleType = SCE_PFX_EDGE_CONCAVE;
+		edge.m_tilt = 0;
+	}
+	else {
+		edge.m_angleType = SCE_PFX_EDGE_FLAT;
+		edge.m_tilt = 0;
+	}
+}
+
+static SCE_PFX_FORCE_INLINE
+PfxVector3 pfxGetFacetNormal(const PfxVector3 *pnts)
+{
+	return normalize(cross(pnts[2]-pnts[1],pnts[0]-pnts[1]));
+}
+
+// セル(cellX,cellZ)の三角形triangleのエッジedgeIdと、そのエッジを共有する隣の三角形から凹凸を判定する
+// エッジ0:頂点0-1 エッジ1:頂点1-2 エッジ2:頂点2-0
+// 三角形0のエッジ0は左隣のセルの三角形1、エッジ1は上隣のセルの三角形1、エッジ2は同じセルの三角形1と共有する
+// 三角形1のエッジ1は右隣のセルの三角形0、エッジ2は下隣のセルの三角形0と共有する
+// ハイトフィールドの外周のエッジは凸とする
+static
+void pfxCalcHeightFieldEdge(
+				PfxEdge &edge,
+				const PfxHeightField &field,
+				PfxInt32 cellX,PfxInt32 cellZ,PfxUInt32 triangle,PfxUInt32 edgeId)
+{
+	PfxInt32 neighborX = cellX,neighborZ = cellZ;
+	PfxUInt32 neighborTriangle = 1 - triangle;
+	PfxUInt32 neighborEdgeId = edgeId;
+
+	if(triangle == 0) {
+		if(edgeId == 0) {neighborX--;neighborEdgeId = 1;}
+		else if(edgeId == 1) {neighborZ++;neighborEdgeId = 2;}
+		else {neighborEdgeId = 0;}
+	}
+	else {
+		if(edgeId == 1) {neighborX++;neighborEdgeId = 0;}
+		else if(edgeId == 2) {neighborZ--;neighborEdgeId = 1;}
+		else {neighborEdgeId = 2;}
+	}
+
+	if(neighborX < 0 || neighborX >= (PfxInt32)field.getNumCellsX() ||
+	   neighborZ < 0 || neighborZ >= (PfxInt32)field.getNumCellsZ()) {
+		edge.m_angleType = SCE_PFX_EDGE_CONVEX;
+		edge.m_tilt = 0;
+		return;
+	}
+
+	PfxVector3 pntsA[3],pntsB[3];
+	field.getTriangle(cellX,cellZ,triangle,pntsA);
+	field.getTriangle(neighborX,neighborZ,neighborTriangle,pntsB);
+
+	pfxCalcEdgeAngle(edge,pntsA[edgeId],
+		pfxGetFacetNormal(pntsA),pntsA[(edgeId+2)%3],
+		pfxGetFacetNormal(pntsB),pntsB[(neighborEdgeId+2)%3]);
+}
+
+// セルの範囲をPfxTriMeshに展開する。高さの範囲がAABBと交差しない場合はfalse
+// 頂点は(numCellsX+1)*(numCellsZ+1)個、エッジはX方向、Z方向、対角線の順に並べる
+static
+bool pfxCreateHeightFieldTile(
+				PfxTriMesh &tile,
+				const PfxHeightField &field,
+				PfxUInt32 startX,PfxUInt32 startZ,PfxUInt32 numCellsX,PfxUInt32 numCellsZ,
+				const PfxVector3 &aabbMin,const PfxVector3 &aabbMax)
+{
+	PfxUInt32 numVertsX = numCellsX + 1;
+	PfxUInt32 numVertsZ = numCellsZ + 1;
+
+	PfxFloat minHeight = SCE_PFX_FLT_MAX;
+	PfxFloat maxHeight = -SCE_PFX_FLT_MAX;
+	for(PfxUInt32 z=0;z<numVertsZ;z++) {
+		for(PfxUInt32 x=0;x<numVertsX;x++) {
+			PfxFloat h = field.getHeight(startX+x,startZ+z);
+			minHeight = SCE_PFX_MIN(minHeight,h);
+			maxHeight = SCE_PFX_MAX(maxHeight,h);
+		}
+	}
+
+	if(aabbMin[1] > maxHeight || aabbMax[1] < minHeight - field.m_thickness) return false;
+
+	for(PfxUInt32 z=0;z<numVertsZ;z++) {
+		for(PfxUInt32 x=0;x<numVertsX;x++) {
+			tile.m_verts[z*numVertsX+x] = field.getVertex(startX+x,startZ+z);
+		}
+	}
+
+	PfxUInt32 edgeBaseZ = numCellsX * numVertsZ;
+	PfxUInt32 edgeBaseDiagonal = edgeBaseZ + numVertsX * numCellsZ;
+
+	for(PfxUInt32 z=0;z<numCellsZ;z++) {
+		for(PfxUInt32 x=0;x<numCellsX;x++) {
+			PfxUInt8 v00 = (PfxUInt8)(z*numVertsX+x);
+			PfxUInt8 v10 = (PfxUInt8)(v00+1);
+			PfxUInt8 v01 = (PfxUInt8)(v00+numVertsX);
+			PfxUInt8 v11 = (PfxUInt8)(v01+1);
+
+			PfxUInt8 eBottom = (PfxUInt8)(z*numCellsX+x);
+			PfxUInt8 eTop = (PfxUInt8)(eBottom+numCellsX);
+			PfxUInt8 eLeft = (PfxUInt8)(edgeBaseZ+z*numVertsX+x);
+			PfxUInt8 eRight = (PfxUInt8)(eLeft+1);
+			PfxUInt8 eDiagonal = (PfxUInt8)(edgeBaseDiagonal+z*numCellsX+x);
+
+			PfxUInt8 vertIds[2][3] = {{v00,v01,v11},{v00,v11,v10}};
+			PfxUInt8 edgeIds[2][3] = {{eLeft,eTop,eDiagonal},{eDiagonal,eRight,eBottom}};
+
+			for(PfxUInt32 t=0;t<2;t++) {
+				PfxFacet &facet = tile.m_facets[(z*numCellsX+x)*2+t];
+				PfxVector3 pnts[3] = {
+					tile.m_verts[vertIds[t][0]],
+					tile.m_verts[vertIds[t][1]],
+					tile.m_verts[vertIds[t][2]],
+				};
+				pfxStoreVector3(pfxGetFacetNormal(pnts),facet.m_normal);
+				facet.m_thickness = field.m_thickness;
+				facet.m_group = 0;
+				facet.m_userData = 0;
+
+				for(PfxUInt32 e=0;e<3;e++) {
+					facet.m_vertIds[e] = vertIds[t][e];
+					facet.m_edgeIds[e] = edgeIds[t][e];
+
+					PfxEdge &edge = tile.m_edges[edgeIds[t][e]];
+					edge.m_vertId[0] = vertIds[t][e];
+					edge.m_vertId[1] = vertIds[t][(e+1)%3];
+				}
+
+				// 共有するエッジは一方の三角形から判定する
+				// 三角形0は左と対角線、三角形1は下のエッジを担当し、タイルの上端と右端はそれぞれ最後の行と列で判定する
+				if(t == 0) {
+					pfxCalcHeightFieldEdge(tile.m_edges[eLeft],field,startX+x,startZ+z,0,0);
+					pfxCalcHeightFieldEdge(tile.m_edges[eDiagonal],field,startX+x,startZ+z,0,2);
+					if(z == numCellsZ-1) pfxCalcHeightFieldEdge(tile.m_edges[eTop],field,startX+x,startZ+z,0,1);
+				}
+				else {
+					pfxCalcHeightFieldEdge(tile.m_edges[eBottom],field,startX+x,startZ+z,1,2);
+					if(x == numCellsX-1) pfxCalcHeightFieldEdge(tile.m_edges[eRight],field,startX+x,startZ+z,1,1);
+				}
+			}
+		}
+	}
+
+	tile.m_numVerts = (PfxUInt8)(numVertsX * numVertsZ);
+	tile.m_numEdges = (PfxUInt8)(edgeBaseDiagonal + numCellsX * numCellsZ);
+	tile.m_numFacets = (PfxUInt8)(numCellsX * numCellsZ * 2);
+	tile.updateAABB();
+
+	return true;
+}
+
+static
+void pfxContactTile(
+				PfxContactCache &contacts,
+				const PfxHeightField *fieldA,const PfxTriMesh *tile,
+				PfxUInt32 startX,PfxUInt32 startZ,PfxUInt32 numCellsX,
+				const PfxTransform3 &transformA,
+				const PfxShape &shapeB,
+				const PfxTransform3 &transformB,
+				PfxFloat distanceThreshold)
+{
+	// 衝突判定
+	PfxContactCache localContacts;
+	switch(shapeB.getType()) {
+		case kPfxShapeSphere:
+		pfxContactTriMeshSphere(localContacts,tile,transformA,shapeB.getSphere(),transformB,distanceThreshold);
+		break;
+
+		case kPfxShapeCapsule:
+		pfxContactTriMeshCapsule(localContacts,tile,transformA,shapeB.getCapsule(),transformB,distanceThreshold);
+		break;
+
+		case kPfxShapeBox:
+		pfxContactTriMeshBox(localContacts,tile,transformA,shapeB.getBox(),transformB,distanceThreshold);
+		break;
+
+		case kPfxShapeCylinder:
+		pfxContactTriMeshCylinder(localContacts,tile,transformA,shapeB.getCylinder(),transformB,distanceThreshold);
+		break;
+
+		case kPfxShapeConvexMesh:
+		pfxContactTriMeshConvex(localContacts,tile,transformA,*shapeB.getConvexMesh(),transformB,distanceThreshold);
+		break;
+
+		default:
+		break;
+	}
+
+	// 衝突点を追加。タイル内の面番号をハイトフィールドの三角形に変換する
+	for(int j=0;j<localContacts.getNumContacts();j++) {
+		PfxSubData subData = localContacts.getSubData(j);
+		PfxUInt32 facetId = subData.getFacetId();
+		PfxUInt32 cellId = facetId >> 1;
+		fieldA->setFacet(subData,startX + cellId % numCellsX,startZ + cellId / numCellsX,facetId & 1);
+		contacts.addContactPoint(
+			localContacts.getDistance(j),
+			localContacts.getNormal(j),
+			localContacts.getLocalPointA(j),
+			localContacts.getLocalPointB(j),
+			subData);
+	}
+}
+
+PfxInt32 pfxContactHeightField(
+				PfxContactCache &contacts,
+				const PfxHeightField *fieldA,
+				const PfxTransform3 &transformA,
+				const PfxShape &shapeB,
+				const PfxTransform3 &transformB,
+				PfxFloat distanceThreshold)
+{
+	PfxTransform3 transformAB;
+	PfxMatrix3 matrixAB;
+	PfxVector3 offsetAB;
+
+	// Bローカル→Aローカルへの変換
+	transformAB = orthoInverse(transformA) * transformB;
+	matrixAB = transformAB.getUpper3x3();
+	offsetAB = transformAB.getTranslation();
+
+	// -----------------------------------------------------
+	// 凸体のAABBと重なるセルを求め、タイルごとに衝突判定する。※HeightField座標系
+
+	PfxVector3 shapeHalf(0.0f);
+	PfxVector3 shapeCenter = offsetAB;
+
+	switch(shapeB.getType()) {
+		case kPfxShapeSphere:
+		shapeHalf = PfxVector3(shapeB.getSphere().m_radius);
+		break;
+
+		case kPfxShapeCapsule:
+		{
+			PfxCapsule capsule = shapeB.getCapsule();
+			shapeHalf = absPerElem(matrixAB) * PfxVector3(capsule.m_halfLen+capsule.m_radius,capsule.m_radius,capsule.m_radius);
+		}
+		break;
+
+		case kPfxShapeCylinder:
+		{
+			PfxCylinder cylinder = shapeB.getCylinder();
+			shapeHalf = absPerElem(matrixAB) * PfxVector3(cylinder.m_halfLen,cylinder.m_radius,cylinder.m_radius);
+		}
+		break;
+
+		case kPfxShapeBox:
+		shapeHalf = absPerElem(matrixAB) * shapeB.getBox().m_half;
+		break;
+
+		case kPfxShapeConvexMesh:
+		shapeHalf = absPerElem(matrixAB) * shapeB.getConvexMesh()->m_half;
+		break;
+
+		default:
+		return 0;
+	}
+
+	PfxVector3 aabbMin = shapeCenter - shapeHalf;
+	PfxVector3 aabbMax = shapeCenter + shapeHalf;
+
+	if(aabbMax[0] < -fieldA->m_half[0] || aabbMin[0] > fieldA->m_half[0] ||
+	   aabbMax[2] < -fieldA->m_half[2] || aabbMin[2] > fieldA->m_half[2] ||
+	   aabbMin[1] > fieldA->m_maxHeight || aabbMax[1] < fieldA->m_minHeight - fieldA->m_thickness) {
+		return 0;
+	}
+
+	// 重なるセルの範囲
+	PfxInt32 numCellsX = (PfxInt32)fieldA->getNumCellsX();
+	PfxInt32 numCellsZ = (PfxInt32)fieldA->getNumCellsZ();
+	PfxInt32 startX = (PfxInt32)floorf((aabbMin[0] + fieldA->m_half[0]) / fieldA->m_cellSizeX);
+	PfxInt32 startZ = (PfxInt32)floorf((aabbMin[2] + fieldA->m_half[2]) / fieldA->m_cellSizeZ);
+	PfxInt32 endX = (PfxInt32)floorf((aabbMax[0] + fieldA->m_half[0]) / fieldA->m_cellSizeX);
+	PfxInt32 endZ = (PfxInt32)floorf((aabbMax[2] + fieldA->m_half[2]) / fieldA->m_cellSizeZ);
+	startX = SCE_PFX_CLAMP(startX,0,numCellsX-1);
+	startZ = SCE_PFX_CLAMP(startZ,0,numCellsZ-1);
+	endX = SCE_PFX_CLAMP(endX,0,numCellsX-1);
+	endZ = SCE_PFX_CLAMP(endZ,0,numCellsZ-1);
+
+	// -----------------------------------------------------
+	// タイルとの衝突判定
+
+	PfxTriMesh tile;
+	for(PfxInt32 tileZ=startZ;tileZ<=endZ;tileZ+=SCE_PFX_HEIGHTFIELD_TILE_Z) {
+		PfxUInt32 tileCellsZ = SCE_PFX_MIN(endZ-tileZ+1,SCE_PFX_HEIGHTFIELD_TILE_Z);
+		for(PfxInt32 tileX=startX;tileX<=endX;tileX+=SCE_PFX_HEIGHTFIELD_TILE_X) {
+			PfxUInt32 tileCellsX = SCE_PFX_MIN(endX-tileX+1,SCE_PFX_HEIGHTFIELD_TILE_X);
+			if(!pfxCreateHeightFieldTile(tile,*fieldA,tileX,tileZ,tileCellsX,tileCellsZ,aabbMin,aabbMax)) continue;
+			pfxContactTile(contacts,fieldA,&tile,tileX,tileZ,tileCellsX,transformA,shapeB,transformB,distanceThreshold);
+		}
+	}
+
+	return contacts.getNumContacts();
+}
+} //namespace PhysicsEffects
+} //namespace sce
@@ -29,6 +29,57 @@ namespace sce {
 namespace PhysicsEffects {
 
 
+static
+void pfxContactIsland(
+				PfxContactCache &contacts,
+				const PfxLargeTriMesh *lmeshA,PfxUInt32 islandId,
+				const PfxTransform3 &transformA,
+				const PfxShape &shapeB,
+				const PfxTransform3 &transformB,
+				PfxFloat distanceThreshold)
+{
+	PfxTriMesh *island = &lmeshA->m_islands[islandId];
+
+	// 衝突判定
+	PfxContactCache localContacts;
+	switch(shapeB.getType()) {
+		case kPfxShapeSphere:
+		pfxContactTriMeshSphere(localContacts,island,transformA,shapeB.getSphere(),transformB,distanceThreshold);
+		break;
+		
+		case kPfxShapeCapsule:
+		pfxContactTriMeshCapsule(localContacts,island,transformA,shapeB.getCapsule(),transformB,distanceThreshold);
+		break;
+		
+		case kPfxShapeBox:
+		pfxContactTriMeshBox(localContacts,island,transformA,shapeB.getBox(),transformB,distanceThreshold);
+		break;
+		
+		case kPfxShapeCylinder:
+		pfxContactTriMeshCylinder(localContacts,island,transformA,shapeB.getCylinder(),transformB,distanceThreshold);
+		break;
+		
+		case kPfxShapeConvexMesh:
+		pfxContactTriMeshConvex(localContacts,island,transformA,*shapeB.getConvexMesh(),transformB,distanceThreshold);
+		break;
+		
+		default:
+		break;
+	}
+
+	// 衝突点を追加
+	for(int j=0;j<localContacts.getNumContacts();j++) {
+		PfxSubData subData = localContacts.getSubData(j);
+		subData.setIslandId(islandId);
+		contacts.addContactPoint(
+			localContacts.getDistance(j),
+			localContacts.getNormal(j),
+			localContacts.getLocalPointA(j),
+			localContacts.getLocalPointB(j),
+			subData);
+	}
+}
+
 PfxInt32 pfxContactLargeTriMesh(
 				PfxContactCache &contacts,
 				const PfxLargeTriMesh *lmeshA,
@@ -91,60 +142,32 @@ PfxInt32 pfxContactLargeTriMesh(
 	PfxVecInt3 aabbMinL,aabbMaxL;
 	lmeshA->getLocalPosition((shapeCenter-shapeHalf),(shapeCenter+shapeHalf),aabbMinL,aabbMaxL);
 	
-	PfxUInt32 numIslands = lmeshA->m_numIslands;
-
-	{
-	for(PfxUInt32 i=0;i<numIslands;i++) {
-		// AABBチェック
-		PfxAabb16 aabbB = lmeshA->m_aabbList[i];
-		if(aabbMaxL.getX() < pfxGetXMin(aabbB) || aabbMinL.getX() > pfxGetXMax(aabbB)) continue;
-		if(aabbMaxL.getY() < pfxGetYMin(aabbB) || aabbMinL.getY() > pfxGetYMax(aabbB)) continue;
-		if(aabbMaxL.getZ() < pfxGetZMin(aabbB) || aabbMinL.getZ() > pfxGetZMax(aabbB)) continue;
-		
-		PfxTriMesh *island = &lmeshA->m_islands[i];
-
-			// 衝突判定
-			PfxContactCache localContacts;
-			switch(shapeB.getType()) {
-				case kPfxShapeSphere:
-				pfxContactTriMeshSphere(localContacts,island,transformA,shapeB.getSphere(),transformB,distanceThreshold);
-				break;
-				
-				case kPfxShapeCapsule:
-				pfxContactTriMeshCapsule(localContacts,island,transformA,shapeB.getCapsule(),transformB,distanceThreshold);
-				break;
-				
-				case kPfxShapeBox:
-				pfxContactTriMeshBox(localContacts,island,transformA,shapeB.getBox(),transformB,distanceThreshold);
-				break;
-				
-				case kPfxShapeCylinder:
-				pfxContactTriMeshCylinder(localContacts,island,transformA,shapeB.getCylinder(),transformB,distanceThreshold);
-				break;
-				
-				case kPfxShapeConvexMesh:
-			pfxContactTriMeshConvex(localContacts,island,transformA,*shapeB.getConvexMesh(),transformB,distanceThreshold);
-				break;
-				
-				default:
-				break;
+	if(lmeshA->m_bvhNodes) {
+		// BVHを深さ優先で辿り、交差しないノードは部分木ごと飛ばす
+		PfxUInt32 numNodes = lmeshA->m_numBvhNodes;
+		PfxUInt32 n = 0;
+		while(n < numNodes) {
+			const PfxAabb16 &node = lmeshA->m_bvhNodes[n];
+			if(!pfxTestAabb(node,aabbMinL,aabbMaxL)) {
+				n = pfxGetBvhEscapeId(node);
+				continue;
 			}
 
-			
-			// 衝突点を追加
-			for(int j=0;j<localContacts.getNumContacts();j++) {
-				PfxSubData subData = localContacts.getSubData(j);
-				subData.setIslandId(i);
-				contacts.addContactPoint(
-					localContacts.getDistance(j),
-					localContacts.getNormal(j),
-					localContacts.getLocalPointA(j),
-					localContacts.getLocalPointB(j),
-					subData);
+			PfxUInt32 islandId = pfxGetBvhIslandId(node);
+			if(islandId != SCE_PFX_LARGETRIMESH_BVH_INTERNAL) {
+				pfxContactIsland(contacts,lmeshA,islandId,transformA,shapeB,transformB,distanceThreshold);
 			}
+			n++;
+		}
+	}
+	else {
+		PfxUInt32 numIslands = lmeshA->m_numIslands;
+		for(PfxUInt32 i=0;i<numIslands;i++) {
+			// AABBチェック
+			if(!pfxTestAabb(lmeshA->m_aabbList[i],aabbMinL,aabbMaxL)) continue;
+			pfxContactIsland(contacts,lmeshA,i,transformA,shapeB,transformB,distanceThreshold);
 		}
 	}
-
 
 	return contacts.getNumContacts();
 }
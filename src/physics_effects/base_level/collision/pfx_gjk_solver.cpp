@@ -57,6 +57,7 @@ vertsW = g_vertsW;
 facets = g_facets;
 facetsHead = g_facetsHead;
 edges = g_edges;
+m_hasSeparatingAxis = false;
 }
 
 PfxGjkSolver::~PfxGjkSolver()
@@ -72,6 +73,8 @@ void PfxGjkSolver::setup(void *sA,void *sB,PfxGetSupportVertexFunc fA,PfxGetSupp
 	shapeB = sB;
 	getSupportVertexShapeA = fA;
 	getSupportVertexShapeB = fB;
+	supportHintA = 0;
+	supportHintB = 0;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -158,8 +161,8 @@ PfxFloat PfxGjkSolver::detectPenetrationDepth(
 
 		for(int i=0;i<3;i++) {
 			PfxVector3 pInA,qInB;
-			getSupportVertexShapeA(shapeA,invRotA * aux[i],pInA);
-			getSupportVertexShapeB(shapeB,invRotB * (-aux[i]),qInB);
+			getSupportVertexShapeA(shapeA,invRotA * aux[i],pInA,supportHintA);
+			getSupportVertexShapeB(shapeB,invRotB * (-aux[i]),qInB,supportHintB);
 			p[i] = transformA.getTranslation() + transformA.getUpper3x3() * pInA;
 			q[i] = transformB.getTranslation() + transformB.getUpper3x3() * qInB;
 			w[i] = p[i] - q[i];
@@ -197,13 +200,13 @@ PfxFloat PfxGjkSolver::detectPenetrationDepth(
 		{
 			PfxVector3 v = cross(vertsW[2]-vertsW[0],vertsW[1]-vertsW[0]);
 			PfxVector3 pInA,qInB;
-			getSupportVertexShapeA(shapeA,invRotA * v,pInA);
-			getSupportVertexShapeB(shapeB,invRotB * (-v),qInB);
+			getSupportVertexShapeA(shapeA,invRotA * v,pInA,supportHintA);
+			getSupportVertexShapeB(shapeB,invRotB * (-v),qInB,supportHintB);
 			p[0] = transformA.getTranslation() + transformA.getUpper3x3() * pInA;
 			q[0] = transformB.getTranslation() + transformB.getUpper3x3() * qInB;
 			w[0] = p[0] - q[0];
-			getSupportVertexShapeA(shapeA,invRotA * (-v),pInA);
-			getSupportVertexShapeB(shapeB,invRotB * v,qInB);
+			getSupportVertexShapeA(shapeA,invRotA * (-v),pInA,supportHintA);
+			getSupportVertexShapeB(shapeB,invRotB * v,qInB,supportHintB);
 			p[1] = transformA.getTranslation() + transformA.getUpper3x3() * pInA;
 			q[1] = transformB.getTranslation() + transformB.getUpper3x3() * qInB;
 			w[1] = p[1] - q[1];
@@ -288,8 +291,8 @@ PfxFloat PfxGjkSolver::detectPenetrationDepth(
 		facetsHead[minFacetIdx] = facetsHead[--numFacetsHead];
 
 		PfxVector3 pInA(0.0f),qInB(0.0f);
-		getSupportVertexShapeA(shapeA,invRotA * facetMin->normal,pInA);
-		getSupportVertexShapeB(shapeB,invRotB * (-facetMin->normal),qInB);
+		getSupportVertexShapeA(shapeA,invRotA * facetMin->normal,pInA,supportHintA);
+		getSupportVertexShapeB(shapeB,invRotB * (-facetMin->normal),qInB,supportHintB);
 		PfxVector3 p = transformA.getTranslation() + transformA.getUpper3x3() * pInA;
 		PfxVector3 q = transformB.getTranslation() + transformB.getUpper3x3() * qInB;
 		PfxVector3 w = p - q;
@@ -411,8 +414,11 @@ PfxFloat PfxGjkSolver::collide( PfxVector3& normal, PfxPoint3 &pointA, PfxPoint3
 	cTransformA.setTranslation(cTransformA.getTranslation()-offset);
 	cTransformB.setTranslation(cTransformB.getTranslation()-offset);
 
+	// 前回の分離軸があればそこから探索を始める
 	PfxVector3 separatingAxis(-cTransformA.getTranslation());
+	if(m_hasSeparatingAxis && lengthSqr(m_separatingAxis) >= 0.000001f) separatingAxis = m_separatingAxis;
 	if(lengthSqr(separatingAxis) < 0.000001f) separatingAxis = PfxVector3(1.0,0.0,0.0);
+	m_hasSeparatingAxis = false;
 	PfxFloat squaredDistance = SCE_PFX_FLT_MAX;
 	PfxFloat delta = 0.0f;
 	PfxFloat distance = SCE_PFX_FLT_MAX;
@@ -421,8 +427,8 @@ PfxFloat PfxGjkSolver::collide( PfxVector3& normal, PfxPoint3 &pointA, PfxPoint3
 		// サポート頂点の取得
 		PfxVector3 pInA,qInB;
 
-		getSupportVertexShapeA(shapeA,invRotA * (-separatingAxis),pInA);
-		getSupportVertexShapeB(shapeB,invRotB * separatingAxis,qInB);
+		getSupportVertexShapeA(shapeA,invRotA * (-separatingAxis),pInA,supportHintA);
+		getSupportVertexShapeB(shapeB,invRotB * separatingAxis,qInB,supportHintB);
 
 		PfxVector3 p = cTransformA.getTranslation() + cTransformA.getUpper3x3() * pInA;
 		PfxVector3 q = cTransformB.getTranslation() + cTransformB.getUpper3x3() * qInB;
@@ -433,6 +439,8 @@ PfxFloat PfxGjkSolver::collide( PfxVector3& normal, PfxPoint3 &pointA, PfxPoint3
 		// 早期終了チェック
 		if(SCE_PFX_UNLIKELY(delta > 0.0f)) {
 			normal = separatingAxis;
+			m_separatingAxis = separatingAxis;
+			m_hasSeparatingAxis = true;
 			return distance;
 		}
 
@@ -477,6 +485,8 @@ PfxFloat PfxGjkSolver::collide( PfxVector3& normal, PfxPoint3 &pointA, PfxPoint3
 		dist = dot(normal,pA-pB);
 		pointA = orthoInverse(transformA)*PfxPoint3(pA+offset);
 		pointB = orthoInverse(transformB)*PfxPoint3(pB+offset);
+		m_separatingAxis = normal;
+		m_hasSeparatingAxis = true;
 	}
 
 	return dist;
@@ -32,7 +32,8 @@ namespace PhysicsEffects {
 ///////////////////////////////////////////////////////////////////////////////
 // Support Function
 
-typedef void (*PfxGetSupportVertexFunc)(void *shape,const PfxVector3 &seperatingAxis,PfxVector3 &supportVertex);
+// hintは形状ごとに前回の探索結果を保持する（凸メッシュは前回のサポート頂点）
+typedef void (*PfxGetSupportVertexFunc)(void *shape,const PfxVector3 &seperatingAxis,PfxVector3 &supportVertex,PfxUInt32 &hint);
 
 ///////////////////////////////////////////////////////////////////////////////
 // Gjk
@@ -111,12 +112,24 @@ private:
 	void *shapeB;
 	PfxGetSupportVertexFunc getSupportVertexShapeA;
 	PfxGetSupportVertexFunc getSupportVertexShapeB;
+	PfxUInt32 supportHintA;
+	PfxUInt32 supportHintB;
+
+	// 前回の分離軸（ワールド座標）
+	PfxVector3 m_separatingAxis;
+	PfxBool m_hasSeparatingAxis;
 
 public:
 	PfxGjkSolver();
 	~PfxGjkSolver();
 	
 	void setup(void *sA,void *sB,PfxGetSupportVertexFunc fA,PfxGetSupportVertexFunc fB);
+
+	// collide()の探索を始める分離軸を与える（前フレームの結果によるウォームスタート）
+	void setSeparatingAxis(const PfxVector3 &axis) {m_separatingAxis = axis;m_hasSeparatingAxis = true;}
+
+	// collide()が求めた分離軸。分離している場合はGJKの分離軸、交差している場合は法線
+	PfxBool getSeparatingAxis(PfxVector3 &axis) const {axis = m_separatingAxis;return m_hasSeparatingAxis;}
 	
 	PfxFloat collide( PfxVector3& normal, PfxPoint3 &pointA, PfxPoint3 &pointB,
 					const PfxTransform3 & transformA,
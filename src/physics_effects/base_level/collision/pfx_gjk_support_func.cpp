@@ -30,8 +30,9 @@ namespace PhysicsEffects {
 ///////////////////////////////////////////////////////////////////////////////
 // Support Function
 
-void pfxGetSupportVertexTriangle(void *shape,const PfxVector3 &seperatingAxis,PfxVector3 &supportVertex)
+void pfxGetSupportVertexTriangle(void *shape,const PfxVector3 &seperatingAxis,PfxVector3 &supportVertex,PfxUInt32 &hint)
 {
+	(void)hint;
 	PfxVector3 *vtx = (PfxVector3*)shape;
 	
 PfxFloat d0 = dot(vtx[0],seperatingAxis);
@@ -50,8 +51,9 @@ else if(d1 > d2) {
 	supportVertex = vtx[reti] + SCE_PFX_GJK_MARGIN * normalize(seperatingAxis);
 }
 
-void pfxGetSupportVertexTriangleWithThickness(void *shape,const PfxVector3 &seperatingAxis,PfxVector3 &supportVertex)
+void pfxGetSupportVertexTriangleWithThickness(void *shape,const PfxVector3 &seperatingAxis,PfxVector3 &supportVertex,PfxUInt32 &hint)
 {
+	(void)hint;
 	PfxVector3 *vtx = (PfxVector3*)shape;
 	
 PfxFloat d[6];
@@ -72,23 +74,94 @@ for(int i=1;i<6;i++) {
 	supportVertex = vtx[reti] + SCE_PFX_GJK_MARGIN * normalize(seperatingAxis);
 }
 
-void pfxGetSupportVertexConvex(void *shape,const PfxVector3 &seperatingAxis,PfxVector3 &supportVertex)
+// 頂点数の少ない凸メッシュは4頂点ずつ全頂点を調べる
+static SCE_PFX_FORCE_INLINE
+PfxUInt32 pfxGetSupportVertexIdBruteForce(const PfxConvexMesh *mesh,const PfxVector3 &seperatingAxis)
 {
-	PfxConvexMesh *mesh = (PfxConvexMesh*)shape;
-	int reti = 0;
-PfxFloat dmax = dot(mesh->m_verts[0],seperatingAxis);
-for(int i=1;i<mesh->m_numVerts;i++) {
-	PfxFloat d = dot(mesh->m_verts[i],seperatingAxis);
-	if(d > dmax) {
-		dmax =d;
-		reti = i;
+	const PfxFloat ax = seperatingAxis[0];
+	const PfxFloat ay = seperatingAxis[1];
+	const PfxFloat az = seperatingAxis[2];
+
+	PfxFloat dmax[4] = {-SCE_PFX_FLT_MAX,-SCE_PFX_FLT_MAX,-SCE_PFX_FLT_MAX,-SCE_PFX_FLT_MAX};
+	PfxUInt32 reti[4] = {0,0,0,0};
+
+	int i=0;
+	for(;i+4<=mesh->m_numVerts;i+=4) {
+		for(int j=0;j<4;j++) {
+			const PfxVector3 &v = mesh->m_verts[i+j];
+			PfxFloat d = v[0]*ax + v[1]*ay + v[2]*az;
+			if(d > dmax[j]) {
+				dmax[j] = d;
+				reti[j] = i+j;
+			}
+		}
+	}
+	for(;i<mesh->m_numVerts;i++) {
+		const PfxVector3 &v = mesh->m_verts[i];
+		PfxFloat d = v[0]*ax + v[1]*ay + v[2]*az;
+		if(d > dmax[0]) {
+			dmax[0] = d;
+			reti[0] = i;
+		}
+	}
+
+	// 同じ値の場合は番号の小さい頂点を選ぶ
+	PfxUInt32 ret = reti[0];
+	PfxFloat d = dmax[0];
+	for(int j=1;j<4;j++) {
+		if(dmax[j] > d || (dmax[j] == d && reti[j] < ret)) {
+			d = dmax[j];
+			ret = reti[j];
+		}
+	}
+	return ret;
+}
+
+// 前回のサポート頂点から、内積が大きくなる隣接頂点へ移動を繰り返す
+// 凸包の辺を辿るので局所的な最大値が全体の最大値になる
+static SCE_PFX_FORCE_INLINE
+PfxUInt32 pfxGetSupportVertexIdHillClimbing(const PfxConvexMesh *mesh,const PfxVector3 &seperatingAxis,PfxUInt32 start)
+{
+	PfxUInt32 reti = start;
+	PfxFloat dmax = dot(mesh->m_verts[reti],seperatingAxis);
+
+	for(;;) {
+		PfxUInt32 next = reti;
+		for(PfxUInt32 i=mesh->m_adjOffsets[reti];i<mesh->m_adjOffsets[reti+1];i++) {
+			PfxUInt32 v = mesh->m_adjVerts[i];
+			PfxFloat d = dot(mesh->m_verts[v],seperatingAxis);
+			if(d > dmax) {
+				dmax = d;
+				next = v;
+			}
+		}
+		if(next == reti) break;
+		reti = next;
 	}
+
+	return reti;
 }
+
+void pfxGetSupportVertexConvex(void *shape,const PfxVector3 &seperatingAxis,PfxVector3 &supportVertex,PfxUInt32 &hint)
+{
+	PfxConvexMesh *mesh = (PfxConvexMesh*)shape;
+
+	PfxUInt32 reti;
+	if(mesh->m_numVerts <= SCE_PFX_CONVEX_BRUTE_FORCE_VERTICES || !mesh->hasAdjacency()) {
+		reti = pfxGetSupportVertexIdBruteForce(mesh,seperatingAxis);
+	}
+	else {
+		// 溶接された頂点から始める（初期値の0は常に溶接先）
+		reti = pfxGetSupportVertexIdHillClimbing(mesh,seperatingAxis,hint < mesh->m_numVerts ? hint : 0);
+		hint = reti;
+	}
+
 	supportVertex = mesh->m_verts[reti] + SCE_PFX_GJK_MARGIN * normalize(seperatingAxis);
 }
 
-void pfxGetSupportVertexBox(void *shape,const PfxVector3 &seperatingAxis,PfxVector3 &supportVertex)
+void pfxGetSupportVertexBox(void *shape,const PfxVector3 &seperatingAxis,PfxVector3 &supportVertex,PfxUInt32 &hint)
 {
+	(void)hint;
 	PfxBox *box = (PfxBox*)shape;
 	PfxVector3 boxHalf = box->m_half + PfxVector3(SCE_PFX_GJK_MARGIN);
 	supportVertex[0] = seperatingAxis[0]>0.0f?boxHalf[0]:-boxHalf[0];
@@ -96,8 +169,9 @@ void pfxGetSupportVertexBox(void *shape,const PfxVector3 &seperatingAxis,PfxVect
 	supportVertex[2] = seperatingAxis[2]>0.0f?boxHalf[2]:-boxHalf[2];
 }
 
-void pfxGetSupportVertexCapsule(void *shape,const PfxVector3 &seperatingAxis,PfxVector3 &supportVertex)
+void pfxGetSupportVertexCapsule(void *shape,const PfxVector3 &seperatingAxis,PfxVector3 &supportVertex,PfxUInt32 &hint)
 {
+	(void)hint;
 	PfxCapsule *capsule = (PfxCapsule*)shape;
 	PfxVector3 u(1.0f,0.0f,0.0f);
 
@@ -106,14 +180,16 @@ void pfxGetSupportVertexCapsule(void *shape,const PfxVector3 &seperatingAxis,Pfx
 	supportVertex = dir + normalize(seperatingAxis) * (capsule->m_radius + SCE_PFX_GJK_MARGIN);
 }
 
-void pfxGetSupportVertexSphere(void *shape,const PfxVector3 &seperatingAxis,PfxVector3 &supportVertex)
+void pfxGetSupportVertexSphere(void *shape,const PfxVector3 &seperatingAxis,PfxVector3 &supportVertex,PfxUInt32 &hint)
 {
+	(void)hint;
 	PfxSphere *sphere = (PfxSphere*)shape;
 	supportVertex = normalize(seperatingAxis) * (sphere->m_radius + SCE_PFX_GJK_MARGIN);
 }
 
-void pfxGetSupportVertexCylinder(void *shape,const PfxVector3 &seperatingAxis,PfxVector3 &supportVertex)
+void pfxGetSupportVertexCylinder(void *shape,const PfxVector3 &seperatingAxis,PfxVector3 &supportVertex,PfxUInt32 &hint)
 {
+	(void)hint;
 	PfxCylinder *cylinder = (PfxCylinder*)shape;
 	PfxVector3 u(1.0f,0.0f,0.0f);
 
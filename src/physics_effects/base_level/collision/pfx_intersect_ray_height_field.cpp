@@ -0,0 +1,191 @@
+/*
+Physics Effects Copyright(C) 2011 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#include "../../../include/physics_effects/base_level/collision/pfx_height_field.h"
+#include "pfx_intersect_common.h"
+#include "pfx_mesh_common.h"
+#include "pfx_intersect_ray_height_field.h"
+
+
+namespace sce {
+namespace PhysicsEffects {
+
+
+static SCE_PFX_FORCE_INLINE
+PfxBool pfxIntersectRayFacet(const PfxTriangle &triangle,const PfxVector3 &rayStart,const PfxVector3 &rayDir,
+	PfxUInt32 facetMode,PfxFloat &variable)
+{
+	if(facetMode == SCE_PFX_RAY_FACET_MODE_FRONT_ONLY) {
+		return pfxIntersectRayTriangleWithoutBackFace(rayStart,rayDir,triangle,variable);
+	}
+	else if(facetMode == SCE_PFX_RAY_FACET_MODE_BACK_ONLY) {
+		return pfxIntersectRayTriangleWithoutFrontFace(rayStart,rayDir,triangle,variable);
+	}
+	return pfxIntersectRayTriangle(rayStart,rayDir,triangle,variable);
+}
+
+// レイとスラブの交差区間を[tmin,tmax]に絞り込む
+static SCE_PFX_FORCE_INLINE
+PfxBool pfxClipRaySlab(PfxFloat start,PfxFloat dir,PfxFloat slabMin,PfxFloat slabMax,PfxFloat &tmin,PfxFloat &tmax)
+{
+	if(fabsf(dir) < SCE_PFX_INTERSECT_COMMON_EPSILON) {
+		return start >= slabMin && start <= slabMax;
+	}
+
+	PfxFloat t1 = (slabMin - start) / dir;
+	PfxFloat t2 = (slabMax - start) / dir;
+	if(t1 > t2) {
+		PfxFloat tmp = t1;
+		t1 = t2;
+		t2 = tmp;
+	}
+	tmin = SCE_PFX_MAX(tmin,t1);
+	tmax = SCE_PFX_MIN(tmax,t2);
+	return tmin <= tmax;
+}
+
+PfxBool pfxIntersectRayHeightField(const PfxRayInput &ray,PfxRayOutput &out,const void *shape,const PfxTransform3 &transform)
+{
+	const PfxHeightField &field = *((PfxHeightField*)shape);
+
+	// レイをハイトフィールドのローカル座標へ変換
+	PfxTransform3 transformField = orthoInverse(transform);
+	PfxVector3 rayStartPosition = transformField.getUpper3x3() * ray.m_startPosition + transformField.getTranslation();
+	PfxVector3 rayDirection = transformField.getUpper3x3() * ray.m_direction;
+
+	// ハイトフィールドのAABBでレイを切り取る
+	PfxFloat tmin = 0.0f;
+	PfxFloat tmax = out.m_variable;
+	if(!pfxClipRaySlab(rayStartPosition[0],rayDirection[0],-field.m_half[0],field.m_half[0],tmin,tmax) ||
+	   !pfxClipRaySlab(rayStartPosition[2],rayDirection[2],-field.m_half[2],field.m_half[2],tmin,tmax) ||
+	   !pfxClipRaySlab(rayStartPosition[1],rayDirection[1],field.m_minHeight,field.m_maxHeight,tmin,tmax)) {
+		return false;
+	}
+
+	// -----------------------------------------------------
+	// レイが通過するセルを順に辿る（2D DDA）
+
+	PfxInt32 numCellsX = (PfxInt32)field.getNumCellsX();
+	PfxInt32 numCellsZ = (PfxInt32)field.getNumCellsZ();
+
+	PfxVector3 enterPosition = rayStartPosition + tmin * rayDirection;
+	PfxInt32 cellX = (PfxInt32)floorf((enterPosition[0] + field.m_half[0]) / field.m_cellSizeX);
+	PfxInt32 cellZ = (PfxInt32)floorf((enterPosition[2] + field.m_half[2]) / field.m_cellSizeZ);
+	cellX = SCE_PFX_CLAMP(cellX,0,numCellsX-1);
+	cellZ = SCE_PFX_CLAMP(cellZ,0,numCellsZ-1);
+
+	PfxInt32 stepX = 0,stepZ = 0;
+	PfxFloat nextX = SCE_PFX_FLT_MAX,nextZ = SCE_PFX_FLT_MAX;
+	PfxFloat deltaX = SCE_PFX_FLT_MAX,deltaZ = SCE_PFX_FLT_MAX;
+
+	if(fabsf(rayDirection[0]) >= SCE_PFX_INTERSECT_COMMON_EPSILON) {
+		stepX = rayDirection[0] > 0.0f ? 1 : -1;
+		PfxFloat boundary = (cellX + (stepX > 0 ? 1 : 0)) * field.m_cellSizeX - field.m_half[0];
+		nextX = (boundary - rayStartPosition[0]) / rayDirection[0];
+		deltaX = field.m_cellSizeX / fabsf(rayDirection[0]);
+	}
+
+	if(fabsf(rayDirection[2]) >= SCE_PFX_INTERSECT_COMMON_EPSILON) {
+		stepZ = rayDirection[2] > 0.0f ? 1 : -1;
+		PfxFloat boundary = (cellZ + (stepZ > 0 ? 1 : 0)) * field.m_cellSizeZ - field.m_half[2];
+		nextZ = (boundary - rayStartPosition[2]) / rayDirection[2];
+		deltaZ = field.m_cellSizeZ / fabsf(rayDirection[2]);
+	}
+
+	PfxFloat nearestVariable = out.m_variable;
+	PfxUInt32 nearestX = 0,nearestZ = 0,nearestTriangle = 0;
+	PfxBool ret = false;
+
+	PfxFloat cellEnter = tmin;
+	for(;;) {
+		PfxFloat cellExit = SCE_PFX_MIN(SCE_PFX_MIN(nextX,nextZ),tmax);
+
+		// セル内のレイの高さの範囲とセルの高さの範囲を比較する
+		PfxFloat rayMinY = rayStartPosition[1] + SCE_PFX_MIN(cellEnter*rayDirection[1],cellExit*rayDirection[1]);
+		PfxFloat rayMaxY = rayStartPosition[1] + SCE_PFX_MAX(cellEnter*rayDirection[1],cellExit*rayDirection[1]);
+		PfxFloat h00 = field.getHeight(cellX,cellZ);
+		PfxFloat h10 = field.getHeight(cellX+1,cellZ);
+		PfxFloat h01 = field.getHeight(cellX,cellZ+1);
+		PfxFloat h11 = field.getHeight(cellX+1,cellZ+1);
+		PfxFloat cellMinY = SCE_PFX_MIN(SCE_PFX_MIN(h00,h10),SCE_PFX_MIN(h01,h11));
+		PfxFloat cellMaxY = SCE_PFX_MAX(SCE_PFX_MAX(h00,h10),SCE_PFX_MAX(h01,h11));
+
+		if(rayMinY <= cellMaxY + SCE_PFX_INTERSECT_COMMON_EPSILON && rayMaxY >= cellMinY - SCE_PFX_INTERSECT_COMMON_EPSILON) {
+			for(PfxUInt32 t=0;t<2;t++) {
+				PfxVector3 verts[3];
+				field.getTriangle(cellX,cellZ,t,verts);
+				PfxTriangle triangle(verts[0],verts[1],verts[2]);
+
+				PfxFloat curVariable = 1.0f;
+				if(pfxIntersectRayFacet(triangle,rayStartPosition,rayDirection,ray.m_facetMode,curVariable) &&
+				   curVariable < nearestVariable) {
+					nearestVariable = curVariable;
+					nearestX = cellX;
+					nearestZ = cellZ;
+					nearestTriangle = t;
+					ret = true;
+				}
+			}
+
+			// 以降のセルの交点はこのセルの交点より遠い
+			if(ret) break;
+		}
+
+		if(cellExit >= tmax) break;
+
+		// 次のセルへ
+		if(nextX < nextZ) {
+			cellX += stepX;
+			cellEnter = nextX;
+			nextX += deltaX;
+		}
+		else {
+			cellZ += stepZ;
+			cellEnter = nextZ;
+			nextZ += deltaZ;
+		}
+
+		if(cellX < 0 || cellX >= numCellsX || cellZ < 0 || cellZ >= numCellsZ) break;
+	}
+
+	if(ret) {
+		PfxVector3 verts[3];
+		field.getTriangle(nearestX,nearestZ,nearestTriangle,verts);
+		PfxTriangle triangle(verts[0],verts[1],verts[2]);
+
+		// 面のローカル座標を算出
+		PfxFloat s=0.0f,t=0.0f;
+		pfxGetLocalCoords(rayStartPosition+nearestVariable*rayDirection,triangle,s,t);
+
+		PfxSubData subData;
+		subData.m_type = PfxSubData::MESH_INFO;
+		subData.setFacetLocalS(s);
+		subData.setFacetLocalT(t);
+		field.setFacet(subData,nearestX,nearestZ,nearestTriangle);
+
+		PfxVector3 normal = normalize(cross(verts[1]-verts[0],verts[2]-verts[0]));
+
+		out.m_contactFlag = true;
+		out.m_variable = nearestVariable;
+		out.m_contactPoint = ray.m_startPosition + nearestVariable * ray.m_direction;
+		out.m_contactNormal = transform.getUpper3x3() * normal;
+		out.m_subData = subData;
+	}
+
+	return ret;
+}
+} //namespace PhysicsEffects
+} //namespace sce
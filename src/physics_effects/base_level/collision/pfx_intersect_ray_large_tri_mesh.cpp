@@ -98,6 +98,52 @@ PfxBool pfxIntersectRayTriMesh(const PfxTriMesh &mesh,const PfxVector3 &rayStart
 	return ret;
 }
 
+// アイランドのAABBとレイの交差判定。既に見つかった交点より遠い場合はfalse
+static SCE_PFX_FORCE_INLINE
+PfxBool pfxIntersectRayIslandAabb(const PfxLargeTriMesh &largeMesh,const PfxAabb16 &aabbB,
+	const PfxVector3 &rayStartPosition,const PfxVector3 &rayDirection,PfxFloat nearestVariable)
+{
+	PfxVector3 aabbMin,aabbMax;
+	aabbMin = largeMesh.getWorldPosition(PfxVecInt3((PfxFloat)pfxGetXMin(aabbB),(PfxFloat)pfxGetYMin(aabbB),(PfxFloat)pfxGetZMin(aabbB)));
+	aabbMax = largeMesh.getWorldPosition(PfxVecInt3((PfxFloat)pfxGetXMax(aabbB),(PfxFloat)pfxGetYMax(aabbB),(PfxFloat)pfxGetZMax(aabbB)));
+
+	PfxFloat tmpVariable = 1.0f;
+
+	if( !pfxIntersectRayAABBFast(
+		rayStartPosition,rayDirection,
+		(aabbMax+aabbMin)*0.5f,
+		(aabbMax-aabbMin)*0.5f,
+		tmpVariable) )
+		return false;
+	
+	return tmpVariable < nearestVariable;
+}
+
+// アイランドとの交差チェック
+static SCE_PFX_FORCE_INLINE
+PfxBool pfxIntersectRayIsland(const PfxRayInput &ray,PfxRayOutput &out,const PfxLargeTriMesh &largeMesh,PfxUInt32 islandId,
+	const PfxVector3 &rayStartPosition,const PfxVector3 &rayDirection,const PfxTransform3 &transform)
+{
+	const PfxTriMesh *island = &largeMesh.m_islands[islandId];
+	
+	PfxSubData subData;
+	PfxVector3 tmpNormal;
+	PfxFloat tmpVariable = out.m_variable;
+
+	if( pfxIntersectRayTriMesh(*island,rayStartPosition,rayDirection,ray.m_facetMode,tmpVariable,tmpNormal,subData) &&
+		tmpVariable < out.m_variable ) {
+		out.m_contactFlag = true;
+		out.m_variable = tmpVariable;
+		out.m_contactPoint = ray.m_startPosition + tmpVariable * ray.m_direction;
+		out.m_contactNormal = transform.getUpper3x3() * tmpNormal;
+		subData.setIslandId(islandId);
+		out.m_subData = subData;
+		return true;
+	}
+
+	return false;
+}
+
 PfxBool pfxIntersectRayLargeTriMesh(const PfxRayInput &ray,PfxRayOutput &out,const void *shape,const PfxTransform3 &transform)
 {
 	PfxBool ret = false;
@@ -117,49 +163,32 @@ PfxBool pfxIntersectRayLargeTriMesh(const PfxRayInput &ray,PfxRayOutput &out,con
 	aabbMinL = minPerElem(s,e);
 	aabbMaxL = maxPerElem(s,e);
 	
-	PfxUInt32 numIslands = largeMesh.m_numIslands;
-	
-	{
-	for(PfxUInt32 i=0;i<numIslands;i++) {
-		PfxAabb16 aabbB = largeMesh.m_aabbList[i];
-		if(aabbMaxL.getX() < pfxGetXMin(aabbB) || aabbMinL.getX() > pfxGetXMax(aabbB)) continue;
-		if(aabbMaxL.getY() < pfxGetYMin(aabbB) || aabbMinL.getY() > pfxGetYMax(aabbB)) continue;
-		if(aabbMaxL.getZ() < pfxGetZMin(aabbB) || aabbMinL.getZ() > pfxGetZMax(aabbB)) continue;
-		// Todo:早期終了チェック
-
-			PfxVector3 aabbMin,aabbMax;
-			aabbMin = largeMesh.getWorldPosition(PfxVecInt3((PfxFloat)pfxGetXMin(aabbB),(PfxFloat)pfxGetYMin(aabbB),(PfxFloat)pfxGetZMin(aabbB)));
-			aabbMax = largeMesh.getWorldPosition(PfxVecInt3((PfxFloat)pfxGetXMax(aabbB),(PfxFloat)pfxGetYMax(aabbB),(PfxFloat)pfxGetZMax(aabbB)));
-
-			PfxFloat tmpVariable = 1.0f;
-			PfxVector3 tmpNormal;
-
-			if( !pfxIntersectRayAABBFast(
-				rayStartPosition,rayDirection,
-				(aabbMax+aabbMin)*0.5f,
-				(aabbMax-aabbMin)*0.5f,
-				tmpVariable) )
+	if(largeMesh.m_bvhNodes) {
+		// BVHを深さ優先で辿り、レイと交差しないノードや既に見つかった交点より遠いノードは部分木ごと飛ばす
+		PfxUInt32 numNodes = largeMesh.m_numBvhNodes;
+		PfxUInt32 n = 0;
+		while(n < numNodes) {
+			const PfxAabb16 &node = largeMesh.m_bvhNodes[n];
+			if(!pfxTestAabb(node,aabbMinL,aabbMaxL) ||
+			   !pfxIntersectRayIslandAabb(largeMesh,node,rayStartPosition,rayDirection,out.m_variable)) {
+				n = pfxGetBvhEscapeId(node);
 				continue;
-			
-			if( out.m_variable <= tmpVariable ) continue;
-
-			// アイランドとの交差チェック
-		const PfxTriMesh *island = &largeMesh.m_islands[i];
-			
-			PfxSubData subData;
-			tmpVariable = out.m_variable;
-
-			if( pfxIntersectRayTriMesh(*island,rayStartPosition,rayDirection,ray.m_facetMode,tmpVariable,tmpNormal,subData) &&
-				tmpVariable < out.m_variable ) {
-				out.m_contactFlag = true;
-				out.m_variable = tmpVariable;
-				out.m_contactPoint = ray.m_startPosition + tmpVariable * ray.m_direction;
-				out.m_contactNormal = transform.getUpper3x3() * tmpNormal;
-				subData.setIslandId(i);
-				out.m_subData = subData;
-				ret = true;
 			}
 
+			PfxUInt32 islandId = pfxGetBvhIslandId(node);
+			if(islandId != SCE_PFX_LARGETRIMESH_BVH_INTERNAL) {
+				ret |= pfxIntersectRayIsland(ray,out,largeMesh,islandId,rayStartPosition,rayDirection,transform);
+			}
+			n++;
+		}
+	}
+	else {
+		PfxUInt32 numIslands = largeMesh.m_numIslands;
+		for(PfxUInt32 i=0;i<numIslands;i++) {
+			const PfxAabb16 &aabbB = largeMesh.m_aabbList[i];
+			if(!pfxTestAabb(aabbB,aabbMinL,aabbMaxL)) continue;
+			if(!pfxIntersectRayIslandAabb(largeMesh,aabbB,rayStartPosition,rayDirection,out.m_variable)) continue;
+			ret |= pfxIntersectRayIsland(ray,out,largeMesh,i,rayStartPosition,rayDirection,transform);
 		}
 	}
 
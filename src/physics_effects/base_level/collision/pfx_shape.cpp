@@ -69,6 +69,14 @@ void pfxGetShapeAabbLargeTriMesh(const PfxShape &shape,PfxVector3 &aabbMin,PfxVe
 	aabbMax = shape.getOffsetPosition() + half;
 }
 
+void pfxGetShapeAabbHeightField(const PfxShape &shape,PfxVector3 &aabbMin,PfxVector3 &aabbMax)
+{
+	const PfxHeightField *heightField = shape.getHeightField();
+	PfxVector3 half = absPerElem(PfxMatrix3(shape.getOffsetOrientation())) * heightField->m_half;
+	aabbMin = shape.getOffsetPosition() - half;
+	aabbMax = shape.getOffsetPosition() + half;
+}
+
 typedef void (*PfxFuncGetShapeAabb)(const PfxShape &shape,PfxVector3 &aabbMin,PfxVector3 &aabbMax);
 
 PfxFuncGetShapeAabb pfxFuncGetShapeAabb[kPfxShapeCount] = {
@@ -78,7 +86,7 @@ PfxFuncGetShapeAabb pfxFuncGetShapeAabb[kPfxShapeCount] = {
 	pfxGetShapeAabbCylinder,
 	pfxGetShapeAabbConvexMesh,
 	pfxGetShapeAabbLargeTriMesh,
-	pfxGetShapeAabbDummy,
+	pfxGetShapeAabbHeightField,
 	pfxGetShapeAabbDummy,
 	pfxGetShapeAabbDummy,
 	pfxGetShapeAabbDummy,
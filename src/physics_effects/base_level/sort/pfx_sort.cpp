@@ -98,21 +98,25 @@ unsigned int i=0,j=0;
 
 while(i<n1&&j<n2) {
 	if(Key(d1[i]) < Key(d2[j])) {
-		buff[i+j] = d1[i++];
+		buff[i+j] = d1[i];
+		i++;
 	}
 	else {
-		buff[i+j] = d2[j++];
+		buff[i+j] = d2[j];
+		j++;
 	}
 }
 
 if(i<n1) {
 	while(i<n1) {
-		buff[i+j] = d1[i++];
+		buff[i+j] = d1[i];
+		i++;
 	}
 }
 else if(j<n2) {
 	while(j<n2) {
-		buff[i+j] = d2[j++];
+		buff[i+j] = d2[j];
+		j++;
 	}
 }
 
@@ -263,5 +267,10 @@ void pfxSort(PfxSortData32 *data,PfxSortData32 *buff,unsigned int n)
 pfxMergeSort(data,buff,n);
 }
 
+void pfxSort(PfxSortData32Key64 *data,PfxSortData32Key64 *buff,unsigned int n)
+{
+pfxMergeSort(data,buff,n);
+}
+
 } //namespace PhysicsEffects
 } //namespace sce
@@ -0,0 +1,370 @@
+/*
+Physics Effects Copyright(C) 2010 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#include "../../../include/physics_effects/base_level/base/pfx_perf_counter.h"
+#include "../../../include/physics_effects/base_level/sort/pfx_sort.h"
+#include "../../../include/physics_effects/base_level/broadphase/pfx_update_broadphase_proxy.h"
+#include "../../../include/physics_effects/low_level/broadphase/pfx_broadphase.h"
+#include "../../base_level/broadphase/pfx_check_collidable.h"
+
+namespace sce {
+namespace PhysicsEffects {
+
+extern PfxInt32 pfxCheckParamOfUpdateBroadphaseProxies(const PfxUpdateBroadphaseProxiesParam &param);
+extern PfxInt32 pfxCheckParamOfFindPairs(const PfxFindPairsParam &param,int maxTasks);
+
+///////////////////////////////////////////////////////////////////////////////
+// MULTI THREADS
+
+///////////////////////////////////////////////////////////////////////////////
+// Update Broadphase Proxies
+
+struct PfxUpdateBroadphaseProxiesIO {
+	PfxUpdateBroadphaseProxiesParam *param;
+	PfxBroadphaseProxy *workProxies[6];
+	PfxInt32 numOutOfWorldProxies;
+};
+
+//J 各タスクは剛体を分割してプロキシを更新し、バリア同期後に6つの軸配列をタスク間で分担してソートする
+//E Each task updates the proxies of a contiguous range of rigid bodies. After
+//E the barrier the six axis arrays are sorted concurrently, one per task.
+static void pfxUpdateBroadphaseProxiesTaskEntry(PfxTaskArg *arg)
+{
+	PfxUpdateBroadphaseProxiesIO *io = (PfxUpdateBroadphaseProxiesIO*)arg->io;
+	PfxUpdateBroadphaseProxiesParam &param = *io->param;
+	PfxUInt32 taskId = arg->taskId;
+	PfxUInt32 numTasks = arg->maxTasks;
+
+	PfxUInt32 begin = (PfxUInt32)(((PfxUInt64)param.numRigidBodies * taskId) / numTasks);
+	PfxUInt32 end = (PfxUInt32)(((PfxUInt64)param.numRigidBodies * (taskId+1)) / numTasks);
+
+	io->numOutOfWorldProxies = 0;
+
+	for(PfxUInt32 i=begin;i<end;i++) {
+		PfxInt32 chk = pfxUpdateBroadphaseProxy(
+			param.proxiesX[i],
+			param.proxiesY[i],
+			param.proxiesZ[i],
+			param.proxiesXb[i],
+			param.proxiesYb[i],
+			param.proxiesZb[i],
+			param.offsetRigidStates[i],
+			param.offsetCollidables[i],
+			param.worldCenter,
+			param.worldExtent);
+
+		if(chk == (PfxInt32)SCE_PFX_ERR_OUT_OF_WORLD) {
+			io->numOutOfWorldProxies++;
+
+			if(param.outOfWorldBehavior & SCE_PFX_OUT_OF_WORLD_BEHAVIOR_FIX_MOTION) {
+				PfxRigidState &state = param.offsetRigidStates[i];
+				state.setMotionType(kPfxMotionTypeFixed);
+				pfxSetMotionMask(param.proxiesX[i],state.getMotionMask());
+				pfxSetMotionMask(param.proxiesY[i],state.getMotionMask());
+				pfxSetMotionMask(param.proxiesZ[i],state.getMotionMask());
+				pfxSetMotionMask(param.proxiesXb[i],state.getMotionMask());
+				pfxSetMotionMask(param.proxiesYb[i],state.getMotionMask());
+				pfxSetMotionMask(param.proxiesZb[i],state.getMotionMask());
+			}
+
+			if(param.outOfWorldBehavior & SCE_PFX_OUT_OF_WORLD_BEHAVIOR_REMOVE_PROXY) {
+				pfxSetKey(param.proxiesX[i],SCE_PFX_SENTINEL_KEY);
+				pfxSetKey(param.proxiesY[i],SCE_PFX_SENTINEL_KEY);
+				pfxSetKey(param.proxiesZ[i],SCE_PFX_SENTINEL_KEY);
+				pfxSetKey(param.proxiesXb[i],SCE_PFX_SENTINEL_KEY);
+				pfxSetKey(param.proxiesYb[i],SCE_PFX_SENTINEL_KEY);
+				pfxSetKey(param.proxiesZb[i],SCE_PFX_SENTINEL_KEY);
+			}
+		}
+	}
+
+	arg->barrier->sync();
+
+	PfxBroadphaseProxy *proxies[6] = {
+		param.proxiesX,param.proxiesY,param.proxiesZ,
+		param.proxiesXb,param.proxiesYb,param.proxiesZb,
+	};
+
+	for(PfxUInt32 a=taskId;a<6;a+=numTasks) {
+		pfxSort(proxies[a],io->workProxies[a],param.numRigidBodies);
+	}
+}
+
+PfxInt32 pfxUpdateBroadphaseProxies(PfxUpdateBroadphaseProxiesParam &param,PfxUpdateBroadphaseProxiesResult &result,PfxTaskManager *taskManager)
+{
+	if(!taskManager) return SCE_PFX_ERR_INVALID_VALUE;
+
+	PfxInt32 ret = pfxCheckParamOfUpdateBroadphaseProxies(param);
+	if(ret != SCE_PFX_OK) return ret;
+
+	PfxUInt32 numTasks = taskManager->getNumTasks();
+
+	if(SCE_PFX_AVAILABLE_BYTES_ALIGN16(param.workBuff,param.workBytes) < pfxGetWorkBytesOfUpdateBroadphaseProxies(param.numRigidBodies,numTasks) ) return SCE_PFX_ERR_OUT_OF_BUFFER;
+
+	SCE_PFX_PUSH_MARKER("pfxUpdateBroadphaseProxies");
+
+	PfxHeapManager pool((unsigned char*)param.workBuff,param.workBytes);
+
+	PfxBroadphaseProxy *workProxies[6];
+	for(int a=0;a<6;a++) {
+		workProxies[a] = (PfxBroadphaseProxy*)pool.allocate(sizeof(PfxBroadphaseProxy)*param.numRigidBodies,PfxHeapManager::ALIGN128);
+	}
+
+	PfxUpdateBroadphaseProxiesIO *io = (PfxUpdateBroadphaseProxiesIO*)taskManager->allocate(sizeof(PfxUpdateBroadphaseProxiesIO)*numTasks);
+
+	taskManager->setTaskEntry((void*)pfxUpdateBroadphaseProxiesTaskEntry);
+
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		io[t].param = &param;
+		for(int a=0;a<6;a++) {
+			io[t].workProxies[a] = workProxies[a];
+		}
+		io[t].numOutOfWorldProxies = 0;
+		taskManager->startTask(t,&io[t],0,0,0,0);
+	}
+
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		int taskId;
+		PfxUInt32 data1,data2,data3,data4;
+		taskManager->waitTask(taskId,data1,data2,data3,data4);
+	}
+
+	result.numOutOfWorldProxies = 0;
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		result.numOutOfWorldProxies += io[t].numOutOfWorldProxies;
+	}
+
+	taskManager->deallocate(io);
+
+	pool.clear();
+
+	SCE_PFX_POP_MARKER();
+
+	return SCE_PFX_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Find Pairs
+
+struct PfxFindPairsIO {
+	PfxBroadphaseProxy *proxies;
+	PfxUInt32 numProxies;
+	PfxUInt32 maxPairs;
+	int axis;
+	PfxBroadphasePair *taskPairs;
+	PfxUInt32 numTaskPairs;
+	PfxBroadphasePair *outPairs;
+	PfxUInt32 outOffset;
+	PfxInt32 ret;
+	PfxFindPairsIO *ioTop;
+};
+
+//J 各タスクはソート済みプロキシをnumTasks間隔で担当し、自分専用のバッファにペアを出力する
+//J バリア同期後、全タスクのペア数から出力位置を求めてコピーし、各区間を並列にソートする
+//E Each task sweeps every numTasks-th proxy of the sorted array and writes
+//E pairs into its own slice. After the barrier every task knows the pair
+//E counts of all tasks, copies its pairs to the output and sorts that run.
+static void pfxFindPairsTaskEntry(PfxTaskArg *arg)
+{
+	PfxFindPairsIO *io = (PfxFindPairsIO*)arg->io;
+	PfxUInt32 taskId = arg->taskId;
+	PfxUInt32 numTasks = arg->maxTasks;
+
+	PfxBroadphaseProxy *proxies = io->proxies;
+	PfxUInt32 numProxies = io->numProxies;
+	PfxUInt32 maxPairs = io->maxPairs;
+	int axis = io->axis;
+
+	PfxBroadphasePair *pairs = io->taskPairs;
+	PfxUInt32 numPairs = 0;
+
+	io->ret = SCE_PFX_OK;
+
+	for(PfxUInt32 i=taskId;i<numProxies && io->ret == SCE_PFX_OK;i+=numTasks) {
+		for(PfxUInt32 j=i+1;j<numProxies;j++) {
+			if(pfxGetXYZMax(proxies[i],axis) < pfxGetXYZMin(proxies[j],axis)) {
+				break;
+			}
+
+			PfxBroadphaseProxy &proxyA = pfxGetObjectId(proxies[i]) < pfxGetObjectId(proxies[j]) ? proxies[i] : proxies[j];
+			PfxBroadphaseProxy &proxyB = pfxGetObjectId(proxies[i]) < pfxGetObjectId(proxies[j]) ? proxies[j] : proxies[i];
+
+			if(	pfxCheckCollidableInBroadphase(proxyA,proxyB) ) {
+				if(numPairs >= maxPairs) {
+					io->ret = SCE_PFX_ERR_OUT_OF_MAX_PAIRS;
+					break;
+				}
+
+				PfxBroadphasePair &pair = pairs[numPairs++];
+				pfxSetBroadphaseFlag(pair,0);
+				pfxSetActive(pair,true);
+				pfxSetObjectIdA(pair,pfxGetObjectId(proxyA));
+				pfxSetObjectIdB(pair,pfxGetObjectId(proxyB));
+				pfxSetMotionMaskA(pair,pfxGetMotionMask(proxyA));
+				pfxSetMotionMaskB(pair,pfxGetMotionMask(proxyB));
+
+				pfxSetKey(pair,pfxCreateUniqueKey(pfxGetObjectId(proxyA),pfxGetObjectId(proxyB)));
+			}
+		}
+	}
+
+	io->numTaskPairs = numPairs;
+
+	arg->barrier->sync();
+
+	PfxUInt32 offset = 0;
+	PfxUInt32 total = 0;
+	PfxBool failed = false;
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		if(t == taskId) offset = total;
+		total += io->ioTop[t].numTaskPairs;
+		failed |= io->ioTop[t].ret != SCE_PFX_OK;
+	}
+
+	io->outOffset = offset;
+
+	if(failed || total > maxPairs) {
+		return;
+	}
+
+	PfxBroadphasePair *outPairs = io->outPairs + offset;
+	for(PfxUInt32 i=0;i<numPairs;i++) {
+		outPairs[i] = pairs[i];
+	}
+
+	pfxSort(outPairs,pairs,numPairs);
+}
+
+//J ソート済みの区間をマージする（srcとdstを交互に使用）
+//E Merge sorted runs pairwise, ping-ponging between the pair buffer and buff
+static void pfxMergeSortedRuns(PfxBroadphasePair *pairs,PfxBroadphasePair *buff,PfxUInt32 *offsets,PfxUInt32 numRuns)
+{
+	PfxBroadphasePair *src = pairs;
+	PfxBroadphasePair *dst = buff;
+
+	while(numRuns > 1) {
+		PfxUInt32 numMerged = 0;
+		for(PfxUInt32 r=0;r<numRuns;r+=2) {
+			PfxUInt32 begin = offsets[r];
+			if(r+1 < numRuns) {
+				PfxUInt32 i = begin,iEnd = offsets[r+1];
+				PfxUInt32 j = offsets[r+1],jEnd = offsets[r+2];
+				PfxUInt32 k = begin;
+				while(i<iEnd&&j<jEnd) {
+					if(pfxGetKey(src[i]) < pfxGetKey(src[j])) {
+						dst[k++] = src[i++];
+					}
+					else {
+						dst[k++] = src[j++];
+					}
+				}
+				while(i<iEnd) dst[k++] = src[i++];
+				while(j<jEnd) dst[k++] = src[j++];
+			}
+			else {
+				for(PfxUInt32 k=begin;k<offsets[r+1];k++) {
+					dst[k] = src[k];
+				}
+			}
+			offsets[numMerged++] = begin;
+		}
+		offsets[numMerged] = offsets[numRuns];
+		numRuns = numMerged;
+		PfxBroadphasePair *tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	if(src != pairs) {
+		for(PfxUInt32 k=0;k<offsets[1];k++) {
+			pairs[k] = src[k];
+		}
+	}
+}
+
+PfxInt32 pfxFindPairs(PfxFindPairsParam &param,PfxFindPairsResult &result,PfxTaskManager *taskManager)
+{
+	if(!taskManager) return SCE_PFX_ERR_INVALID_VALUE;
+
+	PfxUInt32 numTasks = taskManager->getNumTasks();
+
+	PfxInt32 ret = pfxCheckParamOfFindPairs(param,numTasks);
+	if(ret != SCE_PFX_OK) return ret;
+
+	SCE_PFX_PUSH_MARKER("pfxFindPairs");
+
+	PfxHeapManager pool((unsigned char*)param.workBuff,param.workBytes);
+
+	PfxBroadphasePair *pairs = (PfxBroadphasePair*)SCE_PFX_PTR_ALIGN16(param.pairBuff);
+
+	PfxFindPairsIO *io = (PfxFindPairsIO*)taskManager->allocate(sizeof(PfxFindPairsIO)*numTasks);
+
+	taskManager->setTaskEntry((void*)pfxFindPairsTaskEntry);
+
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		io[t].proxies = param.proxies;
+		io[t].numProxies = param.numProxies;
+		io[t].maxPairs = param.maxPairs;
+		io[t].axis = param.axis;
+		io[t].taskPairs = (PfxBroadphasePair*)pool.allocate(sizeof(PfxBroadphasePair)*param.maxPairs,PfxHeapManager::ALIGN128);
+		io[t].numTaskPairs = 0;
+		io[t].outPairs = pairs;
+		io[t].outOffset = 0;
+		io[t].ret = SCE_PFX_OK;
+		io[t].ioTop = io;
+	}
+
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		taskManager->startTask(t,&io[t],0,0,0,0);
+	}
+
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		int taskId;
+		PfxUInt32 data1,data2,data3,data4;
+		taskManager->waitTask(taskId,data1,data2,data3,data4);
+	}
+
+	PfxUInt32 numPairs = 0;
+	PfxUInt32 *offsets = (PfxUInt32*)taskManager->allocate(sizeof(PfxUInt32)*(numTasks+1));
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		if(io[t].ret != SCE_PFX_OK) ret = io[t].ret;
+		offsets[t] = numPairs;
+		numPairs += io[t].numTaskPairs;
+	}
+	offsets[numTasks] = numPairs;
+
+	if(ret == SCE_PFX_OK && numPairs > param.maxPairs) {
+		ret = SCE_PFX_ERR_OUT_OF_MAX_PAIRS;
+	}
+
+	if(ret == SCE_PFX_OK) {
+		pfxMergeSortedRuns(pairs,io[0].taskPairs,offsets,numTasks);
+
+		result.pairs = pairs;
+		result.numPairs = numPairs;
+	}
+
+	pool.clear();
+	taskManager->deallocate(offsets);
+	taskManager->deallocate(io);
+
+	SCE_PFX_POP_MARKER();
+
+	return ret;
+}
+
+} //namespace PhysicsEffects
+} //namespace sce
@@ -0,0 +1,561 @@
+/*
+Physics Effects Copyright(C) 2010 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#include "../../../include/physics_effects/base_level/base/pfx_perf_counter.h"
+#include "../../../include/physics_effects/base_level/base/pfx_heap_manager.h"
+#include "../../../include/physics_effects/base_level/sort/pfx_sort.h"
+#include "../../../include/physics_effects/base_level/broadphase/pfx_update_broadphase_proxy.h"
+#include "../../../include/physics_effects/low_level/broadphase/pfx_dynamic_tree.h"
+#include "../../base_level/broadphase/pfx_check_collidable.h"
+
+namespace sce {
+namespace PhysicsEffects {
+
+///////////////////////////////////////////////////////////////////////////////
+// Dynamic AABB Tree
+
+#define SCE_PFX_DYNAMIC_TREE_NULL_NODE 0xffffffff
+
+//J AABBはプロキシと同じく16ビットに量子化されたワールド座標
+//E AABBs are stored in the same 16 bit quantized world coordinates as proxies
+struct PfxDynamicTreeNode {
+	PfxUInt16 aabbMin[3];
+	PfxUInt16 aabbMax[3];
+	PfxUInt32 parent;   // Next free node while the node is unused
+	PfxUInt32 child[2]; // A leaf holds the rigid body id in child[0] and NULL_NODE in child[1]
+};
+
+struct PfxDynamicTree {
+	PfxUInt32 maxRigidBodies;
+	PfxUInt32 numRigidBodies;
+	PfxFloat worldCenter[3];
+	PfxFloat worldExtent[3];
+	PfxUInt32 root;
+	PfxUInt32 freeNode;
+	PfxUInt32 numRotations;
+	PfxDynamicTreeNode *nodes;
+	PfxUInt32 *leaves; // Leaf node of each rigid body
+	PfxBroadphaseProxy *proxies;
+};
+
+PfxUInt32 pfxGetTreeBytesOfCreateDynamicTree(PfxUInt32 maxRigidBodies)
+{
+	return 16 +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxDynamicTree)) +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxDynamicTreeNode)*maxRigidBodies*2) +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxUInt32)*maxRigidBodies) +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxBroadphaseProxy)*maxRigidBodies);
+}
+
+PfxUInt32 pfxGetWorkBytesOfFindPairsDynamicTree(PfxUInt32 maxRigidBodies,PfxUInt32 maxPairs)
+{
+	return 16 +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxUInt32)*(maxRigidBodies+1)) +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxBroadphasePair)*maxPairs);
+}
+
+PfxUInt32 pfxGetPairBytesOfFindPairsDynamicTree(PfxUInt32 maxPairs)
+{
+	return 16 + sizeof(PfxBroadphasePair)*maxPairs;
+}
+
+PfxInt32 pfxCheckParamOfCreateDynamicTree(const PfxCreateDynamicTreeParam &param)
+{
+	if(!param.treeBuff || param.maxRigidBodies == 0 || param.maxRigidBodies > SCE_PFX_MAX_OBJECT_IDS) return SCE_PFX_ERR_INVALID_VALUE;
+	if(SCE_PFX_AVAILABLE_BYTES_ALIGN16(param.treeBuff,param.treeBytes) < pfxGetTreeBytesOfCreateDynamicTree(param.maxRigidBodies)) return SCE_PFX_ERR_OUT_OF_BUFFER;
+	return SCE_PFX_OK;
+}
+
+PfxInt32 pfxCheckParamOfUpdateDynamicTree(const PfxUpdateDynamicTreeParam &param)
+{
+	if(!param.tree || !param.offsetRigidStates || !param.offsetCollidables) return SCE_PFX_ERR_INVALID_VALUE;
+	if(param.numRigidBodies > param.tree->maxRigidBodies) return SCE_PFX_ERR_OUT_OF_RANGE;
+	return SCE_PFX_OK;
+}
+
+PfxInt32 pfxCheckParamOfFindPairsDynamicTree(const PfxFindPairsDynamicTreeParam &param)
+{
+	if(!param.workBuff || !param.pairBuff || !param.tree) return SCE_PFX_ERR_INVALID_VALUE;
+	if(SCE_PFX_AVAILABLE_BYTES_ALIGN16(param.workBuff,param.workBytes) < pfxGetWorkBytesOfFindPairsDynamicTree(param.tree->maxRigidBodies,param.maxPairs)) return SCE_PFX_ERR_OUT_OF_BUFFER;
+	if(SCE_PFX_AVAILABLE_BYTES_ALIGN16(param.pairBuff,param.pairBytes) < pfxGetPairBytesOfFindPairsDynamicTree(param.maxPairs)) return SCE_PFX_ERR_OUT_OF_BUFFER;
+	return SCE_PFX_OK;
+}
+
+PfxInt32 pfxCreateDynamicTree(PfxCreateDynamicTreeParam &param,PfxCreateDynamicTreeResult &result)
+{
+	PfxInt32 ret = pfxCheckParamOfCreateDynamicTree(param);
+	if(ret != SCE_PFX_OK) return ret;
+
+	PfxHeapManager pool((unsigned char*)param.treeBuff,param.treeBytes);
+
+	PfxDynamicTree *tree = (PfxDynamicTree*)pool.allocate(sizeof(PfxDynamicTree));
+	tree->maxRigidBodies = param.maxRigidBodies;
+	tree->nodes = (PfxDynamicTreeNode*)pool.allocate(sizeof(PfxDynamicTreeNode)*param.maxRigidBodies*2);
+	tree->leaves = (PfxUInt32*)pool.allocate(sizeof(PfxUInt32)*param.maxRigidBodies);
+	tree->proxies = (PfxBroadphaseProxy*)pool.allocate(sizeof(PfxBroadphaseProxy)*param.maxRigidBodies);
+	for(int axis=0;axis<3;axis++) {
+		tree->worldCenter[axis] = 0.0f;
+		tree->worldExtent[axis] = 0.0f;
+	}
+
+	pfxResetDynamicTree(tree);
+
+	result.tree = tree;
+
+	return SCE_PFX_OK;
+}
+
+void pfxResetDynamicTree(PfxDynamicTree *tree)
+{
+	tree->numRigidBodies = 0;
+	tree->root = SCE_PFX_DYNAMIC_TREE_NULL_NODE;
+	tree->freeNode = 0;
+
+	PfxUInt32 numNodes = tree->maxRigidBodies*2;
+	for(PfxUInt32 i=0;i<numNodes;i++) {
+		tree->nodes[i].parent = i+1<numNodes ? i+1 : SCE_PFX_DYNAMIC_TREE_NULL_NODE;
+	}
+}
+
+static SCE_PFX_FORCE_INLINE
+PfxUInt32 pfxAllocateNode(PfxDynamicTree *tree)
+{
+	PfxUInt32 nodeId = tree->freeNode;
+	SCE_PFX_ASSERT(nodeId != SCE_PFX_DYNAMIC_TREE_NULL_NODE);
+	tree->freeNode = tree->nodes[nodeId].parent;
+	return nodeId;
+}
+
+static SCE_PFX_FORCE_INLINE
+void pfxFreeNode(PfxDynamicTree *tree,PfxUInt32 nodeId)
+{
+	tree->nodes[nodeId].parent = tree->freeNode;
+	tree->freeNode = nodeId;
+}
+
+static SCE_PFX_FORCE_INLINE
+PfxBool pfxIsLeaf(const PfxDynamicTreeNode &node)
+{
+	return node.child[1] == SCE_PFX_DYNAMIC_TREE_NULL_NODE;
+}
+
+//J 表面積の半分をコストとして用いる
+//E Half of the surface area is used as the cost
+static SCE_PFX_FORCE_INLINE
+PfxFloat pfxSurfaceArea(const PfxDynamicTreeNode &node)
+{
+	PfxFloat dx = (PfxFloat)(node.aabbMax[0] - node.aabbMin[0]);
+	PfxFloat dy = (PfxFloat)(node.aabbMax[1] - node.aabbMin[1]);
+	PfxFloat dz = (PfxFloat)(node.aabbMax[2] - node.aabbMin[2]);
+	return dx*dy + dy*dz + dz*dx;
+}
+
+static SCE_PFX_FORCE_INLINE
+PfxFloat pfxSurfaceAreaOfUnion(const PfxDynamicTreeNode &nodeA,const PfxDynamicTreeNode &nodeB)
+{
+	PfxFloat dx = (PfxFloat)(SCE_PFX_MAX(nodeA.aabbMax[0],nodeB.aabbMax[0]) - SCE_PFX_MIN(nodeA.aabbMin[0],nodeB.aabbMin[0]));
+	PfxFloat dy = (PfxFloat)(SCE_PFX_MAX(nodeA.aabbMax[1],nodeB.aabbMax[1]) - SCE_PFX_MIN(nodeA.aabbMin[1],nodeB.aabbMin[1]));
+	PfxFloat dz = (PfxFloat)(SCE_PFX_MAX(nodeA.aabbMax[2],nodeB.aabbMax[2]) - SCE_PFX_MIN(nodeA.aabbMin[2],nodeB.aabbMin[2]));
+	return dx*dy + dy*dz + dz*dx;
+}
+
+static SCE_PFX_FORCE_INLINE
+void pfxMergeAabb(PfxDynamicTreeNode &node,const PfxDynamicTreeNode &nodeA,const PfxDynamicTreeNode &nodeB)
+{
+	for(int axis=0;axis<3;axis++) {
+		node.aabbMin[axis] = SCE_PFX_MIN(nodeA.aabbMin[axis],nodeB.aabbMin[axis]);
+		node.aabbMax[axis] = SCE_PFX_MAX(nodeA.aabbMax[axis],nodeB.aabbMax[axis]);
+	}
+}
+
+static SCE_PFX_FORCE_INLINE
+PfxBool pfxTestAabb(const PfxDynamicTreeNode &node,const PfxBroadphaseProxy &proxy)
+{
+	if(node.aabbMax[0] < pfxGetXMin(proxy) || node.aabbMin[0] > pfxGetXMax(proxy)) return false;
+	if(node.aabbMax[1] < pfxGetYMin(proxy) || node.aabbMin[1] > pfxGetYMax(proxy)) return false;
+	if(node.aabbMax[2] < pfxGetZMin(proxy) || node.aabbMin[2] > pfxGetZMax(proxy)) return false;
+	return true;
+}
+
+static SCE_PFX_FORCE_INLINE
+PfxBool pfxContainsAabb(const PfxDynamicTreeNode &node,const PfxBroadphaseProxy &proxy)
+{
+	for(int axis=0;axis<3;axis++) {
+		if(pfxGetXYZMin(proxy,axis) < node.aabbMin[axis] || pfxGetXYZMax(proxy,axis) > node.aabbMax[axis]) return false;
+	}
+	return true;
+}
+
+static SCE_PFX_FORCE_INLINE
+void pfxSetFatAabb(PfxDynamicTreeNode &node,const PfxBroadphaseProxy &proxy,const PfxUInt32 *margin)
+{
+	for(int axis=0;axis<3;axis++) {
+		PfxUInt32 aabbMin = pfxGetXYZMin(proxy,axis);
+		PfxUInt32 aabbMax = pfxGetXYZMax(proxy,axis) + margin[axis];
+		node.aabbMin[axis] = aabbMin > margin[axis] ? (PfxUInt16)(aabbMin - margin[axis]) : 0;
+		node.aabbMax[axis] = (PfxUInt16)SCE_PFX_MIN(aabbMax,0xffffu);
+	}
+}
+
+//J 子と孫を入れ替えて表面積が小さくなる場合は回転する。ノード自身のAABBは変化しない
+//E Swap a child with a grandchild when that reduces the surface area of the
+//E modified child. The AABB of the node itself doesn't change.
+static void pfxRotateNode(PfxDynamicTree *tree,PfxUInt32 nodeId)
+{
+	PfxDynamicTreeNode *nodes = tree->nodes;
+	PfxDynamicTreeNode &nodeA = nodes[nodeId];
+	PfxUInt32 idB = nodeA.child[0];
+	PfxUInt32 idC = nodeA.child[1];
+	PfxDynamicTreeNode &nodeB = nodes[idB];
+	PfxDynamicTreeNode &nodeC = nodes[idC];
+
+	PfxFloat bestGain = 0.0f;
+	int bestRotation = -1;
+
+	if(!pfxIsLeaf(nodeC)) {
+		PfxFloat areaC = pfxSurfaceArea(nodeC);
+		PfxFloat gainBF = areaC - pfxSurfaceAreaOfUnion(nodeB,nodes[nodeC.child[1]]);
+		PfxFloat gainBG = areaC - pfxSurfaceAreaOfUnion(nodeB,nodes[nodeC.child[0]]);
+		if(gainBF > bestGain) {bestGain = gainBF;bestRotation = 0;}
+		if(gainBG > bestGain) {bestGain = gainBG;bestRotation = 1;}
+	}
+
+	if(!pfxIsLeaf(nodeB)) {
+		PfxFloat areaB = pfxSurfaceArea(nodeB);
+		PfxFloat gainCD = areaB - pfxSurfaceAreaOfUnion(nodeC,nodes[nodeB.child[1]]);
+		PfxFloat gainCE = areaB - pfxSurfaceAreaOfUnion(nodeC,nodes[nodeB.child[0]]);
+		if(gainCD > bestGain) {bestGain = gainCD;bestRotation = 2;}
+		if(gainCE > bestGain) {bestGain = gainCE;bestRotation = 3;}
+	}
+
+	if(bestRotation < 0) return;
+
+	if(bestRotation < 2) {
+		// Swap B with a child of C
+		int i = bestRotation;
+		PfxUInt32 idGrandChild = nodeC.child[i];
+		nodeA.child[0] = idGrandChild;
+		nodes[idGrandChild].parent = nodeId;
+		nodeC.child[i] = idB;
+		nodeB.parent = idC;
+		pfxMergeAabb(nodeC,nodes[nodeC.child[0]],nodes[nodeC.child[1]]);
+	}
+	else {
+		// Swap C with a child of B
+		int i = bestRotation - 2;
+		PfxUInt32 idGrandChild = nodeB.child[i];
+		nodeA.child[1] = idGrandChild;
+		nodes[idGrandChild].parent = nodeId;
+		nodeB.child[i] = idC;
+		nodeC.parent = idB;
+		pfxMergeAabb(nodeB,nodes[nodeB.child[0]],nodes[nodeB.child[1]]);
+	}
+
+	tree->numRotations++;
+}
+
+//J 祖先のAABBを更新しながら回転する。AABBが変化しなくなった時点で終了する
+//E Refit and rotate the ancestors, stopping at the first one whose AABB is unchanged
+static void pfxRefitAncestors(PfxDynamicTree *tree,PfxUInt32 nodeId)
+{
+	PfxDynamicTreeNode *nodes = tree->nodes;
+
+	while(nodeId != SCE_PFX_DYNAMIC_TREE_NULL_NODE) {
+		PfxDynamicTreeNode &node = nodes[nodeId];
+		PfxDynamicTreeNode prevNode = node;
+
+		pfxMergeAabb(node,nodes[node.child[0]],nodes[node.child[1]]);
+		pfxRotateNode(tree,nodeId);
+
+		if(	node.aabbMin[0] == prevNode.aabbMin[0] && node.aabbMax[0] == prevNode.aabbMax[0] &&
+			node.aabbMin[1] == prevNode.aabbMin[1] && node.aabbMax[1] == prevNode.aabbMax[1] &&
+			node.aabbMin[2] == prevNode.aabbMin[2] && node.aabbMax[2] == prevNode.aabbMax[2]) {
+			break;
+		}
+
+		nodeId = node.parent;
+	}
+}
+
+static void pfxInsertLeaf(PfxDynamicTree *tree,PfxUInt32 leafId)
+{
+	PfxDynamicTreeNode *nodes = tree->nodes;
+	PfxDynamicTreeNode &leaf = nodes[leafId];
+
+	if(tree->root == SCE_PFX_DYNAMIC_TREE_NULL_NODE) {
+		tree->root = leafId;
+		leaf.parent = SCE_PFX_DYNAMIC_TREE_NULL_NODE;
+		return;
+	}
+
+	//J 表面積ヒューリスティックで兄弟ノードを探す
+	//E Descend to the sibling with the lowest surface area cost
+	PfxUInt32 siblingId = tree->root;
+	while(!pfxIsLeaf(nodes[siblingId])) {
+		const PfxDynamicTreeNode &node = nodes[siblingId];
+
+		PfxFloat area = pfxSurfaceArea(node);
+		PfxFloat combinedArea = pfxSurfaceAreaOfUnion(node,leaf);
+		PfxFloat cost = 2.0f * combinedArea;
+		PfxFloat inheritanceCost = 2.0f * (combinedArea - area);
+
+		PfxFloat childCost[2];
+		for(int i=0;i<2;i++) {
+			const PfxDynamicTreeNode &child = nodes[node.child[i]];
+			childCost[i] = pfxSurfaceAreaOfUnion(child,leaf) + inheritanceCost;
+			if(!pfxIsLeaf(child)) {
+				childCost[i] -= pfxSurfaceArea(child);
+			}
+		}
+
+		if(cost < childCost[0] && cost < childCost[1]) break;
+
+		siblingId = childCost[0] < childCost[1] ? node.child[0] : node.child[1];
+	}
+
+	PfxUInt32 oldParentId = nodes[siblingId].parent;
+	PfxUInt32 newParentId = pfxAllocateNode(tree);
+	PfxDynamicTreeNode &newParent = nodes[newParentId];
+	newParent.parent = oldParentId;
+	newParent.child[0] = siblingId;
+	newParent.child[1] = leafId;
+	pfxMergeAabb(newParent,nodes[siblingId],leaf);
+	nodes[siblingId].parent = newParentId;
+	leaf.parent = newParentId;
+
+	if(oldParentId == SCE_PFX_DYNAMIC_TREE_NULL_NODE) {
+		tree->root = newParentId;
+	}
+	else {
+		PfxDynamicTreeNode &oldParent = nodes[oldParentId];
+		oldParent.child[oldParent.child[0] == siblingId ? 0 : 1] = newParentId;
+	}
+
+	pfxRotateNode(tree,newParentId);
+	pfxRefitAncestors(tree,oldParentId);
+}
+
+static void pfxRemoveLeaf(PfxDynamicTree *tree,PfxUInt32 leafId)
+{
+	PfxDynamicTreeNode *nodes = tree->nodes;
+
+	if(leafId == tree->root) {
+		tree->root = SCE_PFX_DYNAMIC_TREE_NULL_NODE;
+		return;
+	}
+
+	PfxUInt32 parentId = nodes[leafId].parent;
+	PfxDynamicTreeNode &parent = nodes[parentId];
+	PfxUInt32 grandParentId = parent.parent;
+	PfxUInt32 siblingId = parent.child[0] == leafId ? parent.child[1] : parent.child[0];
+
+	if(grandParentId == SCE_PFX_DYNAMIC_TREE_NULL_NODE) {
+		tree->root = siblingId;
+		nodes[siblingId].parent = SCE_PFX_DYNAMIC_TREE_NULL_NODE;
+	}
+	else {
+		PfxDynamicTreeNode &grandParent = nodes[grandParentId];
+		grandParent.child[grandParent.child[0] == parentId ? 0 : 1] = siblingId;
+		nodes[siblingId].parent = grandParentId;
+	}
+
+	pfxFreeNode(tree,parentId);
+	pfxRefitAncestors(tree,grandParentId);
+}
+
+PfxInt32 pfxUpdateDynamicTree(PfxUpdateDynamicTreeParam &param,PfxUpdateDynamicTreeResult &result)
+{
+	PfxInt32 ret = pfxCheckParamOfUpdateDynamicTree(param);
+	if(ret != SCE_PFX_OK) return ret;
+
+	SCE_PFX_PUSH_MARKER("pfxUpdateDynamicTree");
+
+	PfxDynamicTree *tree = param.tree;
+	PfxDynamicTreeNode *nodes = tree->nodes;
+
+	for(int axis=0;axis<3;axis++) {
+		if(tree->worldCenter[axis] != param.worldCenter[axis] || tree->worldExtent[axis] != param.worldExtent[axis]) {
+			pfxResetDynamicTree(tree);
+			break;
+		}
+	}
+
+	PfxUInt32 margin[3];
+	for(int axis=0;axis<3;axis++) {
+		tree->worldCenter[axis] = param.worldCenter[axis];
+		tree->worldExtent[axis] = param.worldExtent[axis];
+		PfxFloat m = ceilf(SCE_PFX_MAX(param.fatMargin,0.0f) * 65535.0f / (2.0f * param.worldExtent[axis]));
+		margin[axis] = (PfxUInt32)SCE_PFX_MIN(m,65535.0f);
+	}
+
+	tree->numRotations = 0;
+	result.numRefitLeaves = 0;
+	result.numOutOfWorldProxies = 0;
+
+	//J 減った剛体のリーフを削除する
+	//E Remove the leaves of the rigid bodies that no longer exist
+	for(PfxUInt32 i=param.numRigidBodies;i<tree->numRigidBodies;i++) {
+		pfxRemoveLeaf(tree,tree->leaves[i]);
+		pfxFreeNode(tree,tree->leaves[i]);
+	}
+
+	PfxUInt32 numExistingBodies = SCE_PFX_MIN(tree->numRigidBodies,param.numRigidBodies);
+
+	for(PfxUInt32 i=0;i<param.numRigidBodies;i++) {
+		PfxBroadphaseProxy &proxy = tree->proxies[i];
+		PfxInt32 chk = pfxUpdateBroadphaseProxy(proxy,param.offsetRigidStates[i],param.offsetCollidables[i],param.worldCenter,param.worldExtent,0);
+		SCE_PFX_ASSERT(pfxGetObjectId(proxy) == i);
+
+		if(chk == (PfxInt32)SCE_PFX_ERR_OUT_OF_WORLD) {
+			result.numOutOfWorldProxies++;
+
+			if(param.outOfWorldBehavior & SCE_PFX_OUT_OF_WORLD_BEHAVIOR_FIX_MOTION) {
+				PfxRigidState &state = param.offsetRigidStates[i];
+				state.setMotionType(kPfxMotionTypeFixed);
+				pfxSetMotionMask(proxy,state.getMotionMask());
+			}
+
+			//J リーフは残し、衝突フィルタを空にしてペアを作らないようにする
+			//E The leaf stays in the tree but an empty filter keeps it out of pairs
+			if(param.outOfWorldBehavior & SCE_PFX_OUT_OF_WORLD_BEHAVIOR_REMOVE_PROXY) {
+				pfxSetSelf(proxy,0);
+				pfxSetTarget(proxy,0);
+			}
+		}
+
+		if(i >= numExistingBodies) {
+			PfxUInt32 leafId = pfxAllocateNode(tree);
+			PfxDynamicTreeNode &leaf = nodes[leafId];
+			leaf.child[0] = i;
+			leaf.child[1] = SCE_PFX_DYNAMIC_TREE_NULL_NODE;
+			pfxSetFatAabb(leaf,proxy,margin);
+			pfxInsertLeaf(tree,leafId);
+			tree->leaves[i] = leafId;
+			result.numRefitLeaves++;
+		}
+		else {
+			PfxDynamicTreeNode &leaf = nodes[tree->leaves[i]];
+			if(!pfxContainsAabb(leaf,proxy)) {
+				pfxSetFatAabb(leaf,proxy,margin);
+				pfxRefitAncestors(tree,leaf.parent);
+				result.numRefitLeaves++;
+			}
+		}
+	}
+
+	tree->numRigidBodies = param.numRigidBodies;
+
+	result.numRotations = tree->numRotations;
+
+	SCE_PFX_POP_MARKER();
+
+	return SCE_PFX_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Find Pairs
+
+//J 固定とキーフレーム同士は衝突しないので、これらの剛体からはツリーを探索しない
+//E Fixed and keyframe bodies never collide with each other, so the tree
+//E is only queried from the other bodies.
+static SCE_PFX_FORCE_INLINE
+PfxBool pfxIsStaticInDynamicTree(const PfxBroadphaseProxy &proxy)
+{
+	PfxUInt32 motionType = pfxGetMotionMask(proxy)&SCE_PFX_MOTION_MASK_TYPE;
+	return motionType == kPfxMotionTypeFixed || motionType == kPfxMotionTypeKeyframe;
+}
+
+PfxInt32 pfxFindPairs(PfxFindPairsDynamicTreeParam &param,PfxFindPairsDynamicTreeResult &result)
+{
+	PfxInt32 ret = pfxCheckParamOfFindPairsDynamicTree(param);
+	if(ret != SCE_PFX_OK) return ret;
+
+	SCE_PFX_PUSH_MARKER("pfxFindPairs");
+
+	PfxDynamicTree *tree = param.tree;
+	const PfxDynamicTreeNode *nodes = tree->nodes;
+	const PfxBroadphaseProxy *proxies = tree->proxies;
+
+	PfxHeapManager pool((unsigned char*)param.workBuff,param.workBytes);
+
+	PfxUInt32 *stack = (PfxUInt32*)pool.allocate(sizeof(PfxUInt32)*(tree->maxRigidBodies+1));
+	PfxBroadphasePair *sortBuff = (PfxBroadphasePair*)pool.allocate(sizeof(PfxBroadphasePair)*param.maxPairs);
+
+	PfxBroadphasePair *pairs = (PfxBroadphasePair*)SCE_PFX_PTR_ALIGN16(param.pairBuff);
+	PfxUInt32 numPairs = 0;
+
+	for(PfxUInt32 i=0;i<tree->numRigidBodies && ret == SCE_PFX_OK;i++) {
+		const PfxBroadphaseProxy &proxyI = proxies[i];
+
+		if(pfxIsStaticInDynamicTree(proxyI)) continue;
+
+		PfxUInt32 stackPtr = 0;
+		stack[stackPtr++] = tree->root;
+
+		while(stackPtr > 0) {
+			const PfxDynamicTreeNode &node = nodes[stack[--stackPtr]];
+
+			if(!pfxTestAabb(node,proxyI)) continue;
+
+			if(!pfxIsLeaf(node)) {
+				stack[stackPtr++] = node.child[0];
+				stack[stackPtr++] = node.child[1];
+				continue;
+			}
+
+			//J 両方とも探索する剛体の場合は、IDの小さい方からのみペアを作る
+			//E When both bodies query the tree, only the lower id creates the pair
+			PfxUInt32 j = node.child[0];
+			const PfxBroadphaseProxy &proxyJ = proxies[j];
+			if(j == i || (j < i && !pfxIsStaticInDynamicTree(proxyJ))) continue;
+
+			const PfxBroadphaseProxy &proxyA = i < j ? proxyI : proxyJ;
+			const PfxBroadphaseProxy &proxyB = i < j ? proxyJ : proxyI;
+
+			if(pfxCheckCollidableInBroadphase(proxyA,proxyB)) {
+				if(numPairs >= param.maxPairs) {
+					ret = SCE_PFX_ERR_OUT_OF_MAX_PAIRS;
+					break;
+				}
+
+				PfxBroadphasePair &pair = pairs[numPairs++];
+				pfxSetBroadphaseFlag(pair,0);
+				pfxSetActive(pair,true);
+				pfxSetObjectIdA(pair,pfxGetObjectId(proxyA));
+				pfxSetObjectIdB(pair,pfxGetObjectId(proxyB));
+				pfxSetMotionMaskA(pair,pfxGetMotionMask(proxyA));
+				pfxSetMotionMaskB(pair,pfxGetMotionMask(proxyB));
+				pfxSetKey(pair,pfxCreateUniqueKey(pfxGetObjectId(proxyA),pfxGetObjectId(proxyB)));
+			}
+		}
+	}
+
+	if(ret == SCE_PFX_OK) {
+		pfxSort(pairs,sortBuff,numPairs);
+
+		result.pairs = pairs;
+		result.numPairs = numPairs;
+	}
+
+	pool.clear();
+
+	SCE_PFX_POP_MARKER();
+
+	return ret;
+}
+
+} //namespace PhysicsEffects
+} //namespace sce
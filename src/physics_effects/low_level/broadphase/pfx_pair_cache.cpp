@@ -0,0 +1,298 @@
+/*
+Physics Effects Copyright(C) 2011 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#include "../../../include/physics_effects/base_level/base/pfx_perf_counter.h"
+#include "../../../include/physics_effects/base_level/base/pfx_heap_manager.h"
+#include "../../../include/physics_effects/low_level/broadphase/pfx_pair_cache.h"
+
+namespace sce {
+namespace PhysicsEffects {
+
+///////////////////////////////////////////////////////////////////////////////
+// Pair Cache
+
+struct PfxPairCache {
+	PfxUInt32 maxPairs;
+	PfxUInt32 maxContacts;
+	PfxUInt32 numPairs;
+	PfxUInt32 pairSwap;
+	PfxUInt32 numAllocatedContacts; // Contact ids below this have been handed out at least once
+	PfxUInt32 numFreeContactIds;
+	PfxUInt32 numRemovePairs; // Removed by the last update, their manifolds are released by the next one
+	PfxBroadphasePair *pairs[2];
+	PfxBroadphasePair *removePairs;
+	PfxUInt32 *newPairIds;
+	PfxUInt32 *freeContactIds;
+	PfxContactManifold *contacts;
+};
+
+PfxUInt32 pfxGetCacheBytesOfCreatePairCache(PfxUInt32 maxPairs,PfxUInt32 maxContacts)
+{
+	return 128 +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxPairCache)) +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxBroadphasePair)*maxPairs) * 3 +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxUInt32)*maxPairs) +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxUInt32)*maxContacts) +
+		SCE_PFX_ALLOC_BYTES_ALIGN128(sizeof(PfxContactManifold)*maxContacts);
+}
+
+static PfxInt32 pfxCheckParamOfCreatePairCache(void *cacheBuff,PfxUInt32 cacheBytes,PfxUInt32 maxPairs,PfxUInt32 maxContacts)
+{
+	if(!cacheBuff || maxPairs == 0 || maxContacts == 0) return SCE_PFX_ERR_INVALID_VALUE;
+	if(SCE_PFX_AVAILABLE_BYTES_ALIGN16(cacheBuff,cacheBytes) < pfxGetCacheBytesOfCreatePairCache(maxPairs,maxContacts)) return SCE_PFX_ERR_OUT_OF_BUFFER;
+	return SCE_PFX_OK;
+}
+
+static PfxPairCache *pfxAllocatePairCache(void *cacheBuff,PfxUInt32 cacheBytes,PfxUInt32 maxPairs,PfxUInt32 maxContacts)
+{
+	PfxHeapManager pool((unsigned char*)cacheBuff,cacheBytes);
+
+	PfxPairCache *cache = (PfxPairCache*)pool.allocate(sizeof(PfxPairCache));
+	cache->maxPairs = maxPairs;
+	cache->maxContacts = maxContacts;
+	cache->pairs[0] = (PfxBroadphasePair*)pool.allocate(sizeof(PfxBroadphasePair)*maxPairs);
+	cache->pairs[1] = (PfxBroadphasePair*)pool.allocate(sizeof(PfxBroadphasePair)*maxPairs);
+	cache->removePairs = (PfxBroadphasePair*)pool.allocate(sizeof(PfxBroadphasePair)*maxPairs);
+	cache->newPairIds = (PfxUInt32*)pool.allocate(sizeof(PfxUInt32)*maxPairs);
+	cache->freeContactIds = (PfxUInt32*)pool.allocate(sizeof(PfxUInt32)*maxContacts);
+	cache->contacts = (PfxContactManifold*)pool.allocate(sizeof(PfxContactManifold)*maxContacts,PfxHeapManager::ALIGN128);
+
+	pfxResetPairCache(cache);
+
+	return cache;
+}
+
+PfxInt32 pfxCreatePairCache(PfxCreatePairCacheParam &param,PfxCreatePairCacheResult &result)
+{
+	PfxInt32 ret = pfxCheckParamOfCreatePairCache(param.cacheBuff,param.cacheBytes,param.maxPairs,param.maxContacts);
+	if(ret != SCE_PFX_OK) return ret;
+
+	result.cache = pfxAllocatePairCache(param.cacheBuff,param.cacheBytes,param.maxPairs,param.maxContacts);
+
+	return SCE_PFX_OK;
+}
+
+void pfxResetPairCache(PfxPairCache *cache)
+{
+	cache->numPairs = 0;
+	cache->pairSwap = 0;
+	cache->numAllocatedContacts = 0;
+	cache->numFreeContactIds = 0;
+	cache->numRemovePairs = 0;
+}
+
+PfxInt32 pfxGrowPairCache(PfxGrowPairCacheParam &param,PfxGrowPairCacheResult &result)
+{
+	if(!param.cache) return SCE_PFX_ERR_INVALID_VALUE;
+
+	PfxInt32 ret = pfxCheckParamOfCreatePairCache(param.cacheBuff,param.cacheBytes,param.maxPairs,param.maxContacts);
+	if(ret != SCE_PFX_OK) return ret;
+
+	const PfxPairCache *src = param.cache;
+
+	//J 使用中のコンタクトIDを保つため、これまでに割り当てたマニフォールドは全て移す
+	//E Every manifold handed out so far moves along, so contact ids stay valid
+	if(param.maxPairs < src->numPairs || param.maxContacts < src->numAllocatedContacts) return SCE_PFX_ERR_OUT_OF_RANGE;
+
+	PfxPairCache *dst = pfxAllocatePairCache(param.cacheBuff,param.cacheBytes,param.maxPairs,param.maxContacts);
+
+	memcpy(dst->pairs[0],src->pairs[src->pairSwap],sizeof(PfxBroadphasePair)*src->numPairs);
+	memcpy(dst->freeContactIds,src->freeContactIds,sizeof(PfxUInt32)*src->numFreeContactIds);
+	memcpy(dst->removePairs,src->removePairs,sizeof(PfxBroadphasePair)*src->numRemovePairs);
+	memcpy(dst->contacts,src->contacts,sizeof(PfxContactManifold)*src->numAllocatedContacts);
+
+	dst->numPairs = src->numPairs;
+	dst->numAllocatedContacts = src->numAllocatedContacts;
+	dst->numFreeContactIds = src->numFreeContactIds;
+	dst->numRemovePairs = src->numRemovePairs;
+
+	result.cache = dst;
+
+	return SCE_PFX_OK;
+}
+
+PfxInt32 pfxCheckParamOfUpdatePairCache(const PfxUpdatePairCacheParam &param)
+{
+	if(!param.cache || (param.numCurrentPairs > 0 && !param.currentPairs)) return SCE_PFX_ERR_INVALID_VALUE;
+	if(!SCE_PFX_PTR_IS_ALIGNED16(param.currentPairs)) return SCE_PFX_ERR_INVALID_ALIGN;
+	return SCE_PFX_OK;
+}
+
+//J 書き込まずに新規ペアと廃棄ペアを数える
+//E Count new and removed pairs without writing them
+static void pfxCountPairChanges(
+	const PfxBroadphasePair *previousPairs,PfxUInt32 numPreviousPairs,
+	const PfxBroadphasePair *currentPairs,PfxUInt32 numCurrentPairs,
+	PfxUInt32 &numNew,PfxUInt32 &numRemove)
+{
+	PfxUInt32 oldId = 0,newId = 0;
+	numNew = numRemove = 0;
+	while(oldId<numPreviousPairs&&newId<numCurrentPairs) {
+		if(pfxGetKey(currentPairs[newId]) > pfxGetKey(previousPairs[oldId])) {
+			numRemove++;
+			oldId++;
+		}
+		else if(pfxGetKey(currentPairs[newId]) == pfxGetKey(previousPairs[oldId])) {
+			oldId++;
+			newId++;
+		}
+		else {
+			numNew++;
+			newId++;
+		}
+	}
+	numNew += numCurrentPairs - newId;
+	numRemove += numPreviousPairs - oldId;
+}
+
+PfxInt32 pfxUpdatePairCache(PfxUpdatePairCacheParam &param,PfxUpdatePairCacheResult &result)
+{
+	PfxInt32 ret = pfxCheckParamOfUpdatePairCache(param);
+	if(ret != SCE_PFX_OK) return ret;
+
+	SCE_PFX_PUSH_MARKER("pfxUpdatePairCache");
+
+	PfxPairCache *cache = param.cache;
+
+	//J 前回の廃棄ペアのマニフォールドはoutRemovePairsとして参照され終わったので、ここで空きリストに戻す
+	//E The manifolds of the pairs removed by the last update were reported in
+	//E its outRemovePairs and are only returned to the free list now
+	for(PfxUInt32 i=0;i<cache->numRemovePairs;i++) {
+		cache->freeContactIds[cache->numFreeContactIds++] = pfxGetContactId(cache->removePairs[i]);
+	}
+	cache->numRemovePairs = 0;
+
+	PfxBroadphasePair *previousPairs = cache->pairs[cache->pairSwap];
+	PfxUInt32 numPreviousPairs = cache->numPairs;
+	PfxBroadphasePair *currentPairs = param.currentPairs;
+	PfxUInt32 numCurrentPairs = param.numCurrentPairs;
+	PfxUInt32 numUsedContacts = cache->numAllocatedContacts - cache->numFreeContactIds;
+
+	result.numNewPairs = 0;
+	result.numKeepPairs = 0;
+	result.outRemovePairs = cache->removePairs;
+	result.numOutRemovePairs = 0;
+	result.requiredPairs = numCurrentPairs;
+	result.requiredContacts = numUsedContacts;
+
+	if(numCurrentPairs > cache->maxPairs) {
+		PfxUInt32 numNew,numRemove;
+		pfxCountPairChanges(previousPairs,numPreviousPairs,currentPairs,numCurrentPairs,numNew,numRemove);
+		result.requiredContacts = numUsedContacts + numNew;
+		SCE_PFX_POP_MARKER();
+		return SCE_PFX_ERR_OUT_OF_MAX_PAIRS;
+	}
+
+	//J 前フレームのペアと現在のペアを合成する。どちらもキー順なので出力もキー順になる
+	//E Merge the previous pairs with the current pairs. Both are sorted by key,
+	//E so the output is sorted as well and needs no further sort.
+	PfxBroadphasePair *outPairs = cache->pairs[1-cache->pairSwap];
+	PfxBroadphasePair *outRemovePairs = cache->removePairs;
+	PfxUInt32 *newPairIds = cache->newPairIds;
+
+	PfxUInt32 nOut = 0;
+	PfxUInt32 nNew = 0;
+	PfxUInt32 nRemove = 0;
+	PfxUInt32 oldId = 0,newId = 0;
+
+	while(oldId<numPreviousPairs||newId<numCurrentPairs) {
+		if(newId >= numCurrentPairs || (oldId<numPreviousPairs && pfxGetKey(currentPairs[newId]) > pfxGetKey(previousPairs[oldId]))) {
+			// remove
+			outRemovePairs[nRemove++] = previousPairs[oldId++];
+		}
+		else if(oldId<numPreviousPairs && pfxGetKey(currentPairs[newId]) == pfxGetKey(previousPairs[oldId])) {
+			// keep
+			outPairs[nOut] = currentPairs[newId++];
+			pfxSetContactId(outPairs[nOut],pfxGetContactId(previousPairs[oldId++]));
+			nOut++;
+		}
+		else {
+			// new
+			newPairIds[nNew++] = nOut;
+			outPairs[nOut++] = currentPairs[newId++];
+		}
+	}
+
+	//J 廃棄ペアのマニフォールドは次の更新まで解放しない
+	//E The manifolds of removed pairs stay in use until the next update
+	result.requiredContacts = numUsedContacts + nNew;
+
+	if(result.requiredContacts > cache->maxContacts) {
+		SCE_PFX_POP_MARKER();
+		return SCE_PFX_ERR_OUT_OF_BUFFER;
+	}
+
+	//J 新規ペアにマニフォールドを割り当てて初期化する
+	//E Assign a manifold to each new pair and initialize it
+	for(PfxUInt32 i=0;i<nNew;i++) {
+		PfxBroadphasePair &pair = outPairs[newPairIds[i]];
+		PfxUInt32 cId;
+		if(cache->numFreeContactIds > 0) {
+			cId = cache->freeContactIds[--cache->numFreeContactIds];
+		}
+		else {
+			cId = cache->numAllocatedContacts++;
+		}
+		SCE_PFX_ASSERT(cId < cache->maxContacts);
+		pfxSetContactId(pair,cId);
+		cache->contacts[cId].reset(pfxGetObjectIdA(pair),pfxGetObjectIdB(pair));
+	}
+
+	cache->numPairs = nOut;
+	cache->pairSwap = 1-cache->pairSwap;
+	cache->numRemovePairs = nRemove;
+
+	result.numNewPairs = nNew;
+	result.numKeepPairs = nOut - nNew;
+	result.numOutRemovePairs = nRemove;
+
+	SCE_PFX_POP_MARKER();
+
+	return SCE_PFX_OK;
+}
+
+PfxBroadphasePair *pfxGetPairsOfPairCache(PfxPairCache *cache)
+{
+	return cache->pairs[cache->pairSwap];
+}
+
+PfxUInt32 pfxGetNumPairsOfPairCache(const PfxPairCache *cache)
+{
+	return cache->numPairs;
+}
+
+PfxContactManifold *pfxGetContactsOfPairCache(PfxPairCache *cache)
+{
+	return cache->contacts;
+}
+
+PfxUInt32 pfxGetNumContactsOfPairCache(const PfxPairCache *cache)
+{
+	return cache->numAllocatedContacts - cache->numFreeContactIds;
+}
+
+PfxUInt32 pfxGetMaxContactsOfPairCache(const PfxPairCache *cache)
+{
+	return cache->maxContacts;
+}
+
+PfxUInt32 pfxGetMaxPairsOfPairCache(const PfxPairCache *cache)
+{
+	return cache->maxPairs;
+}
+
+} //namespace PhysicsEffects
+} //namespace sce
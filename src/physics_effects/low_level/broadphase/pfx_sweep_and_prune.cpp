@@ -0,0 +1,484 @@
+/*
+Physics Effects Copyright(C) 2010 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#include "../../../include/physics_effects/base_level/base/pfx_perf_counter.h"
+#include "../../../include/physics_effects/base_level/base/pfx_heap_manager.h"
+#include "../../../include/physics_effects/base_level/sort/pfx_sort.h"
+#include "../../../include/physics_effects/base_level/broadphase/pfx_update_broadphase_proxy.h"
+#include "../../../include/physics_effects/low_level/broadphase/pfx_sweep_and_prune.h"
+#include "../../base_level/broadphase/pfx_check_collidable.h"
+
+namespace sce {
+namespace PhysicsEffects {
+
+///////////////////////////////////////////////////////////////////////////////
+// Sweep And Prune
+
+//J 端点キーは(座標<<1)|最大端フラグ。同じ座標では最小端が先に並ぶので、接している箱は交差とみなされる
+//E An endpoint key is (coordinate<<1)|isMax. At equal coordinates a min
+//E endpoint sorts before a max endpoint, matching the inclusive pfxTestAabb.
+#define SCE_PFX_SAP_KEY(value,isMax) ((((PfxUInt32)(value))<<1)|(isMax))
+
+struct PfxSapEndpoint {
+	PfxUInt32 key;
+	PfxUInt32 bodyId;
+};
+
+struct PfxSweepAndPrune {
+	PfxUInt32 maxRigidBodies;
+	PfxUInt32 numRigidBodies;
+	PfxBool valid;
+	PfxFloat worldCenter[3];
+	PfxFloat worldExtent[3];
+	PfxBroadphaseProxy *proxies;
+	PfxSapEndpoint *endpoints[3];
+	PfxUInt32 *positions[3]; // Index of each endpoint in endpoints[axis], [bodyId*2+isMax]
+};
+
+struct PfxSapContext {
+	PfxSweepAndPrune *sap;
+	PfxBroadphasePair *candidates;
+	PfxUInt32 numCandidates;
+	PfxUInt32 maxCandidates;
+	PfxBool overflow;
+};
+
+PfxUInt32 pfxGetSapBytesOfCreateSweepAndPrune(PfxUInt32 maxRigidBodies)
+{
+	return 16 +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxSweepAndPrune)) +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxBroadphaseProxy)*maxRigidBodies) +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxSapEndpoint)*maxRigidBodies*2) * 3 +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxUInt32)*maxRigidBodies*2) * 3;
+}
+
+PfxUInt32 pfxGetWorkBytesOfUpdateSweepAndPrune(PfxUInt32 maxRigidBodies,PfxUInt32 maxPairs)
+{
+	return 16 +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxBroadphasePair)*maxPairs) * 2 +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxSapEndpoint)*maxRigidBodies*2) +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxUInt32)*maxRigidBodies) * 2;
+}
+
+PfxUInt32 pfxGetPairBytesOfUpdateSweepAndPrune(PfxUInt32 numPreviousPairs,PfxUInt32 maxPairs)
+{
+	return 16 + sizeof(PfxBroadphasePair)*(maxPairs+numPreviousPairs*2);
+}
+
+PfxInt32 pfxCheckParamOfCreateSweepAndPrune(const PfxCreateSweepAndPruneParam &param)
+{
+	if(!param.sapBuff || param.maxRigidBodies == 0 || param.maxRigidBodies > SCE_PFX_MAX_OBJECT_IDS) return SCE_PFX_ERR_INVALID_VALUE;
+	if(SCE_PFX_AVAILABLE_BYTES_ALIGN16(param.sapBuff,param.sapBytes) < pfxGetSapBytesOfCreateSweepAndPrune(param.maxRigidBodies)) return SCE_PFX_ERR_OUT_OF_BUFFER;
+	return SCE_PFX_OK;
+}
+
+PfxInt32 pfxCheckParamOfUpdateSweepAndPrune(const PfxUpdateSweepAndPruneParam &param)
+{
+	if(!param.workBuff || !param.pairBuff || !param.sap || !param.offsetRigidStates || !param.offsetCollidables ||
+		(param.numPreviousPairs > 0 && !param.previousPairs)) return SCE_PFX_ERR_INVALID_VALUE;
+	if(param.numRigidBodies > param.sap->maxRigidBodies) return SCE_PFX_ERR_OUT_OF_RANGE;
+	if(!SCE_PFX_PTR_IS_ALIGNED16(param.previousPairs)) return SCE_PFX_ERR_INVALID_ALIGN;
+	if(SCE_PFX_AVAILABLE_BYTES_ALIGN16(param.workBuff,param.workBytes) < pfxGetWorkBytesOfUpdateSweepAndPrune(param.sap->maxRigidBodies,param.maxPairs)) return SCE_PFX_ERR_OUT_OF_BUFFER;
+	if(SCE_PFX_AVAILABLE_BYTES_ALIGN16(param.pairBuff,param.pairBytes) < pfxGetPairBytesOfUpdateSweepAndPrune(param.numPreviousPairs,param.maxPairs)) return SCE_PFX_ERR_OUT_OF_BUFFER;
+	return SCE_PFX_OK;
+}
+
+PfxInt32 pfxCreateSweepAndPrune(PfxCreateSweepAndPruneParam &param,PfxCreateSweepAndPruneResult &result)
+{
+	PfxInt32 ret = pfxCheckParamOfCreateSweepAndPrune(param);
+	if(ret != SCE_PFX_OK) return ret;
+
+	PfxHeapManager pool((unsigned char*)param.sapBuff,param.sapBytes);
+
+	PfxSweepAndPrune *sap = (PfxSweepAndPrune*)pool.allocate(sizeof(PfxSweepAndPrune));
+	sap->maxRigidBodies = param.maxRigidBodies;
+	sap->numRigidBodies = 0;
+	sap->valid = false;
+	sap->proxies = (PfxBroadphaseProxy*)pool.allocate(sizeof(PfxBroadphaseProxy)*param.maxRigidBodies);
+	for(int axis=0;axis<3;axis++) {
+		sap->endpoints[axis] = (PfxSapEndpoint*)pool.allocate(sizeof(PfxSapEndpoint)*param.maxRigidBodies*2);
+		sap->positions[axis] = (PfxUInt32*)pool.allocate(sizeof(PfxUInt32)*param.maxRigidBodies*2);
+		sap->worldCenter[axis] = 0.0f;
+		sap->worldExtent[axis] = 0.0f;
+	}
+
+	result.sap = sap;
+
+	return SCE_PFX_OK;
+}
+
+void pfxResetSweepAndPrune(PfxSweepAndPrune *sap)
+{
+	sap->valid = false;
+}
+
+static SCE_PFX_FORCE_INLINE
+void pfxSapSetPair(PfxBroadphasePair &pair,const PfxBroadphaseProxy &proxyA,const PfxBroadphaseProxy &proxyB)
+{
+	pfxSetBroadphaseFlag(pair,0);
+	pfxSetActive(pair,true);
+	pfxSetObjectIdA(pair,pfxGetObjectId(proxyA));
+	pfxSetObjectIdB(pair,pfxGetObjectId(proxyB));
+	pfxSetMotionMaskA(pair,pfxGetMotionMask(proxyA));
+	pfxSetMotionMaskB(pair,pfxGetMotionMask(proxyB));
+	pfxSetKey(pair,pfxCreateUniqueKey(pfxGetObjectId(proxyA),pfxGetObjectId(proxyB)));
+}
+
+static SCE_PFX_FORCE_INLINE
+void pfxSapAddCandidate(PfxSapContext &ctx,PfxUInt32 bodyA,PfxUInt32 bodyB)
+{
+	if(ctx.numCandidates >= ctx.maxCandidates) {
+		ctx.overflow = true;
+		return;
+	}
+
+	PfxBroadphasePair &pair = ctx.candidates[ctx.numCandidates++];
+	pfxSetObjectIdA(pair,(PfxObjectId)SCE_PFX_MIN(bodyA,bodyB));
+	pfxSetObjectIdB(pair,(PfxObjectId)SCE_PFX_MAX(bodyA,bodyB));
+	pfxSetKey(pair,pfxCreateUniqueKey(bodyA,bodyB));
+}
+
+//J 端点を新しいキーの位置まで挿入ソートで移動する。最小端と最大端が入れ替わったペアは交差状態が変わりうるので候補に追加する
+//E Move an endpoint to its new key by insertion sort. Passing a min endpoint
+//E over a max endpoint of another body (or vice versa) may change the overlap
+//E of that pair, so the pair becomes a candidate.
+static void pfxSapMoveEndpoint(PfxSapContext &ctx,int axis,PfxUInt32 idx,PfxUInt32 newKey)
+{
+	PfxSapEndpoint *endpoints = ctx.sap->endpoints[axis];
+	PfxUInt32 *positions = ctx.sap->positions[axis];
+	PfxUInt32 numEndpoints = ctx.sap->numRigidBodies*2;
+
+	PfxSapEndpoint ep = endpoints[idx];
+	ep.key = newKey;
+	PfxUInt32 isMax = newKey&1;
+
+	while(idx > 0 && endpoints[idx-1].key > newKey) {
+		const PfxSapEndpoint &prev = endpoints[idx-1];
+		if((prev.key&1) != isMax && prev.bodyId != ep.bodyId) {
+			pfxSapAddCandidate(ctx,ep.bodyId,prev.bodyId);
+		}
+		positions[prev.bodyId*2+(prev.key&1)] = idx;
+		endpoints[idx] = prev;
+		idx--;
+	}
+
+	while(idx+1 < numEndpoints && endpoints[idx+1].key < newKey) {
+		const PfxSapEndpoint &next = endpoints[idx+1];
+		if((next.key&1) != isMax && next.bodyId != ep.bodyId) {
+			pfxSapAddCandidate(ctx,ep.bodyId,next.bodyId);
+		}
+		positions[next.bodyId*2+(next.key&1)] = idx;
+		endpoints[idx] = next;
+		idx++;
+	}
+
+	endpoints[idx] = ep;
+	positions[ep.bodyId*2+isMax] = idx;
+}
+
+static void pfxSapSortEndpoints(PfxSapEndpoint *endpoints,PfxSapEndpoint *buff,PfxUInt32 n)
+{
+	PfxSapEndpoint *src = endpoints;
+	PfxSapEndpoint *dst = buff;
+
+	for(PfxUInt32 width=1;width<n;width*=2) {
+		for(PfxUInt32 lo=0;lo<n;lo+=width*2) {
+			PfxUInt32 mid = SCE_PFX_MIN(lo+width,n);
+			PfxUInt32 hi = SCE_PFX_MIN(lo+width*2,n);
+			PfxUInt32 i = lo,j = mid,k = lo;
+			while(i<mid && j<hi) {
+				if(src[j].key < src[i].key) {
+					dst[k++] = src[j++];
+				}
+				else {
+					dst[k++] = src[i++];
+				}
+			}
+			while(i<mid) dst[k++] = src[i++];
+			while(j<hi) dst[k++] = src[j++];
+		}
+		PfxSapEndpoint *tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	if(src != endpoints) {
+		for(PfxUInt32 i=0;i<n;i++) {
+			endpoints[i] = src[i];
+		}
+	}
+}
+
+static void pfxSapBuildEndpoints(PfxSweepAndPrune *sap,PfxSapEndpoint *buff)
+{
+	PfxUInt32 numRigidBodies = sap->numRigidBodies;
+
+	for(int axis=0;axis<3;axis++) {
+		PfxSapEndpoint *endpoints = sap->endpoints[axis];
+		PfxUInt32 *positions = sap->positions[axis];
+
+		for(PfxUInt32 i=0;i<numRigidBodies;i++) {
+			endpoints[i*2  ].key = SCE_PFX_SAP_KEY(pfxGetXYZMin(sap->proxies[i],axis),0);
+			endpoints[i*2  ].bodyId = i;
+			endpoints[i*2+1].key = SCE_PFX_SAP_KEY(pfxGetXYZMax(sap->proxies[i],axis),1);
+			endpoints[i*2+1].bodyId = i;
+		}
+
+		pfxSapSortEndpoints(endpoints,buff,numRigidBodies*2);
+
+		for(PfxUInt32 i=0;i<numRigidBodies*2;i++) {
+			positions[endpoints[i].bodyId*2+(endpoints[i].key&1)] = i;
+		}
+	}
+}
+
+//J X軸の端点を走査して全ての交差ペアを求める
+//E Sweep the sorted X endpoints to find every overlapping pair
+static PfxInt32 pfxSapFindAllPairs(PfxSweepAndPrune *sap,PfxBroadphasePair *pairs,PfxUInt32 maxPairs,PfxUInt32 &numPairs,PfxUInt32 *active,PfxUInt32 *activePos)
+{
+	PfxSapEndpoint *endpoints = sap->endpoints[0];
+	PfxUInt32 numActive = 0;
+
+	numPairs = 0;
+
+	for(PfxUInt32 i=0;i<sap->numRigidBodies*2;i++) {
+		PfxUInt32 bodyId = endpoints[i].bodyId;
+
+		if(endpoints[i].key&1) {
+			PfxUInt32 pos = activePos[bodyId];
+			active[pos] = active[--numActive];
+			activePos[active[pos]] = pos;
+			continue;
+		}
+
+		for(PfxUInt32 j=0;j<numActive;j++) {
+			const PfxBroadphaseProxy &proxyA = bodyId < active[j] ? sap->proxies[bodyId] : sap->proxies[active[j]];
+			const PfxBroadphaseProxy &proxyB = bodyId < active[j] ? sap->proxies[active[j]] : sap->proxies[bodyId];
+			if(pfxCheckCollidableInBroadphase(proxyA,proxyB)) {
+				if(numPairs >= maxPairs) {
+					return SCE_PFX_ERR_OUT_OF_MAX_PAIRS;
+				}
+				pfxSapSetPair(pairs[numPairs++],proxyA,proxyB);
+			}
+		}
+
+		activePos[bodyId] = numActive;
+		active[numActive++] = bodyId;
+	}
+
+	return SCE_PFX_OK;
+}
+
+PfxInt32 pfxUpdateSweepAndPrune(PfxUpdateSweepAndPruneParam &param,PfxUpdateSweepAndPruneResult &result)
+{
+	PfxInt32 ret = pfxCheckParamOfUpdateSweepAndPrune(param);
+	if(ret != SCE_PFX_OK) return ret;
+
+	SCE_PFX_PUSH_MARKER("pfxUpdateSweepAndPrune");
+
+	PfxSweepAndPrune *sap = param.sap;
+	PfxUInt32 numRigidBodies = param.numRigidBodies;
+
+	for(int axis=0;axis<3;axis++) {
+		if(sap->worldCenter[axis] != param.worldCenter[axis] || sap->worldExtent[axis] != param.worldExtent[axis]) {
+			sap->valid = false;
+		}
+	}
+	if(sap->numRigidBodies != numRigidBodies) {
+		sap->valid = false;
+	}
+
+	PfxHeapManager pool((unsigned char*)param.workBuff,param.workBytes);
+
+	PfxSapContext ctx;
+	ctx.sap = sap;
+	ctx.candidates = (PfxBroadphasePair*)pool.allocate(sizeof(PfxBroadphasePair)*param.maxPairs);
+	ctx.numCandidates = 0;
+	ctx.maxCandidates = param.maxPairs;
+	ctx.overflow = false;
+
+	PfxBroadphasePair *sortBuff = (PfxBroadphasePair*)pool.allocate(sizeof(PfxBroadphasePair)*param.maxPairs);
+	PfxSapEndpoint *endpointBuff = (PfxSapEndpoint*)pool.allocate(sizeof(PfxSapEndpoint)*sap->maxRigidBodies*2);
+	PfxUInt32 *active = (PfxUInt32*)pool.allocate(sizeof(PfxUInt32)*sap->maxRigidBodies);
+	PfxUInt32 *activePos = (PfxUInt32*)pool.allocate(sizeof(PfxUInt32)*sap->maxRigidBodies);
+
+	PfxBool rebuild = !sap->valid;
+	PfxUInt32 numMovedBodies = 0;
+
+	if(rebuild) {
+		SCE_PFX_PUSH_MARKER("Rebuild");
+
+		sap->numRigidBodies = numRigidBodies;
+		for(int axis=0;axis<3;axis++) {
+			sap->worldCenter[axis] = param.worldCenter[axis];
+			sap->worldExtent[axis] = param.worldExtent[axis];
+		}
+
+		for(PfxUInt32 i=0;i<numRigidBodies;i++) {
+			pfxUpdateBroadphaseProxy(sap->proxies[i],param.offsetRigidStates[i],param.offsetCollidables[i],param.worldCenter,param.worldExtent,0);
+			SCE_PFX_ASSERT(pfxGetObjectId(sap->proxies[i]) == i);
+		}
+
+		pfxSapBuildEndpoints(sap,endpointBuff);
+
+		numMovedBodies = numRigidBodies;
+
+		SCE_PFX_POP_MARKER();
+	}
+	else {
+		SCE_PFX_PUSH_MARKER("Update Endpoints");
+
+		for(PfxUInt32 i=0;i<numRigidBodies;i++) {
+			PfxBroadphaseProxy proxy;
+			pfxUpdateBroadphaseProxy(proxy,param.offsetRigidStates[i],param.offsetCollidables[i],param.worldCenter,param.worldExtent,0);
+			SCE_PFX_ASSERT(pfxGetObjectId(proxy) == i);
+
+			PfxBroadphaseProxy &prevProxy = sap->proxies[i];
+
+			PfxBool moved =
+				pfxGetXMin(proxy) != pfxGetXMin(prevProxy) || pfxGetXMax(proxy) != pfxGetXMax(prevProxy) ||
+				pfxGetYMin(proxy) != pfxGetYMin(prevProxy) || pfxGetYMax(proxy) != pfxGetYMax(prevProxy) ||
+				pfxGetZMin(proxy) != pfxGetZMin(prevProxy) || pfxGetZMax(proxy) != pfxGetZMax(prevProxy);
+			PfxBool filterChanged =
+				(pfxGetMotionMask(proxy)&SCE_PFX_MOTION_MASK_TYPE) != (pfxGetMotionMask(prevProxy)&SCE_PFX_MOTION_MASK_TYPE) ||
+				pfxGetSelf(proxy) != pfxGetSelf(prevProxy) || pfxGetTarget(proxy) != pfxGetTarget(prevProxy);
+
+			prevProxy = proxy;
+
+			if(moved) {
+				numMovedBodies++;
+				for(int axis=0;axis<3;axis++) {
+					pfxSapMoveEndpoint(ctx,axis,sap->positions[axis][i*2  ],SCE_PFX_SAP_KEY(pfxGetXYZMin(proxy,axis),0));
+					pfxSapMoveEndpoint(ctx,axis,sap->positions[axis][i*2+1],SCE_PFX_SAP_KEY(pfxGetXYZMax(proxy,axis),1));
+				}
+			}
+
+			//J 衝突フィルタやモーションタイプが変わった剛体は、交差している全ての剛体とのペアを再判定する
+			//E Bodies whose filter or motion type changed re-test every overlapping body
+			if(filterChanged) {
+				for(PfxUInt32 j=0;j<numRigidBodies && !ctx.overflow;j++) {
+					if(j != i && pfxTestAabb(sap->proxies[i],sap->proxies[j])) {
+						pfxSapAddCandidate(ctx,i,j);
+					}
+				}
+			}
+		}
+
+		SCE_PFX_POP_MARKER();
+	}
+
+	//J 候補が溢れた場合は全ペアを求め直す
+	//E Fall back to a full sweep when the candidates overflow
+	PfxBool verified = rebuild || ctx.overflow;
+
+	if(verified) {
+		ret = pfxSapFindAllPairs(sap,ctx.candidates,ctx.maxCandidates,ctx.numCandidates,active,activePos);
+		if(ret != SCE_PFX_OK) {
+			sap->valid = false;
+			SCE_PFX_POP_MARKER();
+			return ret;
+		}
+	}
+
+	pfxSort(ctx.candidates,sortBuff,ctx.numCandidates);
+
+	PfxBroadphasePair *candidates = ctx.candidates;
+	PfxUInt32 numCandidates = 0;
+	for(PfxUInt32 i=0;i<ctx.numCandidates;i++) {
+		if(numCandidates == 0 || pfxGetKey(candidates[numCandidates-1]) != pfxGetKey(candidates[i])) {
+			candidates[numCandidates++] = candidates[i];
+		}
+	}
+
+	PfxBroadphasePair *previousPairs = param.previousPairs;
+	PfxUInt32 numPreviousPairs = param.numPreviousPairs;
+
+	PfxBroadphasePair *outNewPairs = (PfxBroadphasePair*)SCE_PFX_PTR_ALIGN16(param.pairBuff);
+	PfxBroadphasePair *outKeepPairs = outNewPairs + param.maxPairs;
+	PfxBroadphasePair *outRemovePairs = outKeepPairs + numPreviousPairs;
+
+	PfxUInt32 nNew = 0;
+	PfxUInt32 nKeep = 0;
+	PfxUInt32 nRemove = 0;
+
+	PfxUInt32 oldId = 0,newId = 0;
+
+	while(oldId<numPreviousPairs || newId<numCandidates) {
+		if(newId >= numCandidates || (oldId<numPreviousPairs && pfxGetKey(previousPairs[oldId]) < pfxGetKey(candidates[newId]))) {
+			// not touched
+			const PfxBroadphasePair &pair = previousPairs[oldId++];
+			if(verified) {
+				outRemovePairs[nRemove++] = pair;
+			}
+			else {
+				PfxBroadphasePair &keepPair = outKeepPairs[nKeep++];
+				keepPair = pair;
+				pfxSetMotionMaskA(keepPair,pfxGetMotionMask(sap->proxies[pfxGetObjectIdA(pair)]));
+				pfxSetMotionMaskB(keepPair,pfxGetMotionMask(sap->proxies[pfxGetObjectIdB(pair)]));
+			}
+		}
+		else {
+			const PfxBroadphasePair &candidate = candidates[newId++];
+			const PfxBroadphaseProxy &proxyA = sap->proxies[pfxGetObjectIdA(candidate)];
+			const PfxBroadphaseProxy &proxyB = sap->proxies[pfxGetObjectIdB(candidate)];
+			PfxBool overlapped = verified || pfxCheckCollidableInBroadphase(proxyA,proxyB);
+
+			if(oldId<numPreviousPairs && pfxGetKey(previousPairs[oldId]) == pfxGetKey(candidate)) {
+				// touched existing pair
+				const PfxBroadphasePair &pair = previousPairs[oldId++];
+				if(overlapped) {
+					PfxBroadphasePair &keepPair = outKeepPairs[nKeep++];
+					keepPair = pair;
+					pfxSetMotionMaskA(keepPair,pfxGetMotionMask(proxyA));
+					pfxSetMotionMaskB(keepPair,pfxGetMotionMask(proxyB));
+				}
+				else {
+					outRemovePairs[nRemove++] = pair;
+				}
+			}
+			else if(overlapped) {
+				// new pair
+				pfxSapSetPair(outNewPairs[nNew++],proxyA,proxyB);
+			}
+		}
+	}
+
+	pool.clear();
+
+	if(nNew + nKeep > param.maxPairs) {
+		sap->valid = false;
+		SCE_PFX_POP_MARKER();
+		return SCE_PFX_ERR_OUT_OF_MAX_PAIRS;
+	}
+
+	sap->valid = true;
+
+	result.outNewPairs = outNewPairs;
+	result.numOutNewPairs = nNew;
+	result.outKeepPairs = outKeepPairs;
+	result.numOutKeepPairs = nKeep;
+	result.outRemovePairs = outRemovePairs;
+	result.numOutRemovePairs = nRemove;
+	result.numMovedBodies = numMovedBodies;
+	result.rebuilt = rebuild;
+
+	SCE_PFX_POP_MARKER();
+
+	return SCE_PFX_OK;
+}
+
+} //namespace PhysicsEffects
+} //namespace sce
@@ -0,0 +1,82 @@
+/*
+Physics Effects Copyright(C) 2010 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+#include "../../../include/physics_effects/base_level/base/pfx_perf_counter.h"
+#include "../../../include/physics_effects/low_level/collision/pfx_batched_ray_cast.h"
+
+namespace sce {
+namespace PhysicsEffects {
+
+extern void pfxCastRaysStart(PfxRayInput *rayInputs,PfxRayOutput *rayOutputs,int numRays,PfxRayCastParam &param);
+
+///////////////////////////////////////////////////////////////////////////////
+// MULTI THREADS
+
+struct PfxCastRaysIO {
+	PfxRayInput *rayInputs;
+	PfxRayOutput *rayOutputs;
+	int numRays;
+	PfxRayCastParam *param;
+};
+
+static void pfxCastRaysTaskEntry(PfxTaskArg *arg)
+{
+	PfxCastRaysIO *io = (PfxCastRaysIO*)arg->io;
+
+	int begin = (int)(((PfxUInt64)io->numRays * arg->taskId) / arg->maxTasks);
+	int end = (int)(((PfxUInt64)io->numRays * (arg->taskId+1)) / arg->maxTasks);
+
+	pfxCastRaysStart(io->rayInputs+begin,io->rayOutputs+begin,end-begin,*io->param);
+}
+
+void pfxCastRays(PfxRayInput *rayInputs,PfxRayOutput *rayOutputs,int numRays,PfxRayCastParam &param,PfxTaskManager *taskManager)
+{
+	SCE_PFX_ALWAYS_ASSERT(taskManager);
+	SCE_PFX_ALWAYS_ASSERT(SCE_PFX_PTR_IS_ALIGNED16(param.proxiesX));
+	SCE_PFX_ALWAYS_ASSERT(SCE_PFX_PTR_IS_ALIGNED16(param.proxiesY));
+	SCE_PFX_ALWAYS_ASSERT(SCE_PFX_PTR_IS_ALIGNED16(param.proxiesZ));
+	SCE_PFX_ALWAYS_ASSERT(SCE_PFX_PTR_IS_ALIGNED16(param.proxiesXb));
+	SCE_PFX_ALWAYS_ASSERT(SCE_PFX_PTR_IS_ALIGNED16(param.proxiesYb));
+	SCE_PFX_ALWAYS_ASSERT(SCE_PFX_PTR_IS_ALIGNED16(param.proxiesZb));
+	SCE_PFX_ALWAYS_ASSERT(SCE_PFX_PTR_IS_ALIGNED16(param.offsetRigidStates));
+	SCE_PFX_ALWAYS_ASSERT(SCE_PFX_PTR_IS_ALIGNED16(param.offsetCollidables));
+
+	SCE_PFX_PUSH_MARKER("pfxCastRays");
+
+	PfxUInt32 numTasks = taskManager->getNumTasks();
+
+	PfxCastRaysIO io;
+	io.rayInputs = rayInputs;
+	io.rayOutputs = rayOutputs;
+	io.numRays = numRays;
+	io.param = &param;
+
+	taskManager->setTaskEntry((void*)pfxCastRaysTaskEntry);
+
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		taskManager->startTask(t,&io,0,0,0,0);
+	}
+
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		int taskId;
+		PfxUInt32 data1,data2,data3,data4;
+		taskManager->waitTask(taskId,data1,data2,data3,data4);
+	}
+
+	SCE_PFX_POP_MARKER();
+}
+
+} //namespace PhysicsEffects
+} //namespace sce
@@ -0,0 +1,147 @@
+/*
+Physics Effects Copyright(C) 2010 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+#include "../../../include/physics_effects/base_level/base/pfx_perf_counter.h"
+#include "../../../include/physics_effects/low_level/collision/pfx_collision_detection.h"
+#include "../../base_level/broadphase/pfx_check_collidable.h"
+#include "../task/pfx_split_by_cost.h"
+#include "pfx_detect_collision_pair.h"
+
+namespace sce {
+namespace PhysicsEffects {
+
+extern int pfxCheckParamOfDetectCollision(PfxDetectCollisionParam &param);
+
+///////////////////////////////////////////////////////////////////////////////
+// MULTI THREADS
+
+//J 形状ごとの衝突判定の相対コスト
+//E Relative cost of collision detection per shape type
+static const PfxUInt32 pfxShapeCollisionCost[kPfxShapeCount] = {
+	1,	// kPfxShapeSphere
+	2,	// kPfxShapeBox
+	2,	// kPfxShapeCapsule
+	4,	// kPfxShapeCylinder
+	16,	// kPfxShapeConvexMesh
+	64,	// kPfxShapeLargeTriMesh
+	32,	// kPfxShapeHeightField
+	4,	// kPfxShapeReserved1
+	4,	// kPfxShapeReserved2
+	4,	// kPfxShapeUser0
+	4,	// kPfxShapeUser1
+	4,	// kPfxShapeUser2
+};
+
+static SCE_PFX_FORCE_INLINE
+PfxUInt32 pfxGetCollidableCost(const PfxCollidable &coll)
+{
+	PfxUInt32 cost = 0;
+	PfxShapeIterator itrShape(coll);
+	for(PfxUInt32 j=0;j<coll.getNumShapes();j++,++itrShape) {
+		cost += pfxShapeCollisionCost[(*itrShape).getType()];
+	}
+	return cost;
+}
+
+//J ペアのコストは両剛体の形状コストの積で見積もる
+//E The cost of a pair is estimated as the product of the shape costs of both
+//E bodies, so a convex mesh against a large mesh weighs ~1000 sphere pairs.
+struct PfxDetectCollisionCost {
+	const PfxDetectCollisionParam *param;
+
+	PfxUInt64 operator()(PfxUInt32 i) const
+	{
+		const PfxBroadphasePair &pair = param->contactPairs[i];
+		if(!pfxCheckCollidableInCollision(pair)) {
+			return 1;
+		}
+		PfxUInt64 costA = pfxGetCollidableCost(param->offsetCollidables[pfxGetObjectIdA(pair)]);
+		PfxUInt64 costB = pfxGetCollidableCost(param->offsetCollidables[pfxGetObjectIdB(pair)]);
+		return SCE_PFX_MAX(costA * costB,(PfxUInt64)1);
+	}
+};
+
+struct PfxDetectCollisionIO {
+	PfxDetectCollisionParam *param;
+	PfxUInt64 *taskCosts;
+};
+
+static void pfxDetectCollisionTaskEntry(PfxTaskArg *arg)
+{
+	PfxDetectCollisionIO *io = (PfxDetectCollisionIO*)arg->io;
+	PfxDetectCollisionParam &param = *io->param;
+
+	PfxDetectCollisionCost cost;
+	cost.param = &param;
+
+	PfxUInt32 begin,end;
+	pfxSplitByCost(arg,param.numContactPairs,io->taskCosts,cost,begin,end);
+
+	PfxPerfCounter pc;
+	pc.countBegin("pfxDetectCollisionTask");
+
+	for(PfxUInt32 i=begin;i<end;i++) {
+		const PfxBroadphasePair &pair = param.contactPairs[i];
+		if(!pfxCheckCollidableInCollision(pair)) {
+			continue;
+		}
+
+		pfxDetectCollisionPair(pair,param.offsetContactManifolds,param.offsetRigidStates,param.offsetCollidables);
+	}
+
+	pc.countEnd();
+
+	if(param.taskTimes) {
+		param.taskTimes[arg->taskId] = pc.getCountTime(0);
+	}
+}
+
+PfxInt32 pfxDetectCollision(PfxDetectCollisionParam &param,PfxTaskManager *taskManager)
+{
+	if(!taskManager) return SCE_PFX_ERR_INVALID_VALUE;
+
+	PfxInt32 ret = pfxCheckParamOfDetectCollision(param);
+	if(ret != SCE_PFX_OK) 
+		return ret;
+
+	SCE_PFX_PUSH_MARKER("pfxDetectCollision");
+
+	PfxUInt32 numTasks = taskManager->getNumTasks();
+
+	PfxDetectCollisionIO io;
+	io.param = &param;
+	io.taskCosts = (PfxUInt64*)taskManager->allocate(sizeof(PfxUInt64)*numTasks);
+
+	taskManager->setTaskEntry((void*)pfxDetectCollisionTaskEntry);
+
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		taskManager->startTask(t,&io,0,0,0,0);
+	}
+
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		int taskId;
+		PfxUInt32 data1,data2,data3,data4;
+		taskManager->waitTask(taskId,data1,data2,data3,data4);
+	}
+
+	taskManager->deallocate(io.taskCosts);
+
+	SCE_PFX_POP_MARKER();
+
+	return SCE_PFX_OK;
+}
+
+} //namespace PhysicsEffects
+} //namespace sce
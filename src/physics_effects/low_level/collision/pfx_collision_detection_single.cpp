@@ -18,8 +18,7 @@ Physics Effects under the filename: physics_effects_license.txt
 #include "../../../include/physics_effects/base_level/collision/pfx_shape_iterator.h"
 #include "../../../include/physics_effects/low_level/collision/pfx_collision_detection.h"
 #include "../../base_level/broadphase/pfx_check_collidable.h"
-#include "../../base_level/collision/pfx_contact_cache.h"
-#include "pfx_detect_collision_func.h"
+#include "pfx_detect_collision_pair.h"
 
 namespace sce {
 namespace PhysicsEffects {
@@ -37,8 +36,6 @@ int pfxCheckParamOfDetectCollision(PfxDetectCollisionParam &param)
 ///////////////////////////////////////////////////////////////////////////////
 // SINGLE THREAD
 
-#define SCE_PFX_CONTACT_THRESHOLD 0.0f
-
 PfxInt32 pfxDetectCollision(PfxDetectCollisionParam &param)
 {
 	PfxInt32 ret = pfxCheckParamOfDetectCollision(param);
@@ -60,58 +57,7 @@ PfxInt32 pfxDetectCollision(PfxDetectCollisionParam &param)
 			continue;
 		}
 
-		PfxUInt32 iContact = pfxGetContactId(pair);
-		PfxUInt32 iA = pfxGetObjectIdA(pair);
-		PfxUInt32 iB = pfxGetObjectIdB(pair);
-
-		PfxContactManifold &contact = offsetContactManifolds[iContact];
-
-		SCE_PFX_ALWAYS_ASSERT(iA==contact.getRigidBodyIdA());
-		SCE_PFX_ALWAYS_ASSERT(iB==contact.getRigidBodyIdB());
-
-		PfxRigidState &stateA = offsetRigidStates[iA];
-		PfxRigidState &stateB = offsetRigidStates[iB];
-		PfxCollidable &collA = offsetCollidables[iA];
-		PfxCollidable &collB = offsetCollidables[iB];
-		PfxTransform3 tA0(stateA.getOrientation(), stateA.getPosition());
-		PfxTransform3 tB0(stateB.getOrientation(), stateB.getPosition());
-		
-		PfxContactCache contactCache;
-		
-		PfxShapeIterator itrShapeA(collA);
-		for(PfxUInt32 j=0;j<collA.getNumShapes();j++,++itrShapeA) {
-			const PfxShape &shapeA = *itrShapeA;
-			PfxTransform3 offsetTrA = shapeA.getOffsetTransform();
-			PfxTransform3 worldTrA = tA0 * offsetTrA;
-
-			PfxShapeIterator itrShapeB(collB);
-			for(PfxUInt32 k=0;k<collB.getNumShapes();k++,++itrShapeB) {
-				const PfxShape &shapeB = *itrShapeB;
-				PfxTransform3 offsetTrB = shapeB.getOffsetTransform();
-				PfxTransform3 worldTrB = tB0 * offsetTrB;
-
-				if( (shapeA.getContactFilterSelf()&shapeB.getContactFilterTarget()) && 
-				    (shapeA.getContactFilterTarget()&shapeB.getContactFilterSelf()) ) {
-					pfxGetDetectCollisionFunc(shapeA.getType(),shapeB.getType())(
-						contactCache,
-						shapeA,offsetTrA,worldTrA,j,
-						shapeB,offsetTrB,worldTrB,k,
-						SCE_PFX_CONTACT_THRESHOLD);
-				}
-			}
-		}
-		
-		for(int j=0;j<contactCache.getNumContacts();j++) {
-			const PfxCachedContactPoint &cp = contactCache.getContactPoint(j);
-
-			contact.addContactPoint(
-				cp.m_distance,
-				cp.m_normal,
-				cp.m_localPointA,
-				cp.m_localPointB,
-				cp.m_subData
-				);
-		}
+		pfxDetectCollisionPair(pair,offsetContactManifolds,offsetRigidStates,offsetCollidables);
 	}
 
 	SCE_PFX_POP_MARKER();
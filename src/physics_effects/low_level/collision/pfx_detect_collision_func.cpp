@@ -23,6 +23,7 @@ Physics Effects under the filename: physics_effects_license.txt
 #include "../../base_level/collision/pfx_contact_sphere_sphere.h"
 #include "../../base_level/collision/pfx_gjk_solver.h"
 #include "../../base_level/collision/pfx_contact_large_tri_mesh.h"
+#include "../../base_level/collision/pfx_contact_height_field.h"
 #include "../../base_level/collision/pfx_gjk_support_func.h"
 #include "pfx_detect_collision_func.h"
 
@@ -232,12 +233,17 @@ void detectCollisionGjk(
 				const PfxShape &shapeB,const PfxTransform3 &offsetTransformB,const PfxTransform3 &worldTransformB,int shapeIdB,
 				float contactThreshold)
 {
-	(void)shapeIdA,(void)shapeIdB;
 	PfxFloat d = SCE_PFX_FLT_MAX;
 	PfxVector3 nml;
 	PfxPoint3 pA,pB;
 	PfxGjkSolver gjk;
 
+	// 前フレームの分離軸からGJKを開始する
+	PfxVector3 cachedAxis;
+	if(contacts.getCachedAxis((PfxUInt8)shapeIdA,(PfxUInt8)shapeIdB,cachedAxis)) {
+		gjk.setSeparatingAxis(worldTransformA.getUpper3x3() * cachedAxis);
+	}
+
 	if(shapeA.getType() == kPfxShapeCylinder) {
 		PfxCylinder cylinderA = shapeA.getCylinder();
 		
@@ -355,6 +361,11 @@ void detectCollisionGjk(
 
 	}
 
+	PfxVector3 separatingAxis;
+	if(gjk.getSeparatingAxis(separatingAxis)) {
+		contacts.setCachedAxis((PfxUInt8)shapeIdA,(PfxUInt8)shapeIdB,transpose(worldTransformA.getUpper3x3()) * separatingAxis);
+	}
+
 	if(d < contactThreshold) {
 		contacts.addContactPoint(d,nml,offsetTransformA*pA,offsetTransformB*pB,PfxSubData());
 	}
@@ -396,6 +407,53 @@ void detectCollisionLargeTriMesh(
 			contactThreshold);
 		
 		
+		for(int i=0;i<localContacts.getNumContacts();i++) {
+			contacts.addContactPoint(
+				localContacts.getDistance(i),
+				-localContacts.getNormal(i),
+				offsetTransformA * localContacts.getLocalPointB(i),
+				offsetTransformB * localContacts.getLocalPointA(i),
+				localContacts.getSubData(i));
+		}
+	}
+}
+
+void detectCollisionHeightField(
+				PfxContactCache &contacts,
+				const PfxShape &shapeA,const PfxTransform3 &offsetTransformA,const PfxTransform3 &worldTransformA,int shapeIdA,
+				const PfxShape &shapeB,const PfxTransform3 &offsetTransformB,const PfxTransform3 &worldTransformB,int shapeIdB,
+				float contactThreshold)
+{
+	(void)shapeIdA,(void)shapeIdB;
+	if(shapeA.getType() == kPfxShapeHeightField) {
+	const PfxHeightField *fieldA = shapeA.getHeightField();
+		
+		PfxContactCache localContacts;
+		pfxContactHeightField(localContacts,
+			fieldA,worldTransformA,
+			shapeB,worldTransformB,
+			contactThreshold);
+		
+		
+		for(int i=0;i<localContacts.getNumContacts();i++) {
+			contacts.addContactPoint(
+				localContacts.getDistance(i),
+				localContacts.getNormal(i),
+				offsetTransformA * localContacts.getLocalPointA(i),
+				offsetTransformB * localContacts.getLocalPointB(i),
+				localContacts.getSubData(i));
+		}
+	}
+	else if(shapeB.getType() == kPfxShapeHeightField) {
+	const PfxHeightField *fieldB = shapeB.getHeightField();
+
+		PfxContactCache localContacts;
+		pfxContactHeightField(localContacts,
+			fieldB,worldTransformB,
+			shapeA,worldTransformA,
+			contactThreshold);
+		
+		
 		for(int i=0;i<localContacts.getNumContacts();i++) {
 			contacts.addContactPoint(
 				localContacts.getDistance(i),
@@ -410,13 +468,13 @@ void detectCollisionLargeTriMesh(
 // Collision Detection Function Table
 
 pfx_detect_collision_func funcTbl_detectCollision[kPfxShapeCount][kPfxShapeCount] = {
-	{detectCollisionSphereSphere	,detectCollisionSphereBox	,detectCollisionSphereCapsule	,detectCollisionGjk			,detectCollisionGjk				,detectCollisionLargeTriMesh,	detectCollisionDummy,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy},
-	{detectCollisionBoxSphere		,detectCollisionBoxBox		,detectCollisionBoxCapsule		,detectCollisionGjk			,detectCollisionGjk				,detectCollisionLargeTriMesh,	detectCollisionDummy,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy},
-	{detectCollisionCapsuleSphere	,detectCollisionCapsuleBox	,detectCollisionCapsuleCapsule	,detectCollisionGjk			,detectCollisionGjk				,detectCollisionLargeTriMesh,	detectCollisionDummy,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy},
-	{detectCollisionGjk				,detectCollisionGjk			,detectCollisionGjk				,detectCollisionGjk			,detectCollisionGjk				,detectCollisionLargeTriMesh,	detectCollisionDummy,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy},
-	{detectCollisionGjk				,detectCollisionGjk			,detectCollisionGjk				,detectCollisionGjk			,detectCollisionGjk				,detectCollisionLargeTriMesh,	detectCollisionDummy,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy},
+	{detectCollisionSphereSphere	,detectCollisionSphereBox	,detectCollisionSphereCapsule	,detectCollisionGjk			,detectCollisionGjk				,detectCollisionLargeTriMesh,	detectCollisionHeightField,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy},
+	{detectCollisionBoxSphere		,detectCollisionBoxBox		,detectCollisionBoxCapsule		,detectCollisionGjk			,detectCollisionGjk				,detectCollisionLargeTriMesh,	detectCollisionHeightField,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy},
+	{detectCollisionCapsuleSphere	,detectCollisionCapsuleBox	,detectCollisionCapsuleCapsule	,detectCollisionGjk			,detectCollisionGjk				,detectCollisionLargeTriMesh,	detectCollisionHeightField,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy},
+	{detectCollisionGjk				,detectCollisionGjk			,detectCollisionGjk				,detectCollisionGjk			,detectCollisionGjk				,detectCollisionLargeTriMesh,	detectCollisionHeightField,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy},
+	{detectCollisionGjk				,detectCollisionGjk			,detectCollisionGjk				,detectCollisionGjk			,detectCollisionGjk				,detectCollisionLargeTriMesh,	detectCollisionHeightField,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy},
 	{detectCollisionLargeTriMesh	,detectCollisionLargeTriMesh,detectCollisionLargeTriMesh	,detectCollisionLargeTriMesh,detectCollisionLargeTriMesh	,detectCollisionDummy,	detectCollisionDummy,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy},
-	{detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy},
+	{detectCollisionHeightField	,detectCollisionHeightField,detectCollisionHeightField	,detectCollisionHeightField,detectCollisionHeightField	,detectCollisionDummy,	detectCollisionDummy,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy},
 	{detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy},
 	{detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy},
 	{detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy	,detectCollisionDummy,	detectCollisionDummy},
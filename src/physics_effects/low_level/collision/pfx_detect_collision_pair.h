@@ -0,0 +1,140 @@
+/*
+Physics Effects Copyright(C) 2010 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#ifndef _SCE_PFX_DETECT_COLLISION_PAIR_H
+#define _SCE_PFX_DETECT_COLLISION_PAIR_H
+
+#include "../../../include/physics_effects/base_level/collision/pfx_shape_iterator.h"
+#include "../../../include/physics_effects/low_level/collision/pfx_collision_detection.h"
+#include "../../base_level/collision/pfx_contact_cache.h"
+#include "pfx_detect_collision_func.h"
+
+#define SCE_PFX_CONTACT_THRESHOLD 0.0f
+
+///////////////////////////////////////////////////////////////////////////////
+// Detect collision of a single pair, shared by the single and multi thread versions
+
+namespace sce {
+namespace PhysicsEffects {
+
+static SCE_PFX_FORCE_INLINE
+void pfxDetectCollisionPair(
+	const PfxBroadphasePair &pair,
+	PfxContactManifold *offsetContactManifolds,
+	PfxRigidState *offsetRigidStates,
+	PfxCollidable *offsetCollidables)
+{
+	PfxUInt32 iContact = pfxGetContactId(pair);
+	PfxUInt32 iA = pfxGetObjectIdA(pair);
+	PfxUInt32 iB = pfxGetObjectIdB(pair);
+
+	PfxContactManifold &contact = offsetContactManifolds[iContact];
+
+	SCE_PFX_ALWAYS_ASSERT(iA==contact.getRigidBodyIdA());
+	SCE_PFX_ALWAYS_ASSERT(iB==contact.getRigidBodyIdB());
+
+	PfxRigidState &stateA = offsetRigidStates[iA];
+	PfxRigidState &stateB = offsetRigidStates[iB];
+	PfxCollidable &collA = offsetCollidables[iA];
+	PfxCollidable &collB = offsetCollidables[iB];
+	PfxTransform3 tA0(stateA.getOrientation(), stateA.getPosition());
+	PfxTransform3 tB0(stateB.getOrientation(), stateB.getPosition());
+	
+	PfxContactCache contactCache;
+
+	// 前回のGJKの分離軸を引き継ぐ
+	{
+		PfxUInt8 shapeIdA,shapeIdB;
+		PfxVector3 axis;
+		if(contact.getCachedAxis(shapeIdA,shapeIdB,axis)) {
+			contactCache.loadCachedAxis(shapeIdA,shapeIdB,axis);
+		}
+	}
+
+	// 形状のBVHを持つ場合は、相手のAABBと重なる形状の組み合わせだけを判定する
+	PfxTransform3 tAB = PfxTransform3::identity();
+	PfxTransform3 tBA = PfxTransform3::identity();
+	if(collA.getNumBvhNodes() > 0 || collB.getNumBvhNodes() > 0) {
+		tAB = orthoInverse(tA0) * tB0;
+		tBA = orthoInverse(tAB);
+	}
+
+	PfxUInt64 shapesA = collA.getAllShapes();
+	if(collA.getNumBvhNodes() > 0) {
+		PfxVector3 centerB = tAB.getUpper3x3() * collB.getCenter() + tAB.getTranslation();
+		PfxVector3 halfB = absPerElem(tAB.getUpper3x3()) * collB.getHalf();
+		shapesA = collA.getOverlappingShapes(centerB-halfB,centerB+halfB);
+	}
+
+	for(PfxUInt32 j=0;j<collA.getNumShapes();j++) {
+		if(!(shapesA & ((PfxUInt64)1 << j))) continue;
+
+		const PfxShape &shapeA = collA.getShape(j);
+		PfxTransform3 offsetTrA = shapeA.getOffsetTransform();
+		PfxTransform3 worldTrA = tA0 * offsetTrA;
+
+		PfxUInt64 shapesB = collB.getAllShapes();
+		if(collB.getNumBvhNodes() > 0) {
+			PfxVector3 aabbMinA,aabbMaxA;
+			shapeA.getAabb(aabbMinA,aabbMaxA);
+			PfxVector3 centerA = tBA.getUpper3x3() * ((aabbMaxA+aabbMinA)*0.5f) + tBA.getTranslation();
+			PfxVector3 halfA = absPerElem(tBA.getUpper3x3()) * ((aabbMaxA-aabbMinA)*0.5f);
+			shapesB = collB.getOverlappingShapes(centerA-halfA,centerA+halfA);
+		}
+
+		for(PfxUInt32 k=0;k<collB.getNumShapes();k++) {
+			if(!(shapesB & ((PfxUInt64)1 << k))) continue;
+
+			const PfxShape &shapeB = collB.getShape(k);
+			PfxTransform3 offsetTrB = shapeB.getOffsetTransform();
+			PfxTransform3 worldTrB = tB0 * offsetTrB;
+
+			if( (shapeA.getContactFilterSelf()&shapeB.getContactFilterTarget()) && 
+			    (shapeA.getContactFilterTarget()&shapeB.getContactFilterSelf()) ) {
+				pfxGetDetectCollisionFunc(shapeA.getType(),shapeB.getType())(
+					contactCache,
+					shapeA,offsetTrA,worldTrA,j,
+					shapeB,offsetTrB,worldTrB,k,
+					SCE_PFX_CONTACT_THRESHOLD);
+			}
+		}
+	}
+
+	// 今回更新された分離軸だけを保持する
+	if(contactCache.isCachedAxisUpdated()) {
+		contact.setCachedAxis(contactCache.getCachedAxisShapeIdA(),contactCache.getCachedAxisShapeIdB(),contactCache.getCachedAxis());
+	}
+	else {
+		contact.clearCachedAxis();
+	}
+	
+	for(int j=0;j<contactCache.getNumContacts();j++) {
+		const PfxCachedContactPoint &cp = contactCache.getContactPoint(j);
+
+		contact.addContactPoint(
+			cp.m_distance,
+			cp.m_normal,
+			cp.m_localPointA,
+			cp.m_localPointB,
+			cp.m_subData
+			);
+	}
+}
+
+} //namespace PhysicsEffects
+} //namespace sce
+
+#endif // _SCE_PFX_DETECT_COLLISION_PAIR_H
@@ -21,6 +21,7 @@ Physics Effects under the filename: physics_effects_license.txt
 #include "../../base_level/collision/pfx_intersect_ray_cylinder.h"
 #include "../../base_level/collision/pfx_intersect_ray_convex.h"
 #include "../../base_level/collision/pfx_intersect_ray_large_tri_mesh.h"
+#include "../../base_level/collision/pfx_intersect_ray_height_field.h"
 #include "pfx_intersect_ray_func.h"
 
 
@@ -91,6 +92,13 @@ const PfxLargeTriMesh *lmesh = shape.getLargeTriMesh();
 	return ret;
 }
 
+PfxBool intersectRayFuncHeightField(
+				const PfxRayInput &ray,PfxRayOutput &out,
+				const PfxShape &shape,const PfxTransform3 &transform)
+{
+	return pfxIntersectRayHeightField(ray,out,(const void*)shape.getHeightField(),transform);
+}
+
 PfxIntersectRayFunc funcTbl_intersectRay[kPfxShapeCount] = {
 	intersectRayFuncSphere,
 	intersectRayFuncBox,
@@ -98,7 +106,7 @@ PfxIntersectRayFunc funcTbl_intersectRay[kPfxShapeCount] = {
 	intersectRayFuncCylinder,
 	intersectRayFuncConvex,
 	intersectRayFuncLargeTriMesh,
-	intersectRayFuncDummy,
+	intersectRayFuncHeightField,
 	intersectRayFuncDummy,
 	intersectRayFuncDummy,
 	intersectRayFuncDummy,
@@ -24,6 +24,61 @@ Physics Effects under the filename: physics_effects_license.txt
 namespace sce {
 namespace PhysicsEffects {
 
+static SCE_PFX_FORCE_INLINE
+void pfxRayCastShape(const PfxRayInput &ray,PfxRayOutput &out,PfxRayOutput &tout,
+	const PfxShape &shape,PfxUInt32 shapeId,const PfxTransform3 &transform,PfxObjectId rigidbodyId)
+{
+	PfxTransform3 shapeTr = transform * shape.getOffsetTransform();
+	
+	if(pfxGetIntersectRayFunc(shape.getType())(ray,tout,shape,shapeTr) && tout.m_variable < out.m_variable) {
+		out = tout;
+		out.m_shapeId = shapeId;
+		out.m_objectId = rigidbodyId;
+	}
+}
+
+static SCE_PFX_FORCE_INLINE
+void pfxRayCastCollidable(const PfxRayInput &ray,PfxRayOutput &out,
+	const PfxCollidable &coll,const PfxTransform3 &transform,PfxObjectId rigidbodyId)
+{
+	PfxRayOutput tout = out;
+
+	if(coll.getNumBvhNodes() > 0) {
+		// レイを剛体のローカル座標へ変換し、形状のBVHを辿る
+		// レイと交差しないノードや既に見つかった交点より遠いノードは部分木ごと飛ばす
+		PfxTransform3 transformInv = orthoInverse(transform);
+		PfxVector3 rayStartPosition = transformInv.getUpper3x3() * ray.m_startPosition + transformInv.getTranslation();
+		PfxVector3 rayDirection = transformInv.getUpper3x3() * ray.m_direction;
+
+		PfxUInt32 numNodes = coll.getNumBvhNodes();
+		PfxUInt32 n = 0;
+		while(n < numNodes) {
+			const PfxAabb16 &node = coll.getBvhNode(n);
+			PfxVector3 aabbMin,aabbMax;
+			coll.getBvhNodeAabb(n,aabbMin,aabbMax);
+
+			PfxFloat t = 1.0f;
+			if(!pfxIntersectRayAABBFast(rayStartPosition,rayDirection,(aabbMax+aabbMin)*0.5f,(aabbMax-aabbMin)*0.5f,t) ||
+			   t >= out.m_variable) {
+				n = pfxGetBvhEscapeId(node);
+				continue;
+			}
+
+			PfxUInt32 shapeId = pfxGetBvhShapeId(node);
+			if(shapeId != SCE_PFX_COLLIDABLE_BVH_INTERNAL) {
+				pfxRayCastShape(ray,out,tout,coll.getShape(shapeId),shapeId,transform,rigidbodyId);
+			}
+			n++;
+		}
+	}
+	else {
+		PfxShapeIterator itrShape(coll);
+		for(PfxUInt32 j=0;j<coll.getNumShapes();j++,++itrShape) {
+			pfxRayCastShape(ray,out,tout,*itrShape,j,transform,rigidbodyId);
+		}
+	}
+}
+
 
 void pfxRayTraverseForward(
 	const PfxRayInput &ray,PfxRayOutput &out,const PfxAabb16 &rayAABB,
@@ -57,7 +112,7 @@ void pfxRayTraverseForward(
 			continue;
 		}
 
-		PfxUInt16 rigidbodyId = pfxGetObjectId(proxy);
+		PfxObjectId rigidbodyId = pfxGetObjectId(proxy);
 		PfxUInt32 contactFilterSelf = pfxGetSelf(proxy);
 		PfxUInt32 contactFilterTarget = pfxGetTarget(proxy);
 
@@ -76,19 +131,7 @@ void pfxRayTraverseForward(
 			PfxCollidable &coll = offsetCollidables[rigidbodyId];
 			PfxTransform3 transform(state.getOrientation(), state.getPosition());
 			
-			PfxRayOutput tout = out;
-			
-			PfxShapeIterator itrShape(coll);
-			for(PfxUInt32 j=0;j<coll.getNumShapes();j++,++itrShape) {
-				const PfxShape &shape = *itrShape;
-				PfxTransform3 shapeTr = transform * shape.getOffsetTransform();
-				
-				if(pfxGetIntersectRayFunc(shape.getType())(ray,tout,shape,shapeTr) && tout.m_variable < out.m_variable) {
-					out = tout;
-					out.m_shapeId = j;
-					out.m_objectId = rigidbodyId;
-				}
-			}
+			pfxRayCastCollidable(ray,out,coll,transform,rigidbodyId);
 		}
 	}
 }
@@ -125,7 +168,7 @@ void pfxRayTraverseBackward(
 			continue;
 		}
 		
-		PfxUInt16 rigidbodyId = pfxGetObjectId(proxy);
+		PfxObjectId rigidbodyId = pfxGetObjectId(proxy);
 		PfxUInt32 contactFilterSelf = pfxGetSelf(proxy);
 		PfxUInt32 contactFilterTarget = pfxGetTarget(proxy);
 		
@@ -144,19 +187,7 @@ void pfxRayTraverseBackward(
 			PfxCollidable &coll = offsetCollidables[rigidbodyId];
 			PfxTransform3 transform(state.getOrientation(), state.getPosition());
 			
-			PfxRayOutput tout = out;
-			
-			PfxShapeIterator itrShape(coll);
-			for(PfxUInt32 j=0;j<coll.getNumShapes();j++,++itrShape) {
-				const PfxShape &shape = *itrShape;
-				PfxTransform3 shapeTr = transform * shape.getOffsetTransform();
-				
-				if(pfxGetIntersectRayFunc(shape.getType())(ray,tout,shape,shapeTr) && tout.m_variable < out.m_variable) {
-					out = tout;
-					out.m_shapeId = j;
-					out.m_objectId = rigidbodyId;
-				}
-			}
+			pfxRayCastCollidable(ray,out,coll,transform,rigidbodyId);
 		}
 	}
 }
@@ -0,0 +1,121 @@
+/*
+Physics Effects Copyright(C) 2010 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+#include "../../../include/physics_effects/base_level/base/pfx_perf_counter.h"
+#include "../../../include/physics_effects/low_level/collision/pfx_refresh_contacts.h"
+#include "../task/pfx_split_by_cost.h"
+
+namespace sce {
+namespace PhysicsEffects {
+
+extern int pfxCheckParamOfRefreshContacts(PfxRefreshContactsParam &param);
+
+///////////////////////////////////////////////////////////////////////////////
+// MULTI THREADS
+
+//J リフレッシュのコストは保持している衝突点の数に比例する
+//E Refreshing a manifold costs roughly one unit per held contact point
+struct PfxRefreshContactsCost {
+	const PfxRefreshContactsParam *param;
+
+	PfxUInt64 operator()(PfxUInt32 i) const
+	{
+		const PfxBroadphasePair &pair = param->contactPairs[i];
+		return 1 + param->offsetContactManifolds[pfxGetContactId(pair)].getNumContacts();
+	}
+};
+
+struct PfxRefreshContactsIO {
+	PfxRefreshContactsParam *param;
+	PfxUInt64 *taskCosts;
+};
+
+static void pfxRefreshContactsTaskEntry(PfxTaskArg *arg)
+{
+	PfxRefreshContactsIO *io = (PfxRefreshContactsIO*)arg->io;
+	PfxRefreshContactsParam &param = *io->param;
+
+	PfxRefreshContactsCost cost;
+	cost.param = &param;
+
+	PfxUInt32 begin,end;
+	pfxSplitByCost(arg,param.numContactPairs,io->taskCosts,cost,begin,end);
+
+	PfxPerfCounter pc;
+	pc.countBegin("pfxRefreshContactsTask");
+
+	for(PfxUInt32 i=begin;i<end;i++) {
+		PfxBroadphasePair &pair = param.contactPairs[i];
+		
+		PfxUInt32 iContact = pfxGetContactId(pair);
+		PfxUInt32 iA = pfxGetObjectIdA(pair);
+		PfxUInt32 iB = pfxGetObjectIdB(pair);
+
+		PfxContactManifold &contact = param.offsetContactManifolds[iContact];
+
+		SCE_PFX_ALWAYS_ASSERT(iA==contact.getRigidBodyIdA());
+		SCE_PFX_ALWAYS_ASSERT(iB==contact.getRigidBodyIdB());
+
+		PfxRigidState &instA = param.offsetRigidStates[iA];
+		PfxRigidState &instB = param.offsetRigidStates[iB];
+		
+		contact.refresh(
+			instA.getPosition(),instA.getOrientation(),
+			instB.getPosition(),instB.getOrientation() );
+	}
+
+	pc.countEnd();
+
+	if(param.taskTimes) {
+		param.taskTimes[arg->taskId] = pc.getCountTime(0);
+	}
+}
+
+PfxInt32 pfxRefreshContacts(PfxRefreshContactsParam &param,PfxTaskManager *taskManager)
+{
+	if(!taskManager) return SCE_PFX_ERR_INVALID_VALUE;
+
+	PfxInt32 ret = pfxCheckParamOfRefreshContacts(param);
+	if(ret != SCE_PFX_OK) return ret;
+	
+	SCE_PFX_PUSH_MARKER("pfxRefreshContacts");
+
+	PfxUInt32 numTasks = taskManager->getNumTasks();
+
+	PfxRefreshContactsIO io;
+	io.param = &param;
+	io.taskCosts = (PfxUInt64*)taskManager->allocate(sizeof(PfxUInt64)*numTasks);
+
+	taskManager->setTaskEntry((void*)pfxRefreshContactsTaskEntry);
+
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		taskManager->startTask(t,&io,0,0,0,0);
+	}
+
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		int taskId;
+		PfxUInt32 data1,data2,data3,data4;
+		taskManager->waitTask(taskId,data1,data2,data3,data4);
+	}
+
+	taskManager->deallocate(io.taskCosts);
+
+	SCE_PFX_POP_MARKER();
+
+	return SCE_PFX_OK;
+}
+
+} //namespace PhysicsEffects
+} //namespace sce
@@ -0,0 +1,447 @@
+/*
+Physics Effects Copyright(C) 2010 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#include "../../../include/physics_effects/base_level/base/pfx_perf_counter.h"
+#include "../../../include/physics_effects/low_level/solver/pfx_constraint_solver.h"
+#include "../../base_level/solver/pfx_check_solver.h"
+#include "pfx_solve_constraint_pair.h"
+#include "pfx_parallel_group.h"
+
+namespace sce {
+namespace PhysicsEffects {
+
+extern PfxInt32 pfxCheckParamOfSetupSolverBodies(const PfxSetupSolverBodiesParam &param);
+extern PfxInt32 pfxCheckParamOfSetupContactConstraints(const PfxSetupContactConstraintsParam &param);
+extern PfxInt32 pfxCheckParamOfSetupJointConstraints(const PfxSetupJointConstraintsParam &param);
+extern PfxInt32 pfxCheckParamOfSolveConstraints(const PfxSolveConstraintsParam &param);
+
+///////////////////////////////////////////////////////////////////////////////
+// MULTI THREADS
+
+static SCE_PFX_FORCE_INLINE
+void pfxGetTaskRange(PfxUInt32 num,PfxUInt32 taskId,PfxUInt32 numTasks,PfxUInt32 &begin,PfxUInt32 &end)
+{
+	begin = (PfxUInt32)(((PfxUInt64)num * taskId) / numTasks);
+	end = (PfxUInt32)(((PfxUInt64)num * (taskId+1)) / numTasks);
+}
+
+static void pfxRunTasks(PfxTaskManager *taskManager,void *entry,void *io)
+{
+	PfxUInt32 numTasks = taskManager->getNumTasks();
+
+	taskManager->setTaskEntry(entry);
+
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		taskManager->startTask(t,io,0,0,0,0);
+	}
+
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		int taskId;
+		PfxUInt32 data1,data2,data3,data4;
+		taskManager->waitTask(taskId,data1,data2,data3,data4);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Setup Solver Bodies
+
+static void pfxSetupSolverBodiesTaskEntry(PfxTaskArg *arg)
+{
+	PfxSetupSolverBodiesParam &param = *(PfxSetupSolverBodiesParam*)arg->io;
+
+	PfxUInt32 begin,end;
+	pfxGetTaskRange(param.numRigidBodies,arg->taskId,arg->maxTasks,begin,end);
+
+	for(PfxUInt32 i=begin;i<end;i++) {
+		PfxRigidState &state = param.states[i];
+		PfxRigidBody &body = param.bodies[i];
+		PfxSolverBody &solverBody = param.solverBodies[i];
+		
+		solverBody.m_orientation = state.getOrientation();
+		solverBody.m_deltaLinearVelocity = PfxVector3(0.0f);
+		solverBody.m_deltaAngularVelocity = PfxVector3(0.0f);
+		solverBody.m_motionType = state.getMotionMask();
+
+		if(SCE_PFX_MOTION_MASK_DYNAMIC(state.getMotionType())) {
+			PfxMatrix3 ori(solverBody.m_orientation);
+			solverBody.m_massInv = body.getMassInv();
+			solverBody.m_inertiaInv = ori * body.getInertiaInv() * transpose(ori);
+		}
+		else {
+			solverBody.m_massInv = 0.0f;
+			solverBody.m_inertiaInv = PfxMatrix3(0.0f);
+		}
+	}
+}
+
+PfxInt32 pfxSetupSolverBodies(PfxSetupSolverBodiesParam &param,PfxTaskManager *taskManager)
+{
+	if(!taskManager) return SCE_PFX_ERR_INVALID_VALUE;
+
+	PfxInt32 ret = pfxCheckParamOfSetupSolverBodies(param);
+	if(ret != SCE_PFX_OK) return ret;
+	
+	SCE_PFX_PUSH_MARKER("pfxSetupSolverBodies");
+
+	pfxRunTasks(taskManager,(void*)pfxSetupSolverBodiesTaskEntry,&param);
+
+	SCE_PFX_POP_MARKER();
+
+	return SCE_PFX_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Setup Constraints
+
+//J セットアップは剛体の速度を書き換えないので、ペアを単純に分割して並列処理できる
+//E Setup only reads the solver bodies, so pairs are split into plain ranges.
+
+static void pfxSetupContactConstraintsTaskEntry(PfxTaskArg *arg)
+{
+	PfxSetupContactConstraintsParam &param = *(PfxSetupContactConstraintsParam*)arg->io;
+
+	PfxUInt32 begin,end;
+	pfxGetTaskRange(param.numContactPairs,arg->taskId,arg->maxTasks,begin,end);
+
+	for(PfxUInt32 i=begin;i<end;i++) {
+		PfxConstraintPair &pair = param.contactPairs[i];
+		if(!pfxCheckSolver(pair)) {
+			continue;
+		}
+
+		pfxSetupContactConstraintPair(param,pair);
+	}
+}
+
+PfxInt32 pfxSetupContactConstraints(PfxSetupContactConstraintsParam &param,PfxTaskManager *taskManager)
+{
+	if(!taskManager) return SCE_PFX_ERR_INVALID_VALUE;
+
+	PfxInt32 ret = pfxCheckParamOfSetupContactConstraints(param);
+	if(ret != SCE_PFX_OK) return ret;
+	
+	SCE_PFX_PUSH_MARKER("pfxSetupContactConstraints");
+
+	pfxRunTasks(taskManager,(void*)pfxSetupContactConstraintsTaskEntry,&param);
+
+	SCE_PFX_POP_MARKER();
+
+	return SCE_PFX_OK;
+}
+
+static void pfxSetupJointConstraintsTaskEntry(PfxTaskArg *arg)
+{
+	PfxSetupJointConstraintsParam &param = *(PfxSetupJointConstraintsParam*)arg->io;
+
+	PfxUInt32 begin,end;
+	pfxGetTaskRange(param.numJointPairs,arg->taskId,arg->maxTasks,begin,end);
+
+	for(PfxUInt32 i=begin;i<end;i++) {
+		PfxConstraintPair &pair = param.jointPairs[i];
+		if(!pfxCheckSolver(pair)) {
+			continue;
+		}
+
+		pfxSetupJointConstraintPair(param,pair);
+	}
+}
+
+PfxInt32 pfxSetupJointConstraints(PfxSetupJointConstraintsParam &param,PfxTaskManager *taskManager)
+{
+	if(!taskManager) return SCE_PFX_ERR_INVALID_VALUE;
+
+	PfxInt32 ret = pfxCheckParamOfSetupJointConstraints(param);
+	if(ret != SCE_PFX_OK) return ret;
+	
+	SCE_PFX_PUSH_MARKER("pfxSetupJointConstraints");
+
+	pfxRunTasks(taskManager,(void*)pfxSetupJointConstraintsTaskEntry,&param);
+
+	SCE_PFX_POP_MARKER();
+
+	return SCE_PFX_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Split Constraints
+
+//J グループ内のペアを動的剛体を共有しないバッチに分割し、同じフェーズのバッチを並列に処理できるようにする
+//J 固定剛体は速度が変化しないので複数のバッチで共有してもよい
+//E Split the pairs of one group into phases of batches so that no dynamic body
+//E is shared by two batches of the same phase. Static bodies never change
+//E velocity and may be shared. Batch indices are relative to the group base.
+//E Returns the number of pairs assigned to a batch.
+static PfxUInt32 pfxSplitConstraintGroup(
+	PfxConstraintPair *pairs,PfxUInt32 base,PfxUInt32 numGroupPairs,
+	PfxParallelGroup &group,PfxParallelBatch *batches,
+	PfxUInt32 *pairTable,PfxUInt8 *bodyTable,PfxUInt32 numRigidBodies,
+	PfxUInt32 numTasks)
+{
+	PfxUInt32 begin = base;
+	PfxUInt32 end = base + numGroupPairs;
+
+	PfxUInt32 numRestPairs = 0;
+	for(PfxUInt32 i=begin;i<end;i++) {
+		if(!(pairTable[i>>5] & (1<<(i&31)))) {
+			numRestPairs++;
+		}
+	}
+
+	PfxUInt32 numSplitPairs = 0;
+	PfxUInt32 targetCount = SCE_PFX_MAX((PfxUInt32)SCE_PFX_MIN_SOLVER_PAIRS,SCE_PFX_MIN(numGroupPairs/(numTasks*2),(PfxUInt32)SCE_PFX_MAX_SOLVER_PAIRS));
+	PfxUInt32 startIndex = begin;
+	PfxUInt32 phaseId = 0;
+
+	for(;phaseId<SCE_PFX_MAX_SOLVER_PHASES&&numRestPairs>0;phaseId++) {
+		while(startIndex < end && (pairTable[startIndex>>5] & (1<<(startIndex&31)))) {
+			startIndex++;
+		}
+
+		memset(bodyTable,0xff,numRigidBodies);
+
+		PfxUInt32 i = startIndex;
+		PfxUInt32 batchId = 0;
+		for(;batchId<SCE_PFX_MAX_SOLVER_BATCHES&&i<end;batchId++) {
+			PfxParallelBatch &batch = batches[phaseId*SCE_PFX_MAX_SOLVER_BATCHES+batchId];
+			PfxUInt32 pairCount = 0;
+
+			for(;i<end&&pairCount<targetCount;i++) {
+				PfxUInt32 idxP = i>>5;
+				PfxUInt32 maskP = 1 << (i&31);
+				if(pairTable[idxP] & maskP) continue;
+
+				PfxUInt32 idxA = pfxGetObjectIdA(pairs[i]);
+				PfxUInt32 idxB = pfxGetObjectIdB(pairs[i]);
+				PfxBool dynamicA = SCE_PFX_MOTION_MASK_DYNAMIC(pfxGetMotionMaskA(pairs[i])&SCE_PFX_MOTION_MASK_TYPE) != 0;
+				PfxBool dynamicB = SCE_PFX_MOTION_MASK_DYNAMIC(pfxGetMotionMaskB(pairs[i])&SCE_PFX_MOTION_MASK_TYPE) != 0;
+
+				if( (dynamicA && bodyTable[idxA] != batchId && bodyTable[idxA] != 0xff) ||
+					(dynamicB && bodyTable[idxB] != batchId && bodyTable[idxB] != 0xff) ) {
+					continue;
+				}
+
+				if(dynamicA) bodyTable[idxA] = (PfxUInt8)batchId;
+				if(dynamicB) bodyTable[idxB] = (PfxUInt8)batchId;
+
+				pairTable[idxP] |= maskP;
+				batch.pairIndices[pairCount++] = (PfxUInt16)(i-base);
+			}
+
+			if(pairCount == 0) break;
+
+			group.numPairs[phaseId*SCE_PFX_MAX_SOLVER_BATCHES+batchId] = (PfxUInt16)pairCount;
+			numRestPairs -= pairCount;
+			numSplitPairs += pairCount;
+		}
+
+		if(batchId == 0) break;
+
+		group.numBatches[phaseId] = (PfxUInt16)batchId;
+	}
+
+	group.numPhases = (PfxUInt16)phaseId;
+
+	return numSplitPairs;
+}
+
+//J ペアを16bitインデックスで参照できるグループごとに分割する
+//J 全フェーズを使い切っても残ったペアは逐次処理する
+//E Split all pairs group by group, SCE_PFX_MAX_GROUP_PAIRS pairs at a time.
+//E Pairs that still do not fit into SCE_PFX_MAX_SOLVER_PHASES phases of their
+//E group are left unmarked in pairTable and counted in the return value so the
+//E solver can process them serially.
+static PfxUInt32 pfxSplitConstraints(
+	PfxConstraintPair *pairs,PfxUInt32 numPairs,
+	PfxParallelGroup *groups,PfxParallelBatch *batches,
+	PfxUInt32 *pairTable,PfxUInt8 *bodyTable,PfxUInt32 numRigidBodies,
+	PfxUInt32 numTasks)
+{
+	memset(pairTable,0,sizeof(PfxUInt32)*((numPairs+31)/32));
+
+	PfxUInt32 numRestPairs = 0;
+	for(PfxUInt32 i=0;i<numPairs;i++) {
+		if(pfxCheckSolver(pairs[i])) {
+			numRestPairs++;
+		}
+		else {
+			pairTable[i>>5] |= 1 << (i&31);
+		}
+	}
+
+	PfxUInt32 numGroups = pfxGetNumParallelGroups(numPairs);
+	for(PfxUInt32 groupId=0;groupId<numGroups;groupId++) {
+		PfxUInt32 base = groupId * SCE_PFX_MAX_GROUP_PAIRS;
+		PfxUInt32 numGroupPairs = SCE_PFX_MIN(numPairs-base,(PfxUInt32)SCE_PFX_MAX_GROUP_PAIRS);
+		numRestPairs -= pfxSplitConstraintGroup(
+			pairs,base,numGroupPairs,
+			groups[groupId],batches+groupId*(SCE_PFX_MAX_SOLVER_PHASES*SCE_PFX_MAX_SOLVER_BATCHES),
+			pairTable,bodyTable,numRigidBodies,numTasks);
+	}
+
+	return numRestPairs;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Solve Constraints
+
+struct PfxSolveConstraintsIO {
+	PfxSolveConstraintsParam *param;
+	PfxParallelGroup *contactGroups;
+	PfxParallelBatch *contactBatches;
+	PfxUInt32 *contactPairTable;
+	PfxUInt32 numRestContactPairs;
+	PfxParallelGroup *jointGroups;
+	PfxParallelBatch *jointBatches;
+	PfxUInt32 *jointPairTable;
+	PfxUInt32 numRestJointPairs;
+};
+
+//J 各フェーズのバッチをタスクに割り当て、フェーズ間でバリア同期する
+//E Batches of a phase are distributed round-robin over the tasks, with a
+//E barrier between phases. Groups are processed one after another. Pairs left
+//E over by the split are processed by task 0 at the end.
+template<class T>
+static void pfxSolvePhases(
+	PfxTaskArg *arg,
+	void (*func)(PfxConstraintPair&,T*,PfxSolverBody*),
+	PfxConstraintPair *pairs,PfxUInt32 numPairs,
+	const PfxParallelGroup *groups,const PfxParallelBatch *batches,
+	const PfxUInt32 *pairTable,PfxUInt32 numRestPairs,
+	T *offsetConstraints,PfxSolverBody *offsetSolverBodies)
+{
+	PfxUInt32 taskId = arg->taskId;
+	PfxUInt32 numTasks = arg->maxTasks;
+	PfxUInt32 numGroups = pfxGetNumParallelGroups(numPairs);
+
+	for(PfxUInt32 groupId=0;groupId<numGroups;groupId++) {
+		const PfxParallelGroup &group = groups[groupId];
+		const PfxParallelBatch *groupBatches = batches + groupId*(SCE_PFX_MAX_SOLVER_PHASES*SCE_PFX_MAX_SOLVER_BATCHES);
+		PfxConstraintPair *groupPairs = pairs + groupId*SCE_PFX_MAX_GROUP_PAIRS;
+
+		for(PfxUInt32 phaseId=0;phaseId<group.numPhases;phaseId++) {
+			for(PfxUInt32 batchId=taskId;batchId<group.numBatches[phaseId];batchId+=numTasks) {
+				const PfxParallelBatch &batch = groupBatches[phaseId*SCE_PFX_MAX_SOLVER_BATCHES+batchId];
+				PfxUInt32 numBatchPairs = group.numPairs[phaseId*SCE_PFX_MAX_SOLVER_BATCHES+batchId];
+				for(PfxUInt32 i=0;i<numBatchPairs;i++) {
+					func(groupPairs[batch.pairIndices[i]],offsetConstraints,offsetSolverBodies);
+				}
+			}
+			arg->barrier->sync();
+		}
+	}
+
+	if(numRestPairs > 0) {
+		if(taskId == 0) {
+			for(PfxUInt32 i=0;i<numPairs;i++) {
+				if(pairTable[i>>5] & (1<<(i&31))) continue;
+				func(pairs[i],offsetConstraints,offsetSolverBodies);
+			}
+		}
+		arg->barrier->sync();
+	}
+}
+
+static void pfxSolveConstraintsTaskEntry(PfxTaskArg *arg)
+{
+	PfxSolveConstraintsIO *io = (PfxSolveConstraintsIO*)arg->io;
+	PfxSolveConstraintsParam &param = *io->param;
+
+	// Warm Starting
+	pfxSolvePhases(arg,pfxWarmStartJointPair,
+		param.jointPairs,param.numJointPairs,
+		io->jointGroups,io->jointBatches,io->jointPairTable,io->numRestJointPairs,
+		param.offsetJoints,param.offsetSolverBodies);
+	pfxSolvePhases(arg,pfxWarmStartContactPair,
+		param.contactPairs,param.numContactPairs,
+		io->contactGroups,io->contactBatches,io->contactPairTable,io->numRestContactPairs,
+		param.offsetContactManifolds,param.offsetSolverBodies);
+
+	// Solver
+	for(PfxUInt32 iteration=0;iteration<param.iteration;iteration++) {
+		pfxSolvePhases(arg,pfxSolveJointPair,
+			param.jointPairs,param.numJointPairs,
+			io->jointGroups,io->jointBatches,io->jointPairTable,io->numRestJointPairs,
+			param.offsetJoints,param.offsetSolverBodies);
+		pfxSolvePhases(arg,pfxSolveContactPair,
+			param.contactPairs,param.numContactPairs,
+			io->contactGroups,io->contactBatches,io->contactPairTable,io->numRestContactPairs,
+			param.offsetContactManifolds,param.offsetSolverBodies);
+	}
+
+	PfxUInt32 begin,end;
+	pfxGetTaskRange(param.numRigidBodies,arg->taskId,arg->maxTasks,begin,end);
+
+	for(PfxUInt32 i=begin;i<end;i++) {
+		param.offsetRigidStates[i].setLinearVelocity(
+			param.offsetRigidStates[i].getLinearVelocity()+param.offsetSolverBodies[i].m_deltaLinearVelocity);
+		param.offsetRigidStates[i].setAngularVelocity(
+			param.offsetRigidStates[i].getAngularVelocity()+param.offsetSolverBodies[i].m_deltaAngularVelocity);
+	}
+}
+
+PfxInt32 pfxSolveConstraints(PfxSolveConstraintsParam &param,PfxTaskManager *taskManager)
+{
+	if(!taskManager) return SCE_PFX_ERR_INVALID_VALUE;
+
+	PfxInt32 ret = pfxCheckParamOfSolveConstraints(param);
+	if(ret != SCE_PFX_OK) return ret;
+
+	SCE_PFX_PUSH_MARKER("pfxSolveConstraints");
+
+	PfxUInt32 numTasks = taskManager->getNumTasks();
+
+	PfxHeapManager pool((unsigned char*)param.workBuff,param.workBytes);
+
+	PfxUInt32 numContactGroups = pfxGetNumParallelGroups(param.numContactPairs);
+	PfxUInt32 numJointGroups = pfxGetNumParallelGroups(param.numJointPairs);
+
+	PfxSolveConstraintsIO io;
+	io.param = &param;
+	io.contactGroups = (PfxParallelGroup*)pool.allocate(sizeof(PfxParallelGroup)*numContactGroups,PfxHeapManager::ALIGN128);
+	io.contactBatches = (PfxParallelBatch*)pool.allocate(sizeof(PfxParallelBatch)*(SCE_PFX_MAX_SOLVER_PHASES*SCE_PFX_MAX_SOLVER_BATCHES)*numContactGroups,PfxHeapManager::ALIGN128);
+	io.jointGroups = (PfxParallelGroup*)pool.allocate(sizeof(PfxParallelGroup)*numJointGroups,PfxHeapManager::ALIGN128);
+	io.jointBatches = (PfxParallelBatch*)pool.allocate(sizeof(PfxParallelBatch)*(SCE_PFX_MAX_SOLVER_PHASES*SCE_PFX_MAX_SOLVER_BATCHES)*numJointGroups,PfxHeapManager::ALIGN128);
+	io.contactPairTable = (PfxUInt32*)pool.allocate(sizeof(PfxUInt32)*((param.numContactPairs+31)/32));
+	io.jointPairTable = (PfxUInt32*)pool.allocate(sizeof(PfxUInt32)*((param.numJointPairs+31)/32));
+	PfxUInt8 *bodyTable = (PfxUInt8*)pool.allocate(sizeof(PfxUInt8)*param.numRigidBodies);
+
+	SCE_PFX_PUSH_MARKER("pfxSplitConstraints");
+
+	io.numRestContactPairs = pfxSplitConstraints(
+		param.contactPairs,param.numContactPairs,
+		io.contactGroups,io.contactBatches,
+		io.contactPairTable,bodyTable,param.numRigidBodies,
+		numTasks);
+
+	io.numRestJointPairs = pfxSplitConstraints(
+		param.jointPairs,param.numJointPairs,
+		io.jointGroups,io.jointBatches,
+		io.jointPairTable,bodyTable,param.numRigidBodies,
+		numTasks);
+
+	SCE_PFX_POP_MARKER();
+
+	pfxRunTasks(taskManager,(void*)pfxSolveConstraintsTaskEntry,&io);
+
+	pool.clear();
+
+	SCE_PFX_POP_MARKER();
+
+	return SCE_PFX_OK;
+}
+
+} //namespace PhysicsEffects
+} //namespace sce
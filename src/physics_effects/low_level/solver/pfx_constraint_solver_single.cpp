@@ -15,10 +15,9 @@ Physics Effects under the filename: physics_effects_license.txt
 */
 
 #include "../../../include/physics_effects/base_level/base/pfx_perf_counter.h"
-#include "../../../include/physics_effects/base_level/solver/pfx_contact_constraint.h"
-#include "../../../include/physics_effects/low_level/solver/pfx_joint_constraint_func.h"
 #include "../../../include/physics_effects/low_level/solver/pfx_constraint_solver.h"
 #include "../../base_level/solver/pfx_check_solver.h"
+#include "pfx_solve_constraint_pair.h"
 #include "pfx_parallel_group.h"
 
 namespace sce {
@@ -28,10 +27,12 @@ PfxUInt32 pfxGetWorkBytesOfSolveConstraints(PfxUInt32 numRigidBodies,PfxUInt32 n
 {
 	(void)maxTasks;
 	PfxUInt32 workBytes = SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxUInt8) * numRigidBodies) +
-		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxUInt32)*((SCE_PFX_MAX(numContactPairs,numJointPairs)+31)/32));
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxUInt32)*((numContactPairs+31)/32)) +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxUInt32)*((numJointPairs+31)/32));
 
 	workBytes += 128 + (SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxParallelGroup)) + 
-		 SCE_PFX_ALLOC_BYTES_ALIGN128(sizeof(PfxParallelBatch)*(SCE_PFX_MAX_SOLVER_PHASES*SCE_PFX_MAX_SOLVER_BATCHES))) * 2;
+		 SCE_PFX_ALLOC_BYTES_ALIGN128(sizeof(PfxParallelBatch)*(SCE_PFX_MAX_SOLVER_PHASES*SCE_PFX_MAX_SOLVER_BATCHES))) *
+		 (pfxGetNumParallelGroups(numContactPairs) + pfxGetNumParallelGroups(numJointPairs));
 
 	return workBytes;
 }
@@ -122,10 +123,6 @@ PfxInt32 pfxSetupContactConstraints(PfxSetupContactConstraintsParam &param)
 
 	PfxConstraintPair *contactPairs = param.contactPairs;
 	PfxUInt32 numContactPairs = param.numContactPairs;
-	PfxContactManifold *offsetContactManifolds = param.offsetContactManifolds;
-	PfxRigidState *offsetRigidStates = param.offsetRigidStates;
-	PfxRigidBody *offsetRigidBodies = param.offsetRigidBodies;
-	PfxSolverBody *offsetSolverBodies = param.offsetSolverBodies;
 	
 	for(PfxUInt32 i=0;i<numContactPairs;i++) {
 		PfxConstraintPair &pair = contactPairs[i];
@@ -133,53 +130,7 @@ PfxInt32 pfxSetupContactConstraints(PfxSetupContactConstraintsParam &param)
 			continue;
 		}
 
-		PfxUInt16 iA = pfxGetObjectIdA(pair);
-		PfxUInt16 iB = pfxGetObjectIdB(pair);
-		PfxUInt32 iConstraint = pfxGetConstraintId(pair);
-
-		PfxContactManifold &contact = offsetContactManifolds[iConstraint];
-
-		SCE_PFX_ALWAYS_ASSERT(iA==contact.getRigidBodyIdA());
-		SCE_PFX_ALWAYS_ASSERT(iB==contact.getRigidBodyIdB());
-
-		PfxRigidState &stateA = offsetRigidStates[iA];
-		PfxRigidBody &bodyA = offsetRigidBodies[iA];
-		PfxSolverBody &solverBodyA = offsetSolverBodies[iA];
-
-		PfxRigidState &stateB = offsetRigidStates[iB];
-		PfxRigidBody &bodyB = offsetRigidBodies[iB];
-		PfxSolverBody &solverBodyB = offsetSolverBodies[iB];
-	
-		contact.setInternalFlag(0);
-		
-		PfxFloat restitution = 0.5f * (bodyA.getRestitution() + bodyB.getRestitution());
-		if(contact.getDuration() > 1) restitution = 0.0f;
-		
-		PfxFloat friction = sqrtf(bodyA.getFriction() * bodyB.getFriction());
-		
-		for(int j=0;j<contact.getNumContacts();j++) {
-			PfxContactPoint &cp = contact.getContactPoint(j);
-			
-			pfxSetupContactConstraint(
-				cp.m_constraintRow[0],
-				cp.m_constraintRow[1],
-				cp.m_constraintRow[2],
-				cp.m_distance,
-				restitution,
-				friction,
-				pfxReadVector3(cp.m_constraintRow[0].m_normal),
-				pfxReadVector3(cp.m_localPointA),
-				pfxReadVector3(cp.m_localPointB),
-				stateA,
-				stateB,
-				solverBodyA,
-				solverBodyB,
-				param.separateBias,
-				param.timeStep
-				);
-		}
-
-		contact.setCompositeFriction(friction);
+		pfxSetupContactConstraintPair(param,pair);
 	}
 
 	SCE_PFX_POP_MARKER();
@@ -196,9 +147,6 @@ PfxInt32 pfxSetupJointConstraints(PfxSetupJointConstraintsParam &param)
 
 	PfxConstraintPair *jointPairs = param.jointPairs;
 	PfxUInt32 numJointPairs = param.numJointPairs;
-	PfxJoint *offsetJoints = param.offsetJoints;
-	PfxRigidState *offsetRigidStates = param.offsetRigidStates;
-	PfxSolverBody *offsetSolverBodies = param.offsetSolverBodies;
 	
 	for(PfxUInt32 i=0;i<numJointPairs;i++) {
 		PfxConstraintPair &pair = jointPairs[i];
@@ -206,28 +154,7 @@ PfxInt32 pfxSetupJointConstraints(PfxSetupJointConstraintsParam &param)
 			continue;
 		}
 
-		PfxUInt16 iA = pfxGetObjectIdA(pair);
-		PfxUInt16 iB = pfxGetObjectIdB(pair);
-		PfxUInt32 iConstraint = pfxGetConstraintId(pair);
-		
-		PfxJoint &joint = offsetJoints[iConstraint];
-
-		SCE_PFX_ALWAYS_ASSERT(iA==joint.m_rigidBodyIdA);
-		SCE_PFX_ALWAYS_ASSERT(iB==joint.m_rigidBodyIdB);
-
-		PfxRigidState &stateA = offsetRigidStates[iA];
-		PfxSolverBody &solverBodyA = offsetSolverBodies[iA];
-
-		PfxRigidState &stateB = offsetRigidStates[iB];
-		PfxSolverBody &solverBodyB = offsetSolverBodies[iB];
-		
-		pfxGetSetupJointConstraintFunc(joint.m_type)(
-			joint,
-			stateA,
-			stateB,
-			solverBodyA,
-			solverBodyB,
-			param.timeStep);
+		pfxSetupJointConstraintPair(param,pair);
 	}
 
 	SCE_PFX_POP_MARKER();
@@ -260,21 +187,7 @@ PfxInt32 pfxSolveConstraints(PfxSolveConstraintsParam &param)
 				continue;
 			}
 
-			PfxUInt16 iA = pfxGetObjectIdA(pair);
-			PfxUInt16 iB = pfxGetObjectIdB(pair);
-
-			PfxJoint &joint = offsetJoints[pfxGetConstraintId(pair)];
-
-			SCE_PFX_ASSERT(iA==joint.m_rigidBodyIdA);
-			SCE_PFX_ASSERT(iB==joint.m_rigidBodyIdB);
-
-			PfxSolverBody &solverBodyA = offsetSolverBodies[iA];
-			PfxSolverBody &solverBodyB = offsetSolverBodies[iB];
-			
-			pfxGetWarmStartJointConstraintFunc(joint.m_type)(
-				joint,
-				solverBodyA,
-				solverBodyB);
+			pfxWarmStartJointPair(pair,offsetJoints,offsetSolverBodies);
 		}
 		for(PfxUInt32 i=0;i<numContactPairs;i++) {
 			PfxConstraintPair &pair = contactPairs[i];
@@ -282,46 +195,7 @@ PfxInt32 pfxSolveConstraints(PfxSolveConstraintsParam &param)
 				continue;
 			}
 
-			PfxUInt16 iA = pfxGetObjectIdA(pair);
-			PfxUInt16 iB = pfxGetObjectIdB(pair);
-
-			PfxContactManifold &contact = offsetContactManifolds[pfxGetConstraintId(pair)];
-
-			SCE_PFX_ASSERT(iA==contact.getRigidBodyIdA());
-			SCE_PFX_ASSERT(iB==contact.getRigidBodyIdB());
-
-			PfxSolverBody &solverBodyA = offsetSolverBodies[iA];
-			PfxSolverBody &solverBodyB = offsetSolverBodies[iB];
-			
-			PfxFloat massInvA = solverBodyA.m_massInv;
-			PfxFloat massInvB = solverBodyB.m_massInv;
-			PfxMatrix3 inertiaInvA = solverBodyA.m_inertiaInv;
-			PfxMatrix3 inertiaInvB = solverBodyB.m_inertiaInv;
-
-			if(solverBodyA.m_motionType == kPfxMotionTypeOneWay) {
-				massInvB = 0.0f;
-				inertiaInvB = PfxMatrix3(0.0f);
-			}
-			if(solverBodyB.m_motionType == kPfxMotionTypeOneWay) {
-				massInvA = 0.0f;
-				inertiaInvA = PfxMatrix3(0.0f);
-			}
-
-			for(int j=0;j<contact.getNumContacts();j++) {
-				PfxContactPoint &cp = contact.getContactPoint(j);
-				
-				PfxVector3 rA = rotate(solverBodyA.m_orientation,pfxReadVector3(cp.m_localPointA));
-				PfxVector3 rB = rotate(solverBodyB.m_orientation,pfxReadVector3(cp.m_localPointB));
-				
-				for(int k=0;k<3;k++) {
-					PfxVector3 normal = pfxReadVector3(cp.m_constraintRow[k].m_normal);
-					PfxFloat deltaImpulse = cp.m_constraintRow[k].m_accumImpulse;
-					solverBodyA.m_deltaLinearVelocity += deltaImpulse * massInvA * normal;
-					solverBodyA.m_deltaAngularVelocity += deltaImpulse * inertiaInvA * cross(rA,normal);
-					solverBodyB.m_deltaLinearVelocity -= deltaImpulse * massInvB * normal;
-					solverBodyB.m_deltaAngularVelocity -= deltaImpulse * inertiaInvB * cross(rB,normal);
-				}
-			}
+			pfxWarmStartContactPair(pair,offsetContactManifolds,offsetSolverBodies);
 		}
 	}
 	
@@ -333,21 +207,7 @@ PfxInt32 pfxSolveConstraints(PfxSolveConstraintsParam &param)
 				continue;
 			}
 
-			PfxUInt16 iA = pfxGetObjectIdA(pair);
-			PfxUInt16 iB = pfxGetObjectIdB(pair);
-
-			PfxJoint &joint = offsetJoints[pfxGetConstraintId(pair)];
-
-			SCE_PFX_ASSERT(iA==joint.m_rigidBodyIdA);
-			SCE_PFX_ASSERT(iB==joint.m_rigidBodyIdB);
-
-			PfxSolverBody &solverBodyA = offsetSolverBodies[iA];
-			PfxSolverBody &solverBodyB = offsetSolverBodies[iB];
-			
-			pfxGetSolveJointConstraintFunc(joint.m_type)(
-				joint,
-				solverBodyA,
-				solverBodyB);
+			pfxSolveJointPair(pair,offsetJoints,offsetSolverBodies);
 		}
 		for(PfxUInt32 i=0;i<numContactPairs;i++) {
 			PfxConstraintPair &pair = contactPairs[i];
@@ -355,31 +215,7 @@ PfxInt32 pfxSolveConstraints(PfxSolveConstraintsParam &param)
 				continue;
 			}
 
-			PfxUInt16 iA = pfxGetObjectIdA(pair);
-			PfxUInt16 iB = pfxGetObjectIdB(pair);
-
-			PfxContactManifold &contact = offsetContactManifolds[pfxGetConstraintId(pair)];
-
-			SCE_PFX_ASSERT(iA==contact.getRigidBodyIdA());
-			SCE_PFX_ASSERT(iB==contact.getRigidBodyIdB());
-
-			PfxSolverBody &solverBodyA = offsetSolverBodies[iA];
-			PfxSolverBody &solverBodyB = offsetSolverBodies[iB];
-			
-			for(int j=0;j<contact.getNumContacts();j++) {
-				PfxContactPoint &cp = contact.getContactPoint(j);
-				
-				pfxSolveContactConstraint(
-					cp.m_constraintRow[0],
-					cp.m_constraintRow[1],
-					cp.m_constraintRow[2],
-					pfxReadVector3(cp.m_localPointA),
-					pfxReadVector3(cp.m_localPointB),
-					solverBodyA,
-					solverBodyB,
-					contact.getCompositeFriction()
-					);
-			}
+			pfxSolveContactPair(pair,offsetContactManifolds,offsetSolverBodies);
 		}
 	}
 
@@ -24,6 +24,7 @@ Physics Effects under the filename: physics_effects_license.txt
 #define SCE_PFX_MAX_SOLVER_BATCHES 32	// １フェーズに含まれる最大並列処理バッチ
 #define SCE_PFX_MAX_SOLVER_PAIRS  64	// １バッチに含まれる最大ペア数
 #define SCE_PFX_MIN_SOLVER_PAIRS  16	// １バッチに含まれる最小ペア数
+#define SCE_PFX_MAX_GROUP_PAIRS   0x10000	// １グループが参照できる最大ペア数（16bitインデックス）
 
 namespace sce {
 namespace PhysicsEffects {
@@ -39,6 +40,13 @@ struct SCE_PFX_ALIGNED(128) PfxParallelGroup {
 SCE_PFX_PADDING(1,126)
 };
 
+//J ペアを16bitインデックスで参照できる範囲ごとにグループへ分ける
+//E Pairs are split into groups of SCE_PFX_MAX_GROUP_PAIRS so that batches can index them with 16 bits
+SCE_PFX_FORCE_INLINE PfxUInt32 pfxGetNumParallelGroups(PfxUInt32 numPairs)
+{
+	return SCE_PFX_MAX((PfxUInt32)1,(numPairs+SCE_PFX_MAX_GROUP_PAIRS-1)/SCE_PFX_MAX_GROUP_PAIRS);
+}
+
 } //namespace PhysicsEffects
 } //namespace sce
 #endif // _SCE_PFX_PARALLEL_GROUP_H
@@ -0,0 +1,227 @@
+/*
+Physics Effects Copyright(C) 2010 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#ifndef _SCE_PFX_SOLVE_CONSTRAINT_PAIR_H
+#define _SCE_PFX_SOLVE_CONSTRAINT_PAIR_H
+
+#include "../../../include/physics_effects/base_level/solver/pfx_contact_constraint.h"
+#include "../../../include/physics_effects/low_level/solver/pfx_joint_constraint_func.h"
+#include "../../../include/physics_effects/low_level/solver/pfx_constraint_solver.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Per pair solver functions shared by the single and multi thread solvers
+
+namespace sce {
+namespace PhysicsEffects {
+
+static SCE_PFX_FORCE_INLINE
+void pfxSetupContactConstraintPair(const PfxSetupContactConstraintsParam &param,PfxConstraintPair &pair)
+{
+	PfxObjectId iA = pfxGetObjectIdA(pair);
+	PfxObjectId iB = pfxGetObjectIdB(pair);
+	PfxUInt32 iConstraint = pfxGetConstraintId(pair);
+
+	PfxContactManifold &contact = param.offsetContactManifolds[iConstraint];
+
+	SCE_PFX_ALWAYS_ASSERT(iA==contact.getRigidBodyIdA());
+	SCE_PFX_ALWAYS_ASSERT(iB==contact.getRigidBodyIdB());
+
+	PfxRigidState &stateA = param.offsetRigidStates[iA];
+	PfxRigidBody &bodyA = param.offsetRigidBodies[iA];
+	PfxSolverBody &solverBodyA = param.offsetSolverBodies[iA];
+
+	PfxRigidState &stateB = param.offsetRigidStates[iB];
+	PfxRigidBody &bodyB = param.offsetRigidBodies[iB];
+	PfxSolverBody &solverBodyB = param.offsetSolverBodies[iB];
+
+	contact.setInternalFlag(0);
+	
+	PfxFloat restitution = 0.5f * (bodyA.getRestitution() + bodyB.getRestitution());
+	if(contact.getDuration() > 1) restitution = 0.0f;
+	
+	PfxFloat friction = sqrtf(bodyA.getFriction() * bodyB.getFriction());
+	
+	for(int j=0;j<contact.getNumContacts();j++) {
+		PfxContactPoint &cp = contact.getContactPoint(j);
+		
+		pfxSetupContactConstraint(
+			cp.m_constraintRow[0],
+			cp.m_constraintRow[1],
+			cp.m_constraintRow[2],
+			cp.m_distance,
+			restitution,
+			friction,
+			pfxReadVector3(cp.m_constraintRow[0].m_normal),
+			pfxReadVector3(cp.m_localPointA),
+			pfxReadVector3(cp.m_localPointB),
+			stateA,
+			stateB,
+			solverBodyA,
+			solverBodyB,
+			param.separateBias,
+			param.timeStep
+			);
+	}
+
+	contact.setCompositeFriction(friction);
+}
+
+static SCE_PFX_FORCE_INLINE
+void pfxSetupJointConstraintPair(const PfxSetupJointConstraintsParam &param,PfxConstraintPair &pair)
+{
+	PfxObjectId iA = pfxGetObjectIdA(pair);
+	PfxObjectId iB = pfxGetObjectIdB(pair);
+	PfxUInt32 iConstraint = pfxGetConstraintId(pair);
+	
+	PfxJoint &joint = param.offsetJoints[iConstraint];
+
+	SCE_PFX_ALWAYS_ASSERT(iA==joint.m_rigidBodyIdA);
+	SCE_PFX_ALWAYS_ASSERT(iB==joint.m_rigidBodyIdB);
+
+	PfxRigidState &stateA = param.offsetRigidStates[iA];
+	PfxSolverBody &solverBodyA = param.offsetSolverBodies[iA];
+
+	PfxRigidState &stateB = param.offsetRigidStates[iB];
+	PfxSolverBody &solverBodyB = param.offsetSolverBodies[iB];
+	
+	pfxGetSetupJointConstraintFunc(joint.m_type)(
+		joint,
+		stateA,
+		stateB,
+		solverBodyA,
+		solverBodyB,
+		param.timeStep);
+}
+
+static SCE_PFX_FORCE_INLINE
+void pfxWarmStartJointPair(PfxConstraintPair &pair,PfxJoint *offsetJoints,PfxSolverBody *offsetSolverBodies)
+{
+	PfxObjectId iA = pfxGetObjectIdA(pair);
+	PfxObjectId iB = pfxGetObjectIdB(pair);
+
+	PfxJoint &joint = offsetJoints[pfxGetConstraintId(pair)];
+
+	SCE_PFX_ASSERT(iA==joint.m_rigidBodyIdA);
+	SCE_PFX_ASSERT(iB==joint.m_rigidBodyIdB);
+
+	PfxSolverBody &solverBodyA = offsetSolverBodies[iA];
+	PfxSolverBody &solverBodyB = offsetSolverBodies[iB];
+	
+	pfxGetWarmStartJointConstraintFunc(joint.m_type)(
+		joint,
+		solverBodyA,
+		solverBodyB);
+}
+
+static SCE_PFX_FORCE_INLINE
+void pfxWarmStartContactPair(PfxConstraintPair &pair,PfxContactManifold *offsetContactManifolds,PfxSolverBody *offsetSolverBodies)
+{
+	PfxObjectId iA = pfxGetObjectIdA(pair);
+	PfxObjectId iB = pfxGetObjectIdB(pair);
+
+	PfxContactManifold &contact = offsetContactManifolds[pfxGetConstraintId(pair)];
+
+	SCE_PFX_ASSERT(iA==contact.getRigidBodyIdA());
+	SCE_PFX_ASSERT(iB==contact.getRigidBodyIdB());
+
+	PfxSolverBody &solverBodyA = offsetSolverBodies[iA];
+	PfxSolverBody &solverBodyB = offsetSolverBodies[iB];
+	
+	PfxFloat massInvA = solverBodyA.m_massInv;
+	PfxFloat massInvB = solverBodyB.m_massInv;
+	PfxMatrix3 inertiaInvA = solverBodyA.m_inertiaInv;
+	PfxMatrix3 inertiaInvB = solverBodyB.m_inertiaInv;
+
+	if(solverBodyA.m_motionType == kPfxMotionTypeOneWay) {
+		massInvB = 0.0f;
+		inertiaInvB = PfxMatrix3(0.0f);
+	}
+	if(solverBodyB.m_motionType == kPfxMotionTypeOneWay) {
+		massInvA = 0.0f;
+		inertiaInvA = PfxMatrix3(0.0f);
+	}
+
+	for(int j=0;j<contact.getNumContacts();j++) {
+		PfxContactPoint &cp = contact.getContactPoint(j);
+		
+		PfxVector3 rA = rotate(solverBodyA.m_orientation,pfxReadVector3(cp.m_localPointA));
+		PfxVector3 rB = rotate(solverBodyB.m_orientation,pfxReadVector3(cp.m_localPointB));
+		
+		for(int k=0;k<3;k++) {
+			PfxVector3 normal = pfxReadVector3(cp.m_constraintRow[k].m_normal);
+			PfxFloat deltaImpulse = cp.m_constraintRow[k].m_accumImpulse;
+			solverBodyA.m_deltaLinearVelocity += deltaImpulse * massInvA * normal;
+			solverBodyA.m_deltaAngularVelocity += deltaImpulse * inertiaInvA * cross(rA,normal);
+			solverBodyB.m_deltaLinearVelocity -= deltaImpulse * massInvB * normal;
+			solverBodyB.m_deltaAngularVelocity -= deltaImpulse * inertiaInvB * cross(rB,normal);
+		}
+	}
+}
+
+static SCE_PFX_FORCE_INLINE
+void pfxSolveJointPair(PfxConstraintPair &pair,PfxJoint *offsetJoints,PfxSolverBody *offsetSolverBodies)
+{
+	PfxObjectId iA = pfxGetObjectIdA(pair);
+	PfxObjectId iB = pfxGetObjectIdB(pair);
+
+	PfxJoint &joint = offsetJoints[pfxGetConstraintId(pair)];
+
+	SCE_PFX_ASSERT(iA==joint.m_rigidBodyIdA);
+	SCE_PFX_ASSERT(iB==joint.m_rigidBodyIdB);
+
+	PfxSolverBody &solverBodyA = offsetSolverBodies[iA];
+	PfxSolverBody &solverBodyB = offsetSolverBodies[iB];
+	
+	pfxGetSolveJointConstraintFunc(joint.m_type)(
+		joint,
+		solverBodyA,
+		solverBodyB);
+}
+
+static SCE_PFX_FORCE_INLINE
+void pfxSolveContactPair(PfxConstraintPair &pair,PfxContactManifold *offsetContactManifolds,PfxSolverBody *offsetSolverBodies)
+{
+	PfxObjectId iA = pfxGetObjectIdA(pair);
+	PfxObjectId iB = pfxGetObjectIdB(pair);
+
+	PfxContactManifold &contact = offsetContactManifolds[pfxGetConstraintId(pair)];
+
+	SCE_PFX_ASSERT(iA==contact.getRigidBodyIdA());
+	SCE_PFX_ASSERT(iB==contact.getRigidBodyIdB());
+
+	PfxSolverBody &solverBodyA = offsetSolverBodies[iA];
+	PfxSolverBody &solverBodyB = offsetSolverBodies[iB];
+	
+	for(int j=0;j<contact.getNumContacts();j++) {
+		PfxContactPoint &cp = contact.getContactPoint(j);
+		
+		pfxSolveContactConstraint(
+			cp.m_constraintRow[0],
+			cp.m_constraintRow[1],
+			cp.m_constraintRow[2],
+			pfxReadVector3(cp.m_localPointA),
+			pfxReadVector3(cp.m_localPointB),
+			solverBodyA,
+			solverBodyB,
+			contact.getCompositeFriction()
+			);
+	}
+}
+
+} //namespace PhysicsEffects
+} //namespace sce
+
+#endif // _SCE_PFX_SOLVE_CONSTRAINT_PAIR_H
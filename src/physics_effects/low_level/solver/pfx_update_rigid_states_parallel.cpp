@@ -0,0 +1,71 @@
+/*
+Physics Effects Copyright(C) 2010 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+#include "../../../include/physics_effects/base_level/base/pfx_perf_counter.h"
+#include "../../../include/physics_effects/base_level/solver/pfx_integrate.h"
+#include "../../../include/physics_effects/low_level/solver/pfx_update_rigid_states.h"
+
+namespace sce {
+namespace PhysicsEffects {
+
+extern PfxInt32 pfxCheckParamOfUpdateRigidStates(const PfxUpdateRigidStatesParam &param);
+
+///////////////////////////////////////////////////////////////////////////////
+// MULTI THREADS
+
+static void pfxUpdateRigidStatesTaskEntry(PfxTaskArg *arg)
+{
+	PfxUpdateRigidStatesParam &param = *((PfxUpdateRigidStatesParam*)arg->io);
+
+	//J 積分のコストは剛体ごとにほぼ一定なので均等に分割する
+	//E Integration costs about the same for every body, so split evenly
+	PfxUInt32 begin = (PfxUInt32)(((PfxUInt64)param.numRigidBodies * arg->taskId) / arg->maxTasks);
+	PfxUInt32 end = (PfxUInt32)(((PfxUInt64)param.numRigidBodies * (arg->taskId+1)) / arg->maxTasks);
+
+	for(PfxUInt32 i=begin;i<end;i++) {
+		pfxIntegrate(param.states[i],param.bodies[i],param.timeStep);
+	}
+}
+
+PfxInt32 pfxUpdateRigidStates(PfxUpdateRigidStatesParam &param,PfxTaskManager *taskManager)
+{
+	if(!taskManager) return SCE_PFX_ERR_INVALID_VALUE;
+
+	PfxInt32 ret = pfxCheckParamOfUpdateRigidStates(param);
+	if(ret != SCE_PFX_OK) return ret;
+
+	SCE_PFX_PUSH_MARKER("pfxUpdateRigidStates");
+
+	PfxUInt32 numTasks = taskManager->getNumTasks();
+
+	taskManager->setTaskEntry((void*)pfxUpdateRigidStatesTaskEntry);
+
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		taskManager->startTask(t,&param,0,0,0,0);
+	}
+
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		int taskId;
+		PfxUInt32 data1,data2,data3,data4;
+		taskManager->waitTask(taskId,data1,data2,data3,data4);
+	}
+
+	SCE_PFX_POP_MARKER();
+
+	return SCE_PFX_OK;
+}
+
+} //namespace PhysicsEffects
+} //namespace sce
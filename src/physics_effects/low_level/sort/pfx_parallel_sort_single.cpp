@@ -52,5 +52,19 @@ PfxInt32 pfxParallelSort(
 	return SCE_PFX_OK;
 }
 
+PfxInt32 pfxParallelSort(
+	PfxSortData32Key64 *data,PfxUInt32 numData,
+	void *workBuff,PfxUInt32 workBytes)
+{
+	if(!SCE_PFX_PTR_IS_ALIGNED16(workBuff)) return SCE_PFX_ERR_INVALID_ALIGN;
+	if(SCE_PFX_AVAILABLE_BYTES_ALIGN16(workBuff,workBytes) < sizeof(PfxSortData32Key64) * numData) return SCE_PFX_ERR_OUT_OF_BUFFER;
+
+	SCE_PFX_PUSH_MARKER("pfxParallelSort");
+	pfxSort(data,(PfxSortData32Key64*)workBuff,numData);
+	SCE_PFX_POP_MARKER();
+
+	return SCE_PFX_OK;
+}
+
 } //namespace PhysicsEffects
 } //namespace sce
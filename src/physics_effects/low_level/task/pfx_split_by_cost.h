@@ -0,0 +1,99 @@
+/*
+Physics Effects Copyright(C) 2010 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#ifndef _SCE_PFX_SPLIT_BY_COST_H
+#define _SCE_PFX_SPLIT_BY_COST_H
+
+#include "../../../include/physics_effects/low_level/task/pfx_task_manager.h"
+
+namespace sce {
+namespace PhysicsEffects {
+
+///////////////////////////////////////////////////////////////////////////////
+// Split By Cost
+
+//J 各要素の推定コストが均等になるように要素の範囲をタスクに割り当てる
+//J taskCostsは全タスクで共有するnumTasks個の配列
+//J 境界を決める間に他のタスクがコストを変えないよう、戻る前に再度同期する
+//E Assign each task a contiguous range of items with roughly equal estimated
+//E cost. Every task first sums the cost of an equal sized slice into the
+//E shared taskCosts array (numTasks entries). After the barrier the range
+//E boundaries are found by rescanning at most the slices that contain them,
+//E so no per item storage is needed. Neighbouring tasks rescan the same slice
+//E and only agree on the shared boundary if cost(i) doesn't change meanwhile,
+//E so all tasks sync again before any of them starts working on its range.
+//E Costs must be at least 1.
+template<class CostFunc>
+void pfxSplitByCost(PfxTaskArg *arg,PfxUInt32 numItems,PfxUInt64 *taskCosts,CostFunc cost,PfxUInt32 &begin,PfxUInt32 &end)
+{
+	PfxUInt32 taskId = arg->taskId;
+	PfxUInt32 numTasks = arg->maxTasks;
+
+	PfxUInt32 sliceBegin = (PfxUInt32)(((PfxUInt64)numItems * taskId) / numTasks);
+	PfxUInt32 sliceEnd = (PfxUInt32)(((PfxUInt64)numItems * (taskId+1)) / numTasks);
+
+	PfxUInt64 sliceCost = 0;
+	for(PfxUInt32 i=sliceBegin;i<sliceEnd;i++) {
+		sliceCost += cost(i);
+	}
+	taskCosts[taskId] = sliceCost;
+
+	arg->barrier->sync();
+
+	PfxUInt64 totalCost = 0;
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		totalCost += taskCosts[t];
+	}
+
+	PfxUInt32 boundary[2];
+	for(PfxUInt32 k=0;k<2;k++) {
+		PfxUInt32 n = taskId + k;
+		if(n == 0) {
+			boundary[k] = 0;
+			continue;
+		}
+		if(n == numTasks) {
+			boundary[k] = numItems;
+			continue;
+		}
+
+		//J 累積コストがtarget以上になる最初の要素を探す
+		//E Find the first item whose cost prefix reaches the target
+		PfxUInt64 target = (totalCost * n) / numTasks;
+		PfxUInt64 prefix = 0;
+		PfxUInt32 t = 0;
+		while(t+1 < numTasks && prefix + taskCosts[t] < target) {
+			prefix += taskCosts[t++];
+		}
+
+		PfxUInt32 i = (PfxUInt32)(((PfxUInt64)numItems * t) / numTasks);
+		PfxUInt32 iEnd = (PfxUInt32)(((PfxUInt64)numItems * (t+1)) / numTasks);
+		while(i < iEnd && prefix < target) {
+			prefix += cost(i++);
+		}
+		boundary[k] = i;
+	}
+
+	begin = boundary[0];
+	end = boundary[1];
+
+	arg->barrier->sync();
+}
+
+} //namespace PhysicsEffects
+} //namespace sce
+
+#endif // _SCE_PFX_SPLIT_BY_COST_H
@@ -0,0 +1,134 @@
+/*
+Physics Effects Copyright(C) 2010 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#ifndef _WIN32
+
+#include <sched.h>
+#include "pfx_sync_components_pthreads.h"
+
+namespace sce {
+namespace PhysicsEffects {
+
+///////////////////////////////////////////////////////////////////////////////
+// Barrier
+
+PfxBarrierPthreads::PfxBarrierPthreads(int n)
+{
+	SCE_PFX_ASSERT(n>0);
+	pthread_mutex_init(&m_mutex,NULL);
+	pthread_cond_init(&m_cond,NULL);
+	m_maxCount = n;
+	m_count = 0;
+	m_generation = 0;
+}
+
+PfxBarrierPthreads::~PfxBarrierPthreads()
+{
+	pthread_cond_destroy(&m_cond);
+	pthread_mutex_destroy(&m_mutex);
+}
+
+void PfxBarrierPthreads::sync()
+{
+	pthread_mutex_lock(&m_mutex);
+
+	PfxUInt32 generation = m_generation;
+
+	if(++m_count >= m_maxCount) {
+		m_count = 0;
+		m_generation++;
+		pthread_cond_broadcast(&m_cond);
+	}
+	else {
+		while(generation == m_generation) {
+			pthread_cond_wait(&m_cond,&m_mutex);
+		}
+	}
+
+	pthread_mutex_unlock(&m_mutex);
+}
+
+void PfxBarrierPthreads::setMaxCount(int n)
+{
+	SCE_PFX_ASSERT(n>0);
+	pthread_mutex_lock(&m_mutex);
+	SCE_PFX_ASSERT(m_count==0);
+	m_maxCount = n;
+	pthread_mutex_unlock(&m_mutex);
+}
+
+int PfxBarrierPthreads::getMaxCount()
+{
+	return m_maxCount;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Critical Section
+
+PfxCriticalSectionPthreads::PfxCriticalSectionPthreads()
+{
+	memset(m_commonBuff,0,sizeof(m_commonBuff));
+	pthread_mutex_init(&m_mutex,NULL);
+}
+
+PfxCriticalSectionPthreads::~PfxCriticalSectionPthreads()
+{
+	pthread_mutex_destroy(&m_mutex);
+}
+
+PfxUInt32 PfxCriticalSectionPthreads::getSharedParam(int i)
+{
+	SCE_PFX_ASSERT(i>=0&&i<32);
+	return m_commonBuff[i];
+}
+
+void PfxCriticalSectionPthreads::setSharedParam(int i,PfxUInt32 p)
+{
+	SCE_PFX_ASSERT(i>=0&&i<32);
+	m_commonBuff[i] = p;
+}
+
+void PfxCriticalSectionPthreads::lock()
+{
+	for(int i=0;i<SCE_PFX_PTHREADS_SPIN_COUNT;i++) {
+		if(pthread_mutex_trylock(&m_mutex) == 0) return;
+		if((i&0x3f) == 0x3f) sched_yield();
+	}
+	pthread_mutex_lock(&m_mutex);
+}
+
+void PfxCriticalSectionPthreads::unlock()
+{
+	pthread_mutex_unlock(&m_mutex);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Create Sync Components
+
+PfxBarrier *pfxCreateBarrierPthreads(int n)
+{
+	return new PfxBarrierPthreads(n);
+}
+
+PfxCriticalSection *pfxCreateCriticalSectionPthreads()
+{
+	return new PfxCriticalSectionPthreads();
+}
+
+} //namespace PhysicsEffects
+} //namespace sce
+
+#endif // _WIN32
@@ -0,0 +1,83 @@
+/*
+Physics Effects Copyright(C) 2010 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#ifndef _SCE_PFX_SYNC_COMPONENTS_PTHREADS_H
+#define _SCE_PFX_SYNC_COMPONENTS_PTHREADS_H
+
+#ifndef _WIN32
+
+#include <pthread.h>
+#include "../../../include/physics_effects/low_level/task/pfx_sync_components.h"
+
+//J ロック取得時にブロックする前のスピン回数
+//E Number of spins before a lock blocks in the kernel
+#define SCE_PFX_PTHREADS_SPIN_COUNT 1024
+
+namespace sce {
+namespace PhysicsEffects {
+
+///////////////////////////////////////////////////////////////////////////////
+// Barrier
+
+//E Generation counted barrier. The last thread to arrive releases the others,
+//E so the same barrier can be reused for consecutive phases without reset.
+
+class PfxBarrierPthreads : public PfxBarrier
+{
+private:
+	pthread_mutex_t m_mutex;
+	pthread_cond_t m_cond;
+	int m_maxCount;
+	int m_count;
+	PfxUInt32 m_generation;
+
+public:
+	PfxBarrierPthreads(int n = 1);
+	~PfxBarrierPthreads();
+
+	void sync();
+	void setMaxCount(int n);
+	int  getMaxCount();
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Critical Section
+
+//E Spins on trylock for SCE_PFX_PTHREADS_SPIN_COUNT iterations before
+//E blocking, which keeps the short shared parameter updates off the kernel.
+
+class PfxCriticalSectionPthreads : public PfxCriticalSection
+{
+private:
+	pthread_mutex_t m_mutex;
+
+public:
+	PfxCriticalSectionPthreads();
+	~PfxCriticalSectionPthreads();
+
+	PfxUInt32 getSharedParam(int i);
+	void setSharedParam(int i,PfxUInt32 p);
+
+	void lock();
+	void unlock();
+};
+
+} //namespace PhysicsEffects
+} //namespace sce
+
+#endif // _WIN32
+
+#endif // _SCE_PFX_SYNC_COMPONENTS_PTHREADS_H
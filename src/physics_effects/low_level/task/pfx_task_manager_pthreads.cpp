@@ -0,0 +1,218 @@
+/*
+Physics Effects Copyright(C) 2010 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#ifndef _WIN32
+
+#include "../../../include/physics_effects/base_level/base/pfx_perf_counter.h"
+#include "pfx_task_manager_pthreads.h"
+
+namespace sce {
+namespace PhysicsEffects {
+
+PfxUInt32 pfxGetWorkBytesOfTaskManagerPthreads(PfxUInt32 numTasks,PfxUInt32 maxTasks)
+{
+	(void)numTasks;
+	return 16 +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxTaskArg)*maxTasks) +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxPthreadsWorker)*maxTasks) +
+		SCE_PFX_ALLOC_BYTES_ALIGN16(sizeof(PfxUInt32)*maxTasks);
+}
+
+PfxTaskManagerPthreads::PfxTaskManagerPthreads(PfxUInt32 numTasks,PfxUInt32 maxTasks,void *workBuff,PfxUInt32 workBytes)
+	: PfxTaskManager(numTasks,maxTasks,workBuff,workBytes),m_barrier(numTasks)
+{
+	m_workers = (PfxPthreadsWorker*)m_pool.allocate(sizeof(PfxPthreadsWorker)*m_maxTasks);
+	m_doneQueue = (PfxUInt32*)m_pool.allocate(sizeof(PfxUInt32)*m_maxTasks);
+	m_doneHead = 0;
+	m_doneCount = 0;
+	m_numRunning = 0;
+	m_initialized = false;
+	m_exit = false;
+	m_taskEntry = NULL;
+
+	pthread_mutex_init(&m_mutex,NULL);
+	pthread_cond_init(&m_doneCond,NULL);
+}
+
+PfxTaskManagerPthreads::~PfxTaskManagerPthreads()
+{
+	finalize();
+
+	pthread_cond_destroy(&m_doneCond);
+	pthread_mutex_destroy(&m_mutex);
+}
+
+void *PfxTaskManagerPthreads::threadEntry(void *arg)
+{
+	PfxPthreadsWorker *worker = (PfxPthreadsWorker*)arg;
+	worker->m_manager->run(*worker);
+	return NULL;
+}
+
+void PfxTaskManagerPthreads::run(PfxPthreadsWorker &worker)
+{
+	pthread_mutex_lock(&m_mutex);
+
+	for(;;) {
+		while(!worker.m_start && !m_exit) {
+			pthread_cond_wait(&worker.m_cond,&m_mutex);
+		}
+
+		if(!worker.m_start) break;
+
+		worker.m_start = false;
+
+		pthread_mutex_unlock(&m_mutex);
+
+		SCE_PFX_PUSH_MARKER("PfxTask");
+		m_taskEntry(&m_taskArg[worker.m_taskId]);
+		SCE_PFX_POP_MARKER();
+
+		pthread_mutex_lock(&m_mutex);
+
+		m_doneQueue[(m_doneHead+m_doneCount)%m_maxTasks] = worker.m_taskId;
+		m_doneCount++;
+		pthread_cond_signal(&m_doneCond);
+	}
+
+	pthread_mutex_unlock(&m_mutex);
+}
+
+PfxUInt32 PfxTaskManagerPthreads::getSharedParam(int i)
+{
+	return m_criticalSection.getSharedParam(i);
+}
+
+void PfxTaskManagerPthreads::setSharedParam(int i,PfxUInt32 p)
+{
+	m_criticalSection.setSharedParam(i,p);
+}
+
+void PfxTaskManagerPthreads::startTask(int taskId,void *io,PfxUInt32 data1,PfxUInt32 data2,PfxUInt32 data3,PfxUInt32 data4)
+{
+	SCE_PFX_ALWAYS_ASSERT(m_initialized);
+	SCE_PFX_ALWAYS_ASSERT(m_taskEntry);
+	SCE_PFX_ASSERT(taskId>=0&&taskId<(int)m_numTasks);
+
+	PfxTaskArg &arg = m_taskArg[taskId];
+	arg.taskId = taskId;
+	arg.maxTasks = m_numTasks;
+	arg.barrier = &m_barrier;
+	arg.criticalSection = &m_criticalSection;
+	arg.io = io;
+	arg.data[0] = data1;
+	arg.data[1] = data2;
+	arg.data[2] = data3;
+	arg.data[3] = data4;
+
+	pthread_mutex_lock(&m_mutex);
+	PfxPthreadsWorker &worker = m_workers[taskId];
+	SCE_PFX_ASSERT(!worker.m_start);
+	worker.m_start = true;
+	m_numRunning++;
+	pthread_cond_signal(&worker.m_cond);
+	pthread_mutex_unlock(&m_mutex);
+}
+
+void PfxTaskManagerPthreads::waitTask(int &taskId,PfxUInt32 &data1,PfxUInt32 &data2,PfxUInt32 &data3,PfxUInt32 &data4)
+{
+	pthread_mutex_lock(&m_mutex);
+	SCE_PFX_ASSERT(m_numRunning>0);
+
+	while(m_doneCount == 0) {
+		pthread_cond_wait(&m_doneCond,&m_mutex);
+	}
+
+	taskId = (int)m_doneQueue[m_doneHead];
+	m_doneHead = (m_doneHead+1)%m_maxTasks;
+	m_doneCount--;
+	m_numRunning--;
+	pthread_mutex_unlock(&m_mutex);
+
+	PfxTaskArg &arg = m_taskArg[taskId];
+	data1 = arg.data[0];
+	data2 = arg.data[1];
+	data3 = arg.data[2];
+	data4 = arg.data[3];
+}
+
+void PfxTaskManagerPthreads::setNumTasks(PfxUInt32 tasks)
+{
+	SCE_PFX_ASSERT(m_numRunning==0);
+	PfxTaskManager::setNumTasks(tasks);
+	m_barrier.setMaxCount(m_numTasks);
+}
+
+void PfxTaskManagerPthreads::initialize()
+{
+	if(m_initialized) return;
+
+	m_exit = false;
+	m_doneHead = 0;
+	m_doneCount = 0;
+	m_numRunning = 0;
+	m_barrier.setMaxCount(m_numTasks);
+
+	for(PfxUInt32 i=0;i<m_maxTasks;i++) {
+		PfxPthreadsWorker &worker = m_workers[i];
+		worker.m_manager = this;
+		worker.m_taskId = i;
+		worker.m_start = false;
+		pthread_cond_init(&worker.m_cond,NULL);
+		int ret = pthread_create(&worker.m_thread,NULL,threadEntry,&worker);
+		SCE_PFX_ALWAYS_ASSERT_MSG(ret==0,"pthread_create failed");
+		(void)ret;
+	}
+
+	m_initialized = true;
+}
+
+void PfxTaskManagerPthreads::finalize()
+{
+	if(!m_initialized) return;
+
+	SCE_PFX_ASSERT(m_numRunning==0);
+
+	pthread_mutex_lock(&m_mutex);
+	m_exit = true;
+	for(PfxUInt32 i=0;i<m_maxTasks;i++) {
+		pthread_cond_signal(&m_workers[i].m_cond);
+	}
+	pthread_mutex_unlock(&m_mutex);
+
+	for(PfxUInt32 i=0;i<m_maxTasks;i++) {
+		pthread_join(m_workers[i].m_thread,NULL);
+		pthread_cond_destroy(&m_workers[i].m_cond);
+	}
+
+	m_initialized = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Create Task Manager
+
+PfxTaskManager *pfxCreateTaskManagerPthreads(PfxUInt32 numTasks,PfxUInt32 maxTasks,void *workBuff,PfxUInt32 workBytes)
+{
+	if(!workBuff || numTasks == 0 || numTasks > maxTasks) return NULL;
+	if(SCE_PFX_AVAILABLE_BYTES_ALIGN16(workBuff,workBytes) < pfxGetWorkBytesOfTaskManagerPthreads(numTasks,maxTasks)) return NULL;
+
+	return new PfxTaskManagerPthreads(numTasks,maxTasks,workBuff,workBytes);
+}
+
+} //namespace PhysicsEffects
+} //namespace sce
+
+#endif // _WIN32
@@ -0,0 +1,84 @@
+/*
+Physics Effects Copyright(C) 2010 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#ifndef _SCE_PFX_TASK_MANAGER_PTHREADS_H
+#define _SCE_PFX_TASK_MANAGER_PTHREADS_H
+
+#ifndef _WIN32
+
+#include <pthread.h>
+#include "../../../include/physics_effects/low_level/task/pfx_task_manager.h"
+#include "pfx_sync_components_pthreads.h"
+
+namespace sce {
+namespace PhysicsEffects {
+
+class PfxTaskManagerPthreads;
+
+struct PfxPthreadsWorker {
+	pthread_t m_thread;
+	pthread_cond_t m_cond;
+	PfxTaskManagerPthreads *m_manager;
+	PfxUInt32 m_taskId;
+	PfxBool m_start;
+};
+
+//J 各タスクIDに専用のワーカースレッドを割り当てる
+//J startTask()はスレッドを起こすだけなので、タスク内でバリア同期してもデッドロックしない
+//E Each task id owns a dedicated worker thread, so tasks started together run
+//E concurrently and may synchronize with each other through the barrier.
+
+class PfxTaskManagerPthreads : public PfxTaskManager
+{
+private:
+	pthread_mutex_t m_mutex;
+	pthread_cond_t m_doneCond;
+	PfxPthreadsWorker *m_workers;
+	PfxUInt32 *m_doneQueue;
+	PfxUInt32 m_doneHead;
+	PfxUInt32 m_doneCount;
+	PfxUInt32 m_numRunning;
+	PfxBool m_initialized;
+	PfxBool m_exit;
+	PfxBarrierPthreads m_barrier;
+	PfxCriticalSectionPthreads m_criticalSection;
+
+	static void *threadEntry(void *arg);
+
+	void run(PfxPthreadsWorker &worker);
+
+public:
+	PfxTaskManagerPthreads(PfxUInt32 numTasks,PfxUInt32 maxTasks,void *workBuff,PfxUInt32 workBytes);
+	~PfxTaskManagerPthreads();
+
+	PfxUInt32 getSharedParam(int i);
+	void setSharedParam(int i,PfxUInt32 p);
+
+	void startTask(int taskId,void *io,PfxUInt32 data1,PfxUInt32 data2,PfxUInt32 data3,PfxUInt32 data4);
+	void waitTask(int &taskId,PfxUInt32 &data1,PfxUInt32 &data2,PfxUInt32 &data3,PfxUInt32 &data4);
+
+	void setNumTasks(PfxUInt32 tasks);
+
+	void initialize();
+	void finalize();
+};
+
+} //namespace PhysicsEffects
+} //namespace sce
+
+#endif // _WIN32
+
+#endif // _SCE_PFX_TASK_MANAGER_PTHREADS_H
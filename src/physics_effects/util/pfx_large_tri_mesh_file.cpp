@@ -0,0 +1,374 @@
+/*
+Physics Effects Copyright(C) 2011 Sony Computer Entertainment Inc.
+All rights reserved.
+
+Physics Effects is open software; you can redistribute it and/or
+modify it under the terms of the BSD License.
+
+Physics Effects is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the BSD License for more details.
+
+A copy of the BSD License is distributed with
+Physics Effects under the filename: physics_effects_license.txt
+*/
+
+#include "../../../include/physics_effects/util/pfx_large_tri_mesh_file.h"
+#include "pfx_util_common.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace sce {
+namespace PhysicsEffects {
+
+///////////////////////////////////////////////////////////////////////////////
+// イメージの配置
+
+static SCE_PFX_FORCE_INLINE
+PfxUInt32 alignOffset(PfxUInt32 offset)
+{
+	return (offset + SCE_PFX_LARGETRIMESH_FILE_ALIGN - 1) & ~(SCE_PFX_LARGETRIMESH_FILE_ALIGN - 1);
+}
+
+static
+void getImageLayout(PfxUInt32 numIslands,PfxUInt32 numBvhNodes,PfxLargeTriMeshFileHeader &header)
+{
+	memset(&header,0,sizeof(PfxLargeTriMeshFileHeader));
+	header.magic = SCE_PFX_LARGETRIMESH_FILE_MAGIC;
+	header.version = SCE_PFX_LARGETRIMESH_FILE_VERSION;
+	header.triMeshBytes = sizeof(PfxTriMesh);
+	header.numIslands = numIslands;
+	header.numBvhNodes = numBvhNodes;
+
+	PfxUInt32 offset = alignOffset(sizeof(PfxLargeTriMeshFileHeader));
+	header.aabbListOffset = offset;
+	offset = alignOffset(offset + sizeof(PfxAabb16) * numIslands);
+	header.islandsOffset = offset;
+	offset = alignOffset(offset + sizeof(PfxTriMesh) * numIslands);
+	if(numBvhNodes > 0) {
+		header.bvhNodesOffset = offset;
+		offset = alignOffset(offset + sizeof(PfxAabb16) * numBvhNodes);
+	}
+	header.fileBytes = offset;
+}
+
+// 未使用の領域を含めないようにメンバ毎にコピーする（dstは0クリア済み）。ベクトルのw成分も0のまま残す
+static
+void writeIsland(PfxTriMesh &dst,const PfxTriMesh &src)
+{
+	dst.m_numVerts = src.m_numVerts;
+	dst.m_numEdges = src.m_numEdges;
+	dst.m_numFacets = src.m_numFacets;
+
+	for(PfxUInt32 i=0;i<src.m_numFacets;i++) {
+		dst.m_facets[i] = src.m_facets[i];
+	}
+
+	for(PfxUInt32 i=0;i<src.m_numEdges;i++) {
+		dst.m_edges[i] = src.m_edges[i];
+	}
+
+	for(PfxUInt32 i=0;i<src.m_numVerts;i++) {
+		pfxStoreVector3(src.m_verts[i],(PfxFloat*)&dst.m_verts[i]);
+	}
+
+	pfxStoreVector3(src.m_half,(PfxFloat*)&dst.m_half);
+}
+
+static
+void writeAabb(PfxAabb16 &dst,const PfxAabb16 &src,PfxInt32 numElements)
+{
+	for(PfxInt32 i=0;i<numElements;i++) {
+		dst.set16(i,src.get16(i));
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// イメージの作成
+
+PfxUInt32 pfxGetLargeTriMeshImageBytes(const PfxLargeTriMesh &lmesh)
+{
+	PfxLargeTriMeshFileHeader header;
+	getImageLayout(lmesh.m_numIslands,lmesh.m_bvhNodes ? lmesh.m_numBvhNodes : 0,header);
+	return header.fileBytes;
+}
+
+PfxInt32 pfxWriteLargeTriMeshImage(const PfxLargeTriMesh &lmesh,void *buff,PfxUInt32 bytes)
+{
+	if(!buff || lmesh.m_numIslands == 0 || !lmesh.m_islands || !lmesh.m_aabbList) return SCE_PFX_ERR_INVALID_VALUE;
+	if(!SCE_PFX_PTR_IS_ALIGNED16(buff)) return SCE_PFX_ERR_INVALID_ALIGN;
+
+	PfxLargeTriMeshFileHeader header;
+	getImageLayout(lmesh.m_numIslands,lmesh.m_bvhNodes ? lmesh.m_numBvhNodes : 0,header);
+	header.half[0] = lmesh.m_half[0];
+	header.half[1] = lmesh.m_half[1];
+	header.half[2] = lmesh.m_half[2];
+
+	if(bytes < header.fileBytes) return SCE_PFX_ERR_OUT_OF_BUFFER;
+
+	PfxUInt8 *image = (PfxUInt8*)buff;
+	memset(image,0,header.fileBytes);
+	memcpy(image,&header,sizeof(PfxLargeTriMeshFileHeader));
+
+	// AABBの要素6,7は未使用
+	PfxAabb16 *aabbList = (PfxAabb16*)(image + header.aabbListOffset);
+	for(PfxUInt32 i=0;i<header.numIslands;i++) {
+		writeAabb(aabbList[i],lmesh.m_aabbList[i],6);
+	}
+
+	PfxTriMesh *islands = (PfxTriMesh*)(image + header.islandsOffset);
+	for(PfxUInt32 i=0;i<header.numIslands;i++) {
+		writeIsland(islands[i],lmesh.m_islands[i]);
+	}
+
+	// BVHのノードは要素6,7にアイランドとエスケープのインデックスを持つ
+	PfxAabb16 *bvhNodes = (PfxAabb16*)(image + header.bvhNodesOffset);
+	for(PfxUInt32 i=0;i<header.numBvhNodes;i++) {
+		writeAabb(bvhNodes[i],lmesh.m_bvhNodes[i],8);
+	}
+
+	return SCE_PFX_OK;
+}
+
+PfxInt32 pfxSaveLargeTriMeshFile(const PfxLargeTriMesh &lmesh,const char *path)
+{
+	if(!path) return SCE_PFX_ERR_INVALID_VALUE;
+
+	PfxUInt32 bytes = pfxGetLargeTriMeshImageBytes(lmesh);
+	void *image = SCE_PFX_UTIL_ALLOC(128,bytes);
+	if(!image) return SCE_PFX_ERR_OUT_OF_BUFFER;
+
+	PfxInt32 ret = pfxWriteLargeTriMeshImage(lmesh,image,bytes);
+	if(ret == SCE_PFX_OK) {
+		FILE *fp = fopen(path,"wb");
+		if(!fp || fwrite(image,1,bytes,fp) != bytes) {
+			ret = SCE_PFX_ERR_INVALID_VALUE;
+		}
+		if(fp && fclose(fp) != 0) {
+			ret = SCE_PFX_ERR_INVALID_VALUE;
+		}
+	}
+
+	SCE_PFX_UTIL_FREE(image);
+
+	return ret;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// イメージの参照
+
+static
+bool checkRange(PfxUInt32 offset,PfxUInt32 elementBytes,PfxUInt32 numElements,PfxUInt32 fileBytes)
+{
+	if(offset % SCE_PFX_LARGETRIMESH_FILE_ALIGN != 0 || offset > fileBytes) return false;
+	return (PfxUInt64)elementBytes * numElements <= (PfxUInt64)(fileBytes - offset);
+}
+
+// ファイルの内容は信用せず、配列外を参照するインデックスと数を拒否する
+static
+bool checkIsland(const PfxTriMesh &island)
+{
+	if(island.m_numVerts > SCE_PFX_NUMMESHVERTICES ||
+	   island.m_numEdges > SCE_PFX_NUMMESHEDGES ||
+	   island.m_numFacets > SCE_PFX_NUMMESHFACETS) {
+		return false;
+	}
+
+	for(PfxUInt32 i=0;i<island.m_numEdges;i++) {
+		const PfxEdge &edge = island.m_edges[i];
+		if(edge.m_vertId[0] >= island.m_numVerts || edge.m_vertId[1] >= island.m_numVerts) return false;
+	}
+
+	for(PfxUInt32 i=0;i<island.m_numFacets;i++) {
+		const PfxFacet &facet = island.m_facets[i];
+		for(int j=0;j<3;j++) {
+			if(facet.m_vertIds[j] >= island.m_numVerts || facet.m_edgeIds[j] >= island.m_numEdges) return false;
+		}
+	}
+
+	return true;
+}
+
+// エスケープ先が前に戻るとBVHの探索が終わらないので、常に後ろのノードを指すことを確認する
+static
+bool checkBvhNodes(const PfxAabb16 *bvhNodes,PfxUInt32 numBvhNodes,PfxUInt32 numIslands)
+{
+	for(PfxUInt32 i=0;i<numBvhNodes;i++) {
+		PfxUInt32 escapeId = pfxGetBvhEscapeId(bvhNodes[i]);
+		PfxUInt32 islandId = pfxGetBvhIslandId(bvhNodes[i]);
+		if(escapeId <= i || escapeId > numBvhNodes) return false;
+		if(islandId != SCE_PFX_LARGETRIMESH_BVH_INTERNAL && islandId >= numIslands) return false;
+	}
+	return true;
+}
+
+// アンマップしたラージメッシュがファイルのページを参照しないよう空に戻す
+static
+void resetLargeTriMesh(PfxLargeTriMesh &lmesh)
+{
+	lmesh.m_half = PfxVector3(0.0f);
+	lmesh.m_numIslands = 0;
+	lmesh.m_axis = 0;
+	lmesh.m_aabbList = NULL;
+	lmesh.m_islands = NULL;
+	lmesh.m_numBvhNodes = 0;
+	lmesh.m_bvhNodes = NULL;
+}
+
+PfxInt32 pfxBindLargeTriMeshImage(PfxLargeTriMesh &lmesh,const void *image,PfxUInt32 bytes)
+{
+	if(!image || bytes < sizeof(PfxLargeTriMeshFileHeader)) return SCE_PFX_ERR_INVALID_VALUE;
+	if(!SCE_PFX_PTR_IS_ALIGNED16(image)) return SCE_PFX_ERR_INVALID_ALIGN;
+
+	const PfxLargeTriMeshFileHeader &header = *((const PfxLargeTriMeshFileHeader*)image);
+
+	// バイトオーダーが異なる場合もマジックナンバーが一致しない
+	if(header.magic != SCE_PFX_LARGETRIMESH_FILE_MAGIC) return SCE_PFX_ERR_INVALID_VALUE;
+	if(header.version != SCE_PFX_LARGETRIMESH_FILE_VERSION || header.triMeshBytes != sizeof(PfxTriMesh)) return SCE_PFX_ERR_INVALID_VALUE;
+	if(header.fileBytes > bytes) return SCE_PFX_ERR_OUT_OF_BUFFER;
+
+	if(header.numIslands == 0 || header.numIslands > SCE_PFX_MAX_LARGETRIMESH_ISLANDS) return SCE_PFX_ERR_OUT_OF_RANGE;
+	if(header.numBvhNodes > 2 * header.numIslands - 1) return SCE_PFX_ERR_OUT_OF_RANGE;
+
+	if(!checkRange(header.aabbListOffset,sizeof(PfxAabb16),header.numIslands,header.fileBytes) ||
+	   !checkRange(header.islandsOffset,sizeof(PfxTriMesh),header.numIslands,header.fileBytes) ||
+	   (header.numBvhNodes > 0 && !checkRange(header.bvhNodesOffset,sizeof(PfxAabb16),header.numBvhNodes,header.fileBytes))) {
+		return SCE_PFX_ERR_OUT_OF_RANGE;
+	}
+
+	const PfxUInt8 *base = (const PfxUInt8*)image;
+	const PfxTriMesh *islands = (const PfxTriMesh*)(base + header.islandsOffset);
+	const PfxAabb16 *bvhNodes = (const PfxAabb16*)(base + header.bvhNodesOffset);
+
+	for(PfxUInt32 i=0;i<header.numIslands;i++) {
+		if(!checkIsland(islands[i])) return SCE_PFX_ERR_OUT_OF_RANGE;
+	}
+
+	if(header.numBvhNodes > 0 && !checkBvhNodes(bvhNodes,header.numBvhNodes,header.numIslands)) {
+		return SCE_PFX_ERR_OUT_OF_RANGE;
+	}
+
+	lmesh.m_half = PfxVector3(header.half[0],header.half[1],header.half[2]);
+	lmesh.m_numIslands = (PfxUInt16)header.numIslands;
+	lmesh.m_aabbList = (PfxAabb16*)(base + header.aabbListOffset);
+	lmesh.m_islands = (PfxTriMesh*)islands;
+	lmesh.m_numBvhNodes = (PfxUInt16)header.numBvhNodes;
+	lmesh.m_bvhNodes = header.numBvhNodes > 0 ? (PfxAabb16*)bvhNodes : NULL;
+
+	return SCE_PFX_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ファイルのマップ
+
+#ifdef _WIN32
+
+PfxInt32 pfxMapLargeTriMeshFile(PfxMappedLargeTriMesh &mapped,const char *path)
+{
+	if(!path || mapped.data) return SCE_PFX_ERR_INVALID_VALUE;
+
+	HANDLE file = CreateFileA(path,GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+	if(file == INVALID_HANDLE_VALUE) return SCE_PFX_ERR_INVALID_VALUE;
+
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(file,&size) || size.QuadPart < (LONGLONG)sizeof(PfxLargeTriMeshFileHeader) || size.QuadPart > 0xffffffff) {
+		CloseHandle(file);
+		return SCE_PFX_ERR_INVALID_VALUE;
+	}
+
+	// マッピングオブジェクトがファイルを参照するので、ファイルのハンドルは閉じてよい
+	HANDLE mapping = CreateFileMappingA(file,NULL,PAGE_READONLY,0,0,NULL);
+	CloseHandle(file);
+	if(!mapping) return SCE_PFX_ERR_INVALID_VALUE;
+
+	void *data = MapViewOfFile(mapping,FILE_MAP_READ,0,0,0);
+	if(!data) {
+		CloseHandle(mapping);
+		return SCE_PFX_ERR_INVALID_VALUE;
+	}
+
+	PfxInt32 ret = pfxBindLargeTriMeshImage(mapped.lmesh,data,(PfxUInt32)size.QuadPart);
+	if(ret != SCE_PFX_OK) {
+		UnmapViewOfFile(data);
+		CloseHandle(mapping);
+		return ret;
+	}
+
+	mapped.data = data;
+	mapped.bytes = (PfxUInt32)size.QuadPart;
+	mapped.handle = mapping;
+
+	return SCE_PFX_OK;
+}
+
+void pfxUnmapLargeTriMeshFile(PfxMappedLargeTriMesh &mapped)
+{
+	if(mapped.data) {
+		UnmapViewOfFile(mapped.data);
+		CloseHandle((HANDLE)mapped.handle);
+	}
+	mapped.data = NULL;
+	mapped.bytes = 0;
+	mapped.handle = NULL;
+	resetLargeTriMesh(mapped.lmesh);
+}
+
+#else
+
+PfxInt32 pfxMapLargeTriMeshFile(PfxMappedLargeTriMesh &mapped,const char *path)
+{
+	if(!path || mapped.data) return SCE_PFX_ERR_INVALID_VALUE;
+
+	int fd = open(path,O_RDONLY);
+	if(fd < 0) return SCE_PFX_ERR_INVALID_VALUE;
+
+	struct stat st;
+	if(fstat(fd,&st) != 0 || st.st_size < (off_t)sizeof(PfxLargeTriMeshFileHeader) || (PfxUInt64)st.st_size > 0xffffffff) {
+		close(fd);
+		return SCE_PFX_ERR_INVALID_VALUE;
+	}
+
+	// 読み込み専用のページはページキャッシュを直接参照するので、同じファイルをマップしたプロセス間で共有される
+	void *data = mmap(NULL,(size_t)st.st_size,PROT_READ,MAP_SHARED,fd,0);
+	close(fd);
+	if(data == MAP_FAILED) return SCE_PFX_ERR_INVALID_VALUE;
+
+	PfxInt32 ret = pfxBindLargeTriMeshImage(mapped.lmesh,data,(PfxUInt32)st.st_size);
+	if(ret != SCE_PFX_OK) {
+		munmap(data,(size_t)st.st_size);
+		return ret;
+	}
+
+	mapped.data = data;
+	mapped.bytes = (PfxUInt32)st.st_size;
+	mapped.handle = NULL;
+
+	return SCE_PFX_OK;
+}
+
+void pfxUnmapLargeTriMeshFile(PfxMappedLargeTriMesh &mapped)
+{
+	if(mapped.data) {
+		munmap(mapped.data,mapped.bytes);
+	}
+	mapped.data = NULL;
+	mapped.bytes = 0;
+	mapped.handle = NULL;
+	resetLargeTriMesh(mapped.lmesh);
+}
+
+#endif
+
+} //namespace PhysicsEffects
+} //namespace sce
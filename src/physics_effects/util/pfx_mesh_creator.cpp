@@ -21,8 +21,6 @@ Physics Effects under the filename: physics_effects_license.txt
 namespace sce {
 namespace PhysicsEffects {
 
-#define SCE_PFX_LARGETRIMESH_MAX_ISLANDS 256
-
 ///////////////////////////////////////////////////////////////////////////////
 // 凸メッシュ作成時に使用する関数
 
@@ -97,6 +95,7 @@ PfxInt32 pfxCreateConvexMesh(PfxConvexMesh &convex,const PfxCreateConvexMeshPara
 	}
 
 	convex.updateAABB();
+	convex.updateAdjacency();
 
 	return SCE_PFX_OK;
 }
@@ -105,9 +104,9 @@ PfxInt32 pfxCreateConvexMesh(PfxConvexMesh &convex,const PfxCreateConvexMeshPara
 // ラージメッシュ作成時に使用する構造体
 
 struct PfxMcVert {
-	PfxInt16 i;
-	PfxInt16 flag;
-	SCE_PFX_PADDING(1,12)
+	PfxInt32 i;
+	PfxInt32 flag;
+	SCE_PFX_PADDING(1,8)
 	PfxVector3  coord;
 };
 
@@ -180,8 +179,10 @@ struct PfxMcFacetLink {
 
 typedef PfxMcFacet* PfxMcFacetPtr;
 
+// アイランドの面は一つの配列に詰めて格納し、各アイランドの先頭位置を記録する
 struct PfxMcIslands {
-	PfxArray<PfxMcFacetPtr> facetsInIsland[SCE_PFX_MAX_LARGETRIMESH_ISLANDS];
+	PfxArray<PfxMcFacetPtr> facets;
+	PfxArray<PfxUInt32> facetOffsets;
 	PfxUInt32 numIslands;
 	SCE_PFX_PADDING(1,12)
 	
@@ -190,9 +191,23 @@ struct PfxMcIslands {
 		numIslands = 0;
 	}
 	
-	void add(PfxArray<PfxMcFacetPtr> &facets)
+	void add(PfxArray<PfxMcFacetPtr> &facetsInIsland)
+	{
+		facetOffsets.push(facets.size());
+		for(PfxUInt32 f=0;f<facetsInIsland.size();f++) {
+			facets.push(facetsInIsland[f]);
+		}
+		numIslands++;
+	}
+	
+	const PfxMcFacetPtr *getFacets(PfxUInt32 i) const
 	{
-		facetsInIsland[numIslands++] = facets;
+		return &facets[facetOffsets[i]];
+	}
+	
+	PfxUInt32 getNumFacets(PfxUInt32 i) const
+	{
+		return (i+1 < numIslands ? facetOffsets[i+1] : facets.size()) - facetOffsets[i];
 	}
 };
 
@@ -262,6 +277,203 @@ bool intersect(const PfxMcFacet &facetA,const PfxMcFacet &facetB,PfxFloat &close
 	return true;
 }
 
+// 空間ハッシュの補助関数
+static SCE_PFX_FORCE_INLINE
+PfxInt32 getCell(PfxFloat x,PfxFloat cellSize)
+{
+	return (PfxInt32)floorf(x/cellSize);
+}
+
+static SCE_PFX_FORCE_INLINE
+PfxUInt32 getCellKey(PfxInt32 x,PfxInt32 y,PfxInt32 z,PfxUInt32 numBuckets)
+{
+	return (((PfxUInt32)x*73856093u)^((PfxUInt32)y*19349663u)^((PfxUInt32)z*83492791u)) & (numBuckets-1);
+}
+
+// num以上の2の累乗
+static
+PfxUInt32 getNumBuckets(PfxUInt32 num)
+{
+	PfxUInt32 numBuckets = 1;
+	while(numBuckets < num) numBuckets <<= 1;
+	return numBuckets;
+}
+
+// 面のAABBを登録した格子。バケットkeyに含まれる面はcellFacets[cellStart[key]]～cellFacets[cellStart[key+1]-1]
+struct PfxMcFacetGrid {
+	PfxArray<PfxUInt32> cellStart;
+	PfxArray<PfxUInt32> cellFacets;
+	PfxVector3 origin;
+	PfxFloat cellSize;
+	PfxUInt32 numBuckets;
+	SCE_PFX_PADDING(1,8)
+
+	void getCellRange(const PfxVector3 &aabbMin,const PfxVector3 &aabbMax,PfxInt32 *cellMin,PfxInt32 *cellMax) const
+	{
+		for(int axis=0;axis<3;axis++) {
+			cellMin[axis] = getCell(aabbMin[axis]-origin[axis],cellSize);
+			cellMax[axis] = getCell(aabbMax[axis]-origin[axis],cellSize);
+		}
+	}
+};
+
+// 面の平均的な大きさの2倍の格子に面のAABBを登録する。多くの面は各軸で2つ以下の格子に収まる
+static
+void createFacetGrid(PfxMcFacetGrid &grid,PfxArray<PfxMcFacet> &facetList)
+{
+	const PfxUInt32 numFacets = facetList.size();
+
+	PfxVector3 aabbMin = facetList[0].aabbMin;
+	PfxFloat sumSize = 0.0f;
+	for(PfxUInt32 i=0;i<numFacets;i++) {
+		aabbMin = minPerElem(aabbMin,facetList[i].aabbMin);
+		sumSize += maxElem(facetList[i].aabbMax-facetList[i].aabbMin);
+	}
+
+	grid.origin = aabbMin;
+	grid.cellSize = SCE_PFX_MAX(2.0f*sumSize/numFacets,0.00001f);
+	grid.numBuckets = getNumBuckets(numFacets);
+
+	// バケット毎の面数を数える
+	grid.cellStart.assign(grid.numBuckets+1,0);
+
+	for(PfxUInt32 i=0;i<numFacets;i++) {
+		PfxInt32 cellMin[3],cellMax[3];
+		grid.getCellRange(facetList[i].aabbMin,facetList[i].aabbMax,cellMin,cellMax);
+		for(PfxInt32 z=cellMin[2];z<=cellMax[2];z++) {
+			for(PfxInt32 y=cellMin[1];y<=cellMax[1];y++) {
+				for(PfxInt32 x=cellMin[0];x<=cellMax[0];x++) {
+					grid.cellStart[getCellKey(x,y,z,grid.numBuckets)+1]++;
+				}
+			}
+		}
+	}
+
+	for(PfxUInt32 i=0;i<grid.numBuckets;i++) {
+		grid.cellStart[i+1] += grid.cellStart[i];
+	}
+
+	// 面を登録
+	PfxArray<PfxUInt32> cellFill(grid.numBuckets);
+	for(PfxUInt32 i=0;i<grid.numBuckets;i++) {
+		cellFill.push(grid.cellStart[i]);
+	}
+
+	grid.cellFacets.assign(grid.cellStart[grid.numBuckets],0);
+
+	for(PfxUInt32 i=0;i<numFacets;i++) {
+		PfxInt32 cellMin[3],cellMax[3];
+		grid.getCellRange(facetList[i].aabbMin,facetList[i].aabbMax,cellMin,cellMax);
+		for(PfxInt32 z=cellMin[2];z<=cellMax[2];z++) {
+			for(PfxInt32 y=cellMin[1];y<=cellMax[1];y++) {
+				for(PfxInt32 x=cellMin[0];x<=cellMax[0];x++) {
+					grid.cellFacets[cellFill[getCellKey(x,y,z,grid.numBuckets)]++] = i;
+				}
+			}
+		}
+	}
+}
+
+// 面の厚みの計算で使用する構造体
+struct PfxCalcThicknessIO {
+	const PfxMcFacetGrid *grid;
+	PfxArray<PfxMcFacet> *facetList;
+	PfxFloat defaultThickness;
+};
+
+// start～end-1番目の面の厚みを計算する
+// 厚みの範囲に入る面だけが対象となるので、厚みだけ広げたAABBと重なる面を格子から探して判定する
+// 書き込むのは面iの厚みだけなので、面の範囲を分ければ並列に計算できる
+static
+void calcThickness(PfxCalcThicknessIO &io,PfxUInt32 start,PfxUInt32 end)
+{
+	const PfxMcFacetGrid &grid = *io.grid;
+	PfxArray<PfxMcFacet> &facetList = *io.facetList;
+	const PfxUInt32 numTriangles = facetList.size();
+	
+	// 複数の格子に登録された面を一度だけ判定するための印
+	PfxUInt32 *facetStamp = (PfxUInt32*)SCE_PFX_UTIL_ALLOC(16,sizeof(PfxUInt32)*numTriangles);
+	memset(facetStamp,0xff,sizeof(PfxUInt32)*numTriangles);
+	
+	for(PfxUInt32 i=start;i<end;i++) {
+		PfxMcFacet &facetA = facetList[i];
+		PfxVector3 aabbMin = facetA.aabbMin - PfxVector3(facetA.thickness);
+		PfxVector3 aabbMax = facetA.aabbMax + PfxVector3(facetA.thickness);
+		
+		PfxInt32 cellMin[3],cellMax[3];
+		grid.getCellRange(aabbMin,aabbMax,cellMin,cellMax);
+		for(PfxInt32 z=cellMin[2];z<=cellMax[2];z++) {
+		for(PfxInt32 y=cellMin[1];y<=cellMax[1];y++) {
+		for(PfxInt32 x=cellMin[0];x<=cellMax[0];x++) {
+			PfxUInt32 key = getCellKey(x,y,z,grid.numBuckets);
+			for(PfxUInt32 c=grid.cellStart[key];c<grid.cellStart[key+1];c++) {
+				PfxUInt32 j = grid.cellFacets[c];
+				if(facetStamp[j] == i) continue;
+				facetStamp[j] = i;
+				
+				// 隣接面は比較対象にしない
+				if( i==j ||
+					j == facetA.e[0]->facetId[0] ||
+					j == facetA.e[0]->facetId[1] ||
+					j == facetA.e[1]->facetId[0] ||
+					j == facetA.e[1]->facetId[1] ||
+					j == facetA.e[2]->facetId[0] ||
+					j == facetA.e[2]->facetId[1]) {
+					continue;
+				}
+				
+				const PfxMcFacet &facetB = facetList[j];
+				
+				if(facetB.aabbMax[0] < aabbMin[0] || facetB.aabbMin[0] > aabbMax[0] ||
+				   facetB.aabbMax[1] < aabbMin[1] || facetB.aabbMin[1] > aabbMax[1] ||
+				   facetB.aabbMax[2] < aabbMin[2] || facetB.aabbMin[2] > aabbMax[2]) {
+					continue;
+				}
+				
+				// 交差判定
+				PfxFloat closestDistance=0;
+				if(intersect(facetA,facetB,closestDistance)) {
+					// 最近接距離/2を厚みとして採用
+					facetA.thickness = SCE_PFX_MAX(io.defaultThickness,SCE_PFX_MIN(facetA.thickness,closestDistance * 0.5f));
+				}
+			}
+		}
+		}
+		}
+	}
+	
+	SCE_PFX_UTIL_FREE(facetStamp);
+}
+
+static
+void calcThicknessTaskEntry(PfxTaskArg *arg)
+{
+	PfxCalcThicknessIO &io = *((PfxCalcThicknessIO*)arg->io);
+	PfxUInt32 numTriangles = io.facetList->size();
+	PfxUInt32 start = (PfxUInt32)(((PfxUInt64)numTriangles * arg->taskId) / arg->maxTasks);
+	PfxUInt32 end = (PfxUInt32)(((PfxUInt64)numTriangles * (arg->taskId+1)) / arg->maxTasks);
+	calcThickness(io,start,end);
+}
+
+// 全てのタスクでentryを実行し、終了を待つ
+static
+void runTasks(PfxTaskManager *taskManager,PfxTaskEntry entry,void *io)
+{
+	PfxUInt32 numTasks = taskManager->getNumTasks();
+	
+	taskManager->setTaskEntry((void*)entry);
+	
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		taskManager->startTask(t,io,0,0,0,0);
+	}
+	
+	for(PfxUInt32 t=0;t<numTasks;t++) {
+		int taskId;
+		PfxUInt32 data1,data2,data3,data4;
+		taskManager->waitTask(taskId,data1,data2,data3,data4);
+	}
+}
+
 static
 void divideMeshes(
 	PfxUInt32 numFacetsLimit,PfxFloat islandsRatio,
@@ -355,12 +567,11 @@ void divideMeshes(
 }
 
 static
-int addIslandToLargeTriMesh(PfxLargeTriMesh &lmesh,PfxTriMesh &island)
+void setIslandToLargeTriMesh(PfxLargeTriMesh &lmesh,PfxUInt32 islandId,PfxTriMesh &island)
 {
 	SCE_PFX_ASSERT(island.m_numFacets <= SCE_PFX_NUMMESHFACETS);
 
-	int newIsland = lmesh.m_numIslands++;
-	lmesh.m_islands[newIsland] = island;
+	lmesh.m_islands[islandId] = island;
 	
 	// アイランドローカルのAABBを計算
 	if(island.m_numFacets > 0) {
@@ -374,37 +585,130 @@ int addIslandToLargeTriMesh(PfxLargeTriMesh &lmesh,PfxTriMesh &island)
 		PfxVecInt3 aabbMinL,aabbMaxL;
 		lmesh.getLocalPosition(aabbMin,aabbMax,aabbMinL,aabbMaxL);
 
-		pfxSetXMin(lmesh.m_aabbList[newIsland],aabbMinL.getX());
-		pfxSetXMax(lmesh.m_aabbList[newIsland],aabbMaxL.getX());
-		pfxSetYMin(lmesh.m_aabbList[newIsland],aabbMinL.getY());
-		pfxSetYMax(lmesh.m_aabbList[newIsland],aabbMaxL.getY());
-		pfxSetZMin(lmesh.m_aabbList[newIsland],aabbMinL.getZ());
-		pfxSetZMax(lmesh.m_aabbList[newIsland],aabbMaxL.getZ());
+		pfxSetXMin(lmesh.m_aabbList[islandId],aabbMinL.getX());
+		pfxSetXMax(lmesh.m_aabbList[islandId],aabbMaxL.getX());
+		pfxSetYMin(lmesh.m_aabbList[islandId],aabbMinL.getY());
+		pfxSetYMax(lmesh.m_aabbList[islandId],aabbMaxL.getY());
+		pfxSetZMin(lmesh.m_aabbList[islandId],aabbMinL.getZ());
+		pfxSetZMax(lmesh.m_aabbList[islandId],aabbMaxL.getZ());
 	}
-	
-	return newIsland;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// アイランドのBVH構築
+
+static SCE_PFX_FORCE_INLINE
+PfxUInt32 getIslandCenter(const PfxAabb16 &aabb,int axis)
+{
+	return (PfxUInt32)pfxGetXYZMin(aabb,axis) + (PfxUInt32)pfxGetXYZMax(aabb,axis);
+}
+
+// 中心がaxis軸上でk番目に小さいアイランドをids[k]に置き、前後に分ける
 static
-void createIsland(PfxTriMesh &island,const PfxArray<PfxMcFacetPtr> &facets)
+void selectIslands(const PfxAabb16 *aabbList,PfxUInt16 *ids,PfxInt32 numIds,PfxInt32 k,int axis)
 {
-	if(facets.empty()) return;
-	
-	island.m_numFacets = facets.size();
+	PfxInt32 left = 0,right = numIds-1;
+	while(left < right) {
+		PfxUInt32 pivot = getIslandCenter(aabbList[ids[(left+right)>>1]],axis);
+		PfxInt32 i = left,j = right;
+		while(i <= j) {
+			while(getIslandCenter(aabbList[ids[i]],axis) < pivot) i++;
+			while(getIslandCenter(aabbList[ids[j]],axis) > pivot) j--;
+			if(i <= j) {
+				PfxUInt16 tmp = ids[i];
+				ids[i++] = ids[j];
+				ids[j--] = tmp;
+			}
+		}
+		if(k <= j) right = j;
+		else if(k >= i) left = i;
+		else break;
+	}
+}
+
+// 中心の分布が最も広い軸の中央値で再帰的に分割する。ノードは深さ優先順に並ぶ
+static
+void buildIslandBvh(PfxLargeTriMesh &lmesh,PfxUInt16 *ids,PfxInt32 numIds)
+{
+	PfxUInt32 nodeId = lmesh.m_numBvhNodes++;
+	PfxAabb16 &node = lmesh.m_bvhNodes[nodeId];
+
+	if(numIds == 1) {
+		node = lmesh.m_aabbList[ids[0]];
+		pfxSetBvhIslandId(node,ids[0]);
+		pfxSetBvhEscapeId(node,(PfxUInt16)(nodeId+1));
+		return;
+	}
+
+	PfxUInt32 centerMin[3] = {0xffffffff,0xffffffff,0xffffffff};
+	PfxUInt32 centerMax[3] = {0,0,0};
+
+	node = lmesh.m_aabbList[ids[0]];
+	for(PfxInt32 i=0;i<numIds;i++) {
+		const PfxAabb16 &aabb = lmesh.m_aabbList[ids[i]];
+		node = pfxMergeAabb(node,aabb);
+		for(int axis=0;axis<3;axis++) {
+			centerMin[axis] = SCE_PFX_MIN(centerMin[axis],getIslandCenter(aabb,axis));
+			centerMax[axis] = SCE_PFX_MAX(centerMax[axis],getIslandCenter(aabb,axis));
+		}
+	}
+
+	int splitAxis = 0;
+	for(int axis=1;axis<3;axis++) {
+		if(centerMax[axis] - centerMin[axis] > centerMax[splitAxis] - centerMin[splitAxis]) splitAxis = axis;
+	}
+
+	PfxInt32 numLeft = numIds >> 1;
+	selectIslands(lmesh.m_aabbList,ids,numIds,numLeft,splitAxis);
+
+	buildIslandBvh(lmesh,ids,numLeft);
+	buildIslandBvh(lmesh,ids+numLeft,numIds-numLeft);
+
+	pfxSetBvhIslandId(lmesh.m_bvhNodes[nodeId],SCE_PFX_LARGETRIMESH_BVH_INTERNAL);
+	pfxSetBvhEscapeId(lmesh.m_bvhNodes[nodeId],(PfxUInt16)lmesh.m_numBvhNodes);
+}
+
+static
+void createIslandBvh(PfxLargeTriMesh &lmesh)
+{
+	// 面を持たないアイランドはAABBが無いので除外する
+	PfxUInt16 *ids = (PfxUInt16*)SCE_PFX_UTIL_ALLOC(16,sizeof(PfxUInt16)*lmesh.m_numIslands);
+	PfxInt32 numIds = 0;
+	for(PfxUInt32 i=0;i<lmesh.m_numIslands;i++) {
+		if(lmesh.m_islands[i].m_numFacets > 0) {
+			ids[numIds++] = (PfxUInt16)i;
+		}
+	}
+
+	lmesh.m_numBvhNodes = 0;
+	lmesh.m_bvhNodes = (PfxAabb16*)SCE_PFX_UTIL_ALLOC(128,sizeof(PfxAabb16)*SCE_PFX_MAX(2*numIds-1,1));
+
+	if(numIds > 0) {
+		buildIslandBvh(lmesh,ids,numIds);
+	}
+
+	SCE_PFX_UTIL_FREE(ids);
+}
+
+// vertsMapは入力メッシュの頂点からアイランドの頂点へのインデックス。未使用は-1で、使用後は-1に戻して返す
+// 共有する頂点に書き込まないので、異なるvertsMapを使えば複数のアイランドを並列に作成できる
+static
+void createIsland(PfxTriMesh &island,const PfxMcFacetPtr *facets,PfxUInt32 numFacets,PfxInt32 *vertsMap)
+{
+	if(numFacets == 0) return;
 	
-	PfxUInt32 vertsFlag[(0xff*SCE_PFX_NUMMESHFACETS*3+31)/32];
-	memset(vertsFlag,0,sizeof(PfxUInt32)*((0xff*SCE_PFX_NUMMESHFACETS*3+31)/32));
+	island.m_numFacets = numFacets;
 	
-	PfxArray<PfxMcEdgeEntry*> edgeHead(facets.size()*3);
-	PfxArray<PfxMcEdgeEntry> edgeList(facets.size()*3);
+	PfxArray<PfxMcEdgeEntry*> edgeHead(numFacets*3);
+	PfxArray<PfxMcEdgeEntry> edgeList(numFacets*3);
 
 	PfxMcEdgeEntry* nl = NULL;
-	edgeHead.assign(facets.size()*3,nl);
-	edgeList.assign(facets.size()*3,PfxMcEdgeEntry());
+	edgeHead.assign(numFacets*3,nl);
+	edgeList.assign(numFacets*3,PfxMcEdgeEntry());
 	
 	int vcnt = 0;
 	int ecnt = 0;
-	for(PfxUInt32 f=0;f<facets.size();f++) {
+	for(PfxUInt32 f=0;f<numFacets;f++) {
 		PfxMcFacet &iFacet = *facets[f];
 		PfxMcEdge *iEdge[3] = {
 			iFacet.e[0],
@@ -418,20 +722,20 @@ void createIsland(PfxTriMesh &island,const PfxArray<PfxMcFacetPtr> &facets)
 		oFacet.m_center[0] = oFacet.m_center[1] = oFacet.m_center[2] = 0.0f;
 		pfxStoreVector3(iFacet.n,oFacet.m_normal);
 		oFacet.m_thickness = iFacet.thickness;
+		oFacet.m_group = 0;
+		oFacet.m_userData = 0;
 		
 		// Vertex
 		for(int v=0;v<3;v++) {
 			PfxMcVert *vert = facets[f]->v[v];
 			PfxUInt32 idx = vert->i;
-			PfxUInt32 mask = 1 << (idx & 31);
-			if((vertsFlag[idx>>5] & mask) == 0) {
+			if(vertsMap[idx] < 0) {
 				SCE_PFX_ASSERT(vcnt<SCE_PFX_NUMMESHVERTICES);
-                vertsFlag[idx>>5] |= mask;
-                island.m_verts[vcnt] = vert->coord;
-				vert->flag = vcnt;// 新しいインデックス
+				island.m_verts[vcnt] = vert->coord;
+				vertsMap[idx] = vcnt;// 新しいインデックス
 				vcnt++;
 			}
-			oFacet.m_vertIds[v] = (PfxUInt8)vert->flag;
+			oFacet.m_vertIds[v] = (PfxUInt8)vertsMap[idx];
 		}
 		
 		// Edge
@@ -481,13 +785,56 @@ void createIsland(PfxTriMesh &island,const PfxArray<PfxMcFacetPtr> &facets)
 	island.m_numVerts = vcnt;
 	
 	island.updateAABB();
+
+	for(PfxUInt32 f=0;f<numFacets;f++) {
+		for(int v=0;v<3;v++) {
+			vertsMap[facets[f]->v[v]->i] = -1;
+		}
+	}
+}
+
+// アイランドの構築で使用する構造体
+struct PfxCreateIslandsIO {
+	PfxLargeTriMesh *lmesh;
+	const PfxMcIslands *islands;
+	PfxUInt32 numVerts;
+};
+
+// start～end-1番目のアイランドを作成する
+static
+void createIslands(PfxCreateIslandsIO &io,PfxUInt32 start,PfxUInt32 end)
+{
+	PfxInt32 *vertsMap = (PfxInt32*)SCE_PFX_UTIL_ALLOC(16,sizeof(PfxInt32)*io.numVerts);
+	memset(vertsMap,0xff,sizeof(PfxInt32)*io.numVerts);
+
+	for(PfxUInt32 i=start;i<end;i++) {
+		PfxTriMesh island;
+		createIsland(island,io.islands->getFacets(i),io.islands->getNumFacets(i),vertsMap);
+		setIslandToLargeTriMesh(*io.lmesh,i,island);
+		//SCE_PFX_PRINTF("island %d verts %d edges %d facets %d\n",i,island.m_numVerts,island.m_numEdges,island.m_numFacets);
+	}
+
+	SCE_PFX_UTIL_FREE(vertsMap);
+}
+
+// アイランドの面数は最大でもnumFacetsLimitなので均等に分割する
+static
+void createIslandsTaskEntry(PfxTaskArg *arg)
+{
+	PfxCreateIslandsIO &io = *((PfxCreateIslandsIO*)arg->io);
+	PfxUInt32 numIslands = io.islands->numIslands;
+	PfxUInt32 start = (PfxUInt32)(((PfxUInt64)numIslands * arg->taskId) / arg->maxTasks);
+	PfxUInt32 end = (PfxUInt32)(((PfxUInt64)numIslands * (arg->taskId+1)) / arg->maxTasks);
+	createIslands(io,start,end);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 // ラージメッシュ
 
-PfxInt32 pfxCreateLargeTriMesh(PfxLargeTriMesh &lmesh,const PfxCreateLargeTriMeshParam &param)
+static
+PfxInt32 createLargeTriMesh(PfxLargeTriMesh &lmesh,const PfxCreateLargeTriMeshParam &param,PfxTaskManager *taskManager)
 {
+
 	// Check input
 	if(param.numVerts == 0 || param.numTriangles == 0 || !param.verts || !param.triangles)
 		return SCE_PFX_ERR_INVALID_VALUE;
@@ -580,12 +927,12 @@ PfxInt32 pfxCreateLargeTriMesh(PfxLargeTriMesh &lmesh,const PfxCreateLargeTriMes
 
 	{
 		PfxArray<PfxMcTriList> triEntry(numTriangles*3);
-		PfxArray<PfxMcTriList*> triHead(numTriangles*3);	// 頂点から面への参照リスト
+		PfxArray<PfxMcTriList*> triHead(param.numVerts);	// 頂点から面への参照リスト
 		PfxInt32 cnt = 0;
 		
 		PfxMcTriList* nl = NULL;
 		triEntry.assign(numTriangles*3,PfxMcTriList());
-		triHead.assign(numTriangles*3,nl);
+		triHead.assign(param.numVerts,nl);
 		
 		// 頂点から面への参照リストを作成
 		for(PfxUInt32 i=0;i<numTriangles;i++) {
@@ -598,27 +945,57 @@ PfxInt32 pfxCreateLargeTriMesh(PfxLargeTriMesh &lmesh,const PfxCreateLargeTriMes
 		}
 		
 		// 同一頂点をまとめる
+		// 頂点を同一とみなす距離の格子に登録し、周囲27個の格子に含まれる頂点とだけ比較する
 		if(param.flag & SCE_PFX_MESH_FLAG_AUTO_ELIMINATION) {
+			const PfxFloat cellSize = sqrtf(epsilon);
+			const PfxUInt32 numBuckets = getNumBuckets(param.numVerts);
+			
+			PfxArray<PfxInt32> bucketHead(numBuckets);
+			PfxArray<PfxInt32> bucketNext(param.numVerts);
+			bucketHead.assign(numBuckets,-1);
+			bucketNext.assign(param.numVerts,-1);
+			
+			for(PfxUInt32 i=0;i<param.numVerts;i++) {
+				const PfxVector3 &coord = vertList[i].coord;
+				PfxUInt32 key = getCellKey(getCell(coord[0],cellSize),getCell(coord[1],cellSize),getCell(coord[2],cellSize),numBuckets);
+				bucketNext[i] = bucketHead[key];
+				bucketHead[key] = (PfxInt32)i;
+			}
+			
 			for(PfxUInt32 i=0;i<param.numVerts;i++) {
 				if(vertList[i].flag == 1) continue;
-				for(PfxUInt32 j=i+1;j<param.numVerts;j++) {
-					if(vertList[j].flag == 1) continue;
-
-					PfxFloat lenSqr = lengthSqr(vertList[i].coord-vertList[j].coord);
-					
-					if(lenSqr < epsilon) {
-						//SCE_PFX_PRINTF("same position %d,%d\n",i,j);
-						vertList[j].flag = 1; // 同一点なのでフラグを立てる
-						for(PfxMcTriList *f=triHead[j];f!=NULL;f=f->next) {
-							for(PfxInt32 k=0;k<3;k++) {
-								if(f->facet->v[k] == &vertList[j]) {
-									f->facet->v[k] = &vertList[i]; // 頂点を付け替える
-									break;
+				
+				const PfxVector3 &coord = vertList[i].coord;
+				PfxInt32 cell[3] = {
+					getCell(coord[0],cellSize),
+					getCell(coord[1],cellSize),
+					getCell(coord[2],cellSize),
+				};
+				
+				for(PfxInt32 z=cell[2]-1;z<=cell[2]+1;z++) {
+				for(PfxInt32 y=cell[1]-1;y<=cell[1]+1;y++) {
+				for(PfxInt32 x=cell[0]-1;x<=cell[0]+1;x++) {
+					for(PfxInt32 j=bucketHead[getCellKey(x,y,z,numBuckets)];j>=0;j=bucketNext[j]) {
+						if((PfxUInt32)j <= i || vertList[j].flag == 1) continue;
+						
+						PfxFloat lenSqr = lengthSqr(coord-vertList[j].coord);
+						
+						if(lenSqr < epsilon) {
+							//SCE_PFX_PRINTF("same position %d,%d\n",i,j);
+							vertList[j].flag = 1; // 同一点なのでフラグを立てる
+							for(PfxMcTriList *f=triHead[j];f!=NULL;f=f->next) {
+								for(PfxInt32 k=0;k<3;k++) {
+									if(f->facet->v[k] == &vertList[j]) {
+										f->facet->v[k] = &vertList[i]; // 頂点を付け替える
+										break;
+									}
 								}
 							}
 						}
 					}
 				}
+				}
+				}
 			}
 		}
 	}
@@ -672,11 +1049,10 @@ PfxInt32 pfxCreateLargeTriMesh(PfxLargeTriMesh &lmesh,const PfxCreateLargeTriMes
 	}
 	
 	// 角度を計算
+	PfxQueue<PfxMcFacetLink> cqueue(ecnt); // 面毎に空になるので使い回す
 	for(PfxUInt32 i=0;i<numTriangles;i++) {
 		PfxMcFacet &facetA = facetList[i];
 
-		PfxQueue<PfxMcFacetLink> cqueue(ecnt);
-
 		for(PfxUInt32 j=0;j<3;j++) {
 			if(facetA.neighbor[j] >= 0) {
 				cqueue.push(PfxMcFacetLink(
@@ -709,7 +1085,7 @@ PfxInt32 pfxCreateLargeTriMesh(PfxLargeTriMesh &lmesh,const PfxCreateLargeTriMes
 				PfxFloat chk2 = dot(ofacet.n,midPnt-pntOnEdge);
 				
 				if(chk1 < -epsilon && chk2 < -epsilon) {
-					if(link.ifacetId == i) edge->angleType = SCE_PFX_EDGE_CONVEX;
+					if(link.ifacetId == (PfxInt32)i) edge->angleType = SCE_PFX_EDGE_CONVEX;
 
 					// 厚み角の判定に使う角度をセット
 					if(param.flag & SCE_PFX_MESH_FLAG_AUTO_THICKNESS) {
@@ -717,10 +1093,10 @@ PfxInt32 pfxCreateLargeTriMesh(PfxLargeTriMesh &lmesh,const PfxCreateLargeTriMes
 					}
 				}
 				else if(chk1 > epsilon && chk2 > epsilon) {
-					if(link.ifacetId == i) edge->angleType = SCE_PFX_EDGE_CONCAVE;
+					if(link.ifacetId == (PfxInt32)i) edge->angleType = SCE_PFX_EDGE_CONCAVE;
 				}
 				else {
-					if(link.ifacetId == i) edge->angleType = SCE_PFX_EDGE_FLAT;
+					if(link.ifacetId == (PfxInt32)i) edge->angleType = SCE_PFX_EDGE_FLAT;
 				}
 			}
 			
@@ -728,7 +1104,7 @@ PfxInt32 pfxCreateLargeTriMesh(PfxLargeTriMesh &lmesh,const PfxCreateLargeTriMes
 			if(param.flag & SCE_PFX_MESH_FLAG_AUTO_THICKNESS) {
 				PfxInt32 nextEdgeId = (link.oedgeId+1)%3;
 				PfxMcEdge *nextEdge = ofacet.e[nextEdgeId];
-				if(ofacet.neighbor[nextEdgeId] >= 0 && ofacet.neighbor[nextEdgeId] != i && 
+				if(ofacet.neighbor[nextEdgeId] >= 0 && ofacet.neighbor[nextEdgeId] != (PfxInt32)i && 
 				  ((PfxInt32)nextEdge->vertId[0] == link.vid1 || (PfxInt32)nextEdge->vertId[0] == link.vid2 || 
 				   (PfxInt32)nextEdge->vertId[1] == link.vid1 || (PfxInt32)nextEdge->vertId[1] == link.vid2) ) {
 					cqueue.push(PfxMcFacetLink(
@@ -739,7 +1115,7 @@ PfxInt32 pfxCreateLargeTriMesh(PfxLargeTriMesh &lmesh,const PfxCreateLargeTriMes
 				}
 				nextEdgeId = (link.oedgeId+2)%3;
 				nextEdge = ofacet.e[nextEdgeId];
-				if(ofacet.neighbor[nextEdgeId] >= 0 && ofacet.neighbor[nextEdgeId] != i && 
+				if(ofacet.neighbor[nextEdgeId] >= 0 && ofacet.neighbor[nextEdgeId] != (PfxInt32)i && 
 				  ((PfxInt32)nextEdge->vertId[0] == link.vid1 || (PfxInt32)nextEdge->vertId[0] == link.vid2 || 
 				   (PfxInt32)nextEdge->vertId[1] == link.vid1 || (PfxInt32)nextEdge->vertId[1] == link.vid2) ) {
 					cqueue.push(PfxMcFacetLink(
@@ -752,49 +1128,40 @@ PfxInt32 pfxCreateLargeTriMesh(PfxLargeTriMesh &lmesh,const PfxCreateLargeTriMes
 		}
 	}
 	
+	// 面のAABBを算出
+	for(PfxUInt32 f=0;f<numTriangles;f++) {
+		PfxVector3 pnts[3] = {
+			facetList[f].v[0]->coord,
+			facetList[f].v[1]->coord,
+			facetList[f].v[2]->coord,
+		};
+		facetList[f].aabbMin = minPerElem(pnts[2],minPerElem(pnts[1],pnts[0]));
+		facetList[f].aabbMax = maxPerElem(pnts[2],maxPerElem(pnts[1],pnts[0]));
+	}
+
 	// 面に厚みを付ける
 	if(param.flag & SCE_PFX_MESH_FLAG_AUTO_THICKNESS) {
-		for(PfxUInt32 i=0;i<numTriangles;i++) {
-			PfxMcFacet &facetA = facetList[i];
-			for(PfxUInt32 j=0;j<numTriangles;j++) {
-				// 隣接面は比較対象にしない
-				if( i==j ||
-					j == (PfxInt32)facetA.e[0]->facetId[0] ||
-					j == (PfxInt32)facetA.e[0]->facetId[1] ||
-					j == (PfxInt32)facetA.e[1]->facetId[0] ||
-					j == (PfxInt32)facetA.e[1]->facetId[1] ||
-					j == (PfxInt32)facetA.e[2]->facetId[0] ||
-					j == (PfxInt32)facetA.e[2]->facetId[1]) {
-					continue;
-				}
-				
-				PfxMcFacet &facetB = facetList[j];
-				
-				// 交差判定
-				PfxFloat closestDistance=0;
-				if(intersect(facetA,facetB,closestDistance)) {
-					// 最近接距離/2を厚みとして採用
-					facetA.thickness = SCE_PFX_MAX(param.defaultThickness,SCE_PFX_MIN(facetA.thickness,closestDistance * 0.5f));
-				}
-			}
-
+		PfxMcFacetGrid grid;
+		createFacetGrid(grid,facetList);
+		
+		PfxCalcThicknessIO io;
+		io.grid = &grid;
+		io.facetList = &facetList;
+		io.defaultThickness = param.defaultThickness;
+		
+		if(taskManager) {
+			runTasks(taskManager,calcThicknessTaskEntry,&io);
+		}
+		else {
+			calcThickness(io,0,numTriangles);
 		}
 	}
 
 	// 面の面積によって３種類に分類する
 	PfxFloat areaMin=SCE_PFX_FLT_MAX,areaMax=-SCE_PFX_FLT_MAX;
 	for(PfxUInt32 f=0;f<(PfxUInt32)numTriangles;f++) {
-		PfxVector3 pnts[3] = {
-			facetList[f].v[0]->coord,
-			facetList[f].v[1]->coord,
-			facetList[f].v[2]->coord,
-		};
 		areaMin = SCE_PFX_MIN(areaMin,facetList[f].area);
 		areaMax = SCE_PFX_MAX(areaMax,facetList[f].area);
-		
-		// 面のAABBを算出
-		facetList[f].aabbMin = minPerElem(pnts[2],minPerElem(pnts[1],pnts[0]));
-		facetList[f].aabbMax = maxPerElem(pnts[2],maxPerElem(pnts[1],pnts[0]));
 	}
 
 	PfxFloat areaDiff = (areaMax-areaMin)/3.0f;
@@ -823,7 +1190,7 @@ PfxInt32 pfxCreateLargeTriMesh(PfxLargeTriMesh &lmesh,const PfxCreateLargeTriMes
 
 	// アイランドの配列
 	PfxMcIslands islands;
-	PfxVector3 lmeshSize;
+	PfxVector3 lmeshSize(0.0f);
 
 	// レベル毎にPfxTriMeshを作成
 	if(!facetsLv0.empty()) {
@@ -897,28 +1264,38 @@ PfxInt32 pfxCreateLargeTriMesh(PfxLargeTriMesh &lmesh,const PfxCreateLargeTriMes
 	// Check Islands
 	//for(PfxInt32 i=0;i<islands.numIslands;i++) {
 	//	SCE_PFX_PRINTF("island %d\n",i);
-	//	for(PfxInt32 f=0;f<islands.facetsInIsland[i].size();f++) {
-	//		PfxMcFacet *facet = islands.facetsInIsland[i][f];
+	//	for(PfxInt32 f=0;f<islands.getNumFacets(i);f++) {
+	//		PfxMcFacet *facet = islands.getFacets(i)[f];
 	//		SCE_PFX_PRINTF("   %d %d %d\n",facet->v[0]->i,facet->v[1]->i,facet->v[2]->i);
 	//	}
 	//}
 
 	// PfxLargeTriMeshの生成
-	if(islands.numIslands > 0) {
-		lmesh.m_numIslands = 0;
+	if(islands.numIslands > 0 && islands.numIslands <= SCE_PFX_MAX_LARGETRIMESH_ISLANDS) {
+		lmesh.m_numIslands = islands.numIslands;
 		lmesh.m_aabbList = (PfxAabb16*)SCE_PFX_UTIL_ALLOC(128,sizeof(PfxAabb16)*islands.numIslands);
 		lmesh.m_islands = (PfxTriMesh*)SCE_PFX_UTIL_ALLOC(128,sizeof(PfxTriMesh)*islands.numIslands);
 		
-		PfxInt32 maxFacets=0,maxVerts=0,maxEdges=0;
-		for(PfxUInt32 i=0;i<islands.numIslands;i++) {
-			PfxTriMesh island;
-			createIsland(island,islands.facetsInIsland[i]);
-			addIslandToLargeTriMesh(lmesh,island);
-			maxFacets = SCE_PFX_MAX(maxFacets,island.m_numFacets);
-			maxVerts = SCE_PFX_MAX(maxVerts,island.m_numVerts);
-			maxEdges = SCE_PFX_MAX(maxEdges,island.m_numEdges);
-			//SCE_PFX_PRINTF("island %d verts %d edges %d facets %d\n",i,island.m_numVerts,island.m_numEdges,island.m_numFacets);
+		PfxCreateIslandsIO io;
+		io.lmesh = &lmesh;
+		io.islands = &islands;
+		io.numVerts = param.numVerts;
+		
+		if(taskManager) {
+			runTasks(taskManager,createIslandsTaskEntry,&io);
+		}
+		else {
+			createIslands(io,0,islands.numIslands);
 		}
+		
+		PfxUInt32 maxFacets=0,maxVerts=0,maxEdges=0;
+		for(PfxUInt32 i=0;i<lmesh.m_numIslands;i++) {
+			maxFacets = SCE_PFX_MAX(maxFacets,lmesh.m_islands[i].m_numFacets);
+			maxVerts = SCE_PFX_MAX(maxVerts,lmesh.m_islands[i].m_numVerts);
+			maxEdges = SCE_PFX_MAX(maxEdges,lmesh.m_islands[i].m_numEdges);
+		}
+
+		createIslandBvh(lmesh);
 
 		SCE_PFX_PRINTF("generate completed!\n\tinput mesh verts %d triangles %d\n\tislands %d max triangles %d verts %d edges %d\n",
 			param.numVerts,param.numTriangles,
@@ -926,18 +1303,31 @@ PfxInt32 pfxCreateLargeTriMesh(PfxLargeTriMesh &lmesh,const PfxCreateLargeTriMes
 		SCE_PFX_PRINTF("\tsizeof(PfxLargeTriMesh) %d sizeof(PfxTriMesh) %d\n",sizeof(PfxLargeTriMesh),sizeof(PfxTriMesh));
 	}
 	else {
-		SCE_PFX_PRINTF("islands overflow! %d/%d\n",islands.numIslands,SCE_PFX_LARGETRIMESH_MAX_ISLANDS);
+		SCE_PFX_PRINTF("islands overflow! %d/%d\n",islands.numIslands,SCE_PFX_MAX_LARGETRIMESH_ISLANDS);
 		return SCE_PFX_ERR_OUT_OF_RANGE;
 	}
 
 	return SCE_PFX_OK;
 }
 
+PfxInt32 pfxCreateLargeTriMesh(PfxLargeTriMesh &lmesh,const PfxCreateLargeTriMeshParam &param)
+{
+	return createLargeTriMesh(lmesh,param,NULL);
+}
+
+PfxInt32 pfxCreateLargeTriMesh(PfxLargeTriMesh &lmesh,const PfxCreateLargeTriMeshParam &param,PfxTaskManager *taskManager)
+{
+	if(!taskManager) return SCE_PFX_ERR_INVALID_VALUE;
+	return createLargeTriMesh(lmesh,param,taskManager);
+}
+
 void pfxReleaseLargeTriMesh(PfxLargeTriMesh &lmesh)
 {
 	SCE_PFX_UTIL_FREE(lmesh.m_aabbList);
 	SCE_PFX_UTIL_FREE(lmesh.m_islands);
+	SCE_PFX_UTIL_FREE(lmesh.m_bvhNodes);
 	lmesh.m_numIslands = 0;
+	lmesh.m_numBvhNodes = 0;
 }
 
 } //namespace PhysicsEffects